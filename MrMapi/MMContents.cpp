@@ -31,6 +31,8 @@ void DumpContentsTable(
 	if (cli::switchList.isSet()) output::DebugPrint(output::dbgLevel::Console, L"List only mode\n");
 	if (cli::switchRecurse.isSet()) output::DebugPrint(output::dbgLevel::Console, L"Recurse into subfolders\n");
 	if (ulCount) output::DebugPrint(output::dbgLevel::Console, L"Limiting output to %u messages.\n", ulCount);
+	const auto ulWorkers = cli::switchWorkers.atULONG(0);
+	if (ulWorkers > 1) output::DebugPrint(output::dbgLevel::Console, L"Walking folders on %u workers.\n", ulWorkers);
 
 	if (lpFolder)
 	{
@@ -66,6 +68,7 @@ void DumpContentsTable(
 
 		if (!cli::switchMoreProperties.isSet()) MyDumpStore.DisableStreamRetry();
 		if (cli::switchSkip.isSet()) MyDumpStore.DisableEmbeddedAttachments();
+		MyDumpStore.InitWorkers(ulWorkers);
 
 		MyDumpStore.ProcessFolders(
 			cli::switchContents.isSet(), cli::switchAssociatedContents.isSet(), cli::switchRecurse.isSet());
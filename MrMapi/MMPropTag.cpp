@@ -132,62 +132,55 @@ void PrintTagFromName(_In_z_ LPCWSTR lpszPropName, _In_ ULONG ulType)
 		wprintf(L"\n");
 	}
 
-	auto bMatchFound = false;
-
-	for (ULONG ulCur = 0; ulCur < PropTagArray.size(); ulCur++)
+	// The guy that matched lpszPropName
+	const auto ulExactMatch = proptags::LookupPropNameIndex(lpszPropName);
+	if (cache::ulNoMatch == ulExactMatch)
 	{
-		if (0 == lstrcmpiW(lpszPropName, PropTagArray[ulCur].lpszName))
-		{
-			if (cache::ulNoMatch == ulType)
-			{
-				PrintTag(ulCur);
-			}
-
-			// now that we have a match, let's see if we have other tags with the same number
-			const auto ulExactMatch = ulCur; // The guy that matched lpszPropName
+		wprintf(L"Property tag \"%ws\" not found\n", lpszPropName);
+		return;
+	}
 
-			std::vector<ULONG> ulExacts;
-			std::vector<ULONG> ulPartials;
-			proptags::FindTagArrayMatches(PropTagArray[ulExactMatch].ulValue, true, PropTagArray, ulExacts, ulPartials);
+	if (cache::ulNoMatch == ulType)
+	{
+		PrintTag(ulExactMatch);
+	}
 
-			// We're gonna skip at least one, so only print if we have more than one
-			if (ulExacts.size() > 1)
-			{
-				if (cache::ulNoMatch == ulType)
-				{
-					wprintf(L"\nOther exact matches:\n");
-				}
+	// now that we have a match, let's see if we have other tags with the same number
+	std::vector<ULONG> ulExacts;
+	std::vector<ULONG> ulPartials;
+	proptags::FindTagArrayMatches(PropTagArray[ulExactMatch].ulValue, true, PropTagArray, ulExacts, ulPartials);
 
-				for (const auto& ulMatch : ulExacts)
-				{
-					if (cache::ulNoMatch == ulType && ulExactMatch == ulMatch) continue; // skip this one
-					if (cache::ulNoMatch != ulType && ulType != PROP_TYPE(PropTagArray[ulMatch].ulValue)) continue;
-					PrintTag(ulMatch);
-				}
-			}
+	// We're gonna skip at least one, so only print if we have more than one
+	if (ulExacts.size() > 1)
+	{
+		if (cache::ulNoMatch == ulType)
+		{
+			wprintf(L"\nOther exact matches:\n");
+		}
 
-			if (!ulPartials.empty())
-			{
-				if (cache::ulNoMatch == ulType)
-				{
-					wprintf(L"\nOther partial matches:\n");
-				}
+		for (const auto& ulMatch : ulExacts)
+		{
+			if (cache::ulNoMatch == ulType && ulExactMatch == ulMatch) continue; // skip this one
+			if (cache::ulNoMatch != ulType && ulType != PROP_TYPE(PropTagArray[ulMatch].ulValue)) continue;
+			PrintTag(ulMatch);
+		}
+	}
 
-				for (const auto& ulMatch : ulPartials)
-				{
-					if (PropTagArray[ulExactMatch].ulValue == PropTagArray[ulMatch].ulValue)
-						continue; // skip our exact matches
-					if (cache::ulNoMatch != ulType && ulType != PROP_TYPE(PropTagArray[ulMatch].ulValue)) continue;
-					PrintTag(ulMatch);
-				}
-			}
+	if (!ulPartials.empty())
+	{
+		if (cache::ulNoMatch == ulType)
+		{
+			wprintf(L"\nOther partial matches:\n");
+		}
 
-			bMatchFound = true;
-			break;
+		for (const auto& ulMatch : ulPartials)
+		{
+			if (PropTagArray[ulExactMatch].ulValue == PropTagArray[ulMatch].ulValue)
+				continue; // skip our exact matches
+			if (cache::ulNoMatch != ulType && ulType != PROP_TYPE(PropTagArray[ulMatch].ulValue)) continue;
+			PrintTag(ulMatch);
 		}
 	}
-
-	if (!bMatchFound) wprintf(L"Property tag \"%ws\" not found\n", lpszPropName);
 }
 
 // Search for properties matching lpszPropName on a substring
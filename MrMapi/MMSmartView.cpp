@@ -1,5 +1,6 @@
 #include <StdAfx.h>
 #include <core/smartview/SmartView.h>
+#include <core/smartview/block/blockEmitter.h>
 #include <core/utility/strings.h>
 #include <MrMapi/mmcli.h>
 #include <io.h>
@@ -7,17 +8,178 @@
 #include <core/utility/registry.h>
 #include <core/utility/output.h>
 #include <core/addin/mfcmapi.h>
+#include <atomic>
+#include <thread>
+
+namespace
+{
+	// Map a parser number, as listed in the help, to its parser
+	parserType ParserFromNumber(ULONG ulSVParser) noexcept
+	{
+		if (ulSVParser && ulSVParser < SmartViewParserTypeArray.size())
+		{
+			return static_cast<parserType>(SmartViewParserTypeArray[ulSVParser].type);
+		}
+
+		return parserType::NOPARSING;
+	}
+
+	// Decode one batch line of the form [<parser number>:][b64:]<data> and render it on a single line
+	std::wstring DecodeBatchLine(const std::string& line, parserType defaultParser)
+	{
+		auto szLine = strings::trimWhitespace(strings::LPCSTRToWstring(line.c_str()));
+		if (szLine.empty()) return {};
+
+		auto parser = defaultParser;
+		auto bBase64 = false;
+		for (auto colon = szLine.find(L':'); colon != std::wstring::npos; colon = szLine.find(L':'))
+		{
+			const auto tag = szLine.substr(0, colon);
+			auto ulParser = ULONG{};
+			if (strings::compareInsensitive(tag, L"b64"))
+			{
+				bBase64 = true;
+			}
+			else if (strings::tryWstringToUlong(ulParser, tag, 10, true))
+			{
+				parser = ParserFromNumber(ulParser);
+			}
+			else
+			{
+				break;
+			}
+
+			szLine.erase(0, colon + 1);
+		}
+
+		if (parser == parserType::NOPARSING) return L"Error: no parser for this line";
+
+		const auto bin = bBase64 ? strings::Base64Decode(szLine) : strings::HexStringToBin(szLine);
+		const auto sBin = SBinary{static_cast<ULONG>(bin.size()), const_cast<LPBYTE>(bin.data())};
+		const auto szResult = smartview::InterpretBinaryAsString(sBin, parser, nullptr);
+
+		// Escape so each result stays on one line and can be unescaped unambiguously
+		auto szEscaped = std::wstring{};
+		szEscaped.reserve(szResult.size());
+		for (const auto ch : szResult)
+		{
+			switch (ch)
+			{
+			case L'\\':
+				szEscaped += L"\\\\";
+				break;
+			case L'\n':
+				szEscaped += L"\\n";
+				break;
+			case L'\r':
+				break;
+			default:
+				szEscaped += ch;
+				break;
+			}
+		}
+
+		return szEscaped;
+	}
+
+	// Read the next line from fIn, without its line ending. Returns false at end of file.
+	bool ReadLine(_In_ FILE* fIn, std::string& line)
+	{
+		line.clear();
+		char buffer[0x10000];
+		while (fgets(buffer, sizeof buffer, fIn))
+		{
+			line += buffer;
+			if (!line.empty() && line.back() == '\n')
+			{
+				line.pop_back();
+				return true;
+			}
+		}
+
+		return !line.empty();
+	}
+
+	// Decode every line of fIn and write one result line per input line, in input order.
+	// Lines are decoded in parallel, a chunk at a time, so memory use doesn't grow with the input.
+	void DoSmartViewBatch(_In_ FILE* fIn, _In_opt_ FILE* fOut, parserType defaultParser)
+	{
+		constexpr size_t cLinesPerChunk = 0x1000;
+		const auto cThreads = max(std::thread::hardware_concurrency(), 1u);
+		auto lines = std::vector<std::string>{};
+		auto results = std::vector<std::wstring>{};
+		auto line = std::string{};
+		for (;;)
+		{
+			lines.clear();
+			while (lines.size() < cLinesPerChunk && ReadLine(fIn, line))
+			{
+				lines.push_back(line);
+			}
+
+			if (lines.empty()) break;
+
+			results.assign(lines.size(), {});
+			auto next = std::atomic<size_t>{};
+			const auto decode = [&] {
+				for (auto i = next++; i < lines.size(); i = next++)
+				{
+					results[i] = DecodeBatchLine(lines[i], defaultParser);
+				}
+			};
+
+			auto threads = std::vector<std::thread>{};
+			for (UINT i = 1; i < cThreads && i < lines.size(); i++)
+			{
+				threads.emplace_back(decode);
+			}
+
+			decode();
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			for (const auto& result : results)
+			{
+				if (fOut)
+				{
+					output::Output(output::dbgLevel::NoDebug, fOut, false, result + L"\n");
+				}
+				else
+				{
+					wprintf(L"%ws\n", result.c_str());
+				}
+			}
+		}
+	}
+} // namespace
 
 void DoSmartView()
 {
 	// Ignore the reg key that disables smart view parsing
 	registry::doSmartView = true;
 
-	auto ulStructType = parserType::NOPARSING;
-	const auto ulSVParser = cli::switchParser.atULONG(0);
-	if (ulSVParser && ulSVParser < SmartViewParserTypeArray.size())
+	const auto ulStructType = ParserFromNumber(cli::switchParser.atULONG(0));
+
+	if (cli::switchBatch.isSet())
 	{
-		ulStructType = static_cast<parserType>(SmartViewParserTypeArray[ulSVParser].type);
+		const auto input = cli::switchInput[0];
+		const auto output = cli::switchOutput[0];
+		const auto fIn = output::MyOpenFileMode(input, L"rb");
+		if (!fIn) wprintf(L"Cannot open input file %ws\n", input.c_str());
+		auto fOut = static_cast<FILE*>(nullptr);
+		if (!output.empty())
+		{
+			fOut = output::MyOpenFileMode(output, L"wb");
+			if (!fOut) wprintf(L"Cannot open output file %ws\n", output.c_str());
+		}
+
+		if (fIn && (output.empty() || fOut)) DoSmartViewBatch(fIn, fOut, ulStructType);
+
+		if (fOut) fclose(fOut);
+		if (fIn) fclose(fIn);
+		return;
 	}
 
 	if (ulStructType != parserType::NOPARSING)
@@ -54,18 +216,50 @@ void DoSmartView()
 				sBin.lpb = bin.data();
 			}
 
-			auto szString = smartview::InterpretBinary(sBin, ulStructType, nullptr)->toString();
-			if (!szString.empty())
+			auto bWrote = false;
+			if (cli::switchEmit.isSet())
 			{
-				if (fOut)
-				{
-					output::Output(output::dbgLevel::NoDebug, fOut, false, szString);
-				}
-				else
-				{
-					wprintf(L"%ws\n", strings::StripCarriage(szString).c_str());
-				}
+				// Structured output goes to a file as is. It's already UTF-8 (or binary).
+				// Binary needs an output file (see PostParseCheck). JSON on the console is widened, since stdout
+				// takes wide output only. A chunk can end partway through a character, so that waits for the next.
+				const auto format = strings::compareInsensitive(cli::switchEmit[0], L"binary")
+										? smartview::emitFormat::binary
+										: smartview::emitFormat::json;
+				auto szPending = std::string{};
+				smartview::emitBlocks(
+					smartview::InterpretBinary(sBin, ulStructType, nullptr), format, [&](const std::string& szData) {
+						bWrote = true;
+						if (fOut)
+						{
+							fwrite(szData.data(), sizeof(char), szData.size(), fOut);
+						}
+						else
+						{
+							szPending += szData;
+							const auto cb = strings::utf8CompleteLength(szPending);
+							fputws(strings::utf8Towstring(szPending.substr(0, cb)).c_str(), stdout);
+							szPending.erase(0, cb);
+						}
+					});
+				if (!szPending.empty()) fputws(strings::utf8Towstring(szPending).c_str(), stdout);
 			}
+			else
+			{
+				// Stream the results out as they're rendered rather than building the whole string first
+				smartview::InterpretBinaryAsString(sBin, ulStructType, nullptr, [&](const std::wstring& szString) {
+					bWrote = true;
+					if (fOut)
+					{
+						output::Output(output::dbgLevel::NoDebug, fOut, false, szString);
+					}
+					else
+					{
+						wprintf(L"%ws", strings::StripCarriage(szString).c_str());
+					}
+				});
+			}
+
+			if (bWrote && !fOut) wprintf(L"\n");
 		}
 
 		if (fOut) fclose(fOut);
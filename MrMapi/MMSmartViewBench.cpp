@@ -0,0 +1,337 @@
+#include <StdAfx.h>
+#include <MrMapi/MMSmartViewBench.h>
+#include <MrMapi/mmcli.h>
+#include <core/smartview/SmartView.h>
+#include <core/smartview/benchmark.h>
+#include <core/smartview/block/blockArena.h>
+#include <core/utility/strings.h>
+#include <core/utility/output.h>
+#include <core/utility/registry.h>
+#include <core/addin/mfcmapi.h>
+#include <chrono>
+#include <crtdbg.h>
+
+namespace
+{
+	constexpr ULONG defaultIterations = 100;
+	constexpr ULONG defaultTolerance = 10; // percent
+
+	// Measurements for one parser, summed over every corpus blob for it
+	struct benchResult
+	{
+		std::wstring parser;
+		size_t blobs{};
+		size_t bytes{}; // Input bytes parsed, once per iteration
+		long long parseNs{};
+		long long toStringNs{};
+		size_t parseAllocs{};
+		size_t toStringAllocs{};
+		size_t parsePeak{}; // Most heap a single parse held at once
+		size_t toStringPeak{}; // Most heap a single toString held at once
+
+		double parseNsPerByte() const noexcept { return bytes ? static_cast<double>(parseNs) / bytes : 0; }
+		double toStringNsPerByte() const noexcept { return bytes ? static_cast<double>(toStringNs) / bytes : 0; }
+	};
+
+	// Heap growth since StartPeak, and the most it's reached, as seen by the debug CRT's allocation hook.
+	// Release builds can't hook the CRT, so they don't measure peaks. The benchmark is single threaded.
+	long long heapGrowth{};
+	long long heapPeak{};
+#ifdef _DEBUG
+	_CRT_ALLOC_HOOK previousHook{};
+
+	int __cdecl TrackHeap(
+		int allocType,
+		void* pvData,
+		size_t nSize,
+		int nBlockUse,
+		long /*lRequest*/,
+		const unsigned char* /*szFileName*/,
+		int /*nLine*/) noexcept
+	{
+		// The CRT's own bookkeeping isn't ours
+		if (nBlockUse == _CRT_BLOCK) return TRUE;
+
+		// Frees and reallocs hand us the block before it's released
+		const auto cbOld = allocType != _HOOK_ALLOC && pvData ? _msize_dbg(pvData, nBlockUse) : 0;
+		const auto cbNew = allocType != _HOOK_FREE ? nSize : 0;
+		heapGrowth += static_cast<long long>(cbNew) - static_cast<long long>(cbOld);
+		heapPeak = max(heapPeak, heapGrowth);
+		return TRUE;
+	}
+#endif
+
+	void StartPeak() noexcept
+	{
+		heapGrowth = 0;
+		heapPeak = 0;
+#ifdef _DEBUG
+		previousHook = _CrtSetAllocHook(TrackHeap);
+#endif
+	}
+
+	// Most the heap grew by since StartPeak
+	size_t EndPeak() noexcept
+	{
+#ifdef _DEBUG
+		_CrtSetAllocHook(previousHook);
+#endif
+		return static_cast<size_t>(heapPeak);
+	}
+
+	std::wstring ParserName(parserType parser)
+	{
+		for (const auto& smartViewParser : SmartViewParserTypeArray)
+		{
+			if (smartViewParser.type == parser) return smartViewParser.lpszName;
+		}
+
+		return strings::format(L"%d", static_cast<int>(parser)); // STRING_OK
+	}
+
+	parserType ParserFromFileName(const std::wstring& szFileName)
+	{
+		auto ulPrefix = ULONG{};
+		const auto dash = szFileName.find(L'-');
+		if (dash == std::wstring::npos || !strings::tryWstringToUlong(ulPrefix, szFileName.substr(0, dash), 10))
+			return parserType::NOPARSING;
+
+		for (const auto& prefix : smartview::benchmark::corpusPrefixes)
+		{
+			if (prefix.first == ulPrefix) return prefix.second;
+		}
+
+		return parserType::NOPARSING;
+	}
+
+	// Corpus files are hex text, either UTF-16 LE with a byte order mark or single byte
+	std::vector<BYTE> LoadCorpusFile(const std::wstring& szPath)
+	{
+		const auto fIn = output::MyOpenFileMode(szPath, L"rb");
+		if (!fIn) return {};
+
+		auto raw = std::string{};
+		char buffer[0x1000];
+		for (auto cb = fread(buffer, 1, sizeof buffer, fIn); cb; cb = fread(buffer, 1, sizeof buffer, fIn))
+		{
+			raw.append(buffer, cb);
+		}
+
+		fclose(fIn);
+
+		if (raw.size() >= 2 && static_cast<BYTE>(raw[0]) == 0xff && static_cast<BYTE>(raw[1]) == 0xfe)
+		{
+			const auto wstr = reinterpret_cast<const wchar_t*>(raw.data());
+			return strings::HexStringToBin(std::wstring(wstr + 1, raw.size() / sizeof(wchar_t) - 1));
+		}
+
+		return strings::HexStringToBin(strings::stringTowstring(raw));
+	}
+
+	// Load every blob in the corpus directory, grouped by parser in prefix order
+	std::vector<std::pair<parserType, std::vector<std::vector<BYTE>>>> LoadCorpus(const std::wstring& szDir)
+	{
+		auto corpus = std::vector<std::pair<parserType, std::vector<std::vector<BYTE>>>>{};
+		for (const auto& prefix : smartview::benchmark::corpusPrefixes)
+		{
+			corpus.emplace_back(prefix.second, std::vector<std::vector<BYTE>>{});
+		}
+
+		auto findData = WIN32_FIND_DATAW{};
+		const auto hFind = FindFirstFileW((szDir + L"\\*.dat").c_str(), &findData); // STRING_OK
+		if (hFind == INVALID_HANDLE_VALUE) return {};
+
+		do
+		{
+			const auto parser = ParserFromFileName(findData.cFileName);
+			if (parser == parserType::NOPARSING) continue;
+
+			auto bin = LoadCorpusFile(szDir + L"\\" + findData.cFileName);
+			if (bin.empty()) continue;
+
+			for (auto& set : corpus)
+			{
+				if (set.first == parser) set.second.push_back(std::move(bin));
+			}
+		} while (FindNextFileW(hFind, &findData));
+
+		FindClose(hFind);
+
+		corpus.erase(
+			std::remove_if(corpus.begin(), corpus.end(), [](const auto& set) { return set.second.empty(); }),
+			corpus.end());
+		return corpus;
+	}
+
+	benchResult RunParser(parserType parser, const std::vector<std::vector<BYTE>>& blobs, ULONG ulIterations)
+	{
+		auto result = benchResult{};
+		result.parser = ParserName(parser);
+		result.blobs = blobs.size();
+
+		// Peaks are the same every time, so take them in a pass of their own, out of the way of the timings
+		for (const auto& bin : blobs)
+		{
+			StartPeak();
+			auto svp = smartview::GetSmartViewParser(parser, nullptr);
+			if (svp) svp->parse(smartview::binaryParser::borrow(bin), true);
+			result.parsePeak = max(result.parsePeak, EndPeak());
+
+			// Blocks render lazily, so toString pays for building the child blocks and their text
+			StartPeak();
+			const auto szResult = svp ? svp->toString() : std::wstring{};
+			result.toStringPeak = max(result.toStringPeak, EndPeak());
+		}
+
+		for (ULONG i = 0; i < ulIterations; i++)
+		{
+			for (const auto& bin : blobs)
+			{
+				result.bytes += bin.size();
+
+				const auto statsStart = smartview::blockArena::getStats();
+				const auto start = std::chrono::steady_clock::now();
+				auto svp = smartview::GetSmartViewParser(parser, nullptr);
+				if (svp) svp->parse(smartview::binaryParser::borrow(bin), true);
+				const auto parsed = std::chrono::steady_clock::now();
+				const auto statsParsed = smartview::blockArena::getStats();
+
+				const auto renderStart = std::chrono::steady_clock::now();
+				const auto szResult = svp ? svp->toString() : std::wstring{};
+				const auto rendered = std::chrono::steady_clock::now();
+				const auto statsRendered = smartview::blockArena::getStats();
+
+				result.parseNs += std::chrono::duration_cast<std::chrono::nanoseconds>(parsed - start).count();
+				result.toStringNs +=
+					std::chrono::duration_cast<std::chrono::nanoseconds>(rendered - renderStart).count();
+				result.parseAllocs += statsParsed.heapAllocations - statsStart.heapAllocations;
+				result.toStringAllocs += statsRendered.heapAllocations - statsParsed.heapAllocations;
+			}
+		}
+
+		return result;
+	}
+
+	// Per parse figures, as written to a results file
+	smartview::benchmark::result Summarize(const benchResult& result, ULONG ulIterations)
+	{
+		const auto parses = result.blobs * ulIterations;
+		auto line = smartview::benchmark::result{};
+		line.parser = result.parser;
+		line.blobs = result.blobs;
+		line.bytes = result.bytes / (ulIterations ? ulIterations : 1);
+		line.parseNsPerByte = result.parseNsPerByte();
+		line.toStringNsPerByte = result.toStringNsPerByte();
+		line.parseAllocs = parses ? result.parseAllocs / parses : 0;
+		line.toStringAllocs = parses ? result.toStringAllocs / parses : 0;
+		line.parsePeak = result.parsePeak;
+		line.toStringPeak = result.toStringPeak;
+		return line;
+	}
+
+	// Print each metric which grew more than ulTolerance percent past its baseline
+	bool CompareToBaseline(
+		const benchResult& result,
+		const smartview::benchmark::result& base,
+		ULONG ulIterations,
+		ULONG ulTolerance)
+	{
+		auto bPassed = true;
+		const auto check = [&](LPCWSTR szMetric, double current, double baselineValue) {
+			const auto limit = baselineValue * (100 + ulTolerance) / 100;
+			if (current > limit && current > baselineValue)
+			{
+				wprintf(
+					L"REGRESSION: %ws %ws %.3f (baseline %.3f)\n",
+					result.parser.c_str(),
+					szMetric,
+					current,
+					baselineValue);
+				bPassed = false;
+			}
+		};
+
+		const auto parses = static_cast<double>(result.blobs) * ulIterations;
+		check(L"parse ns/byte", result.parseNsPerByte(), base.parseNsPerByte); // STRING_OK
+		check(L"toString ns/byte", result.toStringNsPerByte(), base.toStringNsPerByte); // STRING_OK
+		if (parses)
+		{
+			check(L"parse allocs", result.parseAllocs / parses, static_cast<double>(base.parseAllocs)); // STRING_OK
+			check(
+				L"toString allocs", // STRING_OK
+				result.toStringAllocs / parses,
+				static_cast<double>(base.toStringAllocs));
+		}
+
+		// A peak of 0 wasn't measured, by a release build or a baseline from before we measured peaks
+		if (result.parsePeak && base.parsePeak)
+		{
+			check(
+				L"parse peak", // STRING_OK
+				static_cast<double>(result.parsePeak),
+				static_cast<double>(base.parsePeak));
+		}
+
+		if (result.toStringPeak && base.toStringPeak)
+		{
+			check(
+				L"toString peak", // STRING_OK
+				static_cast<double>(result.toStringPeak),
+				static_cast<double>(base.toStringPeak));
+		}
+		return bPassed;
+	}
+} // namespace
+
+bool DoSmartViewBenchmark()
+{
+	// Ignore the reg key that disables smart view parsing
+	registry::doSmartView = true;
+
+	const auto ulIterations = cli::switchBenchmark.hasULONG(0) ? cli::switchBenchmark.atULONG(0) : defaultIterations;
+	const auto ulTolerance = cli::switchBaseline.hasULONG(1) ? cli::switchBaseline.atULONG(1) : defaultTolerance;
+	const auto szCorpus = cli::switchInput[0];
+	const auto corpus = LoadCorpus(szCorpus);
+	if (corpus.empty())
+	{
+		wprintf(L"No smart view test data found in %ws\n", szCorpus.c_str());
+		return false;
+	}
+
+	auto baseline = std::map<std::wstring, smartview::benchmark::result>{};
+	if (cli::switchBaseline.isSet())
+	{
+		baseline = smartview::benchmark::loadResults(cli::switchBaseline[0]);
+		if (baseline.empty())
+		{
+			wprintf(L"Cannot read baseline %ws\n", cli::switchBaseline[0].c_str());
+			return false;
+		}
+	}
+
+	wprintf(L"%ws", smartview::benchmark::resultHeader);
+
+	auto bPassed = true;
+	auto results = std::vector<smartview::benchmark::result>{};
+	for (const auto& set : corpus)
+	{
+		const auto result = RunParser(set.first, set.second, ulIterations);
+		results.push_back(Summarize(result, ulIterations));
+		wprintf(L"%ws", smartview::benchmark::formatResult(results.back()).c_str());
+
+		const auto base = baseline.find(result.parser);
+		if (base != baseline.end() && !CompareToBaseline(result, base->second, ulIterations, ulTolerance))
+		{
+			bPassed = false;
+		}
+	}
+
+	// Saved in the same form loadResults reads, so this run can be the next one's baseline
+	const auto output = cli::switchOutput[0];
+	if (!output.empty() && !smartview::benchmark::saveResults(output, results))
+	{
+		wprintf(L"Cannot open output file %ws\n", output.c_str());
+	}
+
+	return bPassed;
+}
@@ -0,0 +1,5 @@
+#pragma once
+// Smart View parser benchmarks for MrMAPI
+
+// Returns false if results regressed against the baseline
+bool DoSmartViewBenchmark();
@@ -12,6 +12,7 @@
 #include <MrMapi/MMPropTag.h>
 #include <MrMapi/MMRules.h>
 #include <MrMapi/MMSmartView.h>
+#include <MrMapi/MMSmartViewBench.h>
 #include <MrMapi/MMStore.h>
 #include <MrMapi/MMMapiMime.h>
 #include <MrMapi/MMPst.h>
@@ -19,6 +20,7 @@
 #include <core/utility/strings.h>
 #include <core/utility/import.h>
 #include <core/mapi/mapiStoreFunctions.h>
+#include <core/mapi/cache/namedPropCache.h>
 #include <mapistub/library/stubutils.h>
 #include <core/addin/addin.h>
 #include <core/utility/registry.h>
@@ -130,6 +132,7 @@ bool LoadMAPIVersion(const std::wstring& lpszVersion)
 int wmain(_In_ int argc, _In_count_(argc) wchar_t* argv[])
 {
 	auto hRes = S_OK;
+	auto iRet = 0;
 	auto bMAPIInit = false;
 	LPMAPISESSION lpMAPISession{};
 	LPMDB lpMDB{};
@@ -138,6 +141,12 @@ int wmain(_In_ int argc, _In_count_(argc) wchar_t* argv[])
 	// Enable unicode output through wprintf
 	// Don't use printf in this mode!
 	static_cast<void>(_setmode(_fileno(stdout), _O_U16TEXT));
+	// Redirected output is written a buffer at a time rather than a call at a time.
+	// Everything printed goes through the one stream, so it all stays in order.
+	if (GetFileType(GetStdHandle(STD_OUTPUT_HANDLE)) != FILE_TYPE_CHAR)
+	{
+		static_cast<void>(setvbuf(stdout, nullptr, _IOFBF, 64 * 1024));
+	}
 
 	registry::doSmartView = true;
 	registry::useGetPropList = true;
@@ -307,6 +316,9 @@ int wmain(_In_ int argc, _In_count_(argc) wchar_t* argv[])
 		case cli::cmdmodeNamedProps:
 			DoNamedProps(lpMAPISession, lpMDB);
 			break;
+		case cli::cmdmodeSmartViewBenchmark:
+			if (!DoSmartViewBenchmark()) iRet = 1;
+			break;
 		case cli::cmdmodeUnknown:
 			break;
 		case cli::cmdmodeHelp:
@@ -324,10 +336,12 @@ int wmain(_In_ int argc, _In_count_(argc) wchar_t* argv[])
 		MAPIUninitialize();
 	}
 
+	cache::namedPropCache::flushToDisk();
+
 	if (!(cli::switchNoAddins.isSet()))
 	{
 		addin::UnloadAddIns();
 	}
 
-	return 0;
+	return iRet;
 }
\ No newline at end of file
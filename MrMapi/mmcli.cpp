@@ -31,6 +31,11 @@ namespace cli
 	option switchParser{L"ParserType", cmdmodeSmartView, 1, 1, OPT_INITMFC | OPT_NEEDINPUTFILE};
 	option switchInput{L"Input", cmdmodeUnknown, 1, 1, OPT_NOOPT};
 	option switchBinary{L"Binary", cmdmodeSmartView, 0, 0, OPT_NOOPT};
+	option switchBatch{L"Batch", cmdmodeSmartView, 0, 0, OPT_INITMFC | OPT_NEEDINPUTFILE};
+	option switchEmit{L"Emit", cmdmodeSmartView, 1, 1, OPT_NOOPT};
+	option switchBenchmark{
+		L"Benchmark", cmdmodeSmartViewBenchmark, 0, 1, OPT_INITMFC | OPT_NEEDINPUTFILE | OPT_NEEDNUM};
+	option switchBaseline{L"Baseline", cmdmodeSmartViewBenchmark, 1, 2, OPT_NOOPT};
 	option switchAcl{L"Acl", cmdmodeAcls, 0, 0, OPT_INITALL | OPT_NEEDFOLDER};
 	option switchRule{L"Rules", cmdmodeRules, 0, 0, OPT_INITALL | OPT_NEEDFOLDER};
 	option switchContents{L"Contents", cmdmodeContents, 0, 0, OPT_INITALL};
@@ -73,6 +78,7 @@ namespace cli
 	option switchFindProperty{L"FindProperty", cmdmodeContents, 1, USHRT_MAX, OPT_INITALL};
 	option switchFindNamedProperty{L"FindNamedProperty", cmdmodeContents, 1, USHRT_MAX, OPT_INITALL};
 	option switchRecurse{L"Recurse", cmdmodeContents, 0, 0, OPT_NOOPT};
+	option switchWorkers{L"Workers", cmdmodeUnknown, 1, 1, OPT_NOOPT};
 
 	// If we want to add aliases for any switches, add them here
 	option switchHelpAlias{L"Help", cmdmodeHelpFull, 0, 0, OPT_INITMFC};
@@ -93,6 +99,10 @@ namespace cli
 		&switchParser,
 		&switchInput,
 		&switchBinary,
+		&switchBatch,
+		&switchEmit,
+		&switchBenchmark,
+		&switchBaseline,
 		&switchAcl,
 		&switchRule,
 		&switchContents,
@@ -135,6 +145,7 @@ namespace cli
 		&switchFindProperty,
 		&switchFindNamedProperty,
 		&switchRecurse,
+		&switchWorkers,
 		// If we want to add aliases for any switches, add them here
 		&switchHelpAlias,
 	};
@@ -175,11 +186,24 @@ namespace cli
 		wprintf(L"   MrMAPI -%ws\n", switchGuid.name());
 		wprintf(L"   MrMAPI -%ws <error>\n", switchError.name());
 		wprintf(
-			L"   MrMAPI -%ws <type> -%ws <input file> [-%ws] [-%ws <output file>]\n",
+			L"   MrMAPI -%ws <type> -%ws <input file> [-%ws] [-%ws json|binary] [-%ws <output file>]\n",
 			switchParser.name(),
 			switchInput.name(),
 			switchBinary.name(),
+			switchEmit.name(),
 			switchOutput.name());
+		wprintf(
+			L"   MrMAPI -%ws [-%ws <type>] -%ws <input file> [-%ws <output file>]\n",
+			switchBatch.name(),
+			switchParser.name(),
+			switchInput.name(),
+			switchOutput.name());
+		wprintf(
+			L"   MrMAPI -%ws [iterations] -%ws <corpus directory> [-%ws <output file>]\n",
+			switchBenchmark.name(),
+			switchInput.name(),
+			switchOutput.name());
+		wprintf(L"          [-%ws <baseline file> [tolerance]]\n", switchBaseline.name());
 		wprintf(
 			L"   MrMAPI -%ws <flag value> [-%ws] [-%ws] <property number>|<property name>\n",
 			switchFlag.name(),
@@ -212,10 +236,11 @@ namespace cli
 			switchRecent.name(),
 			switchSkip.name());
 		wprintf(
-			L"          [-%ws <property names>] [-%ws <dispid names>] [-%ws]\n",
+			L"          [-%ws <property names>] [-%ws <dispid names>] [-%ws] [-%ws <count>]\n",
 			switchFindProperty.name(),
 			switchFindNamedProperty.name(),
-			switchRecurse.name());
+			switchRecurse.name(),
+			switchWorkers.name());
 		wprintf(
 			L"   MrMAPI -%ws [-%ws <profile>] [-%ws <folder>]\n",
 			switchChildFolders.name(),
@@ -228,10 +253,11 @@ namespace cli
 			switchOutput.name(),
 			switchSkip.name());
 		wprintf(
-			L"   MrMAPI -%ws [fid] [-%ws [mid]] [-%ws <profile>]\n",
+			L"   MrMAPI -%ws [fid] [-%ws [mid]] [-%ws <profile>] [-%ws <count>]\n",
 			switchFid.name(),
 			switchMid.name(),
-			switchProfile.name());
+			switchProfile.name(),
+			switchWorkers.name());
 		wprintf(
 			L"   MrMAPI [<property number>|<property name>] -%ws [<store num>] [-%ws <profile>]\n",
 			switchStore.name(),
@@ -328,6 +354,24 @@ namespace cli
 				L"   -P   (or -%ws) Parser type (number). See list below for supported parsers.\n",
 				switchParser.name());
 			wprintf(L"   -B   (or -%ws) Input file is binary. Default is hex encoded text.\n", switchBinary.name());
+			wprintf(
+				L"   -Ba  (or -%ws) Input file has one blob per line, each written as [<type>:][b64:]<data>.\n",
+				switchBatch.name());
+			wprintf(L"           Data is hex unless marked b64: for base64. <type> overrides -P for that line.\n");
+			wprintf(L"           Output has one line per input line, in order, with line breaks escaped as \\n.\n");
+			wprintf(
+				L"   -Em  (or -%ws) Output the parsed structure instead of text. Each field has its name,\n",
+				switchEmit.name());
+			wprintf(L"           offset, size and typed value. json is UTF-8, binary is length prefixed records\n");
+			wprintf(L"           and needs an output file. Not available with -%ws.\n", switchBatch.name());
+			wprintf(L"   -Benchmark    Time each parser over a directory of smart view test data such as\n");
+			wprintf(L"           UnitTest\\SmartViewTestData\\In. Files are named <number>-<name>.dat.\n");
+			wprintf(L"           Each file is run [iterations] times (default 100). Reports ns/byte,\n");
+			wprintf(L"           block allocations per parse and the most heap one parse or toString still held\n");
+			wprintf(L"           when it returned.\n");
+			wprintf(L"           Use -%ws to save the results as a baseline.\n", switchOutput.name());
+			wprintf(L"   -Baseline     Compare results to a saved baseline. Any metric more than [tolerance]\n");
+			wprintf(L"           percent (default 10) worse is reported and MrMAPI exits with 1.\n");
 			wprintf(L"\n");
 			wprintf(L"   Rules Table:\n");
 			wprintf(L"   -R   (or -%ws) Output rules table. Profile optional.\n", switchRule.name());
@@ -355,6 +399,8 @@ namespace cli
 				L"   -FindN  (or -%ws) Restrict output to messages which contain given named properties.\n",
 				switchFindNamedProperty.name());
 			wprintf(L"   -Recur  (or -%ws) Recurse into subfolders.\n", switchRecurse.name());
+			wprintf(L"   -Wo  (or -%ws) Walk subfolders on 'count' worker threads.\n", switchWorkers.name());
+			wprintf(L"           Files and screen output are the same as a walk on one thread.\n");
 			wprintf(L"\n");
 			wprintf(L"   Child Folders:\n");
 			wprintf(L"   -Chi (or -%ws) List child folders of selected folder.\n", switchChildFolders.name());
@@ -370,6 +416,7 @@ namespace cli
 				L"           If -%ws is specified without a MID, display all messages in folders specified by the FID "
 				"parameter.\n",
 				switchMid.name());
+			wprintf(L"   -Wo  (or -%ws) Search folders on 'count' worker threads.\n", switchWorkers.name());
 			wprintf(L"\n");
 			wprintf(L"   Store Properties\n");
 			wprintf(L"   -St  (or -%ws) Output properties of stores as XML.\n", switchStore.name());
@@ -582,7 +629,7 @@ namespace cli
 
 		// If we weren't passed an output file/directory, remember the current directory
 		if (switchOutput.empty() && options.mode != cmdmodeSmartView && options.mode != cmdmodeProfile &&
-			options.mode != cmdmodeNamedProps)
+			options.mode != cmdmodeNamedProps && options.mode != cmdmodeSmartViewBenchmark)
 		{
 			WCHAR strPath[_MAX_PATH];
 			GetCurrentDirectoryW(_MAX_PATH, strPath);
@@ -620,7 +667,22 @@ namespace cli
 
 			break;
 		case cmdmodeSmartView:
-			if (switchParser.atULONG(0) == 0) options.mode = cmdmodeHelp;
+			// Batch input can name a parser on each line instead
+			if (switchParser.atULONG(0) == 0 && !switchBatch.isSet()) options.mode = cmdmodeHelp;
+			else if (switchBatch.isSet() && switchBinary.isSet())
+				options.mode = cmdmodeHelp;
+			else if (switchEmit.isSet())
+			{
+				const auto json = strings::compareInsensitive(switchEmit[0], L"json");
+				const auto binary = strings::compareInsensitive(switchEmit[0], L"binary");
+				// Binary output can't go to the console
+				if (switchBatch.isSet() || !(json || (binary && !switchOutput.empty()))) options.mode = cmdmodeHelp;
+			}
+
+			break;
+		case cmdmodeSmartViewBenchmark:
+			// A baseline alone isn't enough - we need the benchmark switch to run anything
+			if (!switchBenchmark.isSet()) options.mode = cmdmodeHelp;
 
 			break;
 		case cmdmodeContents:
@@ -15,6 +15,10 @@ namespace cli
 	extern option switchParser;
 	extern option switchInput;
 	extern option switchBinary;
+	extern option switchBatch;
+	extern option switchEmit;
+	extern option switchBenchmark;
+	extern option switchBaseline;
 	extern option switchAcl;
 	extern option switchRule;
 	extern option switchContents;
@@ -57,6 +61,7 @@ namespace cli
 	extern option switchFindProperty;
 	extern option switchFindNamedProperty;
 	extern option switchRecurse;
+	extern option switchWorkers;
 
 	extern std::vector<option*> g_options;
 
@@ -83,6 +88,7 @@ namespace cli
 		cmdmodeSearchState,
 		cmdmodeNamedProps,
 		cmdmodeEnumAccounts,
+		cmdmodeSmartViewBenchmark,
 	};
 
 	enum OPTIONFLAGS
@@ -1485,7 +1485,7 @@ namespace controls::sortlistctrl
 	void CContentsTableListCtrl::OnOutputTable(const std::wstring& szFileName) const
 	{
 		if (m_bInLoadOp) return;
-		const auto fTable = output::MyOpenFile(szFileName, true);
+		const auto fTable = output::MyOpenFile(szFileName, true, true);
 		if (fTable)
 		{
 			output::outputTable(output::dbgLevel::NoDebug, fTable, m_lpContentsTable);
@@ -6,6 +6,7 @@
 #include <core/utility/strings.h>
 #include <core/utility/output.h>
 #include <core/addin/mfcmapi.h>
+#include <core/smartview/renderCache.h>
 
 namespace dialog::editor
 {
@@ -105,6 +106,9 @@ namespace dialog::editor
 		// Commit our values to the registry
 		registry::WriteToRegistry();
 
+		// Options can change how Smart View renders, so drop anything rendered under the old ones
+		smartview::renderCache::clear();
+
 		CEditor::OnOK();
 	}
 
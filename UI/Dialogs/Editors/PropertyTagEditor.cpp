@@ -111,21 +111,22 @@ namespace dialog::editor
 	}
 
 	// Search for properties matching lpszDispIDName on a substring
-	_Check_return_ LPNAMEID_ARRAY_ENTRY GetDispIDFromName(_In_z_ LPCWSTR lpszDispIDName)
+	_Check_return_ const NAMEID_ARRAY_ENTRY* GetDispIDFromName(_In_z_ LPCWSTR lpszDispIDName)
 	{
 		if (!lpszDispIDName) return nullptr;
 
-		const auto entry = find_if(begin(NameIDArray), end(NameIDArray), [&](NAMEID_ARRAY_ENTRY& nameID) noexcept {
-			if (0 == wcscmp(nameID.lpszName, lpszDispIDName))
-			{
-				// PSUNKNOWN is used as a placeholder in NameIDArray - don't return matching entries
-				if (!IsEqualGUID(*nameID.lpGuid, guid::PSUNKNOWN)) return true;
-			}
+		const auto entry =
+			std::find_if(NameIDArray.begin(), NameIDArray.end(), [&](const NAMEID_ARRAY_ENTRY& nameID) noexcept {
+				if (0 == wcscmp(nameID.lpszName, lpszDispIDName))
+				{
+					// PSUNKNOWN is used as a placeholder in NameIDArray - don't return matching entries
+					if (!IsEqualGUID(*nameID.lpGuid, guid::PSUNKNOWN)) return true;
+				}
 
-			return false;
-		});
+				return false;
+			});
 
-		return entry != end(NameIDArray) ? &(*entry) : nullptr;
+		return entry != NameIDArray.end() ? entry : nullptr;
 	}
 
 	void CPropertyTagEditor::LookupNamedProp(ULONG ulSkipField, bool bCreate)
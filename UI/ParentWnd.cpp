@@ -7,6 +7,7 @@
 #include <core/addin/addin.h>
 #include <core/utility/registry.h>
 #include <core/utility/output.h>
+#include <core/mapi/cache/namedPropCache.h>
 
 extern ui::CMyWinApp theApp;
 
@@ -94,6 +95,7 @@ namespace ui
 		UninitializeGDI();
 		addin::UnloadAddIns();
 		if (m_hwinEventHook) UnhookWinEvent(m_hwinEventHook);
+		cache::namedPropCache::flushToDisk();
 		registry::WriteToRegistry();
 		output::CloseDebugFile();
 		// Since we're killing what m_pMainWnd points to here, we need to clear it
@@ -0,0 +1,1394 @@
+#include <UnitTest/stdafx.h>
+#include <UnitTest/syntheticStore.h>
+#include <core/mapi/mapiMemory.h>
+#include <core/mapi/mapiFunctions.h>
+#include <core/mapi/extraPropTags.h>
+#include <core/interpret/guid.h>
+#include <core/utility/strings.h>
+#include <core/utility/error.h>
+#include <random>
+
+namespace synthetic
+{
+	constexpr ULONG firstNamedPropID = 0x8000; // Named prop names[i] has ID firstNamedPropID + i
+	constexpr ULONG firstExtraPropID = 0x6900;
+
+	// One object's props in a single MAPI buffer
+	struct propSet
+	{
+		ULONG cValues{};
+		LPSPropValue lpProps{};
+
+		propSet() = default;
+		propSet(const propSet&) = delete;
+		propSet& operator=(const propSet&) = delete;
+		propSet(propSet&& other) noexcept { *this = std::move(other); }
+		propSet& operator=(propSet&& other) noexcept
+		{
+			std::swap(cValues, other.cValues);
+			std::swap(lpProps, other.lpProps);
+			return *this;
+		}
+		~propSet() { MAPIFreeBuffer(lpProps); }
+
+		// Matches on PROP_ID, so callers can ask for any type
+		_Check_return_ const SPropValue* find(ULONG ulPropTag) const noexcept
+		{
+			for (ULONG i = 0; i < cValues; i++)
+			{
+				if (PROP_ID(lpProps[i].ulPropTag) == PROP_ID(ulPropTag)) return &lpProps[i];
+			}
+
+			return nullptr;
+		}
+	};
+
+	struct messageData;
+
+	struct attachData
+	{
+		propSet props; // Includes PR_ATTACH_DATA_BIN unless embedded
+		std::unique_ptr<messageData> embedded;
+	};
+
+	struct messageData
+	{
+		propSet props;
+		std::vector<propSet> recipients; // Rows of the recipient table
+		std::vector<attachData> attachments; // PR_ATTACH_NUM is the index
+	};
+
+	struct folderData
+	{
+		propSet props;
+		std::vector<ULONG> children; // Indexes in storeData::folders
+		std::vector<messageData> messages;
+		std::vector<messageData> associated;
+	};
+
+	struct storeData
+	{
+		storeConfig config;
+		callCounts counts;
+		propSet props;
+		std::vector<folderData> folders; // The root is first
+		std::vector<BYTE> sig; // PR_MAPPING_SIGNATURE on every object, so named props can be cached
+		std::vector<std::wstring> nameStrings; // Backs the MNID_STRING names
+		std::vector<MAPINAMEID> names;
+		ULONG cMessages{};
+	};
+
+	void callCounts::reset() noexcept
+	{
+		for (auto count : {&OpenEntry,
+						   &GetHierarchyTable,
+						   &GetContentsTable,
+						   &GetRecipientTable,
+						   &GetAttachmentTable,
+						   &OpenAttach,
+						   &SetColumns,
+						   &QueryRows,
+						   &GetProps,
+						   &GetPropList,
+						   &GetNamesFromIDs,
+						   &GetIDsFromNames,
+						   &OpenProperty,
+						   &Read})
+		{
+			*count = 0;
+		}
+	}
+
+	std::wstring callCounts::toString() const
+	{
+		const std::vector<std::pair<LPCWSTR, ULONG>> calls = {
+			{L"OpenEntry", OpenEntry},
+			{L"GetHierarchyTable", GetHierarchyTable},
+			{L"GetContentsTable", GetContentsTable},
+			{L"GetRecipientTable", GetRecipientTable},
+			{L"GetAttachmentTable", GetAttachmentTable},
+			{L"OpenAttach", OpenAttach},
+			{L"SetColumns", SetColumns},
+			{L"QueryRows", QueryRows},
+			{L"GetProps", GetProps},
+			{L"GetPropList", GetPropList},
+			{L"GetNamesFromIDs", GetNamesFromIDs},
+			{L"GetIDsFromNames", GetIDsFromNames},
+			{L"OpenProperty", OpenProperty},
+			{L"Read", Read},
+		};
+
+		auto parts = std::vector<std::wstring>{};
+		for (const auto& call : calls)
+		{
+			parts.push_back(strings::format(L"%ws=%u", call.first, call.second));
+		}
+
+		return strings::join(parts, L" ");
+	}
+
+	// Entry IDs say which folder and message they are
+	enum class objectKind : ULONG
+	{
+		folder = 1,
+		message,
+		associated,
+	};
+
+	struct entryID
+	{
+		BYTE abFlags[4];
+		objectKind kind;
+		ULONG ulFolder;
+		ULONG ulMessage;
+	};
+
+	std::vector<BYTE> makeEntryID(objectKind kind, ULONG ulFolder, ULONG ulMessage)
+	{
+		const auto eid = entryID{{}, kind, ulFolder, ulMessage};
+		const auto lpb = reinterpret_cast<const BYTE*>(&eid);
+		return {lpb, lpb + sizeof eid};
+	}
+
+	// Fids and mids as a store hands them out: replica 1, then a big endian global counter
+	LARGE_INTEGER makeId(ULONGLONG ullCounter) noexcept
+	{
+		auto li = LARGE_INTEGER{};
+		const auto lpb = reinterpret_cast<LPBYTE>(&li.QuadPart);
+		lpb[0] = 1;
+		for (auto i = 7; i >= 2; i--)
+		{
+			lpb[i] = static_cast<BYTE>(ullCounter & 0xFF);
+			ullCounter >>= 8;
+		}
+
+		return li;
+	}
+
+	size_t cbValue(const SPropValue& prop) noexcept
+	{
+		switch (PROP_TYPE(prop.ulPropTag))
+		{
+		case PT_BINARY:
+			return prop.Value.bin.cb;
+		case PT_UNICODE:
+			return prop.Value.lpszW ? wcslen(prop.Value.lpszW) * sizeof(WCHAR) : 0;
+		default:
+			return sizeof prop.Value;
+		}
+	}
+
+	// We keep strings as Unicode. Callers get them that way if they ask for it, by tag or by MAPI_UNICODE.
+	ULONG typeFor(ULONG ulStoredType, ULONG ulAskedType, bool bUnicode) noexcept
+	{
+		if (ulStoredType != PT_UNICODE) return ulStoredType;
+		if (ulAskedType == PT_STRING8 || ulAskedType == PT_UNICODE) return ulAskedType;
+		return bUnicode ? PT_UNICODE : PT_STRING8;
+	}
+
+	bool typeMatches(ULONG ulStoredType, ULONG ulAskedType) noexcept
+	{
+		return ulAskedType == PT_UNSPECIFIED || ulAskedType == ulStoredType ||
+			   ulStoredType == PT_UNICODE && ulAskedType == PT_STRING8;
+	}
+
+	_Check_return_ HRESULT
+	copyValue(_In_ LPSPropValue lpDest, const SPropValue& src, ULONG ulPropType, _In_ LPVOID parent)
+	{
+		if (PROP_TYPE(src.ulPropTag) == PT_UNICODE && ulPropType == PT_STRING8)
+		{
+			const auto szA = strings::wstringTostring(src.Value.lpszW);
+			lpDest->ulPropTag = CHANGE_PROP_TYPE(src.ulPropTag, PT_STRING8);
+			lpDest->Value.lpszA = mapi::allocate<LPSTR>(static_cast<ULONG>(szA.length() + 1), parent);
+			if (!lpDest->Value.lpszA) return MAPI_E_NOT_ENOUGH_MEMORY;
+			memcpy(lpDest->Value.lpszA, szA.c_str(), szA.length() + 1);
+			return S_OK;
+		}
+
+		return mapi::MyPropCopyMore(lpDest, &src, MAPIAllocateMore, parent);
+	}
+
+	// Copies the props in lpTags, or all of them if there are no tags, to a new MAPI buffer.
+	// Props we don't have come back as PT_ERROR. So do big props, unless they're for a table row.
+	_Check_return_ HRESULT copyProps(
+		const storeData& store,
+		const propSet& props,
+		ULONG cTags,
+		_In_opt_count_(cTags) const ULONG* lpTags,
+		bool bUnicode,
+		bool bTable,
+		_Out_ ULONG* lpcValues,
+		_Deref_out_opt_ LPSPropValue* lppProps)
+	{
+		if (!lpcValues || !lppProps) return MAPI_E_INVALID_PARAMETER;
+		*lpcValues = 0;
+		*lppProps = nullptr;
+
+		const auto cValues = lpTags ? cTags : props.cValues;
+		const auto lpProps =
+			mapi::allocate<LPSPropValue>(static_cast<ULONG>(std::max(cValues, ULONG{1}) * sizeof(SPropValue)));
+		if (!lpProps) return MAPI_E_NOT_ENOUGH_MEMORY;
+
+		auto hRes = S_OK;
+		auto bErrors = false;
+		for (ULONG i = 0; i < cValues && SUCCEEDED(hRes); i++)
+		{
+			const auto ulAskedTag = lpTags ? lpTags[i] : props.lpProps[i].ulPropTag;
+			const auto ulAskedType = lpTags ? PROP_TYPE(ulAskedTag) : ULONG{PT_UNSPECIFIED};
+			const auto lpFound = lpTags ? props.find(ulAskedTag) : &props.lpProps[i];
+			auto& dest = lpProps[i];
+			if (!lpFound || !typeMatches(PROP_TYPE(lpFound->ulPropTag), ulAskedType))
+			{
+				dest.ulPropTag = CHANGE_PROP_TYPE(ulAskedTag, PT_ERROR);
+				dest.Value.err = MAPI_E_NOT_FOUND;
+				bErrors = true;
+			}
+			else if (!bTable && cbValue(*lpFound) > store.config.cbMaxProp)
+			{
+				dest.ulPropTag = CHANGE_PROP_TYPE(lpFound->ulPropTag, PT_ERROR);
+				dest.Value.err = MAPI_E_NOT_ENOUGH_MEMORY;
+				bErrors = true;
+			}
+			else
+			{
+				const auto ulPropType = typeFor(PROP_TYPE(lpFound->ulPropTag), ulAskedType, bUnicode);
+				hRes = copyValue(&dest, *lpFound, ulPropType, lpProps);
+			}
+		}
+
+		if (FAILED(hRes))
+		{
+			MAPIFreeBuffer(lpProps);
+			return hRes;
+		}
+
+		*lpcValues = cValues;
+		*lppProps = lpProps;
+		return bErrors ? MAPI_W_ERRORS_RETURNED : S_OK;
+	}
+
+	_Check_return_ const MAPINAMEID* findName(const storeData& store, ULONG ulPropID) noexcept
+	{
+		if (ulPropID < firstNamedPropID || ulPropID - firstNamedPropID >= store.names.size()) return nullptr;
+		return &store.names[ulPropID - firstNamedPropID];
+	}
+
+	bool nameMatches(const MAPINAMEID& name, const MAPINAMEID& other) noexcept
+	{
+		if (!other.lpguid || *name.lpguid != *other.lpguid || name.ulKind != other.ulKind) return false;
+		if (name.ulKind == MNID_ID) return name.Kind.lID == other.Kind.lID;
+		return other.Kind.lpwstrName && wcscmp(name.Kind.lpwstrName, other.Kind.lpwstrName) == 0;
+	}
+
+	_Check_return_ HRESULT getNamesFromIDs(
+		const storeData& store,
+		_Inout_ LPSPropTagArray* lppPropTags,
+		_In_opt_ LPCGUID lpPropSetGuid,
+		_Out_ ULONG* lpcPropNames,
+		_Out_ LPMAPINAMEID** lpppPropNames)
+	{
+		if (!lppPropTags || !lpcPropNames || !lpppPropNames) return MAPI_E_INVALID_PARAMETER;
+		*lpcPropNames = 0;
+		*lpppPropNames = nullptr;
+
+		// No tags asks for every name we have
+		if (!*lppPropTags)
+		{
+			const auto cNames = static_cast<ULONG>(store.names.size());
+			*lppPropTags = mapi::allocate<LPSPropTagArray>(CbNewSPropTagArray(cNames));
+			if (!*lppPropTags) return MAPI_E_NOT_ENOUGH_MEMORY;
+			(*lppPropTags)->cValues = cNames;
+			for (ULONG i = 0; i < cNames; i++)
+			{
+				mapi::setTag(*lppPropTags, i) = PROP_TAG(PT_UNSPECIFIED, firstNamedPropID + i);
+			}
+		}
+
+		const auto lpTags = *lppPropTags;
+		const auto lppNames = mapi::allocate<LPMAPINAMEID*>(
+			static_cast<ULONG>(std::max(lpTags->cValues, ULONG{1}) * sizeof(LPMAPINAMEID)));
+		if (!lppNames) return MAPI_E_NOT_ENOUGH_MEMORY;
+
+		auto bErrors = false;
+		for (ULONG i = 0; i < lpTags->cValues; i++)
+		{
+			const auto lpName = findName(store, PROP_ID(mapi::getTag(lpTags, i)));
+			if (!lpName || lpPropSetGuid && *lpPropSetGuid != *lpName->lpguid)
+			{
+				bErrors = true;
+				continue;
+			}
+
+			// Names are copied out, so they outlive the store
+			const auto lpCopy = mapi::allocate<LPMAPINAMEID>(sizeof(MAPINAMEID), lppNames);
+			const auto lpGuid = mapi::allocate<LPGUID>(sizeof(GUID), lppNames);
+			if (!lpCopy || !lpGuid)
+			{
+				MAPIFreeBuffer(lppNames);
+				return MAPI_E_NOT_ENOUGH_MEMORY;
+			}
+
+			*lpGuid = *lpName->lpguid;
+			*lpCopy = *lpName;
+			lpCopy->lpguid = lpGuid;
+			if (lpName->ulKind == MNID_STRING)
+			{
+				const auto cchName = wcslen(lpName->Kind.lpwstrName) + 1;
+				lpCopy->Kind.lpwstrName =
+					mapi::allocate<LPWSTR>(static_cast<ULONG>(cchName * sizeof(WCHAR)), lppNames);
+				if (!lpCopy->Kind.lpwstrName)
+				{
+					MAPIFreeBuffer(lppNames);
+					return MAPI_E_NOT_ENOUGH_MEMORY;
+				}
+
+				wcscpy_s(lpCopy->Kind.lpwstrName, cchName, lpName->Kind.lpwstrName);
+			}
+
+			lppNames[i] = lpCopy;
+		}
+
+		*lpcPropNames = lpTags->cValues;
+		*lpppPropNames = lppNames;
+		return bErrors ? MAPI_W_ERRORS_RETURNED : S_OK;
+	}
+
+	_Check_return_ HRESULT getIDsFromNames(
+		const storeData& store,
+		ULONG cPropNames,
+		_In_opt_count_(cPropNames) const LPMAPINAMEID* lppPropNames,
+		_Out_ LPSPropTagArray* lppPropTags)
+	{
+		if (!lppPropTags) return MAPI_E_INVALID_PARAMETER;
+		*lppPropTags = nullptr;
+		if (cPropNames && !lppPropNames) return MAPI_E_INVALID_PARAMETER;
+
+		// No names asks for every ID we have
+		const auto cTags = cPropNames ? cPropNames : static_cast<ULONG>(store.names.size());
+		const auto lpTags = mapi::allocate<LPSPropTagArray>(CbNewSPropTagArray(cTags));
+		if (!lpTags) return MAPI_E_NOT_ENOUGH_MEMORY;
+		lpTags->cValues = cTags;
+
+		auto bErrors = false;
+		for (ULONG i = 0; i < cTags; i++)
+		{
+			auto ulPropTag = cPropNames ? PROP_TAG(PT_ERROR, 0) : PROP_TAG(PT_UNSPECIFIED, firstNamedPropID + i);
+			if (cPropNames && lppPropNames[i])
+			{
+				for (ULONG iName = 0; iName < store.names.size(); iName++)
+				{
+					if (nameMatches(store.names[iName], *lppPropNames[i]))
+					{
+						ulPropTag = PROP_TAG(PT_UNSPECIFIED, firstNamedPropID + iName);
+						break;
+					}
+				}
+			}
+
+			if (PROP_TYPE(ulPropTag) == PT_ERROR) bErrors = true;
+			mapi::setTag(lpTags, i) = ulPropTag;
+		}
+
+		*lppPropTags = lpTags;
+		return bErrors ? MAPI_W_ERRORS_RETURNED : S_OK;
+	}
+
+	// Reads a copy of one prop's bytes
+	class streamObject : public IStream
+	{
+	public:
+		streamObject(const std::shared_ptr<storeData>& _store, std::vector<BYTE>&& _bytes)
+			: store(_store), bytes(std::move(_bytes))
+		{
+		}
+
+		STDMETHODIMP QueryInterface(REFIID riid, LPVOID* ppvObj) override
+		{
+			if (!ppvObj) return MAPI_E_INVALID_PARAMETER;
+			*ppvObj = nullptr;
+			if (riid != IID_IUnknown && riid != IID_ISequentialStream && riid != IID_IStream) return E_NOINTERFACE;
+			*ppvObj = static_cast<IStream*>(this);
+			AddRef();
+			return S_OK;
+		}
+		STDMETHODIMP_(ULONG) AddRef() override { return ++cRef; }
+		STDMETHODIMP_(ULONG) Release() override
+		{
+			const auto ulRef = --cRef;
+			if (!ulRef) delete this;
+			return ulRef;
+		}
+
+		STDMETHODIMP Read(void* pv, ULONG cb, ULONG* pcbRead) override
+		{
+			store->counts.Read++;
+			if (!pv) return STG_E_INVALIDPOINTER;
+			const auto cbLeft = ulPos < bytes.size() ? bytes.size() - ulPos : 0;
+			const auto cbRead = static_cast<ULONG>(std::min<size_t>(cb, cbLeft));
+			if (cbRead) memcpy(pv, bytes.data() + ulPos, cbRead);
+			ulPos += cbRead;
+			if (pcbRead) *pcbRead = cbRead;
+			return S_OK;
+		}
+		STDMETHODIMP Write(const void*, ULONG, ULONG*) override { return STG_E_ACCESSDENIED; }
+		STDMETHODIMP Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER* plibNewPosition) override
+		{
+			auto llBase = LONGLONG{};
+			switch (dwOrigin)
+			{
+			case STREAM_SEEK_SET:
+				break;
+			case STREAM_SEEK_CUR:
+				llBase = static_cast<LONGLONG>(ulPos);
+				break;
+			case STREAM_SEEK_END:
+				llBase = static_cast<LONGLONG>(bytes.size());
+				break;
+			default:
+				return STG_E_INVALIDFUNCTION;
+			}
+
+			const auto llPos = llBase + dlibMove.QuadPart;
+			if (llPos < 0) return STG_E_INVALIDFUNCTION;
+			ulPos = static_cast<size_t>(llPos);
+			if (plibNewPosition) plibNewPosition->QuadPart = ulPos;
+			return S_OK;
+		}
+		STDMETHODIMP SetSize(ULARGE_INTEGER) override { return STG_E_ACCESSDENIED; }
+		STDMETHODIMP CopyTo(IStream*, ULARGE_INTEGER, ULARGE_INTEGER*, ULARGE_INTEGER*) override { return E_NOTIMPL; }
+		STDMETHODIMP Commit(DWORD) override { return S_OK; }
+		STDMETHODIMP Revert() override { return S_OK; }
+		STDMETHODIMP LockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override { return STG_E_INVALIDFUNCTION; }
+		STDMETHODIMP UnlockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override { return STG_E_INVALIDFUNCTION; }
+		STDMETHODIMP Stat(STATSTG* pstatstg, DWORD) override
+		{
+			if (!pstatstg) return STG_E_INVALIDPOINTER;
+			*pstatstg = {};
+			pstatstg->type = STGTY_STREAM;
+			pstatstg->cbSize.QuadPart = bytes.size();
+			return S_OK;
+		}
+		STDMETHODIMP Clone(IStream**) override { return E_NOTIMPL; }
+
+	private:
+		virtual ~streamObject() = default;
+
+		std::shared_ptr<storeData> store;
+		std::vector<BYTE> bytes;
+		size_t ulPos{};
+		std::atomic<ULONG> cRef{1};
+	};
+
+	// A static table over rows the store owns
+	class tableObject : public IMAPITable
+	{
+	public:
+		tableObject(const std::shared_ptr<storeData>& _store, std::vector<const propSet*>&& _rows, bool _bUnicode)
+			: store(_store), rows(std::move(_rows)), bUnicode(_bUnicode)
+		{
+		}
+
+		STDMETHODIMP QueryInterface(REFIID riid, LPVOID* ppvObj) override
+		{
+			if (!ppvObj) return MAPI_E_INVALID_PARAMETER;
+			*ppvObj = nullptr;
+			if (riid != IID_IUnknown && riid != IID_IMAPITable) return E_NOINTERFACE;
+			*ppvObj = static_cast<IMAPITable*>(this);
+			AddRef();
+			return S_OK;
+		}
+		STDMETHODIMP_(ULONG) AddRef() override { return ++cRef; }
+		STDMETHODIMP_(ULONG) Release() override
+		{
+			const auto ulRef = --cRef;
+			if (!ulRef) delete this;
+			return ulRef;
+		}
+
+		STDMETHODIMP GetLastError(HRESULT, ULONG, LPMAPIERROR*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP Advise(ULONG, LPMAPIADVISESINK, ULONG_PTR*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP Unadvise(ULONG_PTR) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP GetStatus(ULONG* lpulTableStatus, ULONG* lpulTableType) override
+		{
+			if (!lpulTableStatus || !lpulTableType) return MAPI_E_INVALID_PARAMETER;
+			*lpulTableStatus = TBLSTAT_COMPLETE;
+			*lpulTableType = TBLTYPE_STATIC;
+			return S_OK;
+		}
+		STDMETHODIMP SetColumns(LPSPropTagArray lpPropTagArray, ULONG) override
+		{
+			store->counts.SetColumns++;
+			if (!lpPropTagArray) return MAPI_E_INVALID_PARAMETER;
+			columns.assign(lpPropTagArray->aulPropTag, lpPropTagArray->aulPropTag + lpPropTagArray->cValues);
+			return S_OK;
+		}
+		STDMETHODIMP QueryColumns(ULONG, LPSPropTagArray*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP GetRowCount(ULONG, ULONG* lpulCount) override
+		{
+			if (!lpulCount) return MAPI_E_INVALID_PARAMETER;
+			*lpulCount = static_cast<ULONG>(rows.size());
+			return S_OK;
+		}
+		STDMETHODIMP SeekRow(BOOKMARK bkOrigin, LONG lRowCount, LONG* lplRowsSought) override
+		{
+			auto lBase = LONG{};
+			switch (bkOrigin)
+			{
+			case BOOKMARK_BEGINNING:
+				break;
+			case BOOKMARK_CURRENT:
+				lBase = static_cast<LONG>(ulCursor);
+				break;
+			case BOOKMARK_END:
+				lBase = static_cast<LONG>(rows.size());
+				break;
+			default:
+				return MAPI_E_INVALID_BOOKMARK;
+			}
+
+			const auto lRow = std::clamp(lBase + lRowCount, LONG{0}, static_cast<LONG>(rows.size()));
+			if (lplRowsSought) *lplRowsSought = lRow - lBase;
+			ulCursor = static_cast<ULONG>(lRow);
+			return S_OK;
+		}
+		STDMETHODIMP SeekRowApprox(ULONG ulNumerator, ULONG ulDenominator) override
+		{
+			if (!ulDenominator) return MAPI_E_INVALID_PARAMETER;
+			ulCursor = static_cast<ULONG>(static_cast<ULONGLONG>(rows.size()) * ulNumerator / ulDenominator);
+			return S_OK;
+		}
+		STDMETHODIMP QueryPosition(ULONG* lpulRow, ULONG* lpulNumerator, ULONG* lpulDenominator) override
+		{
+			if (!lpulRow || !lpulNumerator || !lpulDenominator) return MAPI_E_INVALID_PARAMETER;
+			*lpulRow = ulCursor;
+			*lpulNumerator = ulCursor;
+			*lpulDenominator = static_cast<ULONG>(rows.size());
+			return S_OK;
+		}
+		STDMETHODIMP FindRow(LPSRestriction, BOOKMARK, ULONG) override { return MAPI_E_NO_SUPPORT; }
+		// Rows are generated, not searched or sorted. Callers treat this as a soft failure and see every row.
+		STDMETHODIMP Restrict(LPSRestriction, ULONG) override { return MAPI_E_TOO_COMPLEX; }
+		STDMETHODIMP CreateBookmark(BOOKMARK*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP FreeBookmark(BOOKMARK) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP SortTable(LPSSortOrderSet, ULONG) override { return MAPI_E_TOO_COMPLEX; }
+		STDMETHODIMP QuerySortOrder(LPSSortOrderSet*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP QueryRows(LONG lRowCount, ULONG ulFlags, LPSRowSet* lppRows) override
+		{
+			store->counts.QueryRows++;
+			if (store->config.ulLatencyMs) Sleep(store->config.ulLatencyMs);
+			if (!lppRows) return MAPI_E_INVALID_PARAMETER;
+			*lppRows = nullptr;
+			if (lRowCount < 0) return MAPI_E_NO_SUPPORT;
+
+			const auto cRows = static_cast<ULONG>(std::min<size_t>(lRowCount, rows.size() - ulCursor));
+			const auto lpRows = mapi::allocate<LPSRowSet>(CbNewSRowSet(cRows));
+			if (!lpRows) return MAPI_E_NOT_ENOUGH_MEMORY;
+
+			// Each row gets its own buffer, since FreeProws frees them one at a time
+			for (ULONG i = 0; i < cRows; i++)
+			{
+				const auto hRes = copyProps(
+					*store,
+					*rows[ulCursor + i],
+					static_cast<ULONG>(columns.size()),
+					columns.empty() ? nullptr : columns.data(),
+					bUnicode,
+					true,
+					&lpRows->aRow[i].cValues,
+					&lpRows->aRow[i].lpProps);
+				if (FAILED(hRes))
+				{
+					FreeProws(lpRows);
+					return hRes;
+				}
+
+				lpRows->cRows = i + 1;
+			}
+
+			if (!(ulFlags & TBL_NOADVANCE)) ulCursor += cRows;
+			*lppRows = lpRows;
+			return S_OK;
+		}
+		STDMETHODIMP Abort() override { return S_OK; }
+		STDMETHODIMP ExpandRow(ULONG, LPBYTE, ULONG, ULONG, LPSRowSet*, ULONG*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP CollapseRow(ULONG, LPBYTE, ULONG, ULONG*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP WaitForCompletion(ULONG, ULONG, ULONG* lpulTableStatus) override
+		{
+			if (lpulTableStatus) *lpulTableStatus = TBLSTAT_COMPLETE;
+			return S_OK;
+		}
+		STDMETHODIMP GetCollapseState(ULONG, ULONG, LPBYTE, ULONG*, LPBYTE*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP SetCollapseState(ULONG, ULONG, LPBYTE, BOOKMARK*) override { return MAPI_E_NO_SUPPORT; }
+
+	private:
+		virtual ~tableObject() = default;
+
+		std::shared_ptr<storeData> store;
+		std::vector<const propSet*> rows;
+		std::vector<ULONG> columns; // Empty for every prop in the row
+		bool bUnicode{};
+		ULONG ulCursor{};
+		std::atomic<ULONG> cRef{1};
+	};
+
+	_Check_return_ HRESULT openEntry(
+		const std::shared_ptr<storeData>& store,
+		ULONG cbEntryID,
+		_In_opt_ LPENTRYID lpEntryID,
+		_Out_opt_ ULONG* lpulObjType,
+		_Deref_out_opt_ LPUNKNOWN* lppUnk);
+
+	// IUnknown and IMAPIProp over a propSet the store owns
+	template <class I> class propObject : public I
+	{
+	public:
+		propObject(const std::shared_ptr<storeData>& _store, const propSet& _props) : store(_store), props(_props) {}
+
+		STDMETHODIMP QueryInterface(REFIID riid, LPVOID* ppvObj) override
+		{
+			if (!ppvObj) return MAPI_E_INVALID_PARAMETER;
+			*ppvObj = nullptr;
+			if (riid != IID_IUnknown && riid != IID_IMAPIProp && !isA(riid)) return E_NOINTERFACE;
+			*ppvObj = static_cast<I*>(this);
+			AddRef();
+			return S_OK;
+		}
+		STDMETHODIMP_(ULONG) AddRef() override { return ++cRef; }
+		STDMETHODIMP_(ULONG) Release() override
+		{
+			const auto ulRef = --cRef;
+			if (!ulRef) delete this;
+			return ulRef;
+		}
+
+		STDMETHODIMP GetLastError(HRESULT, ULONG, LPMAPIERROR*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP SaveChanges(ULONG) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP
+		GetProps(LPSPropTagArray lpPropTagArray, ULONG ulFlags, ULONG* lpcValues, LPSPropValue* lppPropArray) override
+		{
+			store->counts.GetProps++;
+			return copyProps(
+				*store,
+				props,
+				lpPropTagArray ? lpPropTagArray->cValues : 0,
+				lpPropTagArray ? lpPropTagArray->aulPropTag : nullptr,
+				ulFlags & MAPI_UNICODE,
+				false,
+				lpcValues,
+				lppPropArray);
+		}
+		STDMETHODIMP GetPropList(ULONG ulFlags, LPSPropTagArray* lppPropTagArray) override
+		{
+			store->counts.GetPropList++;
+			if (!lppPropTagArray) return MAPI_E_INVALID_PARAMETER;
+			const auto lpTags = mapi::allocate<LPSPropTagArray>(CbNewSPropTagArray(props.cValues));
+			*lppPropTagArray = lpTags;
+			if (!lpTags) return MAPI_E_NOT_ENOUGH_MEMORY;
+			lpTags->cValues = props.cValues;
+			for (ULONG i = 0; i < props.cValues; i++)
+			{
+				const auto ulPropTag = props.lpProps[i].ulPropTag;
+				mapi::setTag(lpTags, i) = CHANGE_PROP_TYPE(
+					ulPropTag, typeFor(PROP_TYPE(ulPropTag), PT_UNSPECIFIED, ulFlags & MAPI_UNICODE));
+			}
+
+			return S_OK;
+		}
+		STDMETHODIMP OpenProperty(ULONG ulPropTag, LPCIID lpiid, ULONG, ULONG, LPUNKNOWN* lppUnk) override
+		{
+			store->counts.OpenProperty++;
+			if (!lpiid || !lppUnk) return MAPI_E_INVALID_PARAMETER;
+			*lppUnk = nullptr;
+			if (*lpiid != IID_IStream) return openObject(ulPropTag, *lpiid, lppUnk);
+
+			const auto lpProp = props.find(ulPropTag);
+			if (!lpProp || !typeMatches(PROP_TYPE(lpProp->ulPropTag), PROP_TYPE(ulPropTag))) return MAPI_E_NOT_FOUND;
+
+			auto bytes = std::vector<BYTE>{};
+			switch (PROP_TYPE(lpProp->ulPropTag))
+			{
+			case PT_BINARY:
+				bytes.assign(lpProp->Value.bin.lpb, lpProp->Value.bin.lpb + lpProp->Value.bin.cb);
+				break;
+			case PT_UNICODE:
+				if (PROP_TYPE(ulPropTag) == PT_STRING8)
+				{
+					const auto szA = strings::wstringTostring(lpProp->Value.lpszW);
+					bytes.assign(szA.begin(), szA.end());
+				}
+				else
+				{
+					const auto lpb = reinterpret_cast<const BYTE*>(lpProp->Value.lpszW);
+					bytes.assign(lpb, lpb + cbValue(*lpProp));
+				}
+
+				break;
+			default:
+				return MAPI_E_NO_SUPPORT;
+			}
+
+			*lppUnk = new streamObject(store, std::move(bytes));
+			return S_OK;
+		}
+		STDMETHODIMP SetProps(ULONG, LPSPropValue, LPSPropProblemArray*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP DeleteProps(LPSPropTagArray, LPSPropProblemArray*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP CopyTo(
+			ULONG,
+			LPCIID,
+			LPSPropTagArray,
+			ULONG_PTR,
+			LPMAPIPROGRESS,
+			LPCIID,
+			LPVOID,
+			ULONG,
+			LPSPropProblemArray*) override
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+		STDMETHODIMP
+		CopyProps(LPSPropTagArray, ULONG_PTR, LPMAPIPROGRESS, LPCIID, LPVOID, ULONG, LPSPropProblemArray*) override
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+		STDMETHODIMP GetNamesFromIDs(
+			LPSPropTagArray* lppPropTags,
+			LPGUID lpPropSetGuid,
+			ULONG,
+			ULONG* lpcPropNames,
+			LPMAPINAMEID** lpppPropNames) override
+		{
+			store->counts.GetNamesFromIDs++;
+			return getNamesFromIDs(*store, lppPropTags, lpPropSetGuid, lpcPropNames, lpppPropNames);
+		}
+		STDMETHODIMP
+		GetIDsFromNames(ULONG cPropNames, LPMAPINAMEID* lppPropNames, ULONG, LPSPropTagArray* lppPropTags) override
+		{
+			store->counts.GetIDsFromNames++;
+			return getIDsFromNames(*store, cPropNames, lppPropNames, lppPropTags);
+		}
+
+	protected:
+		virtual ~propObject() = default;
+
+		// Interfaces beyond IUnknown and IMAPIProp
+		virtual bool isA(REFIID riid) const noexcept = 0;
+		// OpenProperty for anything but a stream
+		virtual HRESULT openObject(ULONG /*ulPropTag*/, REFIID /*riid*/, LPUNKNOWN* /*lppUnk*/)
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+
+		std::shared_ptr<storeData> store;
+		const propSet& props;
+
+	private:
+		std::atomic<ULONG> cRef{1};
+	};
+
+	_Check_return_ LPMAPITABLE
+	makeTable(const std::shared_ptr<storeData>& store, const std::vector<propSet>& rows, bool bUnicode)
+	{
+		auto lpRows = std::vector<const propSet*>{};
+		lpRows.reserve(rows.size());
+		for (const auto& row : rows)
+		{
+			lpRows.push_back(&row);
+		}
+
+		return new tableObject(store, std::move(lpRows), bUnicode);
+	}
+
+	class folderObject : public propObject<IMAPIFolder>
+	{
+	public:
+		folderObject(const std::shared_ptr<storeData>& _store, ULONG _ulFolder)
+			: propObject(_store, _store->folders[_ulFolder].props), folder(_store->folders[_ulFolder])
+		{
+		}
+
+		STDMETHODIMP GetContentsTable(ULONG ulFlags, LPMAPITABLE* lppTable) override
+		{
+			store->counts.GetContentsTable++;
+			if (!lppTable) return MAPI_E_INVALID_PARAMETER;
+			const auto& messages = ulFlags & MAPI_ASSOCIATED ? folder.associated : folder.messages;
+			auto rows = std::vector<const propSet*>{};
+			rows.reserve(messages.size());
+			for (const auto& message : messages)
+			{
+				rows.push_back(&message.props);
+			}
+
+			*lppTable = new tableObject(store, std::move(rows), ulFlags & MAPI_UNICODE);
+			return S_OK;
+		}
+		// Only the folder's own children. CONVENIENT_DEPTH isn't supported.
+		STDMETHODIMP GetHierarchyTable(ULONG ulFlags, LPMAPITABLE* lppTable) override
+		{
+			store->counts.GetHierarchyTable++;
+			if (!lppTable) return MAPI_E_INVALID_PARAMETER;
+			auto rows = std::vector<const propSet*>{};
+			rows.reserve(folder.children.size());
+			for (const auto child : folder.children)
+			{
+				rows.push_back(&store->folders[child].props);
+			}
+
+			*lppTable = new tableObject(store, std::move(rows), ulFlags & MAPI_UNICODE);
+			return S_OK;
+		}
+		STDMETHODIMP
+		OpenEntry(ULONG cbEntryID, LPENTRYID lpEntryID, LPCIID, ULONG, ULONG* lpulObjType, LPUNKNOWN* lppUnk) override
+		{
+			return openEntry(store, cbEntryID, lpEntryID, lpulObjType, lppUnk);
+		}
+		STDMETHODIMP SetSearchCriteria(LPSRestriction, LPENTRYLIST, ULONG) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP GetSearchCriteria(ULONG, LPSRestriction*, LPENTRYLIST*, ULONG*) override
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+		STDMETHODIMP CreateMessage(LPCIID, ULONG, LPMESSAGE*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP CopyMessages(LPENTRYLIST, LPCIID, LPVOID, ULONG_PTR, LPMAPIPROGRESS, ULONG) override
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+		STDMETHODIMP DeleteMessages(LPENTRYLIST, ULONG_PTR, LPMAPIPROGRESS, ULONG) override
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+		STDMETHODIMP CreateFolder(ULONG, LPTSTR, LPTSTR, LPCIID, ULONG, LPMAPIFOLDER*) override
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+		STDMETHODIMP CopyFolder(ULONG, LPENTRYID, LPCIID, LPVOID, LPTSTR, ULONG_PTR, LPMAPIPROGRESS, ULONG) override
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+		STDMETHODIMP DeleteFolder(ULONG, LPENTRYID, ULONG_PTR, LPMAPIPROGRESS, ULONG) override
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+		STDMETHODIMP SetReadFlags(LPENTRYLIST, ULONG_PTR, LPMAPIPROGRESS, ULONG) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP GetMessageStatus(ULONG, LPENTRYID, ULONG, ULONG*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP SetMessageStatus(ULONG, LPENTRYID, ULONG, ULONG, ULONG*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP SaveContentsSort(LPSSortOrderSet, ULONG) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP EmptyFolder(ULONG_PTR, LPMAPIPROGRESS, ULONG) override { return MAPI_E_NO_SUPPORT; }
+
+	private:
+		bool isA(REFIID riid) const noexcept override { return riid == IID_IMAPIFolder || riid == IID_IMAPIContainer; }
+
+		const folderData& folder;
+	};
+
+	class messageObject : public propObject<IMessage>
+	{
+	public:
+		messageObject(const std::shared_ptr<storeData>& _store, const messageData& _message)
+			: propObject(_store, _message.props), message(_message)
+		{
+		}
+
+		STDMETHODIMP GetAttachmentTable(ULONG ulFlags, LPMAPITABLE* lppTable) override
+		{
+			store->counts.GetAttachmentTable++;
+			if (!lppTable) return MAPI_E_INVALID_PARAMETER;
+			auto rows = std::vector<const propSet*>{};
+			rows.reserve(message.attachments.size());
+			for (const auto& attachment : message.attachments)
+			{
+				rows.push_back(&attachment.props);
+			}
+
+			*lppTable = new tableObject(store, std::move(rows), ulFlags & MAPI_UNICODE);
+			return S_OK;
+		}
+		STDMETHODIMP OpenAttach(ULONG ulAttachmentNum, LPCIID, ULONG, LPATTACH* lppAttach) override;
+		STDMETHODIMP CreateAttach(LPCIID, ULONG, ULONG*, LPATTACH*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP DeleteAttach(ULONG, ULONG_PTR, LPMAPIPROGRESS, ULONG) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP GetRecipientTable(ULONG ulFlags, LPMAPITABLE* lppTable) override
+		{
+			store->counts.GetRecipientTable++;
+			if (!lppTable) return MAPI_E_INVALID_PARAMETER;
+			*lppTable = makeTable(store, message.recipients, ulFlags & MAPI_UNICODE);
+			return S_OK;
+		}
+		STDMETHODIMP ModifyRecipients(ULONG, LPADRLIST) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP SubmitMessage(ULONG) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP SetReadFlag(ULONG) override { return MAPI_E_NO_SUPPORT; }
+
+	private:
+		bool isA(REFIID riid) const noexcept override { return riid == IID_IMessage; }
+
+		const messageData& message;
+	};
+
+	class attachObject : public propObject<IAttach>
+	{
+	public:
+		attachObject(const std::shared_ptr<storeData>& _store, const attachData& _attachment)
+			: propObject(_store, _attachment.props), attachment(_attachment)
+		{
+		}
+
+	private:
+		bool isA(REFIID riid) const noexcept override { return riid == IID_IAttachment; }
+
+		// Embedded messages open through PR_ATTACH_DATA_OBJ
+		HRESULT openObject(ULONG ulPropTag, REFIID riid, LPUNKNOWN* lppUnk) override
+		{
+			if (PROP_ID(ulPropTag) != PROP_ID(PR_ATTACH_DATA_OBJ) || riid != IID_IMessage) return MAPI_E_NO_SUPPORT;
+			if (!attachment.embedded) return MAPI_E_NOT_FOUND;
+			*lppUnk = static_cast<IMessage*>(new messageObject(store, *attachment.embedded));
+			return S_OK;
+		}
+
+		const attachData& attachment;
+	};
+
+	STDMETHODIMP messageObject::OpenAttach(ULONG ulAttachmentNum, LPCIID, ULONG, LPATTACH* lppAttach)
+	{
+		store->counts.OpenAttach++;
+		if (!lppAttach) return MAPI_E_INVALID_PARAMETER;
+		*lppAttach = nullptr;
+		if (ulAttachmentNum >= message.attachments.size()) return MAPI_E_NOT_FOUND;
+		*lppAttach = new attachObject(store, message.attachments[ulAttachmentNum]);
+		return S_OK;
+	}
+
+	class storeObject : public propObject<IMsgStore>
+	{
+	public:
+		explicit storeObject(const std::shared_ptr<storeData>& _store) : propObject(_store, _store->props) {}
+
+		STDMETHODIMP Advise(ULONG, LPENTRYID, ULONG, LPMAPIADVISESINK, ULONG_PTR*) override
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+		STDMETHODIMP Unadvise(ULONG_PTR) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP CompareEntryIDs(ULONG, LPENTRYID, ULONG, LPENTRYID, ULONG, ULONG*) override
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+		STDMETHODIMP
+		OpenEntry(ULONG cbEntryID, LPENTRYID lpEntryID, LPCIID, ULONG, ULONG* lpulObjType, LPUNKNOWN* lppUnk) override
+		{
+			return openEntry(store, cbEntryID, lpEntryID, lpulObjType, lppUnk);
+		}
+		STDMETHODIMP SetReceiveFolder(LPTSTR, ULONG, ULONG, LPENTRYID) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP GetReceiveFolder(LPTSTR, ULONG, ULONG*, LPENTRYID*, LPTSTR*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP GetReceiveFolderTable(ULONG, LPMAPITABLE*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP StoreLogoff(ULONG*) override { return S_OK; }
+		STDMETHODIMP AbortSubmit(ULONG, LPENTRYID, ULONG) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP GetOutgoingQueue(ULONG, LPMAPITABLE*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP SetLockState(LPMESSAGE, ULONG) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP FinishedMsg(ULONG, ULONG, LPENTRYID) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP NotifyNewMail(LPNOTIFICATION) override { return MAPI_E_NO_SUPPORT; }
+
+	private:
+		bool isA(REFIID riid) const noexcept override { return riid == IID_IMsgStore; }
+	};
+
+	// Folders and messages open from the store or any folder. No entry ID opens the root.
+	_Check_return_ HRESULT openEntry(
+		const std::shared_ptr<storeData>& store,
+		ULONG cbEntryID,
+		_In_opt_ LPENTRYID lpEntryID,
+		_Out_opt_ ULONG* lpulObjType,
+		_Deref_out_opt_ LPUNKNOWN* lppUnk)
+	{
+		store->counts.OpenEntry++;
+		if (store->config.ulLatencyMs) Sleep(store->config.ulLatencyMs);
+		if (!lppUnk) return MAPI_E_INVALID_PARAMETER;
+		*lppUnk = nullptr;
+
+		auto eid = entryID{{}, objectKind::folder, 0, 0};
+		if (cbEntryID)
+		{
+			if (cbEntryID != sizeof eid || !lpEntryID) return MAPI_E_INVALID_ENTRYID;
+			memcpy(&eid, lpEntryID, sizeof eid);
+		}
+
+		if (eid.ulFolder >= store->folders.size()) return MAPI_E_NOT_FOUND;
+		const auto& folder = store->folders[eid.ulFolder];
+
+		auto ulObjType = ULONG{};
+		switch (eid.kind)
+		{
+		case objectKind::folder:
+			*lppUnk = static_cast<IMAPIFolder*>(new folderObject(store, eid.ulFolder));
+			ulObjType = MAPI_FOLDER;
+			break;
+		case objectKind::message:
+		case objectKind::associated:
+		{
+			const auto& messages = eid.kind == objectKind::associated ? folder.associated : folder.messages;
+			if (eid.ulMessage >= messages.size()) return MAPI_E_NOT_FOUND;
+			*lppUnk = static_cast<IMessage*>(new messageObject(store, messages[eid.ulMessage]));
+			ulObjType = MAPI_MESSAGE;
+			break;
+		}
+		default:
+			return MAPI_E_INVALID_ENTRYID;
+		}
+
+		if (lpulObjType) *lpulObjType = ulObjType;
+		return S_OK;
+	}
+
+	// Collects one object's props, holding their strings and binaries until they're copied to a propSet
+	class propBuilder
+	{
+	public:
+		void addLong(ULONG ulPropTag, ULONG ulValue) { next(ulPropTag).Value.ul = ulValue; }
+		void addBool(ULONG ulPropTag, bool bValue) { next(ulPropTag).Value.b = bValue; }
+		void addI8(ULONG ulPropTag, LARGE_INTEGER liValue) { next(ulPropTag).Value.li = liValue; }
+		void addTime(ULONG ulPropTag, FILETIME ftValue) { next(ulPropTag).Value.ft = ftValue; }
+		void addString(ULONG ulPropTag, std::wstring szValue)
+		{
+			stringValues.push_back(std::move(szValue));
+			next(ulPropTag).Value.lpszW = const_cast<LPWSTR>(stringValues.back().c_str());
+		}
+		void addBinary(ULONG ulPropTag, std::vector<BYTE> binValue)
+		{
+			binValues.push_back(std::move(binValue));
+			next(ulPropTag).Value.bin = {static_cast<ULONG>(binValues.back().size()), binValues.back().data()};
+		}
+
+		propSet make() const
+		{
+			auto set = propSet{};
+			set.lpProps = mapi::allocate<LPSPropValue>(static_cast<ULONG>(props.size() * sizeof(SPropValue)));
+			if (!set.lpProps) return set;
+			for (const auto& prop : props)
+			{
+				if (FAILED(EC_H(mapi::MyPropCopyMore(&set.lpProps[set.cValues], &prop, MAPIAllocateMore, set.lpProps))))
+				{
+					break;
+				}
+
+				set.cValues++;
+			}
+
+			return set;
+		}
+
+	private:
+		SPropValue& next(ULONG ulPropTag)
+		{
+			props.push_back(SPropValue{ulPropTag});
+			return props.back();
+		}
+
+		std::vector<SPropValue> props;
+		// Deques, so what props point at doesn't move as we add more
+		std::deque<std::wstring> stringValues;
+		std::deque<std::vector<BYTE>> binValues;
+	};
+
+	class generator
+	{
+	public:
+		explicit generator(storeData& _store) : store(_store), config(_store.config), rng(_store.config.ulSeed) {}
+
+		void run()
+		{
+			store.sig = randomBytes(16);
+			makeNames();
+			store.folders.reserve(folderCount());
+			makeFolder(0, L"Root");
+			store.cMessages = static_cast<ULONG>(store.folders.size()) * (config.ulMessages + config.ulAssociated);
+
+			auto props = propBuilder{};
+			props.addLong(PR_OBJECT_TYPE, MAPI_STORE);
+			props.addString(PR_DISPLAY_NAME_W, L"Synthetic Store");
+			props.addBinary(PR_ENTRYID, randomBytes(24));
+			props.addBinary(PR_RECORD_KEY, store.sig);
+			props.addBinary(PR_MAPPING_SIGNATURE, store.sig);
+			props.addBinary(PR_IPM_SUBTREE_ENTRYID, makeEntryID(objectKind::folder, 0, 0));
+			props.addLong(PR_STORE_SUPPORT_MASK, STORE_UNICODE_OK | STORE_ENTRYID_UNIQUE);
+			store.props = props.make();
+		}
+
+	private:
+		ULONG folderCount() const noexcept
+		{
+			auto ulFolders = ULONG{};
+			auto ulLevel = ULONG{1};
+			for (ULONG i = 0; i <= config.ulDepth; i++)
+			{
+				ulFolders += ulLevel;
+				ulLevel *= config.ulSubfolders;
+			}
+
+			return ulFolders;
+		}
+
+		std::vector<BYTE> randomBytes(size_t cb)
+		{
+			auto bytes = std::vector<BYTE>(cb);
+			for (auto& b : bytes)
+			{
+				b = static_cast<BYTE>(rng());
+			}
+
+			return bytes;
+		}
+
+		std::wstring randomText(size_t cch)
+		{
+			static const std::vector<std::wstring> words = {
+				L"lorem", L"ipsum", L"dolor", L"sit", L"amet", L"consectetur", L"adipiscing", L"elit", L"sed"};
+			auto text = std::wstring{};
+			while (text.length() < cch)
+			{
+				text += words[rng() % words.size()];
+				text += L' ';
+			}
+
+			text.resize(cch);
+			return text;
+		}
+
+		// Some time in 2020
+		FILETIME randomTime()
+		{
+			constexpr ULONGLONG ullJan2020 = 132223104000000000;
+			constexpr ULONGLONG ullSecond = 10000000;
+			auto time = ULARGE_INTEGER{};
+			time.QuadPart = ullJan2020 + rng() % (365 * 24 * 60 * 60) * ullSecond;
+			return FILETIME{time.LowPart, time.HighPart};
+		}
+
+		void makeNames()
+		{
+			// Names point in to nameStrings, so it can't grow after this
+			store.nameStrings.reserve(config.ulNamedProps);
+			for (ULONG i = 0; i < config.ulNamedProps; i++)
+			{
+				auto name = MAPINAMEID{};
+				if (i % 2)
+				{
+					store.nameStrings.push_back(strings::format(L"SyntheticProp%u", i));
+					name.lpguid = const_cast<LPGUID>(&PS_PUBLIC_STRINGS);
+					name.ulKind = MNID_STRING;
+					name.Kind.lpwstrName = const_cast<LPWSTR>(store.nameStrings.back().c_str());
+				}
+				else
+				{
+					name.lpguid = const_cast<LPGUID>(&guid::PSETID_Common);
+					name.ulKind = MNID_ID;
+					name.Kind.lID = static_cast<LONG>(0x8500 + i);
+				}
+
+				store.names.push_back(name);
+			}
+		}
+
+		ULONG makeFolder(ULONG ulLevel, const std::wstring& szName)
+		{
+			const auto ulFolder = static_cast<ULONG>(store.folders.size());
+			store.folders.emplace_back();
+			const auto fid = makeId(ullNextId++);
+
+			auto messages = std::vector<messageData>{};
+			for (ULONG i = 0; i < config.ulMessages; i++)
+			{
+				const auto eid = makeEntryID(objectKind::message, ulFolder, i);
+				messages.push_back(makeMessage(&eid, false));
+			}
+
+			auto associated = std::vector<messageData>{};
+			for (ULONG i = 0; i < config.ulAssociated; i++)
+			{
+				const auto eid = makeEntryID(objectKind::associated, ulFolder, i);
+				associated.push_back(makeMessage(&eid, true));
+			}
+
+			auto children = std::vector<ULONG>{};
+			if (ulLevel < config.ulDepth)
+			{
+				for (ULONG i = 0; i < config.ulSubfolders; i++)
+				{
+					auto szChild = ulLevel ? strings::format(L"%ws.%u", szName.c_str(), i + 1)
+										   : strings::format(L"Folder %u", i + 1);
+					if (config.bSameFolderNames) szChild = i % 2 ? L"FOLDER" : L"Folder";
+					children.push_back(makeFolder(ulLevel + 1, szChild));
+				}
+			}
+
+			const auto eid = makeEntryID(objectKind::folder, ulFolder, 0);
+			auto props = propBuilder{};
+			props.addBinary(PR_ENTRYID, eid);
+			props.addBinary(PR_RECORD_KEY, eid);
+			props.addLong(PR_OBJECT_TYPE, MAPI_FOLDER);
+			props.addLong(PR_FOLDER_TYPE, FOLDER_GENERIC);
+			props.addString(PR_DISPLAY_NAME_W, szName);
+			props.addString(PR_CONTAINER_CLASS_W, L"IPF.Note");
+			props.addBool(PR_SUBFOLDERS, !children.empty());
+			props.addLong(PR_CONTENT_COUNT, config.ulMessages);
+			props.addLong(PR_ASSOC_CONTENT_COUNT, config.ulAssociated);
+			props.addI8(PidTagFolderId, fid);
+			props.addBinary(PR_MAPPING_SIGNATURE, store.sig);
+
+			auto& folder = store.folders[ulFolder];
+			folder.props = props.make();
+			folder.children = std::move(children);
+			folder.messages = std::move(messages);
+			folder.associated = std::move(associated);
+			return ulFolder;
+		}
+
+		// Embedded messages have no entry ID, mid or attachments of their own
+		messageData makeMessage(_In_opt_ const std::vector<BYTE>* lpEntryID, bool bAssociated)
+		{
+			auto message = messageData{};
+			for (ULONG i = 0; i < config.ulRecipients; i++)
+			{
+				message.recipients.push_back(makeRecipient(i));
+			}
+
+			if (lpEntryID)
+			{
+				for (ULONG i = 0; i < config.ulAttachments; i++)
+				{
+					message.attachments.push_back(makeAttachment(i));
+				}
+			}
+
+			const auto bHasAttach = !message.attachments.empty();
+			auto props = propBuilder{};
+			if (lpEntryID)
+			{
+				props.addBinary(PR_ENTRYID, *lpEntryID);
+				props.addBinary(PR_RECORD_KEY, *lpEntryID);
+				props.addI8(PidTagMid, makeId(ullNextId++));
+			}
+			else
+			{
+				props.addBinary(PR_RECORD_KEY, randomBytes(16));
+			}
+
+			props.addBinary(PR_SEARCH_KEY, randomBytes(16));
+			props.addLong(PR_OBJECT_TYPE, MAPI_MESSAGE);
+			props.addString(PR_MESSAGE_CLASS_W, bAssociated ? L"IPM.Configuration.Synthetic" : L"IPM.Note");
+			props.addString(PR_SUBJECT_W, L"Synthetic " + randomText(32));
+			props.addTime(PR_MESSAGE_DELIVERY_TIME, randomTime());
+			props.addBool(PR_HASATTACH, bHasAttach);
+			props.addLong(PR_MESSAGE_FLAGS, MSGFLAG_READ | (bHasAttach ? MSGFLAG_HASATTACH : 0));
+			props.addLong(
+				PR_MESSAGE_SIZE,
+				static_cast<ULONG>(config.cchBody * sizeof(WCHAR) + message.attachments.size() * config.cbAttachment));
+			props.addLong(PR_INTERNET_CPID, CP_UTF8);
+			props.addString(PR_SENDER_NAME_W, L"Synthetic Sender");
+			props.addString(PR_SENDER_ADDRTYPE_W, L"SMTP");
+			props.addString(PR_SENDER_EMAIL_ADDRESS_W, L"sender@synthetic.example");
+			props.addString(PR_BODY_W, randomText(config.cchBody));
+			props.addBinary(PR_MAPPING_SIGNATURE, store.sig);
+
+			for (ULONG i = 0; i < config.ulExtraProps; i++)
+			{
+				const auto ulPropID = firstExtraPropID + i;
+				switch (i % 4)
+				{
+				case 0:
+					props.addLong(PROP_TAG(PT_LONG, ulPropID), rng());
+					break;
+				case 1:
+					props.addTime(PROP_TAG(PT_SYSTIME, ulPropID), randomTime());
+					break;
+				case 2:
+					props.addBinary(PROP_TAG(PT_BINARY, ulPropID), randomBytes(8 + rng() % 56));
+					break;
+				default:
+					props.addString(PROP_TAG(PT_UNICODE, ulPropID), randomText(8 + rng() % 56));
+					break;
+				}
+			}
+
+			for (ULONG i = 0; i < store.names.size(); i++)
+			{
+				const auto ulPropID = firstNamedPropID + i;
+				if (store.names[i].ulKind == MNID_STRING)
+				{
+					props.addString(PROP_TAG(PT_UNICODE, ulPropID), randomText(16));
+				}
+				else
+				{
+					props.addLong(PROP_TAG(PT_LONG, ulPropID), rng());
+				}
+			}
+
+			message.props = props.make();
+			return message;
+		}
+
+		propSet makeRecipient(ULONG ulRecip)
+		{
+			auto props = propBuilder{};
+			props.addLong(PR_ROWID, ulRecip);
+			props.addLong(PR_RECIPIENT_TYPE, ulRecip ? MAPI_CC : MAPI_TO);
+			props.addLong(PR_OBJECT_TYPE, MAPI_MAILUSER);
+			props.addLong(PR_DISPLAY_TYPE, DT_MAILUSER);
+			props.addString(PR_DISPLAY_NAME_W, strings::format(L"Recipient %u", ulRecip));
+			props.addString(PR_ADDRTYPE_W, L"SMTP");
+			props.addString(PR_EMAIL_ADDRESS_W, strings::format(L"recipient%u@synthetic.example", ulRecip));
+			props.addBinary(PR_ENTRYID, randomBytes(24));
+			return props.make();
+		}
+
+		attachData makeAttachment(ULONG ulAttachNum)
+		{
+			auto attachment = attachData{};
+			const auto bEmbedded = config.ulEmbeddedEvery && ++ulAttachments % config.ulEmbeddedEvery == 0;
+
+			auto props = propBuilder{};
+			props.addLong(PR_ATTACH_NUM, ulAttachNum);
+			props.addLong(PR_OBJECT_TYPE, MAPI_ATTACH);
+			props.addLong(PR_RENDERING_POSITION, 0xFFFFFFFF);
+			props.addBinary(PR_RECORD_KEY, randomBytes(16));
+			props.addBinary(PR_MAPPING_SIGNATURE, store.sig);
+			if (bEmbedded)
+			{
+				attachment.embedded = std::make_unique<messageData>(makeMessage(nullptr, false));
+				props.addLong(PR_ATTACH_METHOD, ATTACH_EMBEDDED_MSG);
+				props.addString(PR_DISPLAY_NAME_W, L"Embedded message");
+				props.addLong(PR_ATTACH_SIZE, static_cast<ULONG>(config.cchBody * sizeof(WCHAR)));
+			}
+			else
+			{
+				const auto szFileName = strings::format(L"attachment%u.bin", ulAttachNum);
+				props.addLong(PR_ATTACH_METHOD, ATTACH_BY_VALUE);
+				props.addString(PR_DISPLAY_NAME_W, szFileName);
+				props.addString(PR_ATTACH_FILENAME_W, szFileName);
+				props.addString(PR_ATTACH_LONG_FILENAME_W, szFileName);
+				props.addString(PR_ATTACH_EXTENSION_W, L".bin");
+				props.addLong(PR_ATTACH_SIZE, config.cbAttachment);
+				props.addBinary(PR_ATTACH_DATA_BIN, randomBytes(config.cbAttachment));
+			}
+
+			attachment.props = props.make();
+			return attachment;
+		}
+
+		storeData& store;
+		const storeConfig& config;
+		std::mt19937 rng;
+		ULONGLONG ullNextId{1}; // Fids and mids share one counter
+		ULONG ulAttachments{};
+	};
+
+	store::store(const storeConfig& config) : data(std::make_shared<storeData>())
+	{
+		data->config = config;
+		generator(*data).run();
+	}
+
+	LPMDB store::open() const { return new storeObject(data); }
+
+	callCounts& store::counts() noexcept { return data->counts; }
+
+	ULONG store::folderCount() const noexcept { return static_cast<ULONG>(data->folders.size()); }
+
+	ULONG store::messageCount() const noexcept { return data->cMessages; }
+
+	ULONG store::liveObjects() const noexcept { return static_cast<ULONG>(data.use_count() - 1); }
+} // namespace synthetic
@@ -0,0 +1,72 @@
+#pragma once
+// An in-memory message store for driving the processors without a profile or a server.
+// The store is generated up front from a storeConfig, then served read only through
+// IMsgStore, IMAPIFolder, IMAPITable, IMessage, IAttach and IStream.
+// Only the calls the processors and output routines make are implemented.
+// Everything else returns MAPI_E_NO_SUPPORT.
+#include <atomic>
+
+namespace synthetic
+{
+	// Shape of the generated store
+	struct storeConfig
+	{
+		ULONG ulDepth{2}; // Levels of folders below the root
+		ULONG ulSubfolders{3}; // Subfolders in each folder above the bottom level
+		bool bSameFolderNames{}; // Siblings get one name, differing only in case
+		ULONG ulMessages{20}; // Regular messages in each folder
+		ULONG ulAssociated{2}; // Associated messages in each folder
+		ULONG ulRecipients{2}; // Recipients on each message
+		ULONG ulExtraProps{12}; // Extra props on each message, cycling through longs, times, binaries and strings
+		ULONG ulNamedProps{4}; // Named props on each message, alternating dispids and string names
+		ULONG ulAttachments{1}; // Attachments on each message
+		ULONG ulEmbeddedEvery{4}; // Every this many attachments is an embedded message. 0 for none.
+		ULONG cbAttachment{4096}; // Bytes in each attachment's PR_ATTACH_DATA_BIN
+		ULONG cchBody{2048}; // Characters in each PR_BODY_W
+		ULONG cbMaxProp{1024}; // GetProps reports bigger props as MAPI_E_NOT_ENOUGH_MEMORY, as real stores do
+		ULONG ulLatencyMs{}; // QueryRows and OpenEntry wait this long, standing in for a round trip to a server
+		ULONG ulSeed{1}; // Same seed, same store
+	};
+
+	// Calls made against the store. Workers share a store, so these are atomic.
+	struct callCounts
+	{
+		std::atomic<ULONG> OpenEntry{};
+		std::atomic<ULONG> GetHierarchyTable{};
+		std::atomic<ULONG> GetContentsTable{};
+		std::atomic<ULONG> GetRecipientTable{};
+		std::atomic<ULONG> GetAttachmentTable{};
+		std::atomic<ULONG> OpenAttach{};
+		std::atomic<ULONG> SetColumns{};
+		std::atomic<ULONG> QueryRows{};
+		std::atomic<ULONG> GetProps{};
+		std::atomic<ULONG> GetPropList{};
+		std::atomic<ULONG> GetNamesFromIDs{};
+		std::atomic<ULONG> GetIDsFromNames{};
+		std::atomic<ULONG> OpenProperty{};
+		std::atomic<ULONG> Read{};
+
+		void reset() noexcept;
+		std::wstring toString() const;
+	};
+
+	struct storeData;
+
+	class store
+	{
+	public:
+		explicit store(const storeConfig& config);
+
+		// The store object. Release when done. Safe to share across threads.
+		_Check_return_ LPMDB open() const;
+
+		callCounts& counts() noexcept;
+		ULONG folderCount() const noexcept; // Including the root
+		ULONG messageCount() const noexcept; // Regular and associated. Embedded messages are not counted.
+		ULONG liveObjects() const noexcept; // Objects handed out and not yet released
+
+	private:
+		// Shared with every object we hand out, so they can outlive us
+		std::shared_ptr<storeData> data;
+	};
+} // namespace synthetic
@@ -2,6 +2,9 @@
 #include <UnitTest/UnitTest.h>
 #include <core/addin/addin.h>
 #include <core/addin/mfcmapi.h>
+#include <core/interpret/proptags.h>
+#include <core/interpret/flags.h>
+#include <chrono>
 
 namespace addin
 {
@@ -209,5 +212,102 @@ namespace addintest
 			Assert::AreEqual(size_t{3}, flagV2.size(), L"merge null");
 			testFA(L"f2 merge", flagV2[0], {3, 1, flagVALUE, L"four one"});
 		}
+
+		TEST_METHOD(Test_interpretTable)
+		{
+			static constexpr NAME_ARRAY_ENTRY builtIn[] = {{1, L"one"}, {2, L"two"}};
+			auto table = addin::interpretTable<NAME_ARRAY_ENTRY>{builtIn};
+			Assert::AreEqual(true, table.isBuiltIn());
+			Assert::AreEqual(true, table.data() == builtIn);
+			Assert::AreEqual(size_t{2}, table.size());
+			Assert::AreEqual(L"two", table[1].lpszName);
+
+			auto merged = table.copy();
+			merged.push_back({3, L"three"});
+			table.setOverlay(std::move(merged));
+			Assert::AreEqual(false, table.isBuiltIn());
+			Assert::AreEqual(size_t{3}, table.size());
+			Assert::AreEqual(size_t{2}, table.builtInSize());
+			Assert::AreEqual(L"three", table[2].lpszName);
+
+			table.reset();
+			Assert::AreEqual(true, table.data() == builtIn);
+			Assert::AreEqual(size_t{2}, table.size());
+
+			// With no add-ins, our tables read the built in arrays in place
+			addin::MergeAddInArrays();
+			Assert::AreEqual(true, PropTagArray.isBuiltIn());
+			Assert::AreEqual(true, FlagArray.isBuiltIn());
+			Assert::AreEqual(true, NameIDArray.isBuiltIn());
+			Assert::AreEqual(true, SmartViewParserTypeArray.isBuiltIn());
+			Assert::AreEqual(PropTagArray.builtInSize(), PropTagArray.size());
+		}
+
+		// Startup used to copy every built in array into a vector and index them before we could print anything.
+		// Time that against MergeAddInArrays, which with no add-ins just points the tables at the built in arrays.
+		// Both pay for the first lookup, which is where the in place tables build their indexes.
+		TEST_METHOD(Benchmark_startup)
+		{
+			// Every index build is kept alive, so don't build too many
+			constexpr auto iterations = 20;
+
+			// Fastest of the runs, so a stall in one doesn't decide it. prepare isn't timed.
+			const auto time = [](const auto& prepare, const auto& startup) {
+				auto fastest = std::chrono::microseconds::max();
+				for (auto i = 0; i < iterations; i++)
+				{
+					prepare();
+					const auto start = std::chrono::steady_clock::now();
+					startup();
+					fastest = std::min(
+						fastest,
+						std::chrono::duration_cast<std::chrono::microseconds>(
+							std::chrono::steady_clock::now() - start));
+				}
+
+				return fastest.count();
+			};
+
+			const auto firstLookup = [] {
+				unittest::AreEqualEx(L"PR_SUBJECT", proptags::PropTagToPropName(PR_SUBJECT_W, false).bestGuess);
+				unittest::AreEqualEx(L"MSGFLAG_READ", flags::InterpretFlags(PROP_ID(PR_MESSAGE_FLAGS), MSGFLAG_READ));
+			};
+
+			const auto copyTime = time(
+				[] {},
+				[&] {
+					const auto tags = PropTagArray.copy();
+					const auto types = PropTypeArray.copy();
+					const auto guids = PropGuidArray.copy();
+					const auto nameIDs = NameIDArray.copy();
+					const auto flags = FlagArray.copy();
+					const auto parsers = SmartViewParserArray.copy();
+					const auto parserTypes = SmartViewParserTypeArray.copy();
+					proptags::BuildPropTagIndex();
+					flags::BuildFlagIndex();
+					firstLookup();
+				});
+
+			// Overlays leave the indexes stale, as they are in a fresh process, so each run builds them again
+			const auto inPlaceTime = time(
+				[] {
+					PropTagArray.setOverlay(PropTagArray.copy());
+					FlagArray.setOverlay(FlagArray.copy());
+				},
+				[&] {
+					addin::MergeAddInArrays();
+					firstLookup();
+				});
+
+			Logger::WriteMessage(strings::format(
+									 L"Startup and first lookup, best of %d runs: copied %lld us, in place %lld us\n",
+									 iterations,
+									 copyTime,
+									 inPlaceTime)
+									 .c_str());
+			Assert::AreEqual(true, inPlaceTime < copyTime);
+			Assert::AreEqual(true, PropTagArray.isBuiltIn());
+			Assert::AreEqual(true, FlagArray.isBuiltIn());
+		}
 	};
 } // namespace addintest
\ No newline at end of file
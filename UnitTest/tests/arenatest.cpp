@@ -0,0 +1,125 @@
+#include <UnitTest/stdafx.h>
+#include <UnitTest/UnitTest.h>
+#include <core/smartview/SmartView.h>
+#include <core/smartview/benchmark.h>
+#include <core/smartview/block/blockArena.h>
+#include <core/smartview/block/blockBytes.h>
+#include <core/smartview/block/blockT.h>
+#include <core/addin/mfcmapi.h>
+#include <chrono>
+
+namespace arenatest
+{
+	TEST_CLASS(arenatest)
+	{
+	public:
+		// Without this, clang gets weird
+		static const bool dummy_var = true;
+
+		TEST_CLASS_INITIALIZE(initialize) { unittest::init(); }
+
+		TEST_METHOD(Test_arena)
+		{
+			Assert::AreEqual(smartview::blockArena::current() == nullptr, true);
+
+			smartview::blockArena::resetStats();
+			auto block1 = smartview::block::create(L"outside");
+			auto stats = smartview::blockArena::getStats();
+			Assert::AreEqual(stats.blocks, size_t{1});
+			Assert::AreEqual(stats.heapAllocations, size_t{1});
+
+			std::shared_ptr<smartview::block> block2;
+			std::shared_ptr<smartview::blockT<DWORD>> block3;
+			{
+				const auto arena = smartview::blockArena::scope{};
+				Assert::AreEqual(smartview::blockArena::current() != nullptr, true);
+
+				smartview::blockArena::resetStats();
+				block2 = smartview::block::create(L"inside");
+				for (auto i = 0; i < 100; i++)
+				{
+					block2->addChild(smartview::blockT<DWORD>::create(i, sizeof DWORD, i * sizeof DWORD));
+				}
+
+				block3 = smartview::blockT<DWORD>::create(42, sizeof DWORD, 0);
+
+				// 102 blocks, one chunk
+				stats = smartview::blockArena::getStats();
+				Assert::AreEqual(stats.blocks, size_t{102});
+				Assert::AreEqual(stats.heapAllocations, size_t{1});
+
+				// Nested scopes get their own arena and restore the outer one when done
+				const auto outer = smartview::blockArena::current();
+				{
+					const auto inner = smartview::blockArena::scope{};
+					Assert::AreEqual(smartview::blockArena::current() != outer, true);
+				}
+
+				Assert::AreEqual(smartview::blockArena::current() == outer, true);
+			}
+
+			Assert::AreEqual(smartview::blockArena::current() == nullptr, true);
+
+			// Blocks outlive the scope which built them
+			Assert::AreEqual(block2->getChildren().size(), size_t{100});
+			Assert::AreEqual(block3->getData(), DWORD{42});
+			block2.reset();
+			Assert::AreEqual(block3->getData(), DWORD{42});
+			block3.reset();
+			Assert::AreEqual(block1->getText(), std::wstring(L"outside"));
+		}
+
+		// Parse the SmartView test corpus with and without an arena and log the block
+		// heap allocation counts and wall time for each
+		TEST_METHOD(Benchmark_arena)
+		{
+			static auto handle = GetModuleHandleW(L"UnitTest.dll");
+			auto corpus = std::vector<std::pair<parserType, std::vector<BYTE>>>{};
+			for (const auto& set : smartview::benchmark::corpusPrefixes)
+			{
+				for (auto i = 1; i < 100; i++)
+				{
+					const auto hex = unittest::loadfile(handle, static_cast<int>(set.first) * 1000 + i);
+					if (!hex.empty()) corpus.emplace_back(set.second, strings::HexStringToBin(hex));
+				}
+			}
+
+			Assert::AreEqual(corpus.empty(), false);
+
+			constexpr auto iterations = 20;
+			const auto run = [&](bool useArena) {
+				smartview::blockArena::resetStats();
+				const auto start = std::chrono::steady_clock::now();
+				for (auto i = 0; i < iterations; i++)
+				{
+					for (const auto& item : corpus)
+					{
+						auto arena = std::unique_ptr<smartview::blockArena::scope>{};
+						if (useArena) arena = std::make_unique<smartview::blockArena::scope>();
+						auto svp = smartview::GetSmartViewParser(item.first, nullptr);
+						if (svp) svp->parse(smartview::binaryParser::borrow(item.second), true);
+					}
+				}
+
+				const auto elapsed = std::chrono::steady_clock::now() - start;
+				const auto stats = smartview::blockArena::getStats();
+				Logger::WriteMessage(strings::format(
+										 L"%ws: %u blobs x %d: %zu blocks, %zu heap allocations, %zu bytes, %lld us\n",
+										 useArena ? L"arena" : L"heap",
+										 static_cast<UINT>(corpus.size()),
+										 iterations,
+										 stats.blocks,
+										 stats.heapAllocations,
+										 stats.bytes,
+										 std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count())
+										 .c_str());
+				return stats;
+			};
+
+			const auto heap = run(false);
+			const auto arena = run(true);
+			Assert::AreEqual(heap.blocks, arena.blocks);
+			Assert::AreEqual(arena.heapAllocations < heap.heapAllocations, true);
+		}
+	};
+} // namespace arenatest
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include <UnitTest/stdafx.h>
+#include <UnitTest/UnitTest.h>
+#include <core/smartview/benchmark.h>
+#include <core/utility/strings.h>
+#include <filesystem>
+#include <fstream>
+
+namespace benchmarktest
+{
+	std::filesystem::path tempFile(LPCWSTR szName)
+	{
+		return std::filesystem::temp_directory_path() /
+			   strings::format(L"%ws%u.txt", szName, GetCurrentProcessId());
+	}
+
+	void assertSame(const smartview::benchmark::result& expected, const smartview::benchmark::result& actual)
+	{
+		Assert::AreEqual(expected.parser, actual.parser);
+		Assert::AreEqual(expected.blobs, actual.blobs);
+		Assert::AreEqual(expected.bytes, actual.bytes);
+		Assert::AreEqual(expected.parseNsPerByte, actual.parseNsPerByte);
+		Assert::AreEqual(expected.toStringNsPerByte, actual.toStringNsPerByte);
+		Assert::AreEqual(expected.parseAllocs, actual.parseAllocs);
+		Assert::AreEqual(expected.toStringAllocs, actual.toStringAllocs);
+		Assert::AreEqual(expected.parsePeak, actual.parsePeak);
+		Assert::AreEqual(expected.toStringPeak, actual.toStringPeak);
+	}
+
+	TEST_CLASS(benchmarktest)
+	{
+	public:
+		// Without this, clang gets weird
+		static const bool dummy_var = true;
+
+		TEST_CLASS_INITIALIZE(initialize) { unittest::init(); }
+
+		TEST_METHOD(Test_results)
+		{
+			// Values which survive three decimal places exactly
+			const auto results = std::vector<smartview::benchmark::result>{
+				{L"Entry Id", 4, 212, 1.25, 10.5, 3, 17, 4096, 8192},
+				{L"Security Descriptor", 2, 96, 0.125, 2.75, 0, 9, 0, 1024},
+			};
+
+			const auto path = tempFile(L"benchmarktest");
+			Assert::AreEqual(true, smartview::benchmark::saveResults(path.wstring(), results));
+
+			// Written as UTF-8 with a byte order mark
+			{
+				auto file = std::ifstream(path, std::ios::binary);
+				auto bom = std::string(3, '\0');
+				file.read(bom.data(), 3);
+				Assert::AreEqual(std::string("\xEF\xBB\xBF"), bom);
+			}
+
+			const auto loaded = smartview::benchmark::loadResults(path.wstring());
+			Assert::AreEqual(results.size(), loaded.size());
+			for (const auto& result : results)
+			{
+				const auto found = loaded.find(result.parser);
+				Assert::AreEqual(true, found != loaded.end());
+				assertSame(result, found->second);
+			}
+
+			std::filesystem::remove(path);
+		}
+
+		TEST_METHOD(Test_legacyResults)
+		{
+			// Older builds wrote UTF-16 LE with no byte order mark and a peak column header
+			const auto result = smartview::benchmark::result{L"Entry Id", 4, 212, 1.25, 10.5, 3, 17, 4096, 8192};
+			const auto szText =
+				std::wstring(L"parser\tblobs\tbytes\tparse ns/byte\ttoString ns/byte\tparse allocs\ttoString allocs\t"
+							 L"parse peak\ttoString peak\n") +
+				smartview::benchmark::formatResult(result);
+			const auto path = tempFile(L"benchmarklegacy");
+			{
+				auto file = std::ofstream(path, std::ios::binary);
+				file.write(reinterpret_cast<const char*>(szText.data()), szText.size() * sizeof(wchar_t));
+			}
+
+			const auto loaded = smartview::benchmark::loadResults(path.wstring());
+			Assert::AreEqual(size_t{1}, loaded.size());
+			assertSame(result, loaded.begin()->second);
+			std::filesystem::remove(path);
+
+			Assert::AreEqual(true, smartview::benchmark::loadResults(path.wstring()).empty());
+		}
+
+		TEST_METHOD(Test_retainedResults)
+		{
+			// Heap still held after each call isn't a peak, so those columns don't come back as one
+			auto result = smartview::benchmark::result{L"Entry Id", 4, 212, 1.25, 10.5, 3, 17, 4096, 8192};
+			const auto szText = std::string("\xEF\xBB\xBF") +
+								"parser\tblobs\tbytes\tparse ns/byte\ttoString ns/byte\tparse allocs\ttoString allocs\t"
+								"parse retained\ttoString retained\n" +
+								strings::wstringTostring(smartview::benchmark::formatResult(result));
+			const auto path = tempFile(L"benchmarkretained");
+			{
+				auto file = std::ofstream(path, std::ios::binary);
+				file.write(szText.data(), szText.size());
+			}
+
+			const auto loaded = smartview::benchmark::loadResults(path.wstring());
+			Assert::AreEqual(size_t{1}, loaded.size());
+			result.parsePeak = 0;
+			result.toStringPeak = 0;
+			assertSame(result, loaded.begin()->second);
+			std::filesystem::remove(path);
+		}
+	};
+} // namespace benchmarktest
@@ -2,12 +2,29 @@
 #include <UnitTest/UnitTest.h>
 #include <core/smartview/block/block.h>
 #include <core/smartview/block/blockBytes.h>
+#include <core/smartview/block/blockEmitter.h>
 #include <core/smartview/block/blockStringA.h>
 #include <core/smartview/block/blockStringW.h>
 #include <core/smartview/block/blockT.h>
 
 namespace blocktest
 {
+	// Counts how often its blocks get built so we can check rendering is deferred
+	class countingBlock : public smartview::block
+	{
+	public:
+		int built{};
+		std::shared_ptr<smartview::blockT<DWORD>> value = smartview::emptyT<DWORD>();
+
+	private:
+		void parse() override { value = smartview::blockT<DWORD>::parse(parser); }
+		void parseBlocks() override
+		{
+			built++;
+			addChild(value, L"value = 0x%1!08X!", value->getData());
+		}
+	};
+
 	TEST_CLASS(blocktest)
 	{
 	public:
@@ -89,5 +106,100 @@ namespace blocktest
 			auto block2 = smartview::blockStringW::parse(std::wstring(L"test"), 4, 5);
 			Assert::AreEqual(block2->length(), size_t{4});
 		}
+
+		TEST_METHOD(Test_lazyBlocks)
+		{
+			const auto bin = std::vector<BYTE>{1, 2, 3, 4, 5};
+			auto parser = smartview::binaryParser::borrow(bin);
+			auto block1 = smartview::block::parse<countingBlock>(parser, true);
+
+			// Parsing fills in values but builds no text
+			Assert::AreEqual(block1->isSet(), true);
+			Assert::AreEqual(block1->value->getData(), DWORD{0x04030201});
+			Assert::AreEqual(block1->getSize(), size_t{5});
+			Assert::AreEqual(block1->built, 1); // Junk data forces a build so we know where to hang it
+
+			auto parser2 = smartview::binaryParser::borrow(4, bin.data());
+			auto block2 = smartview::block::parse<countingBlock>(parser2, true);
+			Assert::AreEqual(block2->value->getData(), DWORD{0x04030201});
+			Assert::AreEqual(block2->built, 0);
+
+			// Rendering builds the blocks once
+			Assert::AreEqual(block2->toString(), std::wstring(L"value = 0x04030201"));
+			Assert::AreEqual(block2->built, 1);
+			Assert::AreEqual(block2->getChildren().size(), size_t{1});
+			Assert::AreEqual(block2->built, 1);
+
+			auto block3 = smartview::blockBytes::parse(smartview::binaryParser::borrow(bin), 2);
+			Assert::AreEqual(block3->getText(), std::wstring(L"cb: 2 lpb: 0102"));
+		}
+
+		TEST_METHOD(Test_blockBytes)
+		{
+			auto block1 = smartview::emptyBB();
+			Assert::AreEqual(block1->isSet(), false);
+			Assert::AreEqual(block1->empty(), true);
+			Assert::AreEqual(static_cast<std::vector<BYTE>>(*block1).empty(), true);
+
+			const auto bin = std::vector<BYTE>{1, 2, 3, 4, 5};
+			for (const auto& parser :
+				 {std::make_shared<smartview::binaryParser>(bin), smartview::binaryParser::borrow(bin)})
+			{
+				parser->advance(1);
+				auto block2 = smartview::blockBytes::parse(parser, 3);
+				Assert::AreEqual(block2->isSet(), true);
+				Assert::AreEqual(block2->size(), size_t{3});
+				Assert::AreEqual(block2->getOffset(), size_t{1});
+				Assert::AreEqual(block2->equal(3, bin.data() + 1), true);
+				Assert::AreEqual(block2->toHexString(false), std::wstring(L"020304"));
+				Assert::AreEqual(static_cast<std::vector<BYTE>>(*block2) == std::vector<BYTE>{2, 3, 4}, true);
+				Assert::AreEqual(parser->getSize(), size_t{1});
+
+				// Too big to parse
+				auto block3 = smartview::blockBytes::parse(parser, 2);
+				Assert::AreEqual(block3->isSet(), false);
+				Assert::AreEqual(block3->empty(), true);
+			}
+
+			// A borrowed parser reads the caller's buffer directly
+			auto parser = smartview::binaryParser::borrow(bin);
+			Assert::AreEqual(parser->getAddress() == bin.data(), true);
+			Assert::AreEqual(smartview::binaryParser::borrow(0, nullptr)->empty(), true);
+		}
+
+		TEST_METHOD(Test_emitBlocks)
+		{
+			const auto bin = std::vector<BYTE>{4, 0, 0, 0, 'h', 'i', 0, 0xAB, 0xCD};
+			auto parser = smartview::binaryParser::borrow(bin);
+			auto root = smartview::block::create(L"root");
+			const auto cb = smartview::blockT<DWORD>::parse(parser);
+			root->addChild(cb, L"cb = 0x%1!08X!", cb->getData());
+			const auto str = smartview::blockStringA::parse(parser);
+			root->addChild(str, L"str: %1!hs!", str->c_str());
+			root->addLabeledChild(L"data:", smartview::blockBytes::parse(parser, 2));
+
+			const auto json = smartview::emitBlocks(root, smartview::emitFormat::json);
+			Assert::AreEqual(
+				std::string(R"({"text":"root","offset":0,"size":0,"children":[)"
+							R"({"name":"cb","text":"cb = 0x00000004","offset":0,"size":4,"type":"u32","value":4},)"
+							R"({"name":"str","text":"str: hi","offset":4,"size":3,"type":"stringA","value":"hi"},)"
+							R"({"name":"data","text":"data:","offset":7,"size":2,"children":[)"
+							R"({"text":"cb: 2 lpb: ABCD","offset":7,"size":2,"type":"bytes","value":"ABCD"}]}]})"),
+				json);
+
+			// Streaming hands over the same bytes
+			auto streamed = std::string{};
+			smartview::emitBlocks(
+				root, smartview::emitFormat::json, [&](const std::string& chunk) { streamed += chunk; });
+			Assert::AreEqual(json, streamed);
+
+			// Binary starts with its signature and the root's offset, size and source
+			const auto binary = smartview::emitBlocks(root, smartview::emitFormat::binary);
+			Assert::AreEqual(std::string("SVB\x01", 4), binary.substr(0, 4));
+			Assert::AreEqual(std::string(12, '\0'), binary.substr(4, 12));
+			// Then type and width, the empty name, "root", no value, and a count of three children
+			Assert::AreEqual(std::string("\0\0\0\0\0\0", 6), binary.substr(16, 6));
+			Assert::AreEqual(std::string("\x04\0\0\0root\0\0\0\0\x03\0\0\0", 16), binary.substr(22, 16));
+		}
 	};
 } // namespace blocktest
\ No newline at end of file
@@ -0,0 +1,302 @@
+#include <UnitTest/stdafx.h>
+#include <UnitTest/UnitTest.h>
+#include <core/smartview/SmartView.h>
+#include <core/smartview/block/block.h>
+#include <core/smartview/block/blockT.h>
+#include <core/smartview/block/parseBudget.h>
+#include <core/smartview/PropertiesStruct.h>
+#include <core/addin/mfcmapi.h>
+#include <core/addin/addin.h>
+#include <chrono>
+#include <random>
+
+namespace budgettest
+{
+	// Reads DWORDs until the buffer runs out, one block each
+	class dwordListBlock : public smartview::block
+	{
+	public:
+		std::vector<std::shared_ptr<smartview::blockT<DWORD>>> values;
+
+	private:
+		void parse() override
+		{
+			while (parser->getSize())
+			{
+				values.push_back(smartview::blockT<DWORD>::parse(parser));
+			}
+		}
+	};
+
+	// Worst case inputs for a parser, cb bytes each
+	// Counts of all ones, all zeros and runs of ones nest and repeat as far as the caps let them
+	std::vector<std::pair<std::wstring, std::vector<BYTE>>> pathologicalInputs(parserType parser, size_t cb)
+	{
+		auto inputs = std::vector<std::pair<std::wstring, std::vector<BYTE>>>{};
+		inputs.emplace_back(L"ff", std::vector<BYTE>(cb, 0xFF));
+		inputs.emplace_back(L"00", std::vector<BYTE>(cb, 0x00));
+
+		auto ones = std::vector<BYTE>(cb);
+		for (size_t i = 0; i < cb; i += sizeof DWORD)
+		{
+			ones[i] = 1;
+		}
+
+		inputs.emplace_back(L"count1", ones);
+
+		auto words = std::vector<BYTE>(cb);
+		for (size_t i = 0; i < cb; i += sizeof WORD)
+		{
+			words[i] = 2;
+		}
+
+		inputs.emplace_back(L"count2w", words);
+
+		auto random = std::vector<BYTE>(cb);
+		auto engine = std::mt19937{static_cast<UINT>(parser) * 7919u};
+		for (auto& b : random)
+		{
+			b = static_cast<BYTE>(engine());
+		}
+
+		inputs.emplace_back(L"random", random);
+
+		// Restrictions, and rules built on them, nest an and of one or a not inside each other
+		if (parser == parserType::RESTRICTION || parser == parserType::RULECONDITION ||
+			parser == parserType::EXTENDEDRULECONDITION)
+		{
+			auto nest = std::vector<BYTE>(cb);
+			for (size_t i = 0; i + 8 <= cb; i += 8)
+			{
+				nest[i] = RES_AND;
+				nest[i + 4] = 1;
+			}
+
+			inputs.emplace_back(L"nestand", nest);
+
+			auto nots = std::vector<BYTE>(cb);
+			for (size_t i = 0; i + 4 <= cb; i += 4)
+			{
+				nots[i] = RES_NOT;
+			}
+
+			inputs.emplace_back(L"nestnot", nots);
+		}
+
+		return inputs;
+	}
+
+	// A PROPERTIES blob of cProps binary properties tagged ulPropTag, cb bytes each
+	std::vector<BYTE> binaryProps(ULONG ulPropTag, size_t cProps, WORD cb)
+	{
+		auto bin = std::vector<BYTE>{};
+		const auto addWord = [&](WORD value) {
+			bin.push_back(LOBYTE(value));
+			bin.push_back(HIBYTE(value));
+		};
+
+		for (size_t i = 0; i < cProps; i++)
+		{
+			addWord(PROP_TYPE(ulPropTag));
+			addWord(PROP_ID(ulPropTag));
+			addWord(cb);
+			for (WORD j = 0; j < cb; j++)
+			{
+				bin.push_back(static_cast<BYTE>(i + j));
+			}
+		}
+
+		return bin;
+	}
+
+	TEST_CLASS(budgettest)
+	{
+	public:
+		// Without this, clang gets weird
+		static const bool dummy_var = true;
+
+		TEST_CLASS_INITIALIZE(initialize) { unittest::init(); }
+
+		TEST_METHOD(Test_budget)
+		{
+			Assert::AreEqual(smartview::parseBudget::current() == nullptr, true);
+			const auto bin = std::vector<BYTE>(0x1000, 1);
+
+			// Plenty of budget - everything parses
+			{
+				const auto budget = smartview::parseBudget{};
+				Assert::AreEqual(smartview::parseBudget::current() == &budget, true);
+				auto list = smartview::block::parse<dwordListBlock>(smartview::binaryParser::borrow(bin), true);
+				Assert::AreEqual(list->values.size(), size_t{0x400});
+				Assert::AreEqual(budget.exceeded() == smartview::parseBudget::resource::none, true);
+				Assert::AreEqual(budget.describe().empty(), true);
+			}
+
+			Assert::AreEqual(smartview::parseBudget::current() == nullptr, true);
+
+			// Out of blocks - parsing stops, the parser is drained and the rest of the values are unset
+			const auto truncations = smartview::parseBudget::truncations();
+			{
+				const auto budget = smartview::parseBudget{{100, 0x100000, std::chrono::milliseconds{10000}}};
+				auto list = smartview::block::parse<dwordListBlock>(smartview::binaryParser::borrow(bin), true);
+				Assert::AreEqual(budget.exceeded() == smartview::parseBudget::resource::blocks, true);
+				Assert::AreEqual(list->values.size() < size_t{0x400}, true);
+				Assert::AreEqual(list->values.back()->isSet(), false);
+				Assert::AreEqual(list->getSize(), bin.size());
+				Assert::AreEqual(budget.describe().empty(), false);
+			}
+
+			// Counted once, however much more was charged after it ran out
+			Assert::AreEqual(truncations + 1, smartview::parseBudget::truncations());
+
+			// Out of bytes
+			{
+				const auto budget = smartview::parseBudget{{0x100000, 0x1000, std::chrono::milliseconds{10000}}};
+				auto list = smartview::block::parse<dwordListBlock>(smartview::binaryParser::borrow(bin), true);
+				Assert::AreEqual(budget.exceeded() == smartview::parseBudget::resource::bytes, true);
+			}
+
+			// Out of time
+			{
+				const auto budget = smartview::parseBudget{{0x100000, 0x100000, std::chrono::milliseconds{0}}};
+				Sleep(1);
+				auto list = smartview::block::parse<dwordListBlock>(smartview::binaryParser::borrow(bin), true);
+				Assert::AreEqual(budget.exceeded() == smartview::parseBudget::resource::time, true);
+			}
+		}
+
+		// Binary properties parse their own Smart View as part of the structure holding them, under the same budget
+		TEST_METHOD(Test_budgetNested)
+		{
+			constexpr size_t cProps = 400;
+			constexpr WORD cbProp = 0x40;
+			// No parser is registered for this tag, so its values are only bytes
+			const auto plain = binaryProps(PROP_TAG(PT_BINARY, 0x0001), cProps, cbProp);
+			const auto nested = binaryProps(PR_ENTRYID, cProps, cbProp);
+			const auto parse = [](const std::vector<BYTE>& bin, size_t maxBlocks, bool& fits) {
+				const auto budget = smartview::parseBudget{{maxBlocks, 0x10000000, std::chrono::milliseconds{100000}}};
+				auto props = smartview::makeBlock<smartview::PropertiesStruct>(_MaxEntriesSmall, false, false);
+				props->block::parse(smartview::binaryParser::borrow(bin), true);
+				fits = budget.exceeded() == smartview::parseBudget::resource::none;
+				return props;
+			};
+
+			// Find the fewest blocks the plain properties fit in
+			auto fits = false;
+			size_t low = 0;
+			size_t high = 0x100000;
+			parse(plain, high, fits);
+			Assert::AreEqual(true, fits);
+			while (low + 1 < high)
+			{
+				const auto mid = low + (high - low) / 2;
+				parse(plain, mid, fits);
+				if (fits)
+				{
+					high = mid;
+				}
+				else
+				{
+					low = mid;
+				}
+			}
+
+			// The same properties as entry IDs don't fit, since their Smart View is charged too
+			parse(nested, high, fits);
+			Assert::AreEqual(false, fits);
+
+			// Given room, they parse, and render their Smart View after the budget is gone
+			const auto props = parse(nested, 0x100000, fits);
+			Assert::AreEqual(true, fits);
+			const auto result = props->toString();
+			Assert::AreEqual(true, result.find(L"Smart View") != std::wstring::npos);
+		}
+
+		// No parser should need more than the default budget for a small blob, however bad
+		TEST_METHOD(Test_pathologicalCorpus)
+		{
+			for (auto parser = 1; parser < static_cast<int>(parserType::END); parser++)
+			{
+				for (const auto& input : pathologicalInputs(static_cast<parserType>(parser), 0x400))
+				{
+					auto bin = input.second;
+					const auto result = smartview::InterpretBinaryAsString(
+						{static_cast<ULONG>(bin.size()), bin.data()}, static_cast<parserType>(parser), nullptr);
+					const auto name = addin::AddInStructTypeToString(static_cast<parserType>(parser));
+					Assert::AreEqual(
+						false,
+						result.find(L"*** Truncated") != std::wstring::npos,
+						(name + L" " + input.first).c_str());
+				}
+			}
+		}
+
+		// Time every parser over each pathological input at growing sizes. Cost per byte should stay
+		// roughly flat. If it climbs with the size of the input, the parser is superlinear somewhere.
+		TEST_METHOD(Benchmark_pathologicalCorpus)
+		{
+			constexpr size_t cbSmall = 0x1000;
+			constexpr size_t cbLarge = 0x10000;
+			// Allow for noise, but a superlinear parser at 16x the input shows well past this
+			constexpr auto maxGrowth = 8.0;
+			// Too fast to time reliably
+			constexpr auto minNs = 2000000LL;
+			// A single sample is at the mercy of whatever else the machine is doing, so take the median
+			constexpr auto runs = 5;
+
+			auto failures = std::wstring{};
+			for (auto parser = 1; parser < static_cast<int>(parserType::END); parser++)
+			{
+				const auto type = static_cast<parserType>(parser);
+				const auto name = addin::AddInStructTypeToString(type);
+				const auto small = pathologicalInputs(type, cbSmall);
+				const auto large = pathologicalInputs(type, cbLarge);
+				for (size_t i = 0; i < small.size(); i++)
+				{
+					// InterpretBinaryAsString would serve every run after the first from the render cache,
+					// so parse and render here
+					const auto time = [&](const std::vector<BYTE>& bin, bool& truncated) {
+						auto samples = std::vector<long long>{};
+						for (auto run = 0; run < runs; run++)
+						{
+							const auto start = std::chrono::steady_clock::now();
+							const auto svp = smartview::InterpretBinary(
+								{static_cast<ULONG>(bin.size()), const_cast<LPBYTE>(bin.data())}, type, nullptr);
+							const auto result = svp->toString();
+							const auto elapsed = std::chrono::steady_clock::now() - start;
+							truncated = result.find(L"*** Truncated") != std::wstring::npos;
+							samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+						}
+
+						std::nth_element(samples.begin(), samples.begin() + runs / 2, samples.end());
+						return samples[runs / 2];
+					};
+
+					auto smallTruncated = false;
+					auto largeTruncated = false;
+					const auto nsSmall = time(small[i].second, smallTruncated);
+					const auto nsLarge = time(large[i].second, largeTruncated);
+					const auto perByteSmall = static_cast<double>(nsSmall) / cbSmall;
+					const auto perByteLarge = static_cast<double>(nsLarge) / cbLarge;
+					Logger::WriteMessage(strings::format(
+											 L"%ws %ws: %.1f ns/byte at 0x%zx, %.1f ns/byte at 0x%zx%ws\n",
+											 name.c_str(),
+											 small[i].first.c_str(),
+											 perByteSmall,
+											 cbSmall,
+											 perByteLarge,
+											 cbLarge,
+											 largeTruncated ? L" (truncated)" : L"")
+											 .c_str());
+
+					if (!largeTruncated && nsLarge > minNs && perByteLarge > perByteSmall * maxGrowth)
+					{
+						failures += name + L" " + small[i].first + L"\n";
+					}
+				}
+			}
+
+			unittest::AreEqualEx(std::wstring{}, failures, L"superlinear parsers");
+		}
+	};
+} // namespace budgettest
@@ -2,6 +2,7 @@
 #include <UnitTest/UnitTest.h>
 #include <core/interpret/flags.h>
 #include <core/mapi/extraPropTags.h>
+#include <core/addin/mfcmapi.h>
 
 namespace flagtest
 {
@@ -63,6 +64,32 @@ namespace flagtest
 			unittest::AreEqualEx(
 				L"BFLAGS_MASK_OUTLOOK | Type: BFLAGS_INTERNAL_MAILUSER | Home Fax",
 				flags::InterpretFlags(flagWABEntryIDType, BFLAGS_MASK_OUTLOOK | BFLAGS_INTERNAL_MAILUSER | 0x10));
+
+			// Unknown flag names
+			unittest::AreEqualEx(L"", flags::InterpretFlags(0xFFFFFFFF, 1));
+		}
+
+		TEST_METHOD(Test_InterpretFlagsMemo)
+		{
+			// Repeated lookups come from the memo and must match the first result
+			for (auto i = 0; i < 2; i++)
+			{
+				unittest::AreEqualEx(
+					L"MAPI_P1 | MAPI_TO", flags::InterpretFlags(PROP_ID(PR_RECIPIENT_TYPE), MAPI_P1 | MAPI_TO));
+				unittest::AreEqualEx(
+					L"MAPI_SUBMITTED | 0x5", flags::InterpretFlags(PROP_ID(PR_RECIPIENT_TYPE), MAPI_SUBMITTED | 0x5));
+			}
+
+			// Rebuilding the index drops the memo without changing results
+			flags::BuildFlagIndex();
+			unittest::AreEqualEx(
+				L"MAPI_P1 | MAPI_TO", flags::InterpretFlags(PROP_ID(PR_RECIPIENT_TYPE), MAPI_P1 | MAPI_TO));
+
+			// Every name in the table is found, including the last one
+			for (const auto& flag : FlagArray)
+			{
+				Assert::AreEqual(false, flags::InterpretFlags(flag.ulFlagName, flag.lFlagValue).empty());
+			}
 		}
 
 		TEST_METHOD(Test_AllFlagsToString)
@@ -2,12 +2,137 @@
 #include <UnitTest/UnitTest.h>
 #include <core/mapi/cache/namedProps.h>
 #include <core/mapi/cache/namedPropCache.h>
+#include <core/mapi/mapiMemory.h>
+#include <core/mapi/mapiOutput.h>
+#include <core/model/mapiRowModel.h>
 #include <core/mapi/extraPropTags.h>
 #include <core/utility/output.h>
 #include <core/utility/registry.h>
+#include <core/interpret/proptags.h>
+#include <core/interpret/flags.h>
+#include <core/utility/strings.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
 
 namespace namedproptest
 {
+	// Just enough of an IMAPIProp to count the calls named property lookups make.
+	// It has no mapping signature, so the cache never answers for it and every lookup reaches the object.
+	class countingProp : public IMAPIProp
+	{
+	public:
+		ULONG cGetProps{};
+		ULONG cGetNamesFromIDs{};
+		ULONG cAllNames{}; // Get all names calls, also counted in cGetNamesFromIDs
+		// Result of a get all names call, which names 0x8001 and 0x8002. Fails by default.
+		HRESULT hrAllNames{MAPI_E_NO_SUPPORT};
+		// Asked about particular tags, we only name IDs up to this one
+		ULONG ulHighestNamed{cache::__UPPERBOUND};
+
+		STDMETHODIMP QueryInterface(REFIID riid, LPVOID* ppvObj) override
+		{
+			if (!ppvObj) return MAPI_E_INVALID_PARAMETER;
+			*ppvObj = nullptr;
+			if (riid != IID_IUnknown && riid != IID_IMAPIProp) return E_NOINTERFACE;
+			*ppvObj = this;
+			AddRef();
+			return S_OK;
+		}
+		// Lives on the stack
+		STDMETHODIMP_(ULONG) AddRef() override { return ++cRef; }
+		STDMETHODIMP_(ULONG) Release() override { return --cRef; }
+
+		STDMETHODIMP GetLastError(HRESULT, ULONG, LPMAPIERROR*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP SaveChanges(ULONG) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP GetProps(LPSPropTagArray, ULONG, ULONG* lpcValues, LPSPropValue* lppPropArray) override
+		{
+			cGetProps++;
+			if (lpcValues) *lpcValues = 0;
+			if (lppPropArray) *lppPropArray = nullptr;
+			return MAPI_E_NOT_FOUND;
+		}
+		STDMETHODIMP GetPropList(ULONG, LPSPropTagArray*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP OpenProperty(ULONG, LPCIID, ULONG, ULONG, LPUNKNOWN*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP SetProps(ULONG, LPSPropValue, LPSPropProblemArray*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP DeleteProps(LPSPropTagArray, LPSPropProblemArray*) override { return MAPI_E_NO_SUPPORT; }
+		STDMETHODIMP CopyTo(
+			ULONG,
+			LPCIID,
+			LPSPropTagArray,
+			ULONG_PTR,
+			LPMAPIPROGRESS,
+			LPCIID,
+			LPVOID,
+			ULONG,
+			LPSPropProblemArray*) override
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+		STDMETHODIMP
+		CopyProps(LPSPropTagArray, ULONG_PTR, LPMAPIPROGRESS, LPCIID, LPVOID, ULONG, LPSPropProblemArray*) override
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+		// Every tag up to ulHighestNamed is named: PSETID_Common with its own prop ID as the dispid
+		STDMETHODIMP GetNamesFromIDs(
+			LPSPropTagArray* lppPropTags,
+			LPGUID,
+			ULONG,
+			ULONG* lpcPropNames,
+			LPMAPINAMEID** lpppPropNames) override
+		{
+			cGetNamesFromIDs++;
+			if (!lppPropTags || !lpcPropNames || !lpppPropNames) return MAPI_E_NO_SUPPORT;
+			const auto bAllNames = !*lppPropTags;
+			if (bAllNames)
+			{
+				cAllNames++;
+				if (FAILED(hrAllNames)) return hrAllNames;
+				*lppPropTags = mapi::allocate<LPSPropTagArray>(CbNewSPropTagArray(2));
+				if (!*lppPropTags) return MAPI_E_NOT_ENOUGH_MEMORY;
+				(*lppPropTags)->cValues = 2;
+				mapi::setTag(*lppPropTags, 0) = PROP_TAG(PT_NULL, 0x8001);
+				mapi::setTag(*lppPropTags, 1) = PROP_TAG(PT_NULL, 0x8002);
+			}
+
+			const auto cTags = (*lppPropTags)->cValues;
+			const auto lppNames = mapi::allocate<LPMAPINAMEID*>(cTags * sizeof(LPMAPINAMEID));
+			if (!lppNames) return MAPI_E_NOT_ENOUGH_MEMORY;
+			for (ULONG i = 0; i < cTags; i++)
+			{
+				lppNames[i] = nullptr;
+				if (PROP_ID(mapi::getTag(*lppPropTags, i)) > ulHighestNamed) continue;
+				lppNames[i] = mapi::allocate<LPMAPINAMEID>(sizeof(MAPINAMEID), lppNames);
+				if (lppNames[i])
+				{
+					*lppNames[i] = MAPINAMEID{
+						const_cast<LPGUID>(&guid::PSETID_Common),
+						MNID_ID,
+						{.lID = static_cast<LONG>(PROP_ID(mapi::getTag(*lppPropTags, i)))}};
+				}
+			}
+
+			*lpcPropNames = cTags;
+			*lpppPropNames = lppNames;
+			return bAllNames ? hrAllNames : S_OK;
+		}
+		STDMETHODIMP GetIDsFromNames(ULONG, LPMAPINAMEID*, ULONG, LPSPropTagArray*) override
+		{
+			return MAPI_E_NO_SUPPORT;
+		}
+
+	private:
+		ULONG cRef{1};
+	};
+
+	std::vector<BYTE> readCacheFile(const std::filesystem::path& dir, const std::vector<BYTE>& sig)
+	{
+		auto file = std::ifstream(dir / (strings::BinToHexString(sig, false) + L".npc"), std::ios::binary);
+		return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+	}
+
 	TEST_CLASS(namedproptest)
 	{
 	public:
@@ -136,6 +261,13 @@ namespace namedproptest
 			Assert::AreEqual(true, cache::namedPropCache::find(0x1111, formStorageID)->match(prop1, true, true));
 			Assert::AreEqual(true, cache::namedPropCache::find(sig1, 0x1111)->match(prop1, true, true));
 			Assert::AreEqual(true, cache::namedPropCache::find(sig1, formStorageID)->match(prop1, true, true));
+			// By name or signature alone
+			Assert::AreEqual(true, cache::namedPropCache::find(prop1, false, true)->match(prop1, true, true));
+			Assert::AreEqual(true, cache::namedPropCache::find(prop2, false, false)->match(prop1, false, false));
+			Assert::AreEqual(
+				true,
+				cache::namedPropCache::find(prop3, false, true)
+					->match(cache::namedPropCacheEntry::empty(), true, true));
 
 			Assert::AreEqual(
 				true,
@@ -169,6 +301,238 @@ namespace namedproptest
 				true, cache::namedPropCache::find(std::vector<BYTE>{}, pageDirStreamID)->match(prop3, true, true));
 		}
 
+		// Populate the cache with 50k entries and measure lookup throughput through each index
+		TEST_METHOD(Benchmark_Cache)
+		{
+			// Per-entry debug output would swamp the measurement
+			const DWORD debugTag = registry::debugTag;
+			registry::debugTag = debugTag & ~static_cast<DWORD>(output::dbgLevel::NamedPropCache);
+
+			constexpr ULONG cSigs = 5;
+			constexpr ULONG cIDs = 10000;
+			auto sigs = std::vector<std::vector<BYTE>>{};
+			for (ULONG i = 0; i < cSigs; i++)
+			{
+				sigs.push_back({0xBE, 0xEF, static_cast<BYTE>(i), 0x42});
+			}
+
+			const auto nameID = [](ULONG i) {
+				return MAPINAMEID{const_cast<LPGUID>(&guid::PSETID_Address), MNID_ID, {.lID = static_cast<LONG>(i)}};
+			};
+
+			auto start = std::chrono::steady_clock::now();
+			for (const auto& sig : sigs)
+			{
+				auto entries = std::vector<std::shared_ptr<cache::namedPropCacheEntry>>{};
+				for (ULONG i = 0; i < cIDs; i++)
+				{
+					const auto name = nameID(i);
+					entries.emplace_back(cache::namedPropCacheEntry::make(&name, cache::__LOWERBOUND + i));
+				}
+
+				cache::namedPropCache::add(entries, sig);
+			}
+
+			const auto addTime = std::chrono::steady_clock::now() - start;
+
+			start = std::chrono::steady_clock::now();
+			for (const auto& sig : sigs)
+			{
+				for (ULONG i = 0; i < cIDs; i++)
+				{
+					const auto name = nameID(i);
+					Assert::AreEqual(
+						cache::__LOWERBOUND + i, cache::namedPropCache::find(sig, cache::__LOWERBOUND + i)->getPropID());
+					Assert::AreEqual(cache::__LOWERBOUND + i, cache::namedPropCache::find(sig, name)->getPropID());
+					Assert::AreEqual(
+						cache::__LOWERBOUND + i, cache::namedPropCache::find(cache::__LOWERBOUND + i, name)->getPropID());
+				}
+			}
+
+			const auto findTime = std::chrono::steady_clock::now() - start;
+			registry::debugTag = debugTag;
+
+			Logger::WriteMessage(strings::format(
+									 L"namedPropCache: %u entries added in %lld ms, %u lookups in %lld ms\n",
+									 cSigs * cIDs,
+									 std::chrono::duration_cast<std::chrono::milliseconds>(addTime).count(),
+									 cSigs * cIDs * 3,
+									 std::chrono::duration_cast<std::chrono::milliseconds>(findTime).count())
+									 .c_str());
+		}
+
+		// Many threads adding and finding overlapping entries at once must all agree on what's cached
+		TEST_METHOD(Test_ConcurrentCache)
+		{
+			const DWORD debugTag = registry::debugTag;
+			registry::debugTag = debugTag & ~static_cast<DWORD>(output::dbgLevel::NamedPropCache);
+
+			constexpr ULONG cThreads = 8;
+			constexpr ULONG cIDs = 2000;
+			const auto sigs = std::vector<std::vector<BYTE>>{{0xC0, 0x01}, {0xC0, 0x02}};
+			const auto nameID = [](ULONG i) {
+				return MAPINAMEID{const_cast<LPGUID>(&guid::PSETID_Task), MNID_ID, {.lID = static_cast<LONG>(i)}};
+			};
+
+			// What each thread found for each id in each signature
+			auto found = std::vector<std::vector<std::shared_ptr<cache::namedPropCacheEntry>>>(cThreads);
+			auto failures = std::atomic<ULONG>{};
+			auto threads = std::vector<std::thread>{};
+			for (ULONG t = 0; t < cThreads; t++)
+			{
+				threads.emplace_back([&, t] {
+					for (ULONG i = 0; i < cIDs; i++)
+					{
+						const auto& sig = sigs[(t + i) % sigs.size()];
+						const auto ulPropID = cache::__LOWERBOUND + 0x1000 + i;
+						const auto name = nameID(i);
+						cache::namedPropCache::add({cache::namedPropCacheEntry::make(&name, ulPropID)}, sig);
+
+						const auto byID = cache::namedPropCache::find(sig, ulPropID);
+						if (byID != cache::namedPropCache::find(sig, name)) failures++;
+						if (!cache::namedPropCacheEntry::valid(cache::namedPropCache::find(ulPropID, name))) failures++;
+
+						// Shared lookup tables get hit from every thread too
+						if (proptags::PropTagToPropName(PR_SUBJECT_W, false).bestGuess.empty()) failures++;
+						if (flags::InterpretFlags(PROP_ID(PR_RECIPIENT_TYPE), MAPI_TO).empty()) failures++;
+					}
+
+					for (ULONG i = 0; i < cIDs; i++)
+					{
+						for (const auto& sig : sigs)
+						{
+							found[t].push_back(cache::namedPropCache::find(sig, cache::__LOWERBOUND + 0x1000 + i));
+						}
+					}
+				});
+			}
+
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			registry::debugTag = debugTag;
+
+			Assert::AreEqual(ULONG{0}, failures.load());
+			for (ULONG t = 1; t < cThreads; t++)
+			{
+				Assert::AreEqual(found[0].size(), found[t].size());
+				for (size_t i = 0; i < found[0].size(); i++)
+				{
+					Assert::AreEqual(true, cache::namedPropCacheEntry::valid(found[t][i]));
+					Assert::AreEqual(true, found[0][i] == found[t][i]);
+				}
+			}
+		}
+
+		TEST_METHOD(Test_Serialize)
+		{
+			const auto entries = std::vector<std::shared_ptr<cache::namedPropCacheEntry>>{
+				cache::namedPropCacheEntry::make(&formStorageID, 0x8001, sig1),
+				cache::namedPropCacheEntry::make(&formStorageName, 0x8002, sig1),
+				cache::namedPropCacheEntry::make(&pageDirStreamID, 0x8003, sig1)};
+			const auto bin = cache::SerializeNamedProps(sig1, entries, true);
+
+			auto loaded = std::vector<std::shared_ptr<cache::namedPropCacheEntry>>{};
+			auto bComplete = false;
+			Assert::AreEqual(true, cache::DeserializeNamedProps(bin, sig1, loaded, bComplete));
+			Assert::AreEqual(true, bComplete);
+			Assert::AreEqual(entries.size(), loaded.size());
+			for (size_t i = 0; i < entries.size(); i++)
+			{
+				Assert::AreEqual(true, entries[i]->match(loaded[i], true, true));
+			}
+
+			Assert::AreEqual(
+				true, cache::DeserializeNamedProps(cache::SerializeNamedProps(sig1, {}, false), sig1, loaded, bComplete));
+			Assert::AreEqual(false, bComplete);
+			Assert::AreEqual(true, loaded.empty());
+
+			// Saved for another store
+			Assert::AreEqual(false, cache::DeserializeNamedProps(bin, sig2, loaded, bComplete));
+			Assert::AreEqual(true, loaded.empty());
+
+			// Truncated, padded, and corrupt files
+			Assert::AreEqual(
+				false,
+				cache::DeserializeNamedProps(
+					std::vector<BYTE>(bin.begin(), bin.end() - 1), sig1, loaded, bComplete));
+			auto padded = bin;
+			padded.push_back(0);
+			Assert::AreEqual(false, cache::DeserializeNamedProps(padded, sig1, loaded, bComplete));
+			auto corrupt = bin;
+			corrupt[0] ^= 0xFF;
+			Assert::AreEqual(false, cache::DeserializeNamedProps(corrupt, sig1, loaded, bComplete));
+			Assert::AreEqual(false, cache::DeserializeNamedProps({}, sig1, loaded, bComplete));
+			Assert::AreEqual(true, loaded.empty());
+		}
+
+		TEST_METHOD(Test_diskCache)
+		{
+			const auto dir =
+				std::filesystem::temp_directory_path() / strings::format(L"npctest%u", GetCurrentProcessId());
+			std::filesystem::create_directories(dir);
+			const auto szOldDir = std::wstring(registry::namedPropCacheDir);
+			registry::namedPropCacheDir = dir.wstring();
+
+			// Made up for this test so nothing else has loaded or saved them
+			const auto sigPartial = std::vector<BYTE>{0x4E, 0x50, 0x43, 0x01};
+			const auto sigFull = std::vector<BYTE>{0x4E, 0x50, 0x43, 0x02};
+			auto prop = countingProp{};
+
+			// A walk which returned errors is saved, but not as complete, so the next call goes back to the store
+			prop.hrAllNames = MAPI_W_ERRORS_RETURNED;
+			Assert::AreEqual(size_t{2}, cache::namedPropCache::GetNamesFromIDs(&prop, sigPartial, nullptr).size());
+			Assert::AreEqual(size_t{2}, cache::namedPropCache::GetNamesFromIDs(&prop, sigPartial, nullptr).size());
+			Assert::AreEqual(ULONG{2}, prop.cGetNamesFromIDs);
+
+			auto loaded = std::vector<std::shared_ptr<cache::namedPropCacheEntry>>{};
+			auto bComplete = true;
+			Assert::AreEqual(
+				true, cache::DeserializeNamedProps(readCacheFile(dir, sigPartial), sigPartial, loaded, bComplete));
+			Assert::AreEqual(false, bComplete);
+			Assert::AreEqual(size_t{2}, loaded.size());
+
+			// A walk which failed outright saves nothing
+			prop.hrAllNames = MAPI_E_NO_SUPPORT;
+			const auto sigFailed = std::vector<BYTE>{0x4E, 0x50, 0x43, 0x03};
+			Assert::AreEqual(true, cache::namedPropCache::GetNamesFromIDs(&prop, sigFailed, nullptr).empty());
+			Assert::AreEqual(true, readCacheFile(dir, sigFailed).empty());
+
+			// A complete walk answers every later get all names call
+			prop.hrAllNames = S_OK;
+			prop.ulHighestNamed = 0x8002;
+			prop.cAllNames = 0;
+			Assert::AreEqual(size_t{2}, cache::namedPropCache::GetNamesFromIDs(&prop, sigFull, nullptr).size());
+			Assert::AreEqual(size_t{2}, cache::namedPropCache::GetNamesFromIDs(&prop, sigFull, nullptr).size());
+			Assert::AreEqual(ULONG{1}, prop.cAllNames);
+
+			// Names the store maps later are picked up from past the highest one saved, without another full walk
+			prop.ulHighestNamed = 0x8004;
+			Assert::AreEqual(size_t{4}, cache::namedPropCache::GetNamesFromIDs(&prop, sigFull, nullptr).size());
+			Assert::AreEqual(ULONG{1}, prop.cAllNames);
+
+			// Misses are only noted, and written together when flushed
+			const auto sigMisses = std::vector<BYTE>{0x4E, 0x50, 0x43, 0x04};
+			auto tag = SPropTagArray{1, PROP_TAG(PT_LONG, 0x8001)};
+			Assert::AreEqual(size_t{1}, cache::namedPropCache::GetNamesFromIDs(&prop, sigMisses, &tag).size());
+			tag.aulPropTag[0] = PROP_TAG(PT_LONG, 0x8002);
+			Assert::AreEqual(size_t{1}, cache::namedPropCache::GetNamesFromIDs(&prop, sigMisses, &tag).size());
+			Assert::AreEqual(true, readCacheFile(dir, sigMisses).empty());
+			cache::namedPropCache::flushToDisk();
+			Assert::AreEqual(
+				true, cache::DeserializeNamedProps(readCacheFile(dir, sigMisses), sigMisses, loaded, bComplete));
+			Assert::AreEqual(false, bComplete);
+			Assert::AreEqual(size_t{2}, loaded.size());
+			Assert::AreEqual(
+				true, cache::DeserializeNamedProps(readCacheFile(dir, sigFull), sigFull, loaded, bComplete));
+			Assert::AreEqual(true, bComplete);
+
+			registry::namedPropCacheDir = szOldDir;
+			std::filesystem::remove_all(dir);
+		}
+
 		TEST_METHOD(Test_Valid)
 		{
 			Assert::AreEqual(false, cache::namedPropCacheEntry::valid(cache::namedPropCacheEntry::empty()));
@@ -227,5 +591,102 @@ namespace namedproptest
 			const auto badID = MAPINAMEID{const_cast<LPGUID>(&guid::PSETID_Common), 3, dispidFormStorage};
 			Assert::AreEqual(std::wstring(L""), strings::MAPINAMEIDToString(badID));
 		}
+
+		TEST_METHOD(Test_propArrayNames)
+		{
+			auto props = std::vector<SPropValue>{
+				{PROP_TAG(PT_LONG, 0x8001)},
+				{PR_SUBJECT_W},
+				{PROP_TAG(PT_BOOLEAN, 0x8002)},
+				{PROP_TAG(PT_ERROR, 0x8001)}};
+			auto prop = countingProp{};
+			const auto names = cache::propArrayNames(static_cast<ULONG>(props.size()), props.data(), &prop, false);
+			Assert::AreEqual(ULONG{1}, prop.cGetProps);
+			Assert::AreEqual(ULONG{1}, prop.cGetNamesFromIDs);
+			Assert::AreEqual(true, names.getSig() == nullptr);
+
+			const auto name1 = names.find(PROP_TAG(PT_LONG, 0x8001));
+			Assert::AreEqual(LONG{0x8001}, name1->Kind.lID);
+			Assert::AreEqual(true, name1->lpguid && IsEqualGUID(*name1->lpguid, guid::PSETID_Common));
+			Assert::AreEqual(LONG{0x8002}, names.find(PROP_TAG(PT_BOOLEAN, 0x8002))->Kind.lID);
+
+			// Tags we didn't look up get an empty name, which stops any further lookups
+			const auto subject = names.find(PR_SUBJECT_W);
+			Assert::AreEqual(true, subject != nullptr && subject->lpguid == nullptr);
+			Assert::AreEqual(true, cache::NameIDToStrings(PR_SUBJECT_W, &prop, subject, nullptr, false).name.empty());
+			Assert::AreEqual(ULONG{1}, prop.cGetNamesFromIDs);
+
+			// Nothing to look up for address book props
+			const auto abNames = cache::propArrayNames(static_cast<ULONG>(props.size()), props.data(), &prop, true);
+			Assert::AreEqual(ULONG{1}, prop.cGetProps);
+			Assert::AreEqual(ULONG{1}, prop.cGetNamesFromIDs);
+		}
+
+		// Count the calls the object sees when we output and model a property array,
+		// one lookup per property against one batch for the whole array
+		TEST_METHOD(Benchmark_propArrayNames)
+		{
+			constexpr ULONG cNamed = 200;
+			constexpr ULONG cUnnamed = 50;
+			auto props = std::vector<SPropValue>{};
+			for (ULONG i = 0; i < cNamed; i++)
+			{
+				auto prop = SPropValue{PROP_TAG(PT_LONG, cache::__LOWERBOUND + i)};
+				prop.Value.l = static_cast<LONG>(i);
+				props.push_back(prop);
+			}
+
+			for (ULONG i = 0; i < cUnnamed; i++)
+			{
+				auto prop = SPropValue{PROP_TAG(PT_LONG, 0x3000 + i)};
+				prop.Value.l = static_cast<LONG>(i);
+				props.push_back(prop);
+			}
+
+			FILE* fFile = nullptr;
+			Assert::AreEqual(0, tmpfile_s(&fFile));
+
+			auto perProp = countingProp{};
+			auto start = std::chrono::steady_clock::now();
+			for (auto& prop : props)
+			{
+				output::outputProperty(output::dbgLevel::NoDebug, fFile, &prop, &perProp, false);
+			}
+
+			const auto perPropTime = std::chrono::steady_clock::now() - start;
+
+			auto batched = countingProp{};
+			start = std::chrono::steady_clock::now();
+			output::outputProperties(
+				output::dbgLevel::NoDebug, fFile, static_cast<ULONG>(props.size()), props.data(), &batched, false);
+			const auto batchedTime = std::chrono::steady_clock::now() - start;
+			fclose(fFile);
+
+			auto modeled = countingProp{};
+			const auto models = model::propsToModels(static_cast<ULONG>(props.size()), props.data(), &modeled, false);
+
+			Logger::WriteMessage(strings::format(
+									 L"Output %u props, %u named: per prop %u GetProps, %u GetNamesFromIDs in %lld ms, "
+									 L"batched %u GetProps, %u GetNamesFromIDs in %lld ms\n",
+									 cNamed + cUnnamed,
+									 cNamed,
+									 perProp.cGetProps,
+									 perProp.cGetNamesFromIDs,
+									 std::chrono::duration_cast<std::chrono::milliseconds>(perPropTime).count(),
+									 batched.cGetProps,
+									 batched.cGetNamesFromIDs,
+									 std::chrono::duration_cast<std::chrono::milliseconds>(batchedTime).count())
+									 .c_str());
+
+			Assert::AreEqual(true, perProp.cGetNamesFromIDs >= cNamed);
+			Assert::AreEqual(ULONG{1}, batched.cGetProps);
+			Assert::AreEqual(ULONG{1}, batched.cGetNamesFromIDs);
+			Assert::AreEqual(ULONG{1}, modeled.cGetProps);
+			Assert::AreEqual(ULONG{1}, modeled.cGetNamesFromIDs);
+
+			Assert::AreEqual(props.size(), models.size());
+			Assert::AreEqual(false, models[0]->namedPropGuid().empty());
+			Assert::AreEqual(true, models[cNamed]->namedPropGuid().empty());
+		}
 	};
 } // namespace namedproptest
@@ -0,0 +1,139 @@
+#include <UnitTest/stdafx.h>
+#include <UnitTest/UnitTest.h>
+#include <core/utility/output.h>
+#include <core/utility/outputSink.h>
+#include <core/utility/strings.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+namespace outputtest
+{
+	// Collects whatever is written to it
+	class memorySink : public output::sink
+	{
+	public:
+		explicit memorySink(std::wstring& _szText) : szText(_szText) {}
+		void write(std::wstring_view szWrite) override { szText.append(szWrite); }
+		void flush() override { ulFlushes++; }
+
+		std::wstring& szText;
+		ULONG ulFlushes{};
+	};
+
+	std::string readFile(const std::filesystem::path& path)
+	{
+		auto file = std::ifstream(path, std::ios::binary);
+		return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+	}
+
+	std::filesystem::path tempFile(LPCWSTR szName)
+	{
+		return std::filesystem::temp_directory_path() /
+			   strings::format(L"%ws%u.xml", szName, GetCurrentProcessId());
+	}
+
+	TEST_CLASS(outputtest)
+	{
+	public:
+		// Without this, clang gets weird
+		static const bool dummy_var = true;
+
+		TEST_CLASS_INITIALIZE(initialize) { unittest::init(); }
+
+		TEST_METHOD(Test_fileSink)
+		{
+			for (const auto bBackground : {false, true})
+			{
+				const auto path = tempFile(L"outputtest");
+				const auto fFile = output::MyOpenFile(path.wstring(), true, bBackground);
+				Assert::IsNotNull(fFile);
+				Assert::IsNotNull(output::findSink(fFile));
+
+				output::OutputToFile(fFile, L"<a>\n");
+				output::OutputToFilef(fFile, L"<b>%ws</b>\n", L"\x00e9\x20ac");
+				output::OutputToFile(fFile, L"</a>");
+				output::CloseFile(fFile);
+
+				Assert::AreEqual(
+					std::string("\xEF\xBB\xBF<a>\r\n<b>\xC3\xA9\xE2\x82\xAC</b>\r\n</a>"), readFile(path));
+				std::filesystem::remove(path);
+			}
+		}
+
+		TEST_METHOD(Test_fileSinkLarge)
+		{
+			// Enough to fill several buffers
+			const auto szLine = std::wstring(99, L'x') + L"\n";
+			constexpr ULONG cLines = 5000;
+			for (const auto bBackground : {false, true})
+			{
+				const auto path = tempFile(L"outputtestlarge");
+				const auto fFile = output::MyOpenFile(path.wstring(), true, bBackground);
+				Assert::IsNotNull(fFile);
+				for (ULONG i = 0; i < cLines; i++)
+				{
+					output::OutputToFile(fFile, szLine);
+				}
+
+				output::CloseFile(fFile);
+
+				const auto szFile = readFile(path);
+				Assert::AreEqual(size_t{3 + cLines * 101}, szFile.size());
+				Assert::AreEqual(std::string(99, 'x') + "\r\n", szFile.substr(szFile.size() - 101));
+				std::filesystem::remove(path);
+			}
+		}
+
+		TEST_METHOD(Test_attachSink)
+		{
+			FILE* fFile = nullptr;
+			Assert::AreEqual(0, tmpfile_s(&fFile));
+			Assert::IsNull(output::findSink(fFile));
+
+			auto szText = std::wstring{};
+			output::attachSink(fFile, std::make_unique<memorySink>(szText));
+			Assert::IsNotNull(output::findSink(fFile));
+			output::OutputToFile(fFile, L"one\n");
+			output::OutputToFilef(fFile, L"%ws\n", L"two");
+			Assert::AreEqual(std::wstring(L"one\ntwo\n"), szText);
+
+			// Once detached, writes go straight to the file again
+			output::detachSink(fFile);
+			Assert::IsNull(output::findSink(fFile));
+			output::OutputToFile(fFile, L"three\n");
+			Assert::AreEqual(std::wstring(L"one\ntwo\n"), szText);
+			fclose(fFile);
+		}
+
+		TEST_METHOD(Benchmark_fileSink)
+		{
+			const auto szLine = std::wstring(L"\t<property tag = \"0x0037001F\" type = \"PT_UNICODE\">");
+			constexpr ULONG cLines = 200000;
+			for (const auto bBackground : {false, true})
+			{
+				const auto path = tempFile(L"outputbenchmark");
+				const auto fFile = output::MyOpenFile(path.wstring(), true, bBackground);
+				Assert::IsNotNull(fFile);
+
+				const auto start = std::chrono::steady_clock::now();
+				for (ULONG i = 0; i < cLines; i++)
+				{
+					output::OutputToFile(fFile, szLine);
+					output::OutputToFile(fFile, L"\n");
+				}
+
+				output::CloseFile(fFile);
+				const auto elapsed =
+					std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+				Logger::WriteMessage(strings::format(
+										 L"fileSink, background writer %ws: %u fragments in %lld us\n",
+										 bBackground ? L"on" : L"off",
+										 cLines * 2,
+										 elapsed.count())
+										 .c_str());
+				std::filesystem::remove(path);
+			}
+		}
+	};
+} // namespace outputtest
@@ -0,0 +1,618 @@
+#include <UnitTest/stdafx.h>
+#include <UnitTest/UnitTest.h>
+#include <UnitTest/syntheticStore.h>
+#include <core/mapi/processor/dumpStore.h>
+#include <core/mapi/processor/findFidMid.h>
+#include <core/mapi/processor/rowPipeline.h>
+#include <core/mapi/mapiFunctions.h>
+#include <core/mapi/extraPropTags.h>
+#include <core/smartview/SmartView.h>
+#include <core/utility/strings.h>
+#include <core/utility/error.h>
+#include <chrono>
+#include <filesystem>
+
+namespace processortest
+{
+	// A scratch directory for dumps, removed when we're done with it
+	class tempDir
+	{
+	public:
+		explicit tempDir(const std::wstring& szName)
+			: path(std::filesystem::temp_directory_path() /
+				   strings::format(L"%ws%u", szName.c_str(), GetCurrentProcessId()))
+		{
+			std::filesystem::remove_all(path);
+			std::filesystem::create_directories(path);
+		}
+		~tempDir()
+		{
+			auto ec = std::error_code{};
+			std::filesystem::remove_all(path, ec);
+		}
+
+		std::wstring root() const { return path.wstring(); }
+
+	private:
+		std::filesystem::path path;
+	};
+
+	// What a walk saw, in the order it saw it
+	struct walkRecord
+	{
+		std::vector<std::pair<ULONG, std::vector<BYTE>>> rows; // ulCurRow and PR_ENTRYID of each contents table row
+		std::vector<std::vector<BYTE>> messages; // PR_ENTRYID of each message processed
+	};
+
+	std::vector<BYTE> toBytes(const SBinary& bin) { return std::vector<BYTE>(bin.lpb, bin.lpb + bin.cb); }
+
+	// Takes every contents table row, except every ulTurnDownEvery'th, and records it and its message
+	class rowRecorder : public mapi::processor::mapiProcessor
+	{
+	public:
+		rowRecorder(walkRecord& _record, ULONG _ulTurnDownEvery) : record(_record), ulTurnDownEvery(_ulTurnDownEvery)
+		{
+		}
+
+	private:
+		bool ShouldOpenMessagesAhead() noexcept override { return true; }
+
+		bool DoContentsTablePerRowWork(_In_ const _SRow* lpSRow, ULONG ulCurRow) override
+		{
+			const auto lpEID = PpropFindProp(lpSRow->lpProps, lpSRow->cValues, PR_ENTRYID);
+			if (!lpEID) return false;
+			record.rows.emplace_back(ulCurRow, toBytes(mapi::getBin(lpEID)));
+			return !ulTurnDownEvery || (ulCurRow + 1) % ulTurnDownEvery;
+		}
+
+		bool BeginMessageWork(
+			_In_ LPMESSAGE lpMessage,
+			_In_opt_ LPVOID /*lpParentMessageData*/,
+			_Deref_out_opt_ LPVOID* /*lpData*/) override
+		{
+			static const SizedSPropTagArray(1, sptaEID) = {1, {PR_ENTRYID}};
+			ULONG cValues = 0;
+			LPSPropValue lpProps = nullptr;
+			WC_H_GETPROPS_S(lpMessage->GetProps(LPSPropTagArray(&sptaEID), NULL, &cValues, &lpProps));
+			if (lpProps && lpProps[0].ulPropTag == PR_ENTRYID) record.messages.push_back(toBytes(lpProps[0].Value.bin));
+			MAPIFreeBuffer(lpProps);
+			return false;
+		}
+
+		walkRecord& record;
+		ULONG ulTurnDownEvery{};
+	};
+
+	walkRecord recordWalk(synthetic::store& store, ULONG ulPipelineRows, ULONG ulMaxOutput, ULONG ulTurnDownEvery)
+	{
+		auto record = walkRecord{};
+		auto lpMDB = store.open();
+		{
+			auto recorder = rowRecorder(record, ulTurnDownEvery);
+			recorder.InitMDB(lpMDB);
+			recorder.InitMaxOutput(ulMaxOutput);
+			recorder.InitPipelineRows(ulPipelineRows);
+			recorder.ProcessStore();
+		}
+
+		lpMDB->Release();
+		return record;
+	}
+
+	// PR_ENTRYID of each row of lpFolder's contents table, read the plain way
+	std::vector<std::vector<BYTE>> contentsEntryIDs(_In_ LPMAPIFOLDER lpFolder)
+	{
+		auto entryIDs = std::vector<std::vector<BYTE>>{};
+		static const SizedSPropTagArray(1, sptaCols) = {1, {PR_ENTRYID}};
+		LPMAPITABLE lpContents = nullptr;
+		Assert::AreEqual(S_OK, lpFolder->GetContentsTable(MAPI_UNICODE, &lpContents));
+		Assert::AreEqual(S_OK, lpContents->SetColumns(LPSPropTagArray(&sptaCols), TBL_BATCH));
+		LPSRowSet lpRows = nullptr;
+		Assert::AreEqual(S_OK, lpContents->QueryRows(0x7FFFFFFF, NULL, &lpRows));
+		for (ULONG i = 0; i < lpRows->cRows; i++)
+		{
+			entryIDs.push_back(toBytes(mapi::getBin(lpRows->aRow[i].lpProps[0])));
+		}
+
+		FreeProws(lpRows);
+		lpContents->Release();
+		return entryIDs;
+	}
+
+	// Reads the table through pipeline, checking each row and its message against expected.
+	// Returns the size of each batch read. Fails if the pipeline couldn't start, rather than test nothing.
+	std::vector<ULONG> readPipeline(
+		mapi::processor::rowPipeline& pipeline,
+		const mapi::processor::pipelineTable& table,
+		const std::vector<std::vector<BYTE>>& expected)
+	{
+		auto batches = std::vector<ULONG>{};
+		if (!pipeline.start(table)) Assert::Fail(L"rowPipeline didn't start. Did MAPI initialize on its thread?");
+		Assert::AreEqual(static_cast<ULONG>(expected.size()), pipeline.rowCount());
+		const SRowSet* lpBatch = nullptr;
+		ULONG ulRow = 0;
+		for (;;)
+		{
+			auto row = pipeline.next();
+			if (!row.lpRow) break;
+			if (row.batch.get() != lpBatch)
+			{
+				lpBatch = row.batch.get();
+				batches.push_back(lpBatch->cRows);
+			}
+
+			Assert::AreEqual(true, ulRow < expected.size());
+			const auto lpEID = PpropFindProp(row.lpRow->lpProps, row.lpRow->cValues, PR_ENTRYID);
+			Assert::IsNotNull(lpEID);
+			Assert::AreEqual(true, expected[ulRow] == toBytes(mapi::getBin(lpEID)));
+			Assert::AreEqual(table.bOpenMessages, row.bOpened);
+			Assert::AreEqual(table.bOpenMessages, row.lpMessage != nullptr);
+			if (row.lpMessage)
+			{
+				static const SizedSPropTagArray(1, sptaEID) = {1, {PR_ENTRYID}};
+				ULONG cValues = 0;
+				LPSPropValue lpProps = nullptr;
+				Assert::AreEqual(S_OK, row.lpMessage->GetProps(LPSPropTagArray(&sptaEID), NULL, &cValues, &lpProps));
+				Assert::AreEqual(true, expected[ulRow] == toBytes(mapi::getBin(lpProps[0])));
+				MAPIFreeBuffer(lpProps);
+			}
+
+			ulRow++;
+		}
+
+		pipeline.stop();
+		Assert::AreEqual(table.ulMaxRows ? table.ulMaxRows : static_cast<ULONG>(expected.size()), ulRow);
+		return batches;
+	}
+
+	// Seconds to walk the store
+	double runDumpStore(synthetic::store& store, ULONG ulWorkers, ULONG ulPipelineRows, const std::wstring& szRoot)
+	{
+		auto lpMDB = store.open();
+		const auto start = std::chrono::steady_clock::now();
+		{
+			auto dump = mapi::processor::dumpStore{};
+			dump.InitMDB(lpMDB);
+			dump.InitFolderPathRoot(szRoot);
+			dump.InitWorkers(ulWorkers);
+			dump.InitPipelineRows(ulPipelineRows);
+			dump.ProcessStore();
+		}
+
+		const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		lpMDB->Release();
+		return seconds;
+	}
+
+	double runFidMid(synthetic::store& store, ULONG ulWorkers, ULONG ulPipelineRows, mapi::processor::findFidMid& scan)
+	{
+		auto lpMDB = store.open();
+		const auto start = std::chrono::steady_clock::now();
+		scan.InitMDB(lpMDB);
+		scan.InitWorkers(ulWorkers);
+		scan.InitPipelineRows(ulPipelineRows);
+		scan.ProcessStore();
+		const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		lpMDB->Release();
+		return seconds;
+	}
+
+	TEST_CLASS(processortest)
+	{
+	public:
+		// Without this, clang gets weird
+		static const bool dummy_var = true;
+
+		TEST_CLASS_INITIALIZE(initialize) { unittest::init(); }
+
+		TEST_METHOD(Test_syntheticStore)
+		{
+			auto config = synthetic::storeConfig{};
+			config.ulDepth = 2;
+			config.ulSubfolders = 2;
+			config.ulMessages = 3;
+			config.ulAssociated = 1;
+			auto store = synthetic::store(config);
+			Assert::AreEqual(ULONG{7}, store.folderCount());
+			Assert::AreEqual(ULONG{28}, store.messageCount());
+
+			auto lpMDB = store.open();
+			auto lpRoot = mapi::CallOpenEntry<LPMAPIFOLDER>(
+				lpMDB, nullptr, nullptr, nullptr, 0, nullptr, nullptr, MAPI_BEST_ACCESS, nullptr);
+			Assert::IsNotNull(lpRoot);
+
+			LPMAPITABLE lpContents = nullptr;
+			Assert::AreEqual(S_OK, lpRoot->GetContentsTable(MAPI_UNICODE, &lpContents));
+			ULONG ulRows = 0;
+			Assert::AreEqual(S_OK, lpContents->GetRowCount(0, &ulRows));
+			Assert::AreEqual(ULONG{3}, ulRows);
+
+			static const SizedSPropTagArray(3, sptaCols) = {3, {PR_ENTRYID, PR_SUBJECT_A, PR_BODY_W}};
+			Assert::AreEqual(S_OK, lpContents->SetColumns(LPSPropTagArray(&sptaCols), TBL_BATCH));
+			LPSRowSet lpRows = nullptr;
+			Assert::AreEqual(S_OK, lpContents->QueryRows(1, NULL, &lpRows));
+			Assert::AreEqual(ULONG{1}, lpRows->cRows);
+			const auto& row = lpRows->aRow[0];
+			Assert::AreEqual(ULONG{PR_SUBJECT_A}, row.lpProps[1].ulPropTag);
+			Assert::AreEqual(std::string("Synthetic "), std::string(row.lpProps[1].Value.lpszA).substr(0, 10));
+			// Table rows aren't held to the size limit
+			Assert::AreEqual(ULONG{PR_BODY_W}, row.lpProps[2].ulPropTag);
+
+			auto lpMessage = mapi::CallOpenEntry<LPMESSAGE>(
+				nullptr,
+				nullptr,
+				lpRoot,
+				nullptr,
+				&mapi::getBin(row.lpProps[0]),
+				nullptr,
+				MAPI_BEST_ACCESS,
+				nullptr);
+			Assert::IsNotNull(lpMessage);
+
+			// Big props have to be streamed, as they would from a real store
+			SPropTagArray tags = {1, {PR_BODY_W}};
+			ULONG cValues = 0;
+			LPSPropValue lpProps = nullptr;
+			Assert::AreEqual(MAPI_W_ERRORS_RETURNED, lpMessage->GetProps(&tags, MAPI_UNICODE, &cValues, &lpProps));
+			Assert::AreEqual(ULONG{CHANGE_PROP_TYPE(PR_BODY_W, PT_ERROR)}, lpProps[0].ulPropTag);
+			Assert::AreEqual(MAPI_E_NOT_ENOUGH_MEMORY, lpProps[0].Value.err);
+			MAPIFreeBuffer(lpProps);
+
+			auto lpBody = mapi::GetLargeStringProp(lpMessage, PR_BODY_W);
+			Assert::IsNotNull(lpBody);
+			Assert::AreEqual(size_t{config.cchBody}, wcslen(lpBody->Value.lpszW));
+			MAPIFreeBuffer(lpBody);
+
+			FreeProws(lpRows);
+			lpMessage->Release();
+			lpContents->Release();
+			lpRoot->Release();
+			lpMDB->Release();
+		}
+
+		TEST_METHOD(Test_processorCounts)
+		{
+			auto config = synthetic::storeConfig{};
+			config.ulDepth = 2;
+			config.ulSubfolders = 2;
+			config.ulMessages = 4;
+			auto store = synthetic::store(config);
+			const auto ulFolders = store.folderCount();
+			const auto ulMessages = store.messageCount();
+			const auto dir = tempDir(L"processortest");
+
+			for (const auto ulWorkers : {ULONG{1}, ULONG{4}})
+			{
+				store.counts().reset();
+				runDumpStore(store, ulWorkers, 0, dir.root());
+				const auto& counts = store.counts();
+				Assert::AreEqual(ulFolders + ulMessages, counts.OpenEntry.load());
+				Assert::AreEqual(ulFolders * 2, counts.GetContentsTable.load());
+				Assert::AreEqual(ulFolders, counts.GetHierarchyTable.load());
+
+				// Workers' finds are merged back into ours
+				store.counts().reset();
+				auto scan = mapi::processor::findFidMid{};
+				scan.InitFidMid(L"", L"", true);
+				runFidMid(store, ulWorkers, 0, scan);
+				Assert::AreEqual(ulFolders, scan.FoldersFound());
+				Assert::AreEqual(ulMessages, scan.MessagesFound());
+				Assert::AreEqual(ulFolders, counts.OpenEntry.load());
+				Assert::AreEqual(ulFolders * 2, counts.GetContentsTable.load());
+
+				// Without -mid, no contents table is read
+				store.counts().reset();
+				auto folderScan = mapi::processor::findFidMid{};
+				folderScan.InitFidMid(L"", L"", false);
+				runFidMid(store, ulWorkers, 0, folderScan);
+				Assert::AreEqual(ulFolders, folderScan.FoldersFound());
+				Assert::AreEqual(ULONG{0}, folderScan.MessagesFound());
+				Assert::AreEqual(ULONG{0}, counts.GetContentsTable.load());
+			}
+		}
+
+		TEST_METHOD(Test_findFidMid)
+		{
+			auto config = synthetic::storeConfig{};
+			config.ulDepth = 2;
+			config.ulSubfolders = 2;
+			config.ulMessages = 3;
+			config.ulAssociated = 1;
+			auto store = synthetic::store(config);
+			const auto ulFolders = store.folderCount();
+
+			// The root's fid and its first message's mid
+			auto lpMDB = store.open();
+			auto lpRoot = mapi::CallOpenEntry<LPMAPIFOLDER>(
+				lpMDB, nullptr, nullptr, nullptr, 0, nullptr, nullptr, MAPI_BEST_ACCESS, nullptr);
+			Assert::IsNotNull(lpRoot);
+			static const SizedSPropTagArray(1, sptaFid) = {1, {PidTagFolderId}};
+			ULONG cValues = 0;
+			LPSPropValue lpFid = nullptr;
+			Assert::AreEqual(S_OK, lpRoot->GetProps(LPSPropTagArray(&sptaFid), NULL, &cValues, &lpFid));
+			const auto szFid = smartview::FidMidToSzString(lpFid[0].Value.li.QuadPart, false);
+			MAPIFreeBuffer(lpFid);
+
+			static const SizedSPropTagArray(1, sptaMid) = {1, {PidTagMid}};
+			LPMAPITABLE lpContents = nullptr;
+			Assert::AreEqual(S_OK, lpRoot->GetContentsTable(MAPI_UNICODE, &lpContents));
+			Assert::AreEqual(S_OK, lpContents->SetColumns(LPSPropTagArray(&sptaMid), TBL_BATCH));
+			LPSRowSet lpRows = nullptr;
+			Assert::AreEqual(S_OK, lpContents->QueryRows(1, NULL, &lpRows));
+			const auto szMid = smartview::FidMidToSzString(lpRows->aRow[0].lpProps[0].Value.li.QuadPart, false);
+			FreeProws(lpRows);
+			lpContents->Release();
+			lpRoot->Release();
+			lpMDB->Release();
+
+			// An exact fid match stops the walk there, and lists every message in the folder
+			const auto szFidTail = szFid.substr(szFid.find(L'-') + 1);
+			for (const auto& szMatch : {szFid, szFidTail})
+			{
+				store.counts().reset();
+				auto scan = mapi::processor::findFidMid{};
+				scan.InitFidMid(szMatch, L"", true);
+				runFidMid(store, 1, 0, scan);
+				Assert::AreEqual(ULONG{1}, scan.FoldersFound());
+				Assert::AreEqual(config.ulMessages + config.ulAssociated, scan.MessagesFound());
+				Assert::AreEqual(ULONG{2}, store.counts().GetContentsTable.load());
+			}
+
+			// A mid is looked for everywhere. Only the folder holding it is listed.
+			for (const auto ulWorkers : {ULONG{1}, ULONG{4}})
+			{
+				store.counts().reset();
+				auto scan = mapi::processor::findFidMid{};
+				scan.InitFidMid(L"", szMid, true);
+				runFidMid(store, ulWorkers, 0, scan);
+				Assert::AreEqual(ULONG{1}, scan.FoldersFound());
+				Assert::AreEqual(ULONG{1}, scan.MessagesFound());
+				Assert::AreEqual(ulFolders * 2, store.counts().GetContentsTable.load());
+			}
+		}
+
+		TEST_METHOD(Test_sameFolderNames)
+		{
+			auto config = synthetic::storeConfig{};
+			config.ulDepth = 2;
+			config.ulSubfolders = 3;
+			config.ulMessages = 2;
+			config.bSameFolderNames = true;
+			auto store = synthetic::store(config);
+			const auto dir = tempDir(L"processortest");
+
+			// Every folder gets a directory of its own, however the workers are scheduled
+			runDumpStore(store, 4, 0, dir.root());
+			ULONG ulFolderProps = 0;
+			for (const auto& file : std::filesystem::recursive_directory_iterator(dir.root()))
+			{
+				if (file.path().filename() == L"FOLDER_PROPS.xml") ulFolderProps++;
+			}
+
+			Assert::AreEqual(store.folderCount(), ulFolderProps);
+			Assert::AreEqual(true, std::filesystem::exists(std::filesystem::path(dir.root()) / L"FOLDER (2)"));
+			Assert::AreEqual(true, std::filesystem::exists(std::filesystem::path(dir.root()) / L"Folder (3)"));
+		}
+
+		TEST_METHOD(Test_rowPipeline)
+		{
+			auto config = synthetic::storeConfig{};
+			config.ulDepth = 0;
+			config.ulMessages = 200;
+			config.ulAssociated = 0;
+			auto store = synthetic::store(config);
+			auto lpMDB = store.open();
+			auto lpRoot = mapi::CallOpenEntry<LPMAPIFOLDER>(
+				lpMDB, nullptr, nullptr, nullptr, 0, nullptr, nullptr, MAPI_BEST_ACCESS, nullptr);
+			Assert::IsNotNull(lpRoot);
+			const auto expected = contentsEntryIDs(lpRoot);
+			Assert::AreEqual(size_t{config.ulMessages}, expected.size());
+
+			static const SizedSPropTagArray(1, sptaEID) = {1, {PR_ENTRYID}};
+			ULONG cValues = 0;
+			LPSPropValue lpFolderEID = nullptr;
+			Assert::AreEqual(S_OK, lpRoot->GetProps(LPSPropTagArray(&sptaEID), NULL, &cValues, &lpFolderEID));
+
+			static const SizedSPropTagArray(2, sptaCols) = {2, {PR_ENTRYID, PR_SUBJECT_W}};
+			auto table = mapi::processor::pipelineTable{};
+			table.lpMDB = lpMDB;
+			table.folderEID = mapi::getBin(lpFolderEID[0]);
+			table.ulFlags = MAPI_UNICODE;
+			table.lpColumns = LPSPropTagArray(&sptaCols);
+			table.bOpenMessages = true;
+			const auto ulLive = store.liveObjects();
+			{
+				auto pipeline = mapi::processor::rowPipeline{};
+
+				// Rows in order, each with its message. Batches double while they're quick.
+				store.counts().reset();
+				Assert::AreEqual(true, std::vector<ULONG>{32, 64, 104} == readPipeline(pipeline, table, expected));
+				// Our own folder and table, then each message once
+				Assert::AreEqual(ULONG{1} + config.ulMessages, store.counts().OpenEntry.load());
+				Assert::AreEqual(ULONG{1}, store.counts().GetContentsTable.load());
+				Assert::AreEqual(ulLive, store.liveObjects());
+
+				// Only as many rows as we asked for, and no more messages than that
+				table.ulMaxRows = 5;
+				store.counts().reset();
+				Assert::AreEqual(true, std::vector<ULONG>{5} == readPipeline(pipeline, table, expected));
+				Assert::AreEqual(ULONG{1} + table.ulMaxRows, store.counts().OpenEntry.load());
+				Assert::AreEqual(ULONG{1}, store.counts().QueryRows.load());
+
+				// Rows only
+				table.ulMaxRows = 0;
+				table.bOpenMessages = false;
+				store.counts().reset();
+				Assert::AreEqual(true, std::vector<ULONG>{32, 64, 104} == readPipeline(pipeline, table, expected));
+				Assert::AreEqual(ULONG{1}, store.counts().OpenEntry.load());
+
+				// Stopping after one row releases everything read and opened ahead of us
+				table.bOpenMessages = true;
+				Assert::AreEqual(true, pipeline.start(table));
+				{
+					const auto row = pipeline.next();
+					Assert::IsNotNull(row.lpRow);
+					Assert::IsNotNull(row.lpMessage);
+				}
+
+				pipeline.stop();
+				Assert::AreEqual(ulLive, store.liveObjects());
+
+				// So does destroying the pipeline part way through a table
+				Assert::AreEqual(true, pipeline.start(table));
+			}
+
+			Assert::AreEqual(ulLive, store.liveObjects());
+			MAPIFreeBuffer(lpFolderEID);
+			lpRoot->Release();
+			lpMDB->Release();
+			Assert::AreEqual(ULONG{0}, store.liveObjects());
+		}
+
+		TEST_METHOD(Test_rowPipelineSlowTable)
+		{
+			auto config = synthetic::storeConfig{};
+			config.ulDepth = 0;
+			config.ulMessages = 60;
+			config.ulAssociated = 0;
+			config.ulLatencyMs = 150;
+			auto store = synthetic::store(config);
+			auto lpMDB = store.open();
+			auto lpRoot = mapi::CallOpenEntry<LPMAPIFOLDER>(
+				lpMDB, nullptr, nullptr, nullptr, 0, nullptr, nullptr, MAPI_BEST_ACCESS, nullptr);
+			Assert::IsNotNull(lpRoot);
+			const auto expected = contentsEntryIDs(lpRoot);
+
+			// No entry ID opens the root
+			static const SizedSPropTagArray(1, sptaCols) = {1, {PR_ENTRYID}};
+			auto table = mapi::processor::pipelineTable{};
+			table.lpMDB = lpMDB;
+			table.ulFlags = MAPI_UNICODE;
+			table.lpColumns = LPSPropTagArray(&sptaCols);
+			{
+				// Batches taking over twice the 50ms target halve, down to 8 rows
+				auto pipeline = mapi::processor::rowPipeline{};
+				Assert::AreEqual(true, std::vector<ULONG>{32, 16, 8, 4} == readPipeline(pipeline, table, expected));
+			}
+
+			lpRoot->Release();
+			lpMDB->Release();
+			Assert::AreEqual(ULONG{0}, store.liveObjects());
+		}
+
+		TEST_METHOD(Test_pipelinedContents)
+		{
+			auto config = synthetic::storeConfig{};
+			config.ulDepth = 1;
+			config.ulSubfolders = 2;
+			config.ulMessages = 40;
+			config.ulAssociated = 2;
+			auto store = synthetic::store(config);
+			const auto ulFolders = store.folderCount();
+			// The limit cuts each regular table short. Associated tables are too small to go through the pipeline.
+			constexpr ULONG ulMaxOutput = 25;
+			constexpr ULONG ulPipelineRows = 10;
+			const auto ulRows = ulFolders * (ulMaxOutput + config.ulAssociated);
+
+			for (const auto ulTurnDownEvery : {ULONG{0}, ULONG{3}})
+			{
+				store.counts().reset();
+				const auto inlineWalk = recordWalk(store, 0, ulMaxOutput, ulTurnDownEvery);
+				const auto ulInlineOpens = store.counts().OpenEntry.load();
+				Assert::AreEqual(ULONG{0}, store.liveObjects());
+
+				store.counts().reset();
+				const auto pipelinedWalk = recordWalk(store, ulPipelineRows, ulMaxOutput, ulTurnDownEvery);
+				// Messages opened ahead and turned down were all released
+				Assert::AreEqual(ULONG{0}, store.liveObjects());
+
+				// The same rows, numbered the same, and the same messages, all in the same order
+				Assert::AreEqual(size_t{ulRows}, inlineWalk.rows.size());
+				Assert::AreEqual(true, inlineWalk.rows == pipelinedWalk.rows);
+				Assert::AreEqual(true, inlineWalk.messages == pipelinedWalk.messages);
+
+				// Each contents table is opened once, by us or by the pipeline, never both.
+				// Each table read through the pipeline opens its own folder too.
+				Assert::AreEqual(ulFolders * 2, store.counts().GetContentsTable.load());
+				if (!ulTurnDownEvery)
+				{
+					Assert::AreEqual(ulFolders + ulRows, ulInlineOpens);
+					const auto ulPipelined = store.counts().OpenEntry.load() - ulInlineOpens;
+					Assert::AreEqual(ulFolders, ulPipelined);
+				}
+			}
+
+			// The fid/mid scan doesn't open messages, ahead or otherwise
+			for (const auto ulPipelineRows : {ULONG{0}, ULONG{1}})
+			{
+				store.counts().reset();
+				auto scan = mapi::processor::findFidMid{};
+				scan.InitFidMid(L"", L"", true);
+				runFidMid(store, 1, ulPipelineRows, scan);
+				Assert::AreEqual(store.messageCount(), scan.MessagesFound());
+				Assert::AreEqual(ulFolders * 2, store.counts().GetContentsTable.load());
+				// Only the pipeline's own folders, one for each table it read
+				const auto ulPipelined = store.counts().OpenEntry.load() - ulFolders;
+				Assert::AreEqual(ulFolders * 2 * ulPipelineRows, ulPipelined);
+			}
+		}
+
+		TEST_METHOD(Benchmark_syntheticStore)
+		{
+			auto config = synthetic::storeConfig{};
+			config.ulDepth = 3;
+			config.ulSubfolders = 3;
+			config.ulMessages = 25;
+			// A smaller store with a round trip on every table read and open, as over a network
+			auto slowConfig = config;
+			slowConfig.ulDepth = 2;
+			slowConfig.ulLatencyMs = 1;
+			const auto dir = tempDir(L"processorbenchmark");
+
+			for (const auto& shape : {config, slowConfig})
+			{
+				auto store = synthetic::store(shape);
+				const auto ulMessages = store.messageCount();
+				for (const auto ulWorkers : {ULONG{1}, ULONG{4}})
+				{
+					// Every table read inline, then every table read through the pipeline
+					for (const auto ulPipelineRows : {ULONG{0}, ULONG{1}})
+					{
+						const auto szMode = ulPipelineRows ? L"pipelined" : L"inline";
+						store.counts().reset();
+						const auto dumpSeconds = runDumpStore(store, ulWorkers, ulPipelineRows, dir.root());
+						const auto szDump = strings::format(
+							L"dumpStore, %ums latency, %u workers, %ws: %u folders, %u messages in %.3fs, "
+							L"%.0f messages/s\n %ws\n",
+							shape.ulLatencyMs,
+							ulWorkers,
+							szMode,
+							store.folderCount(),
+							ulMessages,
+							dumpSeconds,
+							ulMessages / dumpSeconds,
+							store.counts().toString().c_str());
+						Logger::WriteMessage(szDump.c_str());
+
+						store.counts().reset();
+						auto scan = mapi::processor::findFidMid{};
+						scan.InitFidMid(L"", L"", true);
+						const auto scanSeconds = runFidMid(store, ulWorkers, ulPipelineRows, scan);
+						const auto szScan = strings::format(
+							L"fid/mid scan, %ums latency, %u workers, %ws: %u folders, %u messages in %.3fs, "
+							L"%.0f messages/s\n %ws\n",
+							shape.ulLatencyMs,
+							ulWorkers,
+							szMode,
+							scan.FoldersFound(),
+							scan.MessagesFound(),
+							scanSeconds,
+							scan.MessagesFound() / scanSeconds,
+							store.counts().toString().c_str());
+						Logger::WriteMessage(szScan.c_str());
+					}
+				}
+			}
+		}
+	};
+} // namespace processortest
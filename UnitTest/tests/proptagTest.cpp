@@ -1,6 +1,8 @@
 #include <UnitTest/stdafx.h>
 #include <UnitTest/UnitTest.h>
 #include <core/interpret/proptags.h>
+#include <core/addin/mfcmapi.h>
+#include <chrono>
 
 namespace proptagTest
 {
@@ -40,5 +42,54 @@ namespace proptagTest
 				proptags::PropTagToPropName(0x68020102, false).otherMatches);
 			unittest::AreEqualEx(L"PR_RW_RULES_STREAM", proptags::PropTagToPropName(0x6802000A, false).bestGuess);
 		}
+
+		TEST_METHOD(Test_LookupPropName)
+		{
+			Assert::AreEqual(ULONG{PR_SUBJECT_W}, proptags::LookupPropName(L"PR_SUBJECT_W"));
+			Assert::AreEqual(ULONG{PR_SUBJECT_W}, proptags::LookupPropName(L"pr_subject_w"));
+			Assert::AreEqual(ULONG{PR_SUBJECT_W}, proptags::LookupPropName(L"  PidTagSubject  "));
+			Assert::AreEqual(ULONG{0}, proptags::LookupPropName(L"PR_NOT_A_REAL_PROP"));
+			Assert::AreEqual(ULONG{0}, proptags::LookupPropName(L""));
+			Assert::AreEqual(ULONG{PR_SUBJECT_W}, proptags::PropNameToPropTag(L"PR_SUBJECT_W"));
+			Assert::AreEqual(ULONG{0x0037001F}, proptags::PropNameToPropTag(L"0037001F"));
+		}
+
+		// Every name in the table resolves to the first entry with that name, as a linear scan would find
+		TEST_METHOD(Benchmark_LookupPropName)
+		{
+			const auto linear = [](const std::wstring& name) -> ULONG {
+				for (const auto& tag : PropTagArray)
+				{
+					if (0 == lstrcmpiW(name.c_str(), tag.lpszName)) return tag.ulValue;
+				}
+
+				return 0;
+			};
+
+			const auto time = [](const auto& lookup) {
+				const auto start = std::chrono::steady_clock::now();
+				for (const auto& tag : PropTagArray)
+				{
+					Assert::AreNotEqual(ULONG{0}, lookup(tag.lpszName));
+				}
+
+				return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+					.count();
+			};
+
+			for (const auto& tag : PropTagArray)
+			{
+				Assert::AreEqual(linear(tag.lpszName), proptags::LookupPropName(tag.lpszName));
+			}
+
+			const auto linearTime = time(linear);
+			const auto indexTime = time([](const std::wstring& name) { return proptags::LookupPropName(name); });
+			Logger::WriteMessage(strings::format(
+									 L"LookupPropName over %u names: linear %lld us, indexed %lld us\n",
+									 static_cast<UINT>(PropTagArray.size()),
+									 linearTime,
+									 indexTime)
+									 .c_str());
+		}
 	};
 } // namespace proptagTest
\ No newline at end of file
@@ -1,9 +1,12 @@
 #include <UnitTest/stdafx.h>
 #include <UnitTest/UnitTest.h>
 #include <core/smartview/SmartView.h>
+#include <core/smartview/renderCache.h>
+#include <core/smartview/detectParser.h>
 #include <core/addin/mfcmapi.h>
 #include <core/addin/addin.h>
 #include <core/utility/strings.h>
+#include <core/utility/registry.h>
 
 namespace SmartViewTest
 {
@@ -24,6 +27,13 @@ namespace SmartViewTest
 							  ->toString();
 			unittest::AreEqualEx(expected, actual, testName.c_str());
 
+			auto streamed = std::wstring{};
+			smartview::InterpretBinaryAsString(
+				{static_cast<ULONG>(hex.size()), hex.data()}, structType, nullptr, [&](const std::wstring& chunk) {
+					streamed += chunk;
+				});
+			unittest::AreEqualEx(expected, streamed, (testName + L"-streamed").c_str());
+
 			if (unittest::parse_all)
 			{
 				for (const auto parser : SmartViewParserTypeArray)
@@ -70,6 +80,131 @@ namespace SmartViewTest
 							 L"\tcb: 4 lpb: 01020304"));
 		}
 
+		TEST_METHOD(Test_renderCache)
+		{
+			static auto handle = GetModuleHandleW(L"UnitTest.dll");
+			auto hex = strings::HexStringToBin(unittest::loadfile(handle, IDR_SV3CI1IN));
+			const auto expected = unittest::loadfile(handle, IDR_SV3CI1OUT);
+			const auto bin = SBinary{static_cast<ULONG>(hex.size()), hex.data()};
+
+			const DWORD cacheSize = registry::smartViewCacheSize;
+			registry::smartViewCacheSize = 2;
+			smartview::renderCache::clear();
+			smartview::renderCache::resetStats();
+
+			// First render misses, the rest hit and match
+			for (auto i = 0; i < 3; i++)
+			{
+				unittest::AreEqualEx(
+					expected, smartview::InterpretBinaryAsString(bin, parserType::CONVERSATIONINDEX, nullptr));
+			}
+
+			auto stats = smartview::renderCache::getStats();
+			Assert::AreEqual(size_t{1}, stats.misses);
+			Assert::AreEqual(size_t{2}, stats.hits);
+			Assert::AreEqual(size_t{1}, stats.entries);
+
+			// Same bytes through a different parser, and different bytes through the same parser, are new entries
+			const auto asEntryId = smartview::InterpretBinaryAsString(bin, parserType::ENTRYID, nullptr);
+			hex.back() ^= 0xFF;
+			const auto changed = smartview::InterpretBinaryAsString(bin, parserType::CONVERSATIONINDEX, nullptr);
+			Assert::AreEqual(false, changed == expected);
+			stats = smartview::renderCache::getStats();
+			Assert::AreEqual(size_t{3}, stats.misses);
+			Assert::AreEqual(size_t{2}, stats.entries);
+			Assert::AreEqual(size_t{1}, stats.evictions);
+
+			// The entry ID render is still cached and the original bytes were evicted
+			Assert::AreEqual(asEntryId, smartview::InterpretBinaryAsString(bin, parserType::ENTRYID, nullptr));
+			hex.back() ^= 0xFF;
+			unittest::AreEqualEx(
+				expected, smartview::InterpretBinaryAsString(bin, parserType::CONVERSATIONINDEX, nullptr));
+			stats = smartview::renderCache::getStats();
+			Assert::AreEqual(size_t{4}, stats.misses);
+			Assert::AreEqual(size_t{3}, stats.hits);
+
+			// Zero disables the cache
+			registry::smartViewCacheSize = 0;
+			smartview::renderCache::clear();
+			smartview::renderCache::resetStats();
+			unittest::AreEqualEx(
+				expected, smartview::InterpretBinaryAsString(bin, parserType::CONVERSATIONINDEX, nullptr));
+			stats = smartview::renderCache::getStats();
+			Assert::AreEqual(size_t{0}, stats.misses + stats.hits + stats.entries);
+
+			registry::smartViewCacheSize = cacheSize;
+		}
+
+		TEST_METHOD(Test_detectParsers)
+		{
+			static auto handle = GetModuleHandleW(L"UnitTest.dll");
+			const auto detect = [](DWORD hexNum) {
+				auto hex = strings::HexStringToBin(unittest::loadfile(handle, hexNum));
+				auto candidates = smartview::DetectParsers({static_cast<ULONG>(hex.size()), hex.data()});
+				// Results point into hex, so flatten them before it goes away
+				auto types = std::vector<parserType>{};
+				for (const auto& candidate : candidates)
+				{
+					types.push_back(candidate.type);
+				}
+
+				return types;
+			};
+
+			// Blobs with magic bytes rank their own parser first
+			for (const auto& test : std::vector<std::pair<DWORD, parserType>>{
+					 {IDR_SV29TOMBSTONE1IN, parserType::TOMBSTONE},
+					 {IDR_SV25NICKNAME2IN, parserType::NICKNAMECACHE},
+					 {IDR_SV10GOID1IN, parserType::GLOBALOBJECTID},
+					 {IDR_SV15REPORTTAG1IN, parserType::REPORTTAG},
+					 {IDR_SV18SF1IN, parserType::SEARCHFOLDERDEFINITION},
+					 {IDR_SV19SD1IN, parserType::SECURITYDESCRIPTOR},
+					 {IDR_SV2ARP1IN, parserType::APPOINTMENTRECURRENCEPATTERN},
+					 {IDR_SV4EID1IN, parserType::ENTRYID},
+				 })
+			{
+				const auto types = detect(test.first);
+				const auto name = addin::AddInStructTypeToString(test.second);
+				Assert::AreEqual(false, types.empty(), name.c_str());
+				Assert::AreEqual(true, types.front() == test.second, name.c_str());
+			}
+
+			// Blobs known only by their shape have their parser among the candidates
+			for (const auto& test : std::vector<std::pair<DWORD, parserType>>{
+					 {IDR_SV1AEI1IN, parserType::ADDITIONALRENENTRYIDSEX},
+					 {IDR_SV3CI1IN, parserType::CONVERSATIONINDEX},
+					 {IDR_SV6EFF1IN, parserType::EXTENDEDFOLDERFLAGS},
+					 {IDR_SV8FE1IN, parserType::FLATENTRYLIST},
+					 {IDR_SV12PROPDEF1IN, parserType::PROPERTYDEFINITIONSTREAM},
+					 {IDR_SV14ARP1IN, parserType::RECURRENCEPATTERN},
+					 {IDR_SV20SID2IN, parserType::SID},
+					 {IDR_SV22TZ1IN, parserType::TIMEZONE},
+					 {IDR_SV23TZD1IN, parserType::TIMEZONEDEFINITION},
+					 {IDR_SV28VERBSTREAM1IN, parserType::VERBSTREAM},
+					 {IDR_SV30PCL1IN, parserType::PCL},
+					 {IDR_SV32XID1IN, parserType::XID},
+					 {IDR_SV38SWAPTODO1IN, parserType::SWAPPEDTODO},
+				 })
+			{
+				const auto types = detect(test.first);
+				Assert::AreEqual(
+					true,
+					std::find(types.begin(), types.end(), test.second) != types.end(),
+					addin::AddInStructTypeToString(test.second).c_str());
+			}
+
+			// The prefilters rule out parsers on sight
+			auto sid = strings::HexStringToBin(unittest::loadfile(handle, IDR_SV20SID2IN));
+			const auto sidBin = SBinary{static_cast<ULONG>(sid.size()), sid.data()};
+			Assert::AreEqual(
+				true, smartview::PrefilterParser(sidBin, parserType::SID) == smartview::parserMatch::shape);
+			Assert::AreEqual(
+				true, smartview::PrefilterParser(sidBin, parserType::TOMBSTONE) == smartview::parserMatch::none);
+			Assert::AreEqual(
+				true, smartview::PrefilterParser(sidBin, parserType::ENCODEENTRYID) == smartview::parserMatch::none);
+			Assert::AreEqual(true, smartview::DetectParsers({}).empty());
+		}
+
 		TEST(ADDITIONALRENENTRYIDSEX, 1AEI, 1)
 		TEST(ADDITIONALRENENTRYIDSEX, 1AEI, 2)
 		TEST(ADDITIONALRENENTRYIDSEX, 1AEI, 3)
@@ -2,11 +2,48 @@
 #include <UnitTest/UnitTest.h>
 #include <core/utility/strings.h>
 #include <core/utility/memory.h>
+#include <chrono>
+#include <crtdbg.h>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 namespace stringtest
 {
+	// The FormatMessageW path our native formatter replaced, for parity and benchmarks
+	std::wstring systemFormatMessage(LPCWSTR szMsg, ...)
+	{
+		va_list argList;
+		va_start(argList, szMsg);
+		LPWSTR buffer = nullptr;
+		const auto dw = FormatMessageW(
+			FORMAT_MESSAGE_FROM_STRING | FORMAT_MESSAGE_ALLOCATE_BUFFER,
+			szMsg,
+			0,
+			0,
+			reinterpret_cast<LPWSTR>(&buffer),
+			0,
+			&argList);
+		va_end(argList);
+		const auto ret = dw ? std::wstring(buffer) : std::wstring{};
+		if (buffer) static_cast<void>(LocalFree(buffer));
+		return ret;
+	}
+
+	template <typename... Args> void checkParity(LPCWSTR szMsg, Args... args)
+	{
+		Assert::AreEqual(systemFormatMessage(szMsg, args...), strings::formatmessage(szMsg, args...), szMsg);
+	}
+
+	// Heap allocations seen by the debug CRT, for benchmarks. Release builds don't count.
+	size_t allocations{};
+#ifdef _DEBUG
+	int __cdecl countAllocations(int allocType, void*, size_t, int, long, const unsigned char*, int) noexcept
+	{
+		if (allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC) allocations++;
+		return TRUE;
+	}
+#endif
+
 	TEST_CLASS(stringtest)
 	{
 	public:
@@ -31,6 +68,11 @@ namespace stringtest
 			// A resource which does exist
 			Assert::AreEqual(std::wstring(L"Flags: "), strings::loadstring(IDS_FLAGS_PREFIX));
 			Assert::AreEqual(std::wstring(L"hh':'mm':'ss'.%1!03d!' tt"), strings::loadstring(IDS_FILETIMEFORMAT));
+
+			// Strings are cached, so repeat loads hand back the same string, missing or not
+			Assert::AreEqual(true, &strings::loadstring(IDS_FLAGS_PREFIX) == &strings::loadstring(IDS_FLAGS_PREFIX));
+			Assert::AreEqual(true, &strings::loadstring(1234) == &strings::loadstring(1234));
+			Assert::AreEqual(false, &strings::loadstring(IDS_FLAGS_PREFIX) == &strings::loadstring(IDS_FILETIMEFORMAT));
 		}
 
 		TEST_METHOD(Test_format)
@@ -47,6 +89,74 @@ namespace stringtest
 			Assert::AreEqual(std::wstring(L"Hello world"), strings::formatmessage(L"%1!hs! %2", "Hello", L"world"));
 			Assert::AreEqual(std::wstring(L""), strings::formatmessage(L"", 1, 2));
 			Assert::AreEqual(std::wstring(L"test"), strings::formatmessage(IDS_TITLEBARPLAIN, L"test"));
+
+			// Escapes, reordered inserts and printf specs
+			Assert::AreEqual(std::wstring(L"b a"), strings::formatmessage(L"%2 %1", L"a", L"b"));
+			Assert::AreEqual(std::wstring(L"a\r\nb\t% !."), strings::formatmessage(L"a%nb%t%%%b%!%."));
+			Assert::AreEqual(std::wstring(L"stop"), strings::formatmessage(L"stop%0more"));
+			Assert::AreEqual(
+				std::wstring(L"0000ABCD-1-1234567890AB"),
+				strings::formatmessage(L"%1!08X!-%2!X!-%3!I64X!", 0xABCD, 1, 0x1234567890ABULL));
+			Assert::AreEqual(
+				std::wstring(L"[  ab][ab  ][0x1f][  -7][-0007][+7][007]"),
+				strings::formatmessage(
+					L"[%1!4ws!][%1!-4ws!][%2!#x!][%3!4d!][%3!05d!][%4!+d!][%4!.3d!]", L"ab", 31, -7, 7));
+			Assert::AreEqual(std::wstring(L"[  abc]"), strings::formatmessage(L"[%1!*s!]", 5, L"abc"));
+			Assert::AreEqual(std::wstring(L"4294967295"), strings::formatmessage(L"%1!u!", -1));
+			Assert::AreEqual(
+				std::wstring(L"j"), strings::formatmessage(L"%10", 1, 2, 3, 4, 5, 6, 7, 8, 9, L"j"));
+
+			auto out = std::wstring(L"prefix ");
+			strings::appendmessage(out, IDS_TITLEBARPLAIN, L"test");
+			Assert::AreEqual(std::wstring(L"prefix test"), out);
+		}
+
+		// The native formatter should match FormatMessageW for every spec our resources use
+		TEST_METHOD(Test_formatmessageParity)
+		{
+			checkParity(L"%1!ws! = %2!08X!%n", L"PR_SUBJECT", 0x0037001F);
+			checkParity(L"%1!hs! %2", "Hello", L"world");
+			checkParity(L"%1!d! %2!04X! %3!02X! %4!X! %5!01X!", -12, 0x12, 0x3, 0xABCDEF, 0);
+			checkParity(L"%1!5d!|%2!03d!", 42, 7);
+			checkParity(L"%1!I64d! bytes = %2!I64d! kilobytes", 123456789012LL, 120563270LL);
+			checkParity(L"%1!X!-%2!I64X!", 0x1234, 0x0123456789ABCDEFULL);
+			checkParity(L"%2 before %1", L"one", L"two");
+			checkParity(L"Tab%tspace%bbang%!dot%.pct%%cr%rlf%n");
+		}
+
+		// Log the cost of our resource formatting through FormatMessageW and through the native formatter
+		TEST_METHOD(Benchmark_formatmessage)
+		{
+			constexpr auto iterations = 100000;
+			const auto szMsg = strings::loadstring(IDS_TITLEBARPLAIN);
+			const auto time = [&](LPCWSTR szName, const std::function<std::wstring(int)>& fn) {
+				auto cch = size_t{};
+				const auto start = std::chrono::steady_clock::now();
+				for (auto i = 0; i < iterations; i++)
+				{
+					cch += fn(i).length();
+				}
+
+				const auto elapsed = std::chrono::steady_clock::now() - start;
+				Logger::WriteMessage(strings::format(
+										 L"%ws: %d calls, %zu chars, %lld us\n",
+										 szName,
+										 iterations,
+										 cch,
+										 std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count())
+										 .c_str());
+				return cch;
+			};
+
+			const auto systemChars = time(L"FormatMessageW", [&](int i) {
+				return systemFormatMessage(L"%1!ws! = 0x%2!08X! (%3!d!)", L"PR_SUBJECT", 0x0037001F, i) +
+					   systemFormatMessage(szMsg.c_str(), L"test");
+			});
+			const auto nativeChars = time(L"native", [&](int i) {
+				return strings::formatmessage(L"%1!ws! = 0x%2!08X! (%3!d!)", L"PR_SUBJECT", 0x0037001F, i) +
+					   strings::formatmessage(IDS_TITLEBARPLAIN, L"test");
+			});
+			Assert::AreEqual(systemChars, nativeChars);
 		}
 
 		TEST_METHOD(Test_stringConverters)
@@ -79,6 +189,21 @@ namespace stringtest
 			Assert::AreEqual(
 				std::wstring(L"abc\xDC\xA7\x40\xC8\xC0\x42"), strings::stringTowstring("abc\xDC\xA7\x40\xC8\xC0\x42"));
 
+			Assert::AreEqual(std::wstring(L"test"), strings::utf8Towstring("test"));
+			Assert::AreEqual(std::wstring(L""), strings::utf8Towstring(""));
+			Assert::AreEqual(
+				std::wstring(L"\x00e9\x20ac\xD83D\xDE00"),
+				strings::utf8Towstring("\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80"));
+
+			// A sequence cut short at the end isn't complete yet
+			Assert::AreEqual(size_t{4}, strings::utf8CompleteLength("test"));
+			Assert::AreEqual(size_t{0}, strings::utf8CompleteLength(""));
+			Assert::AreEqual(size_t{4}, strings::utf8CompleteLength("a\xE2\x82\xAC"));
+			Assert::AreEqual(size_t{1}, strings::utf8CompleteLength("a\xE2\x82"));
+			Assert::AreEqual(size_t{1}, strings::utf8CompleteLength("a\xE2"));
+			Assert::AreEqual(size_t{1}, strings::utf8CompleteLength("a\xF0\x9F\x98"));
+			Assert::AreEqual(size_t{5}, strings::utf8CompleteLength("a\xF0\x9F\x98\x80"));
+
 			Assert::AreEqual(std::string("test"), strings::wstringTostring(std::wstring(L"test")));
 			Assert::AreEqual(std::string("test"), strings::wstringTostring(L"test"));
 			Assert::AreEqual(std::string("test\r\nstring"), strings::wstringTostring(std::wstring(L"test\r\nstring")));
@@ -426,6 +551,131 @@ namespace stringtest
 			Assert::AreEqual(std::wstring(L"1 2"), strings::join({L"", L"", L"1", L"", L"2", L""}, L' ', true));
 		}
 
+		TEST_METHOD(Test_stringViews)
+		{
+			auto fields = std::vector<std::wstring_view>{};
+			strings::split(fullstring, L' ', fields);
+			Assert::AreEqual(words, std::vector<std::wstring>(fields.begin(), fields.end()));
+
+			// The output is reused, not appended to
+			strings::split(L"1..", L'.', fields);
+			Assert::AreEqual(
+				std::vector<std::wstring>{L"1", L"", L""}, std::vector<std::wstring>(fields.begin(), fields.end()));
+			strings::split(L"", L'.', fields);
+			Assert::AreEqual(size_t{0}, fields.size());
+
+			auto out = std::wstring{L"stale"};
+			strings::join(out, words, L" ");
+			Assert::AreEqual(fullstring, out);
+			strings::join(out, words, L", ", true);
+			Assert::AreEqual(std::wstring(L"this, is, a, string, yes"), out);
+			strings::join(out, {}, L" ");
+			Assert::AreEqual(std::wstring{}, out);
+
+			Assert::AreEqual(std::wstring(L"12345"), std::wstring(strings::trimView(L"   12345  ")));
+			Assert::AreEqual(true, strings::trimView(L"  ").empty());
+			Assert::AreEqual(std::wstring(L"1 2"), std::wstring(strings::trimWhitespaceView(L"\t 1 2\r\n")));
+
+			auto scrub = std::wstring(L"8\x08" L"9\x09");
+			Assert::AreEqual(true, strings::NeedsScrubForXML(scrub));
+			strings::ScrubStringForXMLInPlace(scrub);
+			Assert::AreEqual(std::wstring(L"8.9\t"), scrub);
+			Assert::AreEqual(false, strings::NeedsScrubForXML(scrub));
+
+			auto strip = std::wstring(L" 1 2 3 4 5");
+			strings::StripCharacterInPlace(strip, L' ');
+			Assert::AreEqual(std::wstring(L"12345"), strip);
+
+			auto invalid = std::wstring(L"a\x01\x85\tb\0", 6);
+			strings::RemoveInvalidCharactersInPlace(invalid, false);
+			Assert::AreEqual(std::wstring(L"a...b\0", 6), invalid);
+		}
+
+		// Split, trim, join and scrub each line of a dump, once through the copying helpers and once
+		// through the view and in place versions with reused buffers. Debug builds also count allocations.
+		TEST_METHOD(Benchmark_stringViews)
+		{
+			auto dump = std::wstring{};
+			for (auto i = 0; i < 10000; i++)
+			{
+				dump += strings::format(L"  0x%08X\tPR_PROP_%d \t value\x01%d\t\r\n", 0x0037001F + i * 0x10000, i, i);
+			}
+
+			const auto time = [&](LPCWSTR szName, const std::function<size_t()>& fn, size_t& cAllocations) {
+				allocations = 0;
+#ifdef _DEBUG
+				const auto previousHook = _CrtSetAllocHook(countAllocations);
+#endif
+				const auto start = std::chrono::steady_clock::now();
+				const auto cch = fn();
+				const auto elapsed = std::chrono::steady_clock::now() - start;
+#ifdef _DEBUG
+				_CrtSetAllocHook(previousHook);
+#endif
+				cAllocations = allocations;
+				Logger::WriteMessage(strings::format(
+										 L"%ws: %zu chars, %zu allocations, %lld us\n",
+										 szName,
+										 cch,
+										 cAllocations,
+										 std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count())
+										 .c_str());
+				return cch;
+			};
+
+			auto copyAllocations = size_t{};
+			const auto copyChars = time(
+				L"copying",
+				[&] {
+					auto cch = size_t{};
+					for (const auto& line : strings::split(dump, L'\n'))
+					{
+						auto fields = strings::split(line, L'\t');
+						for (auto& field : fields)
+						{
+							field = strings::trim(field);
+						}
+
+						cch += strings::ScrubStringForXML(strings::join(fields, L',')).length();
+					}
+
+					return cch;
+				},
+				copyAllocations);
+
+			auto viewAllocations = size_t{};
+			const auto viewChars = time(
+				L"views",
+				[&] {
+					auto cch = size_t{};
+					auto lines = std::vector<std::wstring_view>{};
+					auto fields = std::vector<std::wstring_view>{};
+					auto row = std::wstring{};
+					strings::split(dump, L'\n', lines);
+					for (const auto& line : lines)
+					{
+						strings::split(line, L'\t', fields);
+						row.clear();
+						for (size_t i = 0; i < fields.size(); i++)
+						{
+							if (i) row += L',';
+							row.append(strings::trimView(fields[i]));
+						}
+
+						strings::ScrubStringForXMLInPlace(row);
+						cch += row.length();
+					}
+
+					return cch;
+				},
+				viewAllocations);
+
+			Assert::AreEqual(copyChars, viewChars);
+#ifdef _DEBUG
+			Assert::AreEqual(true, viewAllocations * 10 < copyAllocations);
+#endif
+		}
+
 		TEST_METHOD(Test_currency)
 		{
 			Assert::AreEqual(std::wstring(L"0.0000"), strings::CurrencyToString(CURRENCY({0, 0})));
@@ -470,6 +720,121 @@ namespace stringtest
 			Assert::AreEqual({}, strings::Base64Decode(L"RU5E===="));
 			Assert::AreEqual({}, strings::Base64Decode(L"RU5E===x"));
 			Assert::AreEqual({}, strings::Base64Decode(L"...."));
+			Assert::AreEqual({}, strings::Base64Decode(L"RU=E"));
+		}
+
+		// Buffer based codecs against every length around the vectorized block size
+		TEST_METHOD(Test_codecBuffers)
+		{
+			auto bin = std::vector<BYTE>(100);
+			for (size_t i = 0; i < bin.size(); i++)
+			{
+				bin[i] = static_cast<BYTE>(i * 37 + 11);
+			}
+
+			for (size_t cb = 0; cb <= bin.size(); cb++)
+			{
+				auto hex = std::wstring(cb * 2, L'\0');
+				strings::BinToHex(bin.data(), cb, &hex[0]);
+				auto expected = std::wstring{};
+				for (size_t i = 0; i < cb; i++)
+				{
+					expected += strings::format(L"%02X", bin[i]);
+				}
+
+				Assert::AreEqual(expected, hex);
+
+				auto back = std::vector<BYTE>(cb);
+				Assert::AreEqual(true, strings::HexToBin(hex.c_str(), hex.length(), back.data()));
+				Assert::AreEqual(std::vector<BYTE>(bin.begin(), bin.begin() + cb), back);
+				Assert::AreEqual(back, strings::HexStringToBin(strings::wstringToLower(hex)));
+
+				if (cb)
+				{
+					// A bad character anywhere, in the vectorized part or the tail, fails the whole conversion
+					for (const auto bad : {L'g', L'G', L':', L'@', L'`', L'\x130', L'\x8030'})
+					{
+						auto badHex = hex;
+						badHex[cb * 7 % badHex.length()] = bad;
+						Assert::AreEqual(false, strings::HexToBin(badHex.c_str(), badHex.length(), back.data()));
+					}
+				}
+
+				auto base64 = std::wstring(strings::Base64EncodedSize(cb), L'\0');
+				if (cb) strings::Base64EncodeTo(cb, bin.data(), &base64[0]);
+				Assert::AreEqual(strings::Base64Encode(cb, bin.data()), base64);
+				Assert::AreEqual(cb, strings::Base64DecodedSize(base64.c_str(), base64.length()));
+				Assert::AreEqual(strings::Base64Decode(base64), std::vector<BYTE>(bin.begin(), bin.begin() + cb));
+			}
+		}
+
+		// Log hex and Base64 throughput from 1KB to 64MB
+		TEST_METHOD(Benchmark_codecs)
+		{
+			const auto log = [](LPCWSTR szName,
+								size_t cb,
+								size_t iterations,
+								std::chrono::steady_clock::duration elapsed) {
+				const auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+				const auto mb = static_cast<double>(cb) * iterations / (1024 * 1024);
+				Logger::WriteMessage(
+					strings::format(
+						L"%ws %zu bytes x %zu: %lld us, %.0f MB/s\n",
+						szName,
+						cb,
+						iterations,
+						us,
+						us ? mb * 1000000 / us : 0.0)
+						.c_str());
+			};
+
+			for (auto cb = size_t{1024}; cb <= 64 * 1024 * 1024; cb *= 4)
+			{
+				auto bin = std::vector<BYTE>(cb);
+				for (size_t i = 0; i < cb; i++)
+				{
+					bin[i] = static_cast<BYTE>(i * 37 + 11);
+				}
+
+				// Move about 64MB through each codec regardless of size
+				const auto iterations = cb < 64 * 1024 * 1024 ? 64 * 1024 * 1024 / cb : size_t{1};
+				auto hex = std::wstring{};
+				auto start = std::chrono::steady_clock::now();
+				for (size_t i = 0; i < iterations; i++)
+				{
+					hex = strings::BinToHexString(bin, false);
+				}
+
+				log(L"BinToHexString", cb, iterations, std::chrono::steady_clock::now() - start);
+
+				auto back = std::vector<BYTE>{};
+				start = std::chrono::steady_clock::now();
+				for (size_t i = 0; i < iterations; i++)
+				{
+					back = strings::HexStringToBin(hex);
+				}
+
+				log(L"HexStringToBin", cb, iterations, std::chrono::steady_clock::now() - start);
+				Assert::AreEqual(true, bin == back);
+
+				auto base64 = std::wstring{};
+				start = std::chrono::steady_clock::now();
+				for (size_t i = 0; i < iterations; i++)
+				{
+					base64 = strings::Base64Encode(bin.size(), bin.data());
+				}
+
+				log(L"Base64Encode", cb, iterations, std::chrono::steady_clock::now() - start);
+
+				start = std::chrono::steady_clock::now();
+				for (size_t i = 0; i < iterations; i++)
+				{
+					back = strings::Base64Decode(base64);
+				}
+
+				log(L"Base64Decode", cb, iterations, std::chrono::steady_clock::now() - start);
+				Assert::AreEqual(true, bin == back);
+			}
 		}
 
 		TEST_METHOD(Test_offsets)
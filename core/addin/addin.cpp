@@ -8,8 +8,10 @@
 #include <core/utility/registry.h>
 #include <core/utility/output.h>
 #include <core/utility/error.h>
+#include <core/interpret/proptags.h>
+#include <core/interpret/flags.h>
 
-// Our built in arrays, which get merged into the arrays declared in mfcmapi.h
+// Our built in arrays, which back the tables declared in addin.h
 #include <core/interpret/genTagArray.h>
 #include <core/interpret/flagArray.h>
 #include <core/interpret/guidArray.h>
@@ -17,13 +19,65 @@
 #include <core/interpret/propTypeArray.h>
 #include <core/interpret/smartViewParsers.h>
 
-std::vector<NAME_ARRAY_ENTRY_V2> PropTagArray;
-std::vector<NAME_ARRAY_ENTRY> PropTypeArray;
-std::vector<GUID_ARRAY_ENTRY> PropGuidArray;
-std::vector<NAMEID_ARRAY_ENTRY> NameIDArray;
-std::vector<FLAG_ARRAY_ENTRY> FlagArray;
-std::vector<SMARTVIEW_PARSER_ARRAY_ENTRY> SmartViewParserArray;
-std::vector<SMARTVIEW_PARSER_TYPE_ARRAY_ENTRY> SmartViewParserTypeArray;
+namespace
+{
+	// Our lookups assume things about how the built in arrays are laid out. Check them here, so a bad edit
+	// breaks the build instead of quietly breaking a search.
+	static_assert(
+		std::is_sorted(
+			std::begin(g_PropTagArray),
+			std::end(g_PropTagArray),
+			[](const NAME_ARRAY_ENTRY_V2& a, const NAME_ARRAY_ENTRY_V2& b) {
+				return a.ulValue < b.ulValue ||
+					   (a.ulValue == b.ulValue && std::wstring_view{a.lpszName} < std::wstring_view{b.lpszName});
+			}),
+		"g_PropTagArray must be sorted by tag, then by name");
+	static_assert(
+		std::is_sorted(
+			std::begin(g_PropTypeArray),
+			std::end(g_PropTypeArray),
+			[](const NAME_ARRAY_ENTRY& a, const NAME_ARRAY_ENTRY& b) { return a.ulValue < b.ulValue; }),
+		"g_PropTypeArray must be sorted by type");
+	// FindNameIDArrayMatches does a binary search on lValue
+	static_assert(
+		std::is_sorted(
+			std::begin(g_NameIDArray),
+			std::end(g_NameIDArray),
+			[](const NAMEID_ARRAY_ENTRY& a, const NAMEID_ARRAY_ENTRY& b) { return a.lValue < b.lValue; }),
+		"g_NameIDArray must be sorted by lValue");
+
+	// The flag index keeps one [begin, end) range per flag name, so all entries for a name must be together.
+	// Flags for a name are listed in the order we want them output, so the array as a whole isn't sorted.
+	template <size_t N> constexpr bool FlagNamesAreGrouped(const FLAG_ARRAY_ENTRY (&flags)[N]) noexcept
+	{
+		for (size_t i = 1; i < N; i++)
+		{
+			if (flags[i].ulFlagName == flags[i - 1].ulFlagName) continue;
+			for (size_t j = 0; j < i; j++)
+			{
+				if (flags[j].ulFlagName == flags[i].ulFlagName) return false;
+			}
+		}
+
+		return true;
+	}
+
+	static_assert(FlagNamesAreGrouped(g_FlagArray), "g_FlagArray entries for each flag name must be contiguous");
+	// The first parser is our 'no parser' choice, and the UI and MrMAPI number parsers from 1
+	static_assert(
+		smartview::g_SmartViewParserTypeArray[0].type == parserType::NOPARSING,
+		"g_SmartViewParserTypeArray must start with NOPARSING");
+} // namespace
+
+// Until MergeAddInArrays finds add-in entries, these just read our built in arrays
+addin::interpretTable<NAME_ARRAY_ENTRY_V2> PropTagArray{g_PropTagArray};
+addin::interpretTable<NAME_ARRAY_ENTRY> PropTypeArray{g_PropTypeArray};
+addin::interpretTable<GUID_ARRAY_ENTRY> PropGuidArray{guid::g_PropGuidArray};
+addin::interpretTable<NAMEID_ARRAY_ENTRY> NameIDArray{g_NameIDArray};
+addin::interpretTable<FLAG_ARRAY_ENTRY> FlagArray{g_FlagArray};
+addin::interpretTable<SMARTVIEW_PARSER_ARRAY_ENTRY> SmartViewParserArray{smartview::g_SmartViewParserArray};
+addin::interpretTable<SMARTVIEW_PARSER_TYPE_ARRAY_ENTRY> SmartViewParserTypeArray{
+	smartview::g_SmartViewParserTypeArray};
 std::vector<_AddIn> g_lpMyAddins;
 
 namespace addin
@@ -469,7 +523,7 @@ namespace addin
 
 	template <typename T>
 	void MergeArrays(
-		std::vector<T>& Target,
+		interpretTable<T>& Target,
 		_Inout_bytecap_x_(cSource* width) T* Source,
 		_In_ size_t cSource,
 		_In_ int(_cdecl* Comparison)(const void*, const void*))
@@ -477,20 +531,27 @@ namespace addin
 		// Sort the source array
 		qsort(Source, cSource, sizeof T, Comparison);
 
-		// Append any entries in the source not already in the target to the target
+		// Append any entries in the source not already in the target to a copy of the target
+		auto merged = Target.copy();
 		for (ULONG i = 0; i < cSource; i++)
 		{
-			if (end(Target) ==
-				find_if(begin(Target), end(Target), [&](T& entry) { return Comparison(&Source[i], &entry) == 0; }))
+			if (end(merged) == find_if(begin(merged), end(merged), [&](const T& entry) {
+					return Comparison(&Source[i], &entry) == 0;
+				}))
 			{
-				Target.push_back(Source[i]);
+				merged.push_back(Source[i]);
 			}
 		}
 
+		// Nothing new means nothing to merge
+		if (merged.size() == Target.size()) return;
+
 		// Stable sort the resulting array
-		std::stable_sort(begin(Target), end(Target), [Comparison](const T& a, const T& b) -> bool {
+		std::stable_sort(begin(merged), end(merged), [Comparison](const T& a, const T& b) -> bool {
 			return Comparison(&a, &b) < 0;
 		});
+
+		Target.setOverlay(std::move(merged));
 	}
 
 	// Flags are difficult to sort since we need to have a stable sort
@@ -570,20 +631,26 @@ namespace addin
 		In1 = Out;
 	}
 
-	// Assumes built in arrays are already sorted!
+	// Rebuild the lookup indexes the interpret layer keeps over the merged arrays
+	void BuildArrayIndexes()
+	{
+		proptags::BuildPropTagIndex();
+		flags::BuildFlagIndex();
+	}
+
+	// The static_asserts at the top of this file check our built in arrays are laid out as our lookups expect
 	void MergeAddInArrays()
 	{
 		output::DebugPrint(output::dbgLevel::AddInPlumbing, L"Loading default arrays\n");
-		PropTagArray = std::vector<NAME_ARRAY_ENTRY_V2>(std::begin(g_PropTagArray), std::end(g_PropTagArray));
-		PropTypeArray = std::vector<NAME_ARRAY_ENTRY>(std::begin(g_PropTypeArray), std::end(g_PropTypeArray));
-		PropGuidArray =
-			std::vector<GUID_ARRAY_ENTRY>(std::begin(guid::g_PropGuidArray), std::end(guid::g_PropGuidArray));
-		NameIDArray = std::vector<NAMEID_ARRAY_ENTRY>(std::begin(g_NameIDArray), std::end(g_NameIDArray));
-		FlagArray = std::vector<FLAG_ARRAY_ENTRY>(std::begin(g_FlagArray), std::end(g_FlagArray));
-		SmartViewParserArray = std::vector<SMARTVIEW_PARSER_ARRAY_ENTRY>(
-			std::begin(smartview::g_SmartViewParserArray), std::end(smartview::g_SmartViewParserArray));
-		SmartViewParserTypeArray = std::vector<SMARTVIEW_PARSER_TYPE_ARRAY_ENTRY>(
-			std::begin(smartview::g_SmartViewParserTypeArray), std::end(smartview::g_SmartViewParserTypeArray));
+		// Our indexes and memos were built over whatever the tables held before
+		const auto bIndexesStale = !PropTagArray.isBuiltIn() || !FlagArray.isBuiltIn();
+		PropTagArray.reset();
+		PropTypeArray.reset();
+		PropGuidArray.reset();
+		NameIDArray.reset();
+		FlagArray.reset();
+		SmartViewParserArray.reset();
+		SmartViewParserTypeArray.reset();
 
 		output::DebugPrint(output::dbgLevel::AddInPlumbing, L"Found 0x%08X built in prop tags.\n", PropTagArray.size());
 		output::DebugPrint(
@@ -601,7 +668,12 @@ namespace addin
 			SmartViewParserTypeArray.size());
 
 		// No add-in == nothing to merge
-		if (g_lpMyAddins.empty()) return;
+		// The indexes build themselves on first use, so a run which never looks anything up never pays for them
+		if (g_lpMyAddins.empty())
+		{
+			if (bIndexesStale) BuildArrayIndexes();
+			return;
+		}
 
 		output::DebugPrint(output::dbgLevel::AddInPlumbing, L"Merging Add-In arrays\n");
 		for (const auto& addIn : g_lpMyAddins)
@@ -637,7 +709,9 @@ namespace addin
 			if (addIn.ulPropFlags)
 			{
 				SortFlagArray(addIn.lpPropFlags, addIn.ulPropFlags);
-				MergeFlagArrays(FlagArray, addIn.lpPropFlags, addIn.ulPropFlags);
+				auto merged = FlagArray.copy();
+				MergeFlagArrays(merged, addIn.lpPropFlags, addIn.ulPropFlags);
+				FlagArray.setOverlay(std::move(merged));
 			}
 
 			if (addIn.ulSmartViewParsers)
@@ -650,24 +724,28 @@ namespace addin
 			static auto s_nextParser = static_cast<int>(parserType::END);
 			if (addIn.ulSmartViewParserTypes)
 			{
+				auto merged = SmartViewParserTypeArray.copy();
 				for (ULONG i = 0; i < addIn.ulSmartViewParserTypes; i++)
 				{
 					SMARTVIEW_PARSER_TYPE_ARRAY_ENTRY addinType{};
 					addinType.type = static_cast<parserType>(s_nextParser);
 					addinType.lpszName = addIn.lpSmartViewParserTypes[i];
-					SmartViewParserTypeArray.push_back(addinType);
+					merged.push_back(addinType);
 					s_nextParser++;
 				}
+
+				SmartViewParserTypeArray.setOverlay(std::move(merged));
 			}
 
 			if (addIn.ulPropGuids)
 			{
+				auto merged = PropGuidArray.copy();
 				// Copy guids from addIn.lpPropGuids, checking for dupes on the way
 				for (ULONG i = 0; i < addIn.ulPropGuids; i++)
 				{
 					auto bDupe = false;
 					// Since this array isn't sorted, we have to compare against all valid entries for dupes
-					for (const auto& guid : PropGuidArray)
+					for (const auto& guid : merged)
 					{
 						if (IsEqualGUID(*addIn.lpPropGuids[i].lpGuid, *guid.lpGuid))
 						{
@@ -678,9 +756,11 @@ namespace addin
 
 					if (!bDupe)
 					{
-						PropGuidArray.push_back(addIn.lpPropGuids[i]);
+						merged.push_back(addIn.lpPropGuids[i]);
 					}
 				}
+
+				if (merged.size() != PropGuidArray.size()) PropGuidArray.setOverlay(std::move(merged));
 			}
 		}
 
@@ -695,6 +775,8 @@ namespace addin
 			L"After merge, 0x%08X Smart View parser types.\n",
 			SmartViewParserTypeArray.size());
 
+		BuildArrayIndexes();
+
 		output::DebugPrint(output::dbgLevel::AddInPlumbing, L"Done merging add-in arrays\n");
 	}
 
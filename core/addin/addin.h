@@ -22,13 +22,65 @@ namespace addin
 	void MergeAddInArrays();
 	std::wstring AddInSmartView(parserType iStructType, ULONG cbBin, _In_count_(cbBin) const BYTE* lpBin);
 	std::wstring AddInStructTypeToString(parserType parser);
+
+	// One of our interpret tables, such as PropTagArray.
+	// The built in entries are a constexpr array which we read in place, so startup copies nothing.
+	// Add-ins never touch that array. When one contributes entries, we merge them with what the
+	// table already holds into an overlay, and lookups read the overlay from then on.
+	template <typename T> class interpretTable
+	{
+	public:
+		constexpr interpretTable() noexcept = default;
+		template <size_t N>
+		constexpr interpretTable(const T (&builtIn)[N]) noexcept
+			: lpBuiltIn(builtIn), cBuiltIn(N), lpEntries(builtIn), cEntries(N)
+		{
+		}
+
+		// Drop any add-in entries and go back to reading the built in array
+		void reset() noexcept
+		{
+			overlay.clear();
+			overlay.shrink_to_fit();
+			lpEntries = lpBuiltIn;
+			cEntries = cBuiltIn;
+		}
+
+		// Read entries from a merged overlay instead of the built in array
+		void setOverlay(std::vector<T>&& merged) noexcept
+		{
+			overlay = std::move(merged);
+			lpEntries = overlay.data();
+			cEntries = overlay.size();
+		}
+
+		// A copy of the current entries to merge add-in entries into
+		std::vector<T> copy() const { return std::vector<T>(begin(), end()); }
+
+		bool isBuiltIn() const noexcept { return lpEntries == lpBuiltIn; }
+		size_t builtInSize() const noexcept { return cBuiltIn; }
+
+		const T* data() const noexcept { return lpEntries; }
+		size_t size() const noexcept { return cEntries; }
+		bool empty() const noexcept { return cEntries == 0; }
+		const T* begin() const noexcept { return lpEntries; }
+		const T* end() const noexcept { return lpEntries + cEntries; }
+		const T& operator[](size_t i) const noexcept { return lpEntries[i]; }
+
+	private:
+		const T* lpBuiltIn{};
+		size_t cBuiltIn{};
+		std::vector<T> overlay;
+		const T* lpEntries{};
+		size_t cEntries{};
+	};
 } // namespace addin
 
-extern std::vector<NAME_ARRAY_ENTRY_V2> PropTagArray;
-extern std::vector<NAME_ARRAY_ENTRY> PropTypeArray;
-extern std::vector<GUID_ARRAY_ENTRY> PropGuidArray;
-extern std::vector<NAMEID_ARRAY_ENTRY> NameIDArray;
-extern std::vector<FLAG_ARRAY_ENTRY> FlagArray;
-extern std::vector<SMARTVIEW_PARSER_ARRAY_ENTRY> SmartViewParserArray;
-extern std::vector<SMARTVIEW_PARSER_TYPE_ARRAY_ENTRY> SmartViewParserTypeArray;
+extern addin::interpretTable<NAME_ARRAY_ENTRY_V2> PropTagArray;
+extern addin::interpretTable<NAME_ARRAY_ENTRY> PropTypeArray;
+extern addin::interpretTable<GUID_ARRAY_ENTRY> PropGuidArray;
+extern addin::interpretTable<NAMEID_ARRAY_ENTRY> NameIDArray;
+extern addin::interpretTable<FLAG_ARRAY_ENTRY> FlagArray;
+extern addin::interpretTable<SMARTVIEW_PARSER_ARRAY_ENTRY> SmartViewParserArray;
+extern addin::interpretTable<SMARTVIEW_PARSER_TYPE_ARRAY_ENTRY> SmartViewParserTypeArray;
 extern std::vector<_AddIn> g_lpMyAddins;
\ No newline at end of file
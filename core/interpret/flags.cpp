@@ -3,30 +3,111 @@
 #include <core/utility/strings.h>
 #include <core/addin/addin.h>
 #include <core/addin/mfcmapi.h>
+#include <atomic>
+#include <mutex>
 
 namespace flags
 {
+	// An index over FlagArray. Never changed once it's published, so readers need no lock.
+	// Each name's entries in FlagArray are contiguous, so they form a single [begin, end) range.
+	// Within a name, entries stay in the order they're output, so FlagArray isn't sorted and mustn't be.
+	struct flagIndex
+	{
+		std::unordered_map<ULONG, std::pair<size_t, size_t>> ranges;
+		// What FlagArray looked like when we built the index, so we can tell if it changed under us
+		const FLAG_ARRAY_ENTRY* lpArray{};
+		size_t cArray{};
+	};
+
+	// The current index. A rebuild publishes a new one and keeps the old, since a reader may still be using it.
+	// Rebuilds only follow add-in loads, so few are ever kept.
+	std::atomic<const flagIndex*> g_FlagIndex{};
+	std::vector<std::unique_ptr<const flagIndex>> g_FlagIndexes;
+	std::mutex g_FlagIndexLock; // Serializes rebuilds
+	// Results of InterpretFlags, keyed on flag name and value. Each thread keeps its own, so they need no lock.
+	// They're dropped when the index they were built with is replaced.
+	thread_local std::unordered_map<ULONG64, std::wstring> g_FlagStrings;
+	thread_local const flagIndex* g_FlagStringsIndex{};
+	// Don't let the memo grow without bound when we're fed a stream of unique values
+	constexpr size_t cMaxFlagStrings = 0x4000;
+
+	// Build and publish an index over FlagArray. Caller holds g_FlagIndexLock.
+	const flagIndex* PublishFlagIndex()
+	{
+		auto index = std::make_unique<flagIndex>();
+		for (size_t i = 0; i < FlagArray.size(); i++)
+		{
+			const auto range = index->ranges.find(FlagArray[i].ulFlagName);
+			if (range == index->ranges.end())
+			{
+				index->ranges.emplace(FlagArray[i].ulFlagName, std::make_pair(i, i + 1));
+			}
+			else
+			{
+				range->second.second = i + 1;
+			}
+		}
+
+		index->lpArray = FlagArray.data();
+		index->cArray = FlagArray.size();
+		const auto lpIndex = index.get();
+		g_FlagIndexes.emplace_back(std::move(index));
+		g_FlagIndex.store(lpIndex, std::memory_order_release);
+		return lpIndex;
+	}
+
+	void BuildFlagIndex()
+	{
+		const auto lock = std::lock_guard<std::mutex>(g_FlagIndexLock);
+		PublishFlagIndex();
+	}
+
+	// The current index, built first if FlagArray has changed since the last one
+	const flagIndex* GetFlagIndex()
+	{
+		const auto stale = [](const flagIndex* index) {
+			return !index || index->lpArray != FlagArray.data() || index->cArray != FlagArray.size();
+		};
+
+		const auto index = g_FlagIndex.load(std::memory_order_acquire);
+		if (!stale(index)) return index;
+
+		const auto lock = std::lock_guard<std::mutex>(g_FlagIndexLock);
+		// Another thread may have rebuilt it while we waited
+		const auto current = g_FlagIndex.load(std::memory_order_acquire);
+		return stale(current) ? PublishFlagIndex() : current;
+	}
+
+	// Find the range of FlagArray entries for a flag name. Returns an empty range if we have none.
+	std::pair<size_t, size_t> FindFlagRange(const flagIndex* index, ULONG ulFlagName)
+	{
+		const auto range = index->ranges.find(ulFlagName);
+		if (range == index->ranges.end()) return {0, 0};
+		return range->second;
+	}
+
 	// Interprets a flag value according to a flag name and returns a string
 	// Will not return a string if the flag name is not recognized
 	std::wstring InterpretFlags(ULONG ulFlagName, LONG lFlagValue)
 	{
-		ULONG ulCurEntry = 0;
+		const auto index = GetFlagIndex();
+		const auto range = FindFlagRange(index, ulFlagName);
+		if (range.first == range.second) return L"";
 
-		if (FlagArray.empty()) return L"";
-
-		while (ulCurEntry < FlagArray.size() && FlagArray[ulCurEntry].ulFlagName != ulFlagName)
+		if (g_FlagStringsIndex != index)
 		{
-			ulCurEntry++;
+			g_FlagStrings.clear();
+			g_FlagStringsIndex = index;
 		}
 
-		// Don't run off the end of the array
-		if (FlagArray.size() == ulCurEntry) return L"";
-		if (FlagArray[ulCurEntry].ulFlagName != ulFlagName) return L"";
+		const auto ulKey = static_cast<ULONG64>(ulFlagName) << 32 | static_cast<ULONG>(lFlagValue);
+		const auto match = g_FlagStrings.find(ulKey);
+		if (match != g_FlagStrings.end()) return match->second;
 
 		// We've matched our flag name to the array - we SHOULD return a string at this point
 		auto flags = std::vector<std::wstring>{};
 		auto lTempValue = lFlagValue;
-		while (FlagArray[ulCurEntry].ulFlagName == ulFlagName)
+		for (auto ulCurEntry = range.first; ulCurEntry < range.second; ulCurEntry++)
 		{
 			switch (FlagArray[ulCurEntry].ulFlagType)
 			{
@@ -84,8 +165,6 @@ namespace flags
 				}
 				break;
 			}
-
-			ulCurEntry++;
 		}
 
 		if (lTempValue || flags.empty())
@@ -93,7 +172,10 @@ namespace flags
 			flags.push_back(strings::format(L"0x%X", lTempValue)); // STRING_OK
 		}
 
-		return strings::join(flags, L" | ");
+		auto szFlags = strings::join(flags, L" | ");
+		if (g_FlagStrings.size() >= cMaxFlagStrings) g_FlagStrings.clear();
+		g_FlagStrings.emplace(ulKey, szFlags);
+		return szFlags;
 	}
 
 	// Returns a list of all known flags/values for a flag name.
@@ -109,20 +191,13 @@ namespace flags
 	std::wstring AllFlagsToString(ULONG ulFlagName, bool bHex)
 	{
 		if (!ulFlagName) return L"";
-		if (FlagArray.empty()) return L"";
 
-		ULONG ulCurEntry = 0;
-
-		while (ulCurEntry < FlagArray.size() && FlagArray[ulCurEntry].ulFlagName != ulFlagName)
-		{
-			ulCurEntry++;
-		}
-
-		if (ulCurEntry == FlagArray.size() || FlagArray[ulCurEntry].ulFlagName != ulFlagName) return L"";
+		const auto range = FindFlagRange(GetFlagIndex(), ulFlagName);
+		if (range.first == range.second) return L"";
 
 		// We've matched our flag name to the array - we SHOULD return a string at this point
 		auto flags = std::vector<std::wstring>{};
-		while (FlagArray[ulCurEntry].ulFlagName == ulFlagName)
+		for (auto ulCurEntry = range.first; ulCurEntry < range.second; ulCurEntry++)
 		{
 			if (flagCLEARBITS != FlagArray[ulCurEntry].ulFlagType)
 			{
@@ -131,8 +206,6 @@ namespace flags
 					FlagArray[ulCurEntry].lFlagValue,
 					FlagArray[ulCurEntry].lpszName));
 			}
-
-			ulCurEntry++;
 		}
 
 		return strings::join(flags, L"\r\n");
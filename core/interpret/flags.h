@@ -2,6 +2,9 @@
 
 namespace flags
 {
+	// Rebuild the flag name index over FlagArray and drop memoized results. Call after FlagArray changes.
+	void BuildFlagIndex();
+
 	std::wstring InterpretFlags(ULONG ulFlagName, LONG lFlagValue);
 	std::wstring AllFlagsToString(ULONG ulFlagName, bool bHex);
 } // namespace flags
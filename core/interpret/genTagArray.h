@@ -1,6 +1,6 @@
 #pragma once
 
-static NAME_ARRAY_ENTRY_V2 g_PropTagArray[] = {
+constexpr NAME_ARRAY_ENTRY_V2 g_PropTagArray[] = {
 	// clang-format off
 	{ 0x00010003, 0x6, L"PROP_ACCT_ID" },
 	{ 0x00010003, 0x5, L"PR_ACKNOWLEDGEMENT_MODE" },
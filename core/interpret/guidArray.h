@@ -4,7 +4,7 @@
 namespace guid
 {
 #define GUID_ENTRY(guid) {&(guid), L#guid},
-	static GUID_ARRAY_ENTRY g_PropGuidArray[] = {
+	static const GUID_ARRAY_ENTRY g_PropGuidArray[] = {
 		// clang-format off
 		GUID_ENTRY(GUID_NULL)
 		GUID_ENTRY(IID_IUnknown)
@@ -1,6 +1,6 @@
 #pragma once
 
-static NAMEID_ARRAY_ENTRY g_NameIDArray[] = {
+constexpr NAMEID_ARRAY_ENTRY g_NameIDArray[] = {
 	{0x0001, &guid::PSETID_Meeting, L"LID_ATTENDEE_CRITICAL_CHANGE", PT_SYSTIME, L"Meetings"},
 	{0x0001, &guid::PSETID_Meeting, L"PidLidAttendeeCriticalChange", PT_SYSTIME, L"Meetings"},
 	{0x0002, &guid::PSETID_Meeting, L"LID_WHERE", PT_UNICODE, L"Meetings"},
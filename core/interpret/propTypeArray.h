@@ -2,7 +2,7 @@
 #define PTYPE_ENTRY(num) {(num), L#num},
 #include <core/mapi/extraPropTags.h>
 
-static NAME_ARRAY_ENTRY g_PropTypeArray[] = {
+constexpr NAME_ARRAY_ENTRY g_PropTypeArray[] = {
 	// clang-format off
 	PTYPE_ENTRY(PT_UNSPECIFIED)
 	PTYPE_ENTRY(PT_NULL)
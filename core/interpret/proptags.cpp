@@ -7,11 +7,37 @@
 #include <core/interpret/proptype.h>
 #include <core/utility/output.h>
 #include <core/utility/registry.h>
+#include <atomic>
+#include <mutex>
 
 namespace proptags
 {
 	static WCHAR szPropSeparator[] = L", "; // STRING_OK
-	std::unordered_map<ULONG64, PropTagNames> g_PropNames;
+
+	// Indexes over PropTagArray, built by BuildPropTagIndex. Never changed once they're published,
+	// so readers need no lock.
+	struct propTagIndex
+	{
+		// Lower cased name -> index of the first entry with that name
+		std::unordered_map<std::wstring, ULONG> names;
+		// Masked tag -> indexes of every entry with that masked tag, already in CompareTagsSortOrder order
+		std::unordered_map<ULONG, std::vector<ULONG>> tags;
+		// What PropTagArray looked like when we built the indexes, so we can tell if it changed under us
+		const NAME_ARRAY_ENTRY_V2* lpArray{};
+		size_t cArray{};
+	};
+
+	// The current indexes. A rebuild publishes new ones and keeps the old, since a reader may still be using them.
+	// Rebuilds only follow add-in loads, so few are ever kept.
+	std::atomic<const propTagIndex*> g_PropTagIndex{};
+	std::vector<std::unique_ptr<const propTagIndex>> g_PropTagIndexes;
+	std::mutex g_PropTagIndexLock; // Serializes rebuilds
+	// Results of PropTagToPropName. Each thread keeps its own, so they need no lock.
+	// They're dropped when the indexes they were built with are replaced.
+	thread_local std::unordered_map<ULONG64, PropTagNames> g_PropNames;
+	thread_local const propTagIndex* g_PropNamesIndex{};
+
+	const propTagIndex* GetPropTagIndex();
 
 	std::wstring TagToString(ULONG ulPropTag, _In_opt_ LPMAPIPROP lpObj, bool bIsAB, bool bSingleLine)
 	{
@@ -105,6 +131,13 @@ namespace proptags
 	{
 		auto ulKey = (bIsAB ? static_cast<ULONG64>(1) << 32 : 0) | ulPropTag;
 
+		const auto index = GetPropTagIndex();
+		if (g_PropNamesIndex != index)
+		{
+			g_PropNames.clear();
+			g_PropNamesIndex = index;
+		}
+
 		const auto match = g_PropNames.find(ulKey);
 		if (match != g_PropNames.end())
 		{
@@ -171,6 +204,64 @@ namespace proptags
 		return true;
 	}
 
+	// Build and publish indexes over PropTagArray. Caller holds g_PropTagIndexLock.
+	const propTagIndex* PublishPropTagIndex()
+	{
+		auto index = std::make_unique<propTagIndex>();
+		index->names.reserve(PropTagArray.size());
+		for (ULONG ulCur = 0; ulCur < PropTagArray.size(); ulCur++)
+		{
+			const auto& tag = PropTagArray[ulCur];
+			if (tag.lpszName)
+			{
+				// emplace won't replace an earlier entry, so the first match wins, as with a linear scan
+				index->names.emplace(strings::wstringToLower(tag.lpszName), ulCur);
+			}
+
+			index->tags[tag.ulValue & PROP_TAG_MASK].push_back(ulCur);
+		}
+
+		for (auto& entries : index->tags)
+		{
+			sort(entries.second.begin(), entries.second.end(), CompareTagsSortOrder);
+		}
+
+		index->lpArray = PropTagArray.data();
+		index->cArray = PropTagArray.size();
+		output::DebugPrint(
+			output::dbgLevel::AddInPlumbing,
+			L"BuildPropTagIndex: indexed 0x%08X names, 0x%08X tags\n",
+			index->names.size(),
+			index->tags.size());
+
+		const auto lpIndex = index.get();
+		g_PropTagIndexes.emplace_back(std::move(index));
+		g_PropTagIndex.store(lpIndex, std::memory_order_release);
+		return lpIndex;
+	}
+
+	void BuildPropTagIndex()
+	{
+		const auto lock = std::lock_guard<std::mutex>(g_PropTagIndexLock);
+		PublishPropTagIndex();
+	}
+
+	// The current indexes, built first if PropTagArray has changed since the last ones
+	const propTagIndex* GetPropTagIndex()
+	{
+		const auto stale = [](const propTagIndex* index) {
+			return !index || index->lpArray != PropTagArray.data() || index->cArray != PropTagArray.size();
+		};
+
+		const auto index = g_PropTagIndex.load(std::memory_order_acquire);
+		if (!stale(index)) return index;
+
+		const auto lock = std::lock_guard<std::mutex>(g_PropTagIndexLock);
+		// Another thread may have rebuilt them while we waited
+		const auto current = g_PropTagIndex.load(std::memory_order_acquire);
+		return stale(current) ? PublishPropTagIndex() : current;
+	}
+
 	// Searches an array for a target number.
 	// Search is done with a mask
 	// Partial matches are those that match with the mask applied
@@ -181,7 +272,7 @@ namespace proptags
 	void FindTagArrayMatches(
 		_In_ ULONG ulTarget,
 		bool bIsAB,
-		const std::vector<NAME_ARRAY_ENTRY_V2>& MyArray,
+		const addin::interpretTable<NAME_ARRAY_ENTRY_V2>& MyArray,
 		std::vector<ULONG>& ulExacts,
 		std::vector<ULONG>& ulPartials)
 	{
@@ -199,6 +290,29 @@ namespace proptags
 		// Short circuit property IDs with the high bit set if bIsAB wasn't passed
 		if (!bIsAB && ulTarget & 0x80000000) return;
 
+		// PropTagArray is indexed, so we can skip the search and the sorts
+		if (&MyArray == &PropTagArray)
+		{
+			const auto index = GetPropTagIndex();
+			const auto match = index->tags.find(ulMaskedTarget);
+			if (match == index->tags.end()) return;
+
+			// Splitting a sorted list keeps both halves sorted
+			for (const auto& ulCur : match->second)
+			{
+				if (ulTarget == MyArray[ulCur].ulValue)
+				{
+					ulExacts.push_back(ulCur);
+				}
+				else
+				{
+					ulPartials.push_back(ulCur);
+				}
+			}
+
+			return;
+		}
+
 		// Find A partial match
 		while (ulUpperBound - ulLowerBound > 1)
 		{
@@ -259,21 +373,24 @@ namespace proptags
 		}
 	}
 
+	_Check_return_ ULONG LookupPropNameIndex(_In_ const std::wstring& lpszPropName)
+	{
+		if (lpszPropName.empty()) return cache::ulNoMatch;
+
+		const auto index = GetPropTagIndex();
+		const auto match = index->names.find(strings::wstringToLower(lpszPropName));
+		if (match == index->names.end()) return cache::ulNoMatch;
+
+		return match->second;
+	}
+
 	// Strictly does a lookup in the array. Does not convert otherwise
 	_Check_return_ ULONG LookupPropName(_In_ const std::wstring& lpszPropName)
 	{
-		auto trimName = strings::trim(lpszPropName);
-		if (trimName.empty()) return 0;
-
-		for (auto& tag : PropTagArray)
-		{
-			if (0 == lstrcmpiW(trimName.c_str(), tag.lpszName))
-			{
-				return tag.ulValue;
-			}
-		}
+		const auto ulIndex = LookupPropNameIndex(strings::trim(lpszPropName));
+		if (ulIndex == cache::ulNoMatch) return 0;
 
-		return 0;
+		return PropTagArray[ulIndex].ulValue;
 	}
 
 	_Check_return_ ULONG PropNameToPropTag(_In_ const std::wstring& lpszPropName)
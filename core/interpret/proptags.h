@@ -1,6 +1,5 @@
 #pragma once
-
-struct NAME_ARRAY_ENTRY_V2;
+#include <core/addin/addin.h>
 
 namespace proptags
 {
@@ -21,10 +20,17 @@ namespace proptags
 	void FindTagArrayMatches(
 		_In_ ULONG ulTarget,
 		bool bIsAB,
-		const std::vector<NAME_ARRAY_ENTRY_V2>& MyArray,
+		const addin::interpretTable<NAME_ARRAY_ENTRY_V2>& MyArray,
 		std::vector<ULONG>& ulExacts,
 		std::vector<ULONG>& ulPartials);
 
+	// Rebuild the name and tag indexes over PropTagArray. Call after PropTagArray changes.
+	void BuildPropTagIndex();
+
+	// Index into PropTagArray of the first entry named lpszPropName (case insensitive)
+	// Returns cache::ulNoMatch if there is no such entry
+	_Check_return_ ULONG LookupPropNameIndex(_In_ const std::wstring& lpszPropName);
+
 	// Strictly does a lookup in the array. Does not convert otherwise
 	_Check_return_ ULONG LookupPropName(_In_ const std::wstring& lpszPropName);
 	_Check_return_ ULONG PropNameToPropTag(_In_ const std::wstring& lpszPropName);
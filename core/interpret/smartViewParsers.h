@@ -3,7 +3,7 @@
 namespace smartview
 {
 	// After 'No Parsing', these are in alphabetical order
-	static SMARTVIEW_PARSER_TYPE_ARRAY_ENTRY g_SmartViewParserTypeArray[] = {
+	constexpr SMARTVIEW_PARSER_TYPE_ARRAY_ENTRY g_SmartViewParserTypeArray[] = {
 		{parserType::NOPARSING, L"Choose Smart View Parser"}, // STRING_OK
 		{parserType::ADDITIONALRENENTRYIDSEX, L"Additional Ren Entry IDs Ex"}, // STRING_OK
 		{parserType::APPOINTMENTRECURRENCEPATTERN, L"Appointment Recurrence Pattern"}, // STRING_OK
@@ -42,7 +42,7 @@ namespace smartview
 		{parserType::SWAPPEDTODO, L"Swapped ToDo"}, // STRING_OK
 	};
 
-	static SMARTVIEW_PARSER_ARRAY_ENTRY g_SmartViewParserArray[] = {
+	constexpr SMARTVIEW_PARSER_ARRAY_ENTRY g_SmartViewParserArray[] = {
 		// clang-format off
 		BINARY_STRUCTURE_ENTRY(PR_REPORT_TAG, parserType::REPORTTAG)
 		BINARY_STRUCTURE_ENTRY(PR_RECEIVED_BY_ENTRYID, parserType::ENTRYID)
@@ -10,6 +10,7 @@
 #include <core/addin/mfcmapi.h>
 #include <core/addin/addin.h>
 #include <core/utility/error.h>
+#include <array>
 
 namespace cache
 {
@@ -42,11 +43,11 @@ namespace cache
 			return E_OUTOFMEMORY;
 		}
 
-		_Check_return_ std::vector<std::shared_ptr<namedPropCacheEntry>>
-		GetAllNamesFromIDs(_In_ LPMAPIFOLDER lpMAPIFolder)
+		// Returns a failure if the walk stopped early. Whatever we found before that is still in names.
+		_Check_return_ HRESULT
+		GetAllNamesFromIDs(_In_ LPMAPIFOLDER lpMAPIFolder, std::vector<std::shared_ptr<namedPropCacheEntry>>& names)
 		{
-			auto names = std::vector<std::shared_ptr<namedPropCacheEntry>>{};
-
+			auto hRes = S_OK;
 			// We didn't get any names - try manual
 			constexpr auto ulLowerBound = __LOWERBOUND;
 			const auto ulUpperBound = FindHighestNamedProp(lpMAPIFolder);
@@ -68,7 +69,7 @@ namespace cache
 
 				// Trying to get a range of these props can fail with MAPI_E_CALL_FAILED if it's too big for the buffer
 				// In this scenario, reopen the object, lower the batch size, and try again
-				HRESULT hRes = WC_H(GetRange(lpMAPIFolder, iTag, end, range));
+				hRes = WC_H(GetRange(lpMAPIFolder, iTag, end, range));
 				if (hRes == MAPI_E_CALL_FAILED)
 				{
 					LPMAPIFOLDER newFolder = nullptr;
@@ -88,6 +89,7 @@ namespace cache
 					// If batch size drops to 0, it's not going to work
 					if (batchSize == 0)
 					{
+						hRes = MAPI_E_CALL_FAILED;
 						break;
 					}
 
@@ -112,30 +114,29 @@ namespace cache
 			}
 
 			lpMAPIFolder->Release();
-			return names;
+			// Unmapped IDs in the last range are expected, and don't make the walk partial
+			return FAILED(hRes) ? hRes : S_OK;
 		}
 
-		_Check_return_ std::vector<std::shared_ptr<namedPropCacheEntry>>
-		GetAllNamesFromIDsFromContainer(LPMAPICONTAINER lpMAPIContainer)
+		_Check_return_ HRESULT GetAllNamesFromIDsFromContainer(
+			LPMAPICONTAINER lpMAPIContainer,
+			std::vector<std::shared_ptr<namedPropCacheEntry>>& names)
 		{
 			LPMAPIFOLDER lpRootFolder = nullptr;
-			if (FAILED(GetRootFolder(lpMAPIContainer, &lpRootFolder)))
-			{
-				return {};
-			}
+			const auto hRes = GetRootFolder(lpMAPIContainer, &lpRootFolder);
+			if (FAILED(hRes)) return hRes;
 
-			return GetAllNamesFromIDs(lpRootFolder);
+			return GetAllNamesFromIDs(lpRootFolder, names);
 		}
 
-		_Check_return_ std::vector<std::shared_ptr<namedPropCacheEntry>> GetAllNamesFromIDsFromMdb(LPMDB lpMdb)
+		_Check_return_ HRESULT
+		GetAllNamesFromIDsFromMdb(LPMDB lpMdb, std::vector<std::shared_ptr<namedPropCacheEntry>>& names)
 		{
 			LPMAPIFOLDER lpRootFolder = nullptr;
-			if (FAILED(GetRootFolder(lpMdb, &lpRootFolder)))
-			{
-				return {};
-			}
+			const auto hRes = GetRootFolder(lpMdb, &lpRootFolder);
+			if (FAILED(hRes)) return hRes;
 
-			return GetAllNamesFromIDs(lpRootFolder);
+			return GetAllNamesFromIDs(lpRootFolder, names);
 		}
 
 		// Returns a vector of NamedPropCacheEntry for the input tags
@@ -165,17 +166,17 @@ namespace cache
 				auto lpContainer = mapi::safe_cast<LPMAPICONTAINER>(lpMAPIProp);
 				if (lpContainer)
 				{
-					names = GetAllNamesFromIDsFromContainer(lpContainer);
+					const auto hResAll = GetAllNamesFromIDsFromContainer(lpContainer, names);
 					lpContainer->Release();
-					return S_OK;
+					return hResAll;
 				}
 
 				auto lpMdb = mapi::safe_cast<LPMDB>(lpMAPIProp);
 				if (lpMdb)
 				{
-					names = GetAllNamesFromIDsFromMdb(lpMdb);
+					const auto hResAll = GetAllNamesFromIDsFromMdb(lpMdb, names);
 					lpMdb->Release();
-					return S_OK;
+					return hResAll;
 				}
 
 				// Can't do the get all props special route because object wasn't IID_IMAPIContainer
@@ -262,11 +263,273 @@ namespace cache
 		}
 	} // namespace directMapi
 
-	std::vector<std::shared_ptr<namedPropCacheEntry>>& namedPropCache::getCache() noexcept
+	namespace
+	{
+		void appendKey(std::string& key, const void* data, size_t cb)
+		{
+			key.append(static_cast<const char*>(data), cb);
+		}
+
+		// Fixed size fields come first, so appending a variable length signature can't make two keys collide
+		std::string idKey(_In_ const std::vector<BYTE>& sig, ULONG ulPropID)
+		{
+			auto key = std::string{};
+			key.reserve(sizeof ulPropID + sig.size());
+			appendKey(key, &ulPropID, sizeof ulPropID);
+			appendKey(key, sig.data(), sig.size());
+			return key;
+		}
+
+		std::string sigKey(_In_ const std::vector<BYTE>& sig)
+		{
+			auto key = std::string{};
+			appendKey(key, sig.data(), sig.size());
+			return key;
+		}
+
+		std::string nameKey(_In_ const std::vector<BYTE>& sig, _In_ const MAPINAMEID& mapiNameId)
+		{
+			auto key = std::string{};
+			const auto& guid = mapiNameId.lpguid ? *mapiNameId.lpguid : GUID_NULL;
+			appendKey(key, &guid, sizeof guid);
+			appendKey(key, &mapiNameId.ulKind, sizeof mapiNameId.ulKind);
+			if (mapiNameId.ulKind == MNID_ID)
+			{
+				appendKey(key, &mapiNameId.Kind.lID, sizeof mapiNameId.Kind.lID);
+			}
+			else if (mapiNameId.ulKind == MNID_STRING && mapiNameId.Kind.lpwstrName)
+			{
+				const auto cchName = static_cast<ULONG>(wcslen(mapiNameId.Kind.lpwstrName));
+				appendKey(key, &cchName, sizeof cchName);
+				appendKey(key, mapiNameId.Kind.lpwstrName, cchName * sizeof WCHAR);
+			}
+
+			appendKey(key, sig.data(), sig.size());
+			return key;
+		}
+
+		// On disk format, in native byte order:
+		// DWORD magic, DWORD flags, DWORD cbSig, signature, DWORD count, then count entries of
+		// DWORD propID, GUID, DWORD ulKind, then DWORD lID for MNID_ID or DWORD cch + cch WCHARs for MNID_STRING
+		constexpr DWORD diskMagic = 0x3143504E; // NPC1
+		constexpr DWORD diskFlagComplete = 0x1;
+
+		template <typename T> void write(std::vector<BYTE>& bin, const T& val)
+		{
+			const auto lpb = reinterpret_cast<const BYTE*>(&val);
+			bin.insert(bin.end(), lpb, lpb + sizeof(T));
+		}
+
+		void write(std::vector<BYTE>& bin, const void* data, size_t cb)
+		{
+			const auto lpb = static_cast<const BYTE*>(data);
+			bin.insert(bin.end(), lpb, lpb + cb);
+		}
+
+		// Bounds checked reads over a buffer. Once a read fails, every read after it fails too.
+		class diskReader
+		{
+		public:
+			explicit diskReader(const std::vector<BYTE>& _bin) noexcept : bin(_bin) {}
+
+			template <typename T> bool read(T& val) noexcept { return read(&val, sizeof(T)); }
+			bool read(void* data, size_t cb) noexcept
+			{
+				if (failed || cb > bin.size() - offset)
+				{
+					failed = true;
+					return false;
+				}
+
+				memcpy(data, bin.data() + offset, cb);
+				offset += cb;
+				return true;
+			}
+			bool done() const noexcept { return !failed && offset == bin.size(); }
+
+		private:
+			const std::vector<BYTE>& bin;
+			size_t offset{};
+			bool failed{};
+		};
+
+		std::wstring diskCachePath(_In_ const std::vector<BYTE>& sig)
+		{
+			std::wstring dir = registry::namedPropCacheDir;
+			if (dir.empty() || sig.empty()) return {};
+			if (dir.back() != L'\\') dir += L'\\';
+			return dir + strings::BinToHexString(sig, false) + L".npc";
+		}
+
+		// What we know about a signature's file
+		struct diskFile
+		{
+			bool bComplete{}; // What we have is a complete walk
+			bool bDirty{}; // We've cached entries since we last wrote it
+		};
+
+		// Signatures we've loaded from disk or saved entries for
+		std::map<std::vector<BYTE>, diskFile>& diskState()
+		{
+			static std::map<std::vector<BYTE>, diskFile> state;
+			return state;
+		}
+
+		std::mutex& diskLock() noexcept
+		{
+			static std::mutex lock;
+			return lock;
+		}
+	} // namespace
+
+	std::vector<BYTE> SerializeNamedProps(
+		_In_ const std::vector<BYTE>& sig,
+		_In_ const std::vector<std::shared_ptr<namedPropCacheEntry>>& entries,
+		bool bComplete)
+	{
+		auto bin = std::vector<BYTE>{};
+		write(bin, diskMagic);
+		write(bin, bComplete ? diskFlagComplete : DWORD{});
+		write(bin, static_cast<DWORD>(sig.size()));
+		write(bin, sig.data(), sig.size());
+		write(bin, static_cast<DWORD>(entries.size()));
+		for (const auto& entry : entries)
+		{
+			const auto& mapiNameId = *entry->getMapiNameId();
+			write(bin, static_cast<DWORD>(entry->getPropID()));
+			write(bin, mapiNameId.lpguid ? *mapiNameId.lpguid : GUID_NULL);
+			write(bin, static_cast<DWORD>(mapiNameId.ulKind));
+			if (mapiNameId.ulKind == MNID_ID)
+			{
+				write(bin, static_cast<DWORD>(mapiNameId.Kind.lID));
+			}
+			else if (mapiNameId.ulKind == MNID_STRING)
+			{
+				const auto cchName = mapiNameId.Kind.lpwstrName ? wcslen(mapiNameId.Kind.lpwstrName) : 0;
+				write(bin, static_cast<DWORD>(cchName));
+				write(bin, mapiNameId.Kind.lpwstrName, cchName * sizeof WCHAR);
+			}
+		}
+
+		return bin;
+	}
+
+	_Check_return_ bool DeserializeNamedProps(
+		_In_ const std::vector<BYTE>& bin,
+		_In_ const std::vector<BYTE>& sig,
+		_Out_ std::vector<std::shared_ptr<namedPropCacheEntry>>& entries,
+		_Out_ bool& bComplete)
+	{
+		entries.clear();
+		bComplete = false;
+
+		auto reader = diskReader{bin};
+		auto magic = DWORD{};
+		auto flags = DWORD{};
+		auto cbSig = DWORD{};
+		if (!reader.read(magic) || magic != diskMagic) return false;
+		if (!reader.read(flags) || !reader.read(cbSig) || cbSig != sig.size()) return false;
+
+		auto fileSig = std::vector<BYTE>(cbSig);
+		if (!reader.read(fileSig.data(), cbSig) || fileSig != sig) return false;
+
+		auto count = DWORD{};
+		if (!reader.read(count)) return false;
+
+		auto results = std::vector<std::shared_ptr<namedPropCacheEntry>>{};
+		for (DWORD i = 0; i < count; i++)
+		{
+			auto ulPropID = DWORD{};
+			auto guid = GUID{};
+			auto mapiNameId = MAPINAMEID{&guid};
+			auto name = std::wstring{};
+			if (!reader.read(ulPropID) || !reader.read(guid) || !reader.read(mapiNameId.ulKind)) return false;
+			if (mapiNameId.ulKind == MNID_ID)
+			{
+				if (!reader.read(mapiNameId.Kind.lID)) return false;
+			}
+			else if (mapiNameId.ulKind == MNID_STRING)
+			{
+				auto cchName = DWORD{};
+				if (!reader.read(cchName) || cchName > bin.size() / sizeof WCHAR) return false;
+				name.resize(cchName);
+				if (!reader.read(name.data(), cchName * sizeof WCHAR)) return false;
+				mapiNameId.Kind.lpwstrName = name.data();
+			}
+			else
+			{
+				return false;
+			}
+
+			results.emplace_back(namedPropCacheEntry::make(&mapiNameId, ulPropID, sig));
+		}
+
+		if (!reader.done()) return false;
+
+		entries = std::move(results);
+		bComplete = (flags & diskFlagComplete) != 0;
+		return true;
+	}
+
+	std::mutex& namedPropCache::getAddLock() noexcept
+	{
+		static std::mutex lock;
+		return lock;
+	}
+
+	namedPropCache::shard& namedPropCache::getShard(const std::string& key) noexcept
 	{
-		// We keep a list of named prop cache entries
-		static std::vector<std::shared_ptr<namedPropCacheEntry>> cache;
-		return cache;
+		static std::array<shard, shardCount> shards;
+		return shards[std::hash<std::string>{}(key) % shardCount];
+	}
+
+	namedPropCache::bucketMap& namedPropCache::getIndex(shard& _shard, indexType type) noexcept
+	{
+		switch (type)
+		{
+		case indexType::id:
+			return _shard.byID;
+		case indexType::name:
+			return _shard.byName;
+		default:
+			return _shard.bySig;
+		}
+	}
+
+	void namedPropCache::addToIndex(const std::shared_ptr<namedPropCacheEntry>& entry)
+	{
+		static const auto noSig = std::vector<BYTE>{};
+		const auto& sig = entry->getSig();
+		const auto ulPropID = entry->getPropID();
+		const auto& mapiNameId = *entry->getMapiNameId();
+
+		const auto index = [&](indexType type, const std::string& key) {
+			auto& _shard = getShard(key);
+			const auto lock = std::unique_lock<std::shared_mutex>(_shard.lock);
+			getIndex(_shard, type)[key].emplace_back(entry);
+		};
+
+		index(indexType::id, idKey(sig, ulPropID));
+		index(indexType::name, nameKey(sig, mapiNameId));
+		index(indexType::sig, sigKey(sig));
+		if (!sig.empty())
+		{
+			index(indexType::id, idKey(noSig, ulPropID));
+			index(indexType::name, nameKey(noSig, mapiNameId));
+		}
+	}
+
+	_Check_return_ std::shared_ptr<namedPropCacheEntry> namedPropCache::findIndexed(
+		indexType type,
+		_In_ const std::string& key,
+		const std::function<bool(const std::shared_ptr<namedPropCacheEntry>&)>& compare)
+	{
+		static const auto noEntries = std::vector<std::shared_ptr<namedPropCacheEntry>>{};
+		auto& _shard = getShard(key);
+		const auto lock = std::shared_lock<std::shared_mutex>(_shard.lock);
+		const auto& map = getIndex(_shard, type);
+		const auto bucket = map.find(key);
+		return cache::find(bucket == map.end() ? noEntries : bucket->second, compare);
 	}
 
 	_Check_return_ std::shared_ptr<namedPropCacheEntry>
@@ -279,7 +542,22 @@ namespace cache
 			entry->output();
 		}
 
-		return cache::find(getCache(), [&](const auto& _entry) { return _entry->match(entry, bMatchID, bMatchName); });
+		const auto compare = [&](const auto& _entry) { return _entry->match(entry, bMatchID, bMatchName); };
+
+		// Every match is filed under the entry's signature, along with its ID or name if we're matching those
+		static const auto noSig = std::vector<BYTE>{};
+		const auto& sig = entry ? entry->getSig() : noSig;
+		if (bMatchID && entry)
+		{
+			return findIndexed(indexType::id, idKey(sig, entry->getPropID()), compare);
+		}
+
+		if (bMatchName && entry)
+		{
+			return findIndexed(indexType::name, nameKey(sig, *entry->getMapiNameId()), compare);
+		}
+
+		return findIndexed(indexType::sig, sigKey(sig), compare);
 	}
 
 	_Check_return_ std::shared_ptr<namedPropCacheEntry>
@@ -303,7 +581,9 @@ namespace cache
 			}
 		}
 
-		return cache::find(getCache(), [&](const auto& _entry) { return _entry->match(_sig, _mapiNameId); });
+		return findIndexed(indexType::name, nameKey(_sig, _mapiNameId), [&](const auto& _entry) {
+			return _entry->match(_sig, _mapiNameId);
+		});
 	}
 
 	_Check_return_ std::shared_ptr<namedPropCacheEntry>
@@ -323,7 +603,8 @@ namespace cache
 			}
 		}
 
-		return cache::find(getCache(), [&](const auto& _entry) { return _entry->match(_sig, _ulPropID); });
+		return findIndexed(
+			indexType::id, idKey(_sig, _ulPropID), [&](const auto& _entry) { return _entry->match(_sig, _ulPropID); });
 	}
 
 	_Check_return_ std::shared_ptr<namedPropCacheEntry>
@@ -339,7 +620,10 @@ namespace cache
 				nameidString.c_str());
 		}
 
-		return cache::find(getCache(), [&](const auto& _entry) { return _entry->match(_ulPropID, _mapiNameId); });
+		// Entries with this name across all signatures
+		return findIndexed(indexType::name, nameKey({}, _mapiNameId), [&](const auto& _entry) {
+			return _entry->match(_ulPropID, _mapiNameId);
+		});
 	}
 
 	// Add a mapping to the cache if it doesn't already exist
@@ -351,7 +635,7 @@ namespace cache
 		// Don't bother adding entries to the cache if they have no signature - we cannot trust entries without a signature.
 		if (sig.empty()) return;
 
-		auto& cache = getCache();
+		const auto addLock = std::lock_guard<std::mutex>(getAddLock());
 		for (auto& entry : entries)
 		{
 			output::DebugPrint(output::dbgLevel::NamedPropCache, L"add:\n");
@@ -384,11 +668,118 @@ namespace cache
 					}
 				}
 
-				cache.emplace_back(entry);
+				addToIndex(entry);
 			}
 		}
 	}
 
+	_Check_return_ std::vector<std::shared_ptr<namedPropCacheEntry>>
+	namedPropCache::getEntries(_In_ const std::vector<BYTE>& sig)
+	{
+		const auto key = sigKey(sig);
+		auto& _shard = getShard(key);
+		const auto lock = std::shared_lock<std::shared_mutex>(_shard.lock);
+		const auto bucket = _shard.bySig.find(key);
+		if (bucket == _shard.bySig.end()) return {};
+		return bucket->second;
+	}
+
+	bool namedPropCache::loadFromDisk(_In_ const std::vector<BYTE>& sig)
+	{
+		const auto path = diskCachePath(sig);
+		if (path.empty()) return false;
+
+		const auto lock = std::lock_guard<std::mutex>(diskLock());
+		const auto state = diskState().find(sig);
+		if (state != diskState().end()) return state->second.bComplete;
+
+		// Whatever happens, don't look at the file again
+		auto& bComplete = diskState()[sig].bComplete;
+
+		const auto fIn = output::MyOpenFileMode(path, L"rb");
+		if (!fIn) return false;
+
+		auto bin = std::vector<BYTE>{};
+		auto buffer = std::array<BYTE, 0x10000>{};
+		size_t cbRead = 0;
+		while ((cbRead = fread(buffer.data(), 1, buffer.size(), fIn)) != 0)
+		{
+			bin.insert(bin.end(), buffer.data(), buffer.data() + cbRead);
+		}
+
+		output::CloseFile(fIn);
+
+		auto entries = std::vector<std::shared_ptr<namedPropCacheEntry>>{};
+		if (!DeserializeNamedProps(bin, sig, entries, bComplete))
+		{
+			output::DebugPrint(output::dbgLevel::NamedPropCache, L"loadFromDisk: ignoring bad file %ws\n", path.c_str());
+			return false;
+		}
+
+		output::DebugPrint(
+			output::dbgLevel::NamedPropCache,
+			L"loadFromDisk: loaded %u entries from %ws\n",
+			static_cast<UINT>(entries.size()),
+			path.c_str());
+		add(entries, sig);
+		return bComplete;
+	}
+
+	void namedPropCache::saveToDisk(_In_ const std::vector<BYTE>& sig, bool bComplete)
+	{
+		if (diskCachePath(sig).empty()) return;
+
+		const auto lock = std::lock_guard<std::mutex>(diskLock());
+		auto& state = diskState()[sig];
+		state.bComplete = state.bComplete || bComplete;
+		state.bDirty = true;
+	}
+
+	void namedPropCache::flushToDisk(_In_ const std::vector<BYTE>& sig)
+	{
+		const auto path = diskCachePath(sig);
+		if (path.empty()) return;
+
+		const auto lock = std::lock_guard<std::mutex>(diskLock());
+		auto& state = diskState()[sig];
+		if (!state.bDirty) return;
+
+		const auto bin = SerializeNamedProps(sig, getEntries(sig), state.bComplete);
+
+		// Write to the side and swap it in so a reader never sees a partial file
+		const auto tempPath = path + L".tmp";
+		const auto fOut = output::MyOpenFileMode(tempPath, L"wb");
+		if (!fOut) return;
+
+		const auto cbWritten = fwrite(bin.data(), 1, bin.size(), fOut);
+		output::CloseFile(fOut);
+		if (cbWritten != bin.size() || !MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+		{
+			output::DebugPrint(output::dbgLevel::NamedPropCache, L"flushToDisk: failed to write %ws\n", path.c_str());
+			DeleteFileW(tempPath.c_str());
+			return;
+		}
+
+		state.bDirty = false;
+	}
+
+	void namedPropCache::flushToDisk()
+	{
+		auto sigs = std::vector<std::vector<BYTE>>{};
+		{
+			const auto lock = std::lock_guard<std::mutex>(diskLock());
+			for (const auto& state : diskState())
+			{
+				if (state.second.bDirty) sigs.emplace_back(state.first);
+			}
+		}
+
+		for (const auto& sig : sigs)
+		{
+			flushToDisk(sig);
+		}
+	}
+
 	// If signature is empty then do not use a signature
 	_Check_return_ std::vector<std::shared_ptr<namedPropCacheEntry>> namedPropCache::GetNamesFromIDs(
 		_In_ LPMAPIPROP lpMAPIProp,
@@ -397,17 +788,72 @@ namespace cache
 	{
 		if (!lpMAPIProp) return {};
 
+		// Pick up anything we saved for this signature in an earlier run
+		const auto bCompleteOnDisk = loadFromDisk(sig);
+
 		// If this is a get all names call, we have to go direct to MAPI since we cannot trust the cache is full.
 		// Same if we don't have a signature at all as anything cached could be wrong
+		// The exception is a get all names call we've already answered and saved to disk. The store may have
+		// mapped more names since, so we only ask it about IDs past the highest one we have.
+		if (!lpPropTags && bCompleteOnDisk)
+		{
+			auto ulStart = __LOWERBOUND;
+			for (const auto& entry : getEntries(sig))
+			{
+				if (namedPropCacheEntry::valid(entry)) ulStart = max(ulStart, entry->getPropID() + 1);
+			}
+
+			const auto ulEnd = FindHighestNamedProp(lpMAPIProp);
+			output::DebugPrint(
+				output::dbgLevel::NamedPropCache,
+				L"GetNamesFromIDs: using saved walk for all props, walking 0x%X to 0x%X\n",
+				ulStart,
+				ulEnd);
+
+			auto hRes = S_OK;
+			auto names = std::vector<std::shared_ptr<namedPropCacheEntry>>{};
+			ULONG batchSize = registry::namedPropBatchSize;
+			if (!batchSize) batchSize = 1;
+			for (auto iTag = ulStart; SUCCEEDED(hRes) && iTag <= ulEnd; iTag += batchSize)
+			{
+				auto range = std::vector<std::shared_ptr<namedPropCacheEntry>>{};
+				hRes = WC_H(directMapi::GetRange(lpMAPIProp, iTag, min(iTag + batchSize - 1, ulEnd), range));
+				for (const auto& name : range)
+				{
+					if (name->getMapiNameId()->lpguid != nullptr) names.push_back(name);
+				}
+			}
+
+			// If the store wouldn't answer, fall back to a full walk below
+			if (SUCCEEDED(hRes))
+			{
+				if (!names.empty())
+				{
+					add(names, sig);
+					saveToDisk(sig, true);
+					flushToDisk(sig);
+				}
+
+				return getEntries(sig);
+			}
+		}
+
 		if (!lpPropTags || sig.empty())
 		{
 			output::DebugPrint(output::dbgLevel::NamedPropCache, L"GetNamesFromIDs: making direct all for all props\n");
 
 			std::vector<std::shared_ptr<namedPropCacheEntry>> names;
-			WC_H_S(directMapi::GetNamesFromIDs(lpMAPIProp, nullptr, NULL, names));
+			const auto hRes = WC_H(directMapi::GetNamesFromIDs(lpMAPIProp, nullptr, NULL, names));
 
 			// Cache the results
 			add(names, sig);
+			// Only a walk which got everything can answer later get all names calls.
+			// Anything less is saved as ordinary entries so we'll ask the store again next time.
+			if (!lpPropTags && (hRes == S_OK || !names.empty()))
+			{
+				saveToDisk(sig, hRes == S_OK);
+				flushToDisk(sig);
+			}
 
 			return names;
 		}
@@ -445,6 +891,7 @@ namespace cache
 
 			// Cache the results
 			add(missed, sig);
+			saveToDisk(sig, false);
 		}
 
 		// Second pass, do our lookup with a populated cache
@@ -477,6 +924,9 @@ namespace cache
 	{
 		if (!lpMAPIProp || !nameIDs.size()) return {};
 
+		// Pick up anything we saved for this signature in an earlier run
+		static_cast<void>(loadFromDisk(sig));
+
 		// We're going to walk the cache, looking for the values we need. As soon as we have all the values we need, we're done
 		// If we reach the end of the cache and don't have everything, we set up to make a GetIDsFromNames call.
 
@@ -510,6 +960,7 @@ namespace cache
 				output::DebugPrint(
 					output::dbgLevel::NamedPropCache, L"GetIDsFromNames: Add %d misses to cache\n", misses.size());
 				add(toCache, sig);
+				saveToDisk(sig, false);
 			}
 
 			MAPIFreeBuffer(missed);
@@ -1,4 +1,6 @@
 #pragma once
+#include <mutex>
+#include <shared_mutex>
 
 namespace cache
 {
@@ -30,7 +32,37 @@ namespace cache
 	class namedPropCache
 	{
 	private:
-		static std::vector<std::shared_ptr<namedPropCacheEntry>>& getCache() noexcept;
+		// Serializes add so two threads can't both decide an entry is missing and cache it twice
+		static std::mutex& getAddLock() noexcept;
+
+		// The cache is a set of indexes, keyed on signature + property ID, on signature + name, and on signature.
+		// Every entry is also indexed under an empty signature by ID and by name so unsigned lookups are indexed too.
+		// Each bucket holds its entries in the order they were cached, so lookups find the same entry a scan would.
+		// Keys are spread over shards, each with its own lock, so concurrent lookups rarely contend and never
+		// wait on a global lock.
+		using bucketMap = std::unordered_map<std::string, std::vector<std::shared_ptr<namedPropCacheEntry>>>;
+		struct shard
+		{
+			std::shared_mutex lock;
+			bucketMap byID;
+			bucketMap byName;
+			bucketMap bySig;
+		};
+		static constexpr size_t shardCount = 16;
+		static shard& getShard(const std::string& key) noexcept;
+		enum class indexType
+		{
+			id,
+			name,
+			sig
+		};
+		static bucketMap& getIndex(shard& _shard, indexType type) noexcept;
+		static void addToIndex(const std::shared_ptr<namedPropCacheEntry>& entry);
+		// Run compare over the entries filed under key, holding only that key's shard lock
+		_Check_return_ static std::shared_ptr<namedPropCacheEntry> findIndexed(
+			indexType type,
+			_In_ const std::string& key,
+			const std::function<bool(const std::shared_ptr<namedPropCacheEntry>&)>& compare);
 
 	public:
 		_Check_return_ static std::shared_ptr<namedPropCacheEntry>
@@ -47,6 +79,23 @@ namespace cache
 		// If not, we search without it
 		static void add(const std::vector<std::shared_ptr<namedPropCacheEntry>>& entries, const std::vector<BYTE>& sig);
 
+		// Every cached entry for a signature
+		_Check_return_ static std::vector<std::shared_ptr<namedPropCacheEntry>>
+		getEntries(_In_ const std::vector<BYTE>& sig);
+
+		// Optional on disk persistence, enabled by setting registry::namedPropCacheDir.
+		// Load any entries saved for this signature. Only the first call for a signature reads the file.
+		// Returns true if the saved entries came from a complete walk of the store's named props.
+		static bool loadFromDisk(_In_ const std::vector<BYTE>& sig);
+		// Note that this signature has new entries to save. Nothing is written until it's flushed,
+		// so a run of lookups which each cache a few entries rewrites the file once rather than every time.
+		// bComplete marks the entries as a complete walk. Once a signature is complete, it stays complete.
+		static void saveToDisk(_In_ const std::vector<BYTE>& sig, bool bComplete);
+		// Write every cached entry for this signature, if it has anything new to save
+		static void flushToDisk(_In_ const std::vector<BYTE>& sig);
+		// Write every signature with anything new to save. Call before shutting down.
+		static void flushToDisk();
+
 		// If signature is empty then do not use a signature
 		_Check_return_ static std::vector<std::shared_ptr<namedPropCacheEntry>> GetNamesFromIDs(
 			_In_ LPMAPIPROP lpMAPIProp,
@@ -60,4 +109,16 @@ namespace cache
 			_In_ std::vector<MAPINAMEID> nameIDs,
 			ULONG ulFlags);
 	};
+
+	// Compact binary form of a signature's cache entries, as persisted by namedPropCache::flushToDisk
+	std::vector<BYTE> SerializeNamedProps(
+		_In_ const std::vector<BYTE>& sig,
+		_In_ const std::vector<std::shared_ptr<namedPropCacheEntry>>& entries,
+		bool bComplete);
+	// Returns false, and no entries, if bin is malformed or was saved for a different signature
+	_Check_return_ bool DeserializeNamedProps(
+		_In_ const std::vector<BYTE>& bin,
+		_In_ const std::vector<BYTE>& sig,
+		_Out_ std::vector<std::shared_ptr<namedPropCacheEntry>>& entries,
+		_Out_ bool& bComplete);
 } // namespace cache
\ No newline at end of file
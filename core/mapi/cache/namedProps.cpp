@@ -180,7 +180,7 @@ namespace cache
 		SBinary sig = {};
 		LPSPropValue lpProp = nullptr;
 		// This error is too chatty to log - ignore it.
-		const auto hRes = HrGetOneProp(lpMAPIProp, PR_MAPPING_SIGNATURE, &lpProp);
+		const auto hRes = mapi::HrGetOnePropEx(lpMAPIProp, PR_MAPPING_SIGNATURE, NULL, &lpProp);
 		if (SUCCEEDED(hRes) && lpProp && PT_BINARY == PROP_TYPE(lpProp->ulPropTag))
 		{
 			sig = mapi::getBin(lpProp);
@@ -216,6 +216,76 @@ namespace cache
 		return namedPropCache::GetNamesFromIDs(lpMAPIProp, sigv, lpPropTags);
 	}
 
+	propArrayNames::propArrayNames(
+		ULONG cValues,
+		_In_opt_count_(cValues) const SPropValue* lpPropVals,
+		_In_opt_ LPMAPIPROP lpMAPIProp,
+		bool bIsAB)
+	{
+		// We check bIsAB here - some address book providers return garbage which will crash us
+		if (!cValues || !lpPropVals || !lpMAPIProp || bIsAB || !registry::parseNamedProps) return;
+
+		// First gather tags, once per prop ID
+		auto tags = std::vector<ULONG>{};
+		for (ULONG i = 0; i < cValues; i++)
+		{
+			const auto ulPropTag = lpPropVals[i].ulPropTag;
+			if ((registry::getPropNamesOnAllProps ||
+				 PROP_ID(ulPropTag) >= 0x8000) && // It's either a named prop or we're doing all props
+				names.emplace(PROP_ID(ulPropTag), namedPropCacheEntry::empty()).second)
+			{
+				tags.push_back(ulPropTag);
+			}
+		}
+
+		if (tags.empty()) return;
+
+		// Second get a mapping signature
+		const auto lpMappingSig = mapi::FindProp(lpPropVals, cValues, PR_MAPPING_SIGNATURE);
+		if (lpMappingSig && lpMappingSig->ulPropTag == PR_MAPPING_SIGNATURE)
+		{
+			lpSigBin = &mapi::getBin(lpMappingSig);
+		}
+		else
+		{
+			// This error is too chatty to log - ignore it.
+			const auto hRes = mapi::HrGetOnePropEx(lpMAPIProp, PR_MAPPING_SIGNATURE, NULL, &lpMappingSigFromObject);
+			if (SUCCEEDED(hRes) && lpMappingSigFromObject &&
+				lpMappingSigFromObject->ulPropTag == PR_MAPPING_SIGNATURE)
+			{
+				lpSigBin = &mapi::getBin(lpMappingSigFromObject);
+			}
+		}
+
+		// Third, look up all the tags at once
+		auto lpTags = mapi::allocate<LPSPropTagArray>(CbNewSPropTagArray(static_cast<ULONG>(tags.size())));
+		if (lpTags)
+		{
+			lpTags->cValues = static_cast<ULONG>(tags.size());
+			ULONG i = 0;
+			for (const auto tag : tags)
+			{
+				mapi::setTag(lpTags, i++) = tag;
+			}
+
+			for (const auto& name : GetNamesFromIDs(lpMAPIProp, lpSigBin, lpTags, NULL))
+			{
+				if (name && names.count(name->getPropID())) names[name->getPropID()] = name;
+			}
+
+			MAPIFreeBuffer(lpTags);
+		}
+	}
+
+	propArrayNames::~propArrayNames() { MAPIFreeBuffer(lpMappingSigFromObject); }
+
+	_Check_return_ const MAPINAMEID* propArrayNames::find(ULONG ulPropTag) const
+	{
+		const auto name = names.find(PROP_ID(ulPropTag));
+		if (name != names.end()) return name->second->getMapiNameId();
+		return namedPropCacheEntry::empty()->getMapiNameId();
+	}
+
 	_Check_return_ LPSPropTagArray
 	GetIDsFromNames(_In_ const LPMAPIPROP lpMAPIProp, _In_ std::vector<MAPINAMEID> nameIDs, _In_ ULONG ulFlags)
 	{
@@ -515,7 +585,7 @@ namespace cache
 	// If no hits, then ulNoMatch should be returned for lpulFirstExact
 	void FindNameIDArrayMatches(
 		_In_ LONG lTarget,
-		_In_count_(ulMyArray) NAMEID_ARRAY_ENTRY* MyArray,
+		_In_count_(ulMyArray) const NAMEID_ARRAY_ENTRY* MyArray,
 		_In_ ULONG ulMyArray,
 		_Out_ ULONG* lpulNumExacts,
 		_Out_ ULONG* lpulFirstExact) noexcept
@@ -597,20 +667,21 @@ namespace cache
 	}
 
 	// Search for properties matching lpszDispIDName on a substring
-	_Check_return_ LPNAMEID_ARRAY_ENTRY GetDispIDFromName(_In_z_ LPCWSTR lpszDispIDName)
+	_Check_return_ const NAMEID_ARRAY_ENTRY* GetDispIDFromName(_In_z_ LPCWSTR lpszDispIDName)
 	{
 		if (!lpszDispIDName) return nullptr;
 
-		const auto entry = find_if(begin(NameIDArray), end(NameIDArray), [&](NAMEID_ARRAY_ENTRY& nameID) noexcept {
-			if (0 == wcscmp(nameID.lpszName, lpszDispIDName))
-			{
-				// PSUNKNOWN is used as a placeholder in NameIDArray - don't return matching entries
-				if (!IsEqualGUID(*nameID.lpGuid, guid::PSUNKNOWN)) return true;
-			}
+		const auto entry =
+			std::find_if(NameIDArray.begin(), NameIDArray.end(), [&](const NAMEID_ARRAY_ENTRY& nameID) noexcept {
+				if (0 == wcscmp(nameID.lpszName, lpszDispIDName))
+				{
+					// PSUNKNOWN is used as a placeholder in NameIDArray - don't return matching entries
+					if (!IsEqualGUID(*nameID.lpGuid, guid::PSUNKNOWN)) return true;
+				}
 
-			return false;
-		});
+				return false;
+			});
 
-		return entry != end(NameIDArray) ? &(*entry) : nullptr;
+		return entry != NameIDArray.end() ? entry : nullptr;
 	}
 } // namespace cache
\ No newline at end of file
@@ -2,6 +2,8 @@
 // Named Property Cache
 #include <core/addin/addin.h>
 #include <core/addin/MFCMAPI.h>
+#include <atomic>
+#include <mutex>
 
 namespace cache
 {
@@ -41,15 +43,22 @@ namespace cache
 				   (item->mapiNameId.Kind.lID || item->mapiNameId.Kind.lpwstrName);
 		}
 		ULONG getPropID() const noexcept { return ulPropID; }
-		const NamePropNames& getNamePropNames() const noexcept { return namePropNames; }
-		void setNamePropNames(const NamePropNames& _namePropNames) noexcept
+		// Cached entries are shared across threads, so the strings are guarded
+		NamePropNames getNamePropNames() const
 		{
+			const auto lock = std::lock_guard<std::mutex>(namePropNamesLock);
+			return namePropNames;
+		}
+		void setNamePropNames(const NamePropNames& _namePropNames)
+		{
+			const auto lock = std::lock_guard<std::mutex>(namePropNamesLock);
 			namePropNames = _namePropNames;
 			bStringsCached = true;
 		}
 		bool hasCachedStrings() const noexcept { return bStringsCached; }
 		const MAPINAMEID* getMapiNameId() const noexcept { return &mapiNameId; }
 		void setSig(const std::vector<BYTE>& _sig) { sig = _sig; }
+		const std::vector<BYTE>& getSig() const noexcept { return sig; }
 
 		_Check_return_ bool
 		match(const std::shared_ptr<namedPropCacheEntry>& entry, bool bMatchID, bool bMatchName) const;
@@ -72,7 +81,8 @@ namespace cache
 		std::wstring name{};
 		std::vector<BYTE> sig{}; // Value of PR_MAPPING_SIGNATURE
 		NamePropNames namePropNames{};
-		bool bStringsCached{}; // We have cached strings
+		mutable std::mutex namePropNamesLock;
+		std::atomic<bool> bStringsCached{}; // We have cached strings
 	};
 
 	constexpr ULONG __LOWERBOUND = 0x8000;
@@ -93,6 +103,33 @@ namespace cache
 		_In_opt_ LPSPropTagArray lpPropTags,
 		ULONG ulFlags);
 
+	// Names for every named property in a property array, looked up once up front.
+	// The mapping signature comes from the array or a single GetProps on the object,
+	// then all the tags which need a name go to one GetNamesFromIDs.
+	class propArrayNames
+	{
+	public:
+		propArrayNames(
+			ULONG cValues,
+			_In_opt_count_(cValues) const SPropValue* lpPropVals,
+			_In_opt_ LPMAPIPROP lpMAPIProp,
+			bool bIsAB);
+		~propArrayNames();
+
+		propArrayNames(const propArrayNames&) = delete;
+		propArrayNames& operator=(const propArrayNames&) = delete;
+
+		// Borrowed from the array or owned by us. Do not free.
+		_Check_return_ const SBinary* getSig() const noexcept { return lpSigBin; }
+		// Never null. Tags without a name get an empty one so callers won't look them up again.
+		_Check_return_ const MAPINAMEID* find(ULONG ulPropTag) const;
+
+	private:
+		const SBinary* lpSigBin{};
+		LPSPropValue lpMappingSigFromObject{};
+		std::unordered_map<ULONG, std::shared_ptr<namedPropCacheEntry>> names;
+	};
+
 	_Check_return_ LPSPropTagArray
 	GetIDsFromNames(_In_ const LPMAPIPROP lpMAPIProp, _In_ std::vector<MAPINAMEID> nameIDs, _In_ ULONG ulFlags);
 
@@ -112,5 +149,5 @@ namespace cache
 		const std::function<bool(const std::shared_ptr<namedPropCacheEntry>&)>& compare);
 
 	void FindNameIDArrayMatches(_In_ LONG lTarget, _Out_ ULONG* lpulNumExacts, _Out_ ULONG* lpulFirstExact) noexcept;
-	_Check_return_ LPNAMEID_ARRAY_ENTRY GetDispIDFromName(_In_z_ LPCWSTR lpszDispIDName);
+	_Check_return_ const NAMEID_ARRAY_ENTRY* GetDispIDFromName(_In_z_ LPCWSTR lpszDispIDName);
 } // namespace cache
\ No newline at end of file
@@ -506,12 +506,14 @@ namespace output
 		Outputf(ulDbgLvl, fFile, true, L"End dumping notifications.\n");
 	}
 
-	void outputProperty(
+	void outputPropertyInternal(
 		dbgLevel ulDbgLvl,
 		_In_opt_ FILE* fFile,
 		_In_ LPSPropValue lpProp,
 		_In_opt_ LPMAPIPROP lpObj,
-		bool bRetryStreamProps)
+		bool bRetryStreamProps,
+		_In_opt_ const MAPINAMEID* lpNameID, // optional named property information to avoid GetNamesFromIDs call
+		_In_opt_ const SBinary* sig) // optional mapping signature for object to speed named prop lookups
 	{
 		if (earlyExit(ulDbgLvl, fFile)) return;
 
@@ -562,7 +564,7 @@ namespace output
 				false,
 				iIndent);
 
-		auto namePropNames = cache::NameIDToStrings(lpProp->ulPropTag, lpObj, nullptr, nullptr, false);
+		auto namePropNames = cache::NameIDToStrings(lpProp->ulPropTag, lpObj, lpNameID, sig, false);
 		if (!namePropNames.guid.empty())
 			OutputXMLValue(
 				ulDbgLvl,
@@ -583,7 +585,7 @@ namespace output
 		auto prop = property::parseProperty(lpProp);
 		Output(ulDbgLvl, fFile, false, strings::StripCarriage(prop.toXML(iIndent)));
 
-		auto szSmartView = smartview::parsePropertySmartView(lpProp, lpObj, nullptr, nullptr, false, false);
+		auto szSmartView = smartview::parsePropertySmartView(lpProp, lpObj, lpNameID, sig, false, false);
 		if (!szSmartView.empty())
 		{
 			OutputXMLValue(
@@ -595,6 +597,16 @@ namespace output
 		if (lpLargeProp) MAPIFreeBuffer(lpLargeProp);
 	}
 
+	void outputProperty(
+		dbgLevel ulDbgLvl,
+		_In_opt_ FILE* fFile,
+		_In_ LPSPropValue lpProp,
+		_In_opt_ LPMAPIPROP lpObj,
+		bool bRetryStreamProps)
+	{
+		outputPropertyInternal(ulDbgLvl, fFile, lpProp, lpObj, bRetryStreamProps, nullptr, nullptr);
+	}
+
 	void outputProperties(
 		dbgLevel ulDbgLvl,
 		_In_opt_ FILE* fFile,
@@ -635,9 +647,18 @@ namespace output
 				lpSortedProps[iLoc] = NextItem;
 			}
 
+			// Look up every named prop in the list at once instead of once per prop
+			const auto names = cache::propArrayNames(cProps, lpSortedProps, lpObj, false);
 			for (ULONG i = 0; i < cProps; i++)
 			{
-				outputProperty(ulDbgLvl, fFile, &lpSortedProps[i], lpObj, bRetryStreamProps);
+				outputPropertyInternal(
+					ulDbgLvl,
+					fFile,
+					&lpSortedProps[i],
+					lpObj,
+					bRetryStreamProps,
+					names.find(lpSortedProps[i].ulPropTag),
+					names.getSig());
 			}
 		}
 
@@ -54,11 +54,14 @@ namespace mapi::processor
 
 	dumpStore::~dumpStore()
 	{
-		output::DebugPrint(
-			output::dbgLevel::Console,
-			L"Output messages (%ws files) count: %d\n",
-			(m_bOutputMSG ? L"MSG" : L"XML"),
-			m_nOutputFileCount);
+		if (!m_bWorker)
+		{
+			output::DebugPrint(
+				output::dbgLevel::Console,
+				L"Output messages (%ws files) count: %d\n",
+				(m_bOutputMSG ? L"MSG" : L"XML"),
+				m_nOutputFileCount);
+		}
 
 		if (m_fFolderProps) output::CloseFile(m_fFolderProps);
 		if (m_fFolderContents) output::CloseFile(m_fFolderContents);
@@ -97,13 +100,33 @@ namespace mapi::processor
 
 	void dumpStore::DisableEmbeddedAttachments() noexcept { m_bOutputAttachments = false; }
 
+	std::unique_ptr<mapiProcessor> dumpStore::MakeWorker()
+	{
+		auto worker = std::make_unique<dumpStore>();
+		worker->m_szFolderPathRoot = m_szFolderPathRoot;
+		worker->m_szMessageFileName = m_szMessageFileName;
+		worker->m_bOutputMSG = m_bOutputMSG;
+		worker->m_bOutputList = m_bOutputList;
+		worker->m_bRetryStreamProps = m_bRetryStreamProps;
+		worker->m_bOutputAttachments = m_bOutputAttachments;
+		worker->m_properties = m_properties;
+		worker->m_namedProperties = m_namedProperties;
+		worker->m_bWorker = true;
+		return worker;
+	}
+
+	void dumpStore::MergeWorkerWork(_In_ mapiProcessor& worker)
+	{
+		m_nOutputFileCount += static_cast<dumpStore&>(worker).m_nOutputFileCount;
+	}
+
 	void dumpStore::BeginMailboxTableWork(_In_ const std::wstring& szExchangeServerName)
 	{
 		if (m_bOutputList) return;
 		const auto szTableContentsFile = strings::format(
 			L"%ws\\MAILBOX_TABLE.xml", // STRING_OK
 			m_szMailboxTablePathRoot.c_str());
-		m_fMailboxTable = output::MyOpenFile(szTableContentsFile, true);
+		m_fMailboxTable = output::MyOpenFile(szTableContentsFile, true, true);
 		if (m_fMailboxTable)
 		{
 			output::OutputToFile(m_fMailboxTable, output::g_szXMLHeader);
@@ -164,6 +187,9 @@ namespace mapi::processor
 
 	void dumpStore::EndStoreWork() noexcept {}
 
+	// A list only reads the contents table, but otherwise we dump every message we find
+	bool dumpStore::ShouldOpenMessagesAhead() noexcept { return !m_bOutputList; }
+
 	void dumpStore::BeginFolderWork()
 	{
 		auto hRes = S_OK;
@@ -237,7 +263,7 @@ namespace mapi::processor
 		if (m_szFolderPath.empty()) return;
 		if (m_bOutputList)
 		{
-			wprintf(L"Subject, Message Class, Filename\n");
+			FolderOutput(L"Subject, Message Class, Filename\n");
 			return;
 		}
 
@@ -245,7 +271,7 @@ namespace mapi::processor
 		const auto szContentsTableFile = ulFlags & MAPI_ASSOCIATED
 											 ? m_szFolderPath + L"ASSOCIATED_CONTENTS_TABLE.xml"
 											 : m_szFolderPath + L"CONTENTS_TABLE.xml"; // STRING_OK
-		m_fFolderContents = output::MyOpenFile(szContentsTableFile, true);
+		m_fFolderContents = output::MyOpenFile(szContentsTableFile, true, true);
 		if (m_fFolderContents)
 		{
 			output::OutputToFile(m_fFolderContents, output::g_szXMLHeader);
@@ -257,11 +283,11 @@ namespace mapi::processor
 		}
 	}
 
-	// Outputs a single message's details to the screen, so as to produce a list of messages
-	void OutputMessageList(_In_ const _SRow* lpSRow, _In_ const std::wstring& szFolderPath, bool bOutputMSG)
+	// Formats a single message's details for the screen, so as to produce a list of messages
+	std::wstring MessageListLine(_In_ const _SRow* lpSRow, _In_ const std::wstring& szFolderPath, bool bOutputMSG)
 	{
-		if (!lpSRow || szFolderPath.empty()) return;
-		if (szFolderPath.length() >= file::MAXMSGPATH) return;
+		if (!lpSRow || szFolderPath.empty()) return {};
+		if (szFolderPath.length() >= file::MAXMSGPATH) return {};
 
 		// Get required properties from the message
 		auto lpTemp = PpropFindProp(lpSRow->lpProps, lpSRow->cValues, PR_SUBJECT_W);
@@ -289,16 +315,18 @@ namespace mapi::processor
 		const auto lpMessageClass =
 			PpropFindProp(lpSRow->lpProps, lpSRow->cValues, CHANGE_PROP_TYPE(PR_MESSAGE_CLASS, PT_UNSPECIFIED));
 
-		wprintf(L"\"%ws\"", szSubj.c_str());
+		auto szLine = strings::format(L"\"%ws\"", szSubj.c_str());
 		if (lpMessageClass)
 		{
 			if (PT_STRING8 == PROP_TYPE(lpMessageClass->ulPropTag))
 			{
-				wprintf(L",\"%hs\"", lpMessageClass->Value.lpszA ? lpMessageClass->Value.lpszA : "");
+				szLine += strings::format(
+					L",\"%hs\"", lpMessageClass->Value.lpszA ? lpMessageClass->Value.lpszA : "");
 			}
 			else if (PT_UNICODE == PROP_TYPE(lpMessageClass->ulPropTag))
 			{
-				wprintf(L",\"%ws\"", lpMessageClass->Value.lpszW ? lpMessageClass->Value.lpszW : L"");
+				szLine += strings::format(
+					L",\"%ws\"", lpMessageClass->Value.lpszW ? lpMessageClass->Value.lpszW : L"");
 			}
 		}
 
@@ -306,14 +334,14 @@ namespace mapi::processor
 		if (bOutputMSG) szExt = L".msg"; // STRING_OK
 
 		auto szFileName = file::BuildFileNameAndPath(szExt, szSubj, szFolderPath, &recordKey);
-		wprintf(L",\"%ws\"\n", szFileName.c_str());
+		return szLine + strings::format(L",\"%ws\"\n", szFileName.c_str());
 	}
 
 	bool dumpStore::DoContentsTablePerRowWork(_In_ const _SRow* lpSRow, ULONG ulCurRow)
 	{
 		if (m_bOutputList)
 		{
-			OutputMessageList(lpSRow, m_szFolderPath, m_bOutputMSG);
+			FolderOutput(MessageListLine(lpSRow, m_szFolderPath, m_bOutputMSG));
 			return false;
 		}
 		if (!m_fFolderContents || !m_lpFolder) return true;
@@ -680,7 +708,12 @@ namespace mapi::processor
 		}
 	}
 
-	void OutputMessageXML(_In_ LPMESSAGE lpMessage, bool bRetryStreamProps, _In_opt_ LPVOID* lpData)
+	// exporting is called with each file's path before it's written
+	void OutputMessageXML(
+		_In_ LPMESSAGE lpMessage,
+		bool bRetryStreamProps,
+		_In_opt_ LPVOID* lpData,
+		const std::function<void(const std::wstring&)>& exporting)
 	{
 		if (!lpMessage || !lpData) return;
 
@@ -699,8 +732,7 @@ namespace mapi::processor
 
 		if (!lpMsgData->szFilePath.empty())
 		{
-			output::DebugPrint(
-				output::dbgLevel::Console, L"Exporting message properties to \"%ws\"\n", lpMsgData->szFilePath.c_str());
+			exporting(lpMsgData->szFilePath);
 			lpMsgData->fMessageProps = output::MyOpenFile(lpMsgData->szFilePath, true);
 
 			if (lpMsgData->fMessageProps)
@@ -781,7 +813,10 @@ namespace mapi::processor
 		MAPIFreeBuffer(lpAllProps);
 	}
 
-	void OutputMessageMSG(_In_ LPMESSAGE lpMessage, _In_ const std::wstring& szFolderPath)
+	void OutputMessageMSG(
+		_In_ LPMESSAGE lpMessage,
+		_In_ const std::wstring& szFolderPath,
+		const std::function<void(const std::wstring&)>& exporting)
 	{
 		enum
 		{
@@ -817,8 +852,7 @@ namespace mapi::processor
 		auto szFileName = file::BuildFileNameAndPath(L".msg", szSubj, szFolderPath, &recordKey); // STRING_OK
 		if (!szFileName.empty())
 		{
-			output::DebugPrint(
-				output::dbgLevel::Console, L"Exporting message properties to \"%ws\"\n", szFileName.c_str());
+			exporting(szFileName);
 
 			WC_H_S(file::SaveToMSG(lpMessage, szFileName, fMapiUnicode != 0, nullptr, false));
 		}
@@ -837,13 +871,17 @@ namespace mapi::processor
 
 		if (!MessageHasInterestingProperties(lpMessage)) return true;
 
+		// Goes with the folder's other screen output, so parallel walks print it in walk order
+		const auto exporting = [this](const std::wstring& szFilePath) {
+			FolderConsoleOutput(strings::format(L"Exporting message properties to \"%ws\"\n", szFilePath.c_str()));
+		};
 		if (m_bOutputMSG)
 		{
-			OutputMessageMSG(lpMessage, m_szFolderPath);
+			OutputMessageMSG(lpMessage, m_szFolderPath, exporting);
 		}
 		else
 		{
-			OutputMessageXML(lpMessage, m_bRetryStreamProps, lpData);
+			OutputMessageXML(lpMessage, m_bRetryStreamProps, lpData, exporting);
 		}
 
 		m_nOutputFileCount++;
@@ -37,6 +37,10 @@ namespace mapi::processor
 		void DisableEmbeddedAttachments() noexcept;
 
 	private:
+		// Each folder writes its own files, so workers can walk folders in parallel
+		std::unique_ptr<mapiProcessor> MakeWorker() override;
+		void MergeWorkerWork(_In_ mapiProcessor& worker) override;
+
 		// Worker functions (dump messages, scan for something, etc)
 		void BeginMailboxTableWork(_In_ const std::wstring& szExchangeServerName) override;
 		void DoMailboxTablePerRowWork(_In_ LPMDB lpMDB, _In_ const _SRow* lpSRow, ULONG ulCurRow) override;
@@ -44,6 +48,7 @@ namespace mapi::processor
 
 		void BeginStoreWork() noexcept override;
 		void EndStoreWork() noexcept override;
+		bool ShouldOpenMessagesAhead() noexcept override;
 
 		void BeginFolderWork() override;
 		void DoFolderPerHierarchyTableRowWork(_In_ const _SRow* lpSRow) override;
@@ -89,6 +94,7 @@ namespace mapi::processor
 		bool m_bRetryStreamProps;
 		bool m_bOutputAttachments;
 		int m_nOutputFileCount;
+		bool m_bWorker{}; // Made by MakeWorker. Our counts go to the original.
 
 		std::vector<std::wstring> m_properties;
 		std::vector<std::wstring> m_namedProperties;
@@ -0,0 +1,42 @@
+#pragma once
+// Processes a store/folder to find folders and messages by FID and MID
+#include <core/mapi/processor/mapiProcessor.h>
+
+namespace mapi::processor
+{
+	class findFidMid : public mapiProcessor
+	{
+	public:
+		findFidMid() = default;
+
+		// An empty FID or MID matches everything. Messages are only searched when bMid is set.
+		void InitFidMid(const std::wstring& szFid, const std::wstring& szMid, bool bMid);
+
+		// What we've output so far, including our workers' output
+		ULONG FoldersFound() const noexcept { return m_ulFoldersFound; }
+		ULONG MessagesFound() const noexcept { return m_ulMessagesFound; }
+
+	private:
+		// Folder state is all set up in BeginFolderWork, so workers only need what we're looking for
+		std::unique_ptr<mapiProcessor> MakeWorker() override;
+		void MergeWorkerWork(_In_ mapiProcessor& worker) override;
+
+		bool ContinueProcessingFolders() noexcept override;
+		bool ShouldProcessContentsTable() noexcept override;
+		void BeginFolderWork() override;
+		void BeginContentsTableWork(ULONG ulFlags, ULONG ulCountRows) override;
+		bool DoContentsTablePerRowWork(_In_ const _SRow* lpSRow, ULONG ulCurRow) override;
+
+		std::wstring m_szFid;
+		std::wstring m_szMid;
+		std::wstring m_szCurrentFid;
+
+		bool m_bMid{};
+		bool m_fFIDMatch{};
+		bool m_fFIDExactMatch{};
+		bool m_fFIDPrinted{};
+		bool m_fAssociated{};
+		ULONG m_ulFoldersFound{};
+		ULONG m_ulMessagesFound{};
+	};
+} // namespace mapi::processor
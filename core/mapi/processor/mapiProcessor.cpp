@@ -1,5 +1,6 @@
 #include <core/stdafx.h>
 #include <core/mapi/processor/mapiProcessor.h>
+#include <core/mapi/processor/rowPipeline.h>
 #include <core/mapi/mapiStoreFunctions.h>
 #include <core/mapi/columnTags.h>
 #include <core/utility/strings.h>
@@ -7,9 +8,41 @@
 #include <core/utility/output.h>
 #include <core/mapi/mapiFunctions.h>
 #include <core/utility/error.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 
 namespace mapi::processor
 {
+	// Folders shared by workers walking in parallel
+	struct folderWalk
+	{
+		std::mutex lock;
+		std::condition_variable changed;
+		std::deque<FolderNode> folders;
+		ULONG ulBusy{}; // Workers with a folder open. They may add more folders.
+		bool bStopped{}; // A folder's ContinueProcessingFolders returned false
+		std::vector<ULONG> stopOrder; // Walk order of the earliest such folder
+		std::vector<std::pair<std::vector<ULONG>, std::wstring>> output; // FolderOutput by walk order
+	};
+
+	namespace
+	{
+		// Serial walks are breadth first: shallower folders first, then by hierarchy table row
+		bool WalkOrderBefore(const std::vector<ULONG>& a, const std::vector<ULONG>& b)
+		{
+			if (a.size() != b.size()) return a.size() < b.size();
+			return a < b;
+		}
+
+		// True if a serial walk would have stopped before reaching walkOrder. Call with walk.lock held.
+		bool StoppedBefore(const folderWalk& walk, const std::vector<ULONG>& walkOrder)
+		{
+			return walk.bStopped && WalkOrderBefore(walk.stopOrder, walkOrder);
+		}
+	} // namespace
+
 	mapiProcessor::mapiProcessor() noexcept
 	{
 		m_lpSession = nullptr;
@@ -18,6 +51,8 @@ namespace mapi::processor
 		m_lpResFolderContents = nullptr;
 		m_lpSort = nullptr;
 		m_ulCount = 0;
+		// Smaller tables are read inline. A second folder and table aren't worth opening for them.
+		m_ulPipelineRows = 64;
 	}
 
 	mapiProcessor::~mapiProcessor()
@@ -50,6 +85,8 @@ namespace mapi::processor
 		m_lpFolder = lpFolder;
 		if (m_lpFolder) m_lpFolder->AddRef();
 		m_szFolderOffset = L"\\"; // STRING_OK
+		m_walkOrder.clear();
+		m_ulChildFolders = 0;
 	}
 
 	void mapiProcessor::InitFolderContentsRestriction(_In_opt_ LPSRestriction lpRes) noexcept
@@ -68,6 +105,10 @@ namespace mapi::processor
 		m_lpSort = lpSort;
 	}
 
+	void mapiProcessor::InitWorkers(_In_ ULONG ulWorkers) noexcept { m_ulWorkers = ulWorkers; }
+
+	void mapiProcessor::InitPipelineRows(_In_ ULONG ulRows) noexcept { m_ulPipelineRows = ulRows; }
+
 	// --------------------------------------------------------------------------------- //
 
 	// Server name MUST be passed
@@ -178,21 +219,194 @@ namespace mapi::processor
 				OpenFirstFolderInList();
 			}
 
+			auto bWorkersDone = false;
 			while (m_lpFolder)
 			{
 				DoProcessFoldersPerFolderWork();
 				ProcessFolder(bDoRegular, bDoAssociated, bDoDescent);
 				if (!ContinueProcessingFolders()) break;
+
+				// The first folder fills the list, then workers can take it from there
+				if (m_ulWorkers > 1 && !bWorkersDone && !m_List.empty())
+				{
+					bWorkersDone = true;
+					ProcessFoldersInParallel(bDoRegular, bDoAssociated, bDoDescent);
+				}
+
 				OpenFirstFolderInList();
 			}
 		}
+
+		// The pipeline's thread is only kept for the length of a walk
+		m_lpPipeline.reset();
 		EndProcessFoldersWork();
 	}
 
+	void mapiProcessor::ProcessFoldersInParallel(bool bDoRegular, bool bDoAssociated, bool bDoDescent)
+	{
+		auto walk = folderWalk{};
+		auto workers = std::vector<std::unique_ptr<mapiProcessor>>{};
+		while (workers.size() < m_ulWorkers)
+		{
+			auto worker = MakeWorker();
+			if (!worker) break;
+			worker->InitSession(m_lpSession);
+			worker->InitMDB(m_lpMDB);
+			worker->m_lpResFolderContents = m_lpResFolderContents;
+			worker->m_lpSort = m_lpSort;
+			worker->m_ulCount = m_ulCount;
+			worker->m_ulPipelineRows = m_ulPipelineRows;
+			worker->m_lpWalk = &walk;
+			workers.push_back(std::move(worker));
+		}
+
+		if (workers.empty()) return;
+
+		output::DebugPrint(
+			output::dbgLevel::Generic,
+			L"ProcessFoldersInParallel: Walking %zu folders on %zu workers\n",
+			m_List.size(),
+			workers.size());
+		walk.folders.swap(m_List);
+
+		auto threads = std::vector<std::thread>{};
+		for (const auto& worker : workers)
+		{
+			threads.emplace_back([&, lpWorker = worker.get()] {
+				// Every thread which uses MAPI needs its own MAPIInitialize
+				if (FAILED(EC_MAPI(MAPIInitialize(nullptr)))) return;
+				lpWorker->WalkFolders(bDoRegular, bDoAssociated, bDoDescent);
+				MAPIUninitialize();
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		for (const auto& worker : workers)
+		{
+			MergeWorkerWork(*worker);
+		}
+
+		// Write what the workers held in serial walk order, stopping where a serial walk would have stopped
+		std::stable_sort(walk.output.begin(), walk.output.end(), [](const auto& a, const auto& b) {
+			return WalkOrderBefore(a.first, b.first);
+		});
+		for (const auto& folder : walk.output)
+		{
+			if (walk.bStopped && WalkOrderBefore(walk.stopOrder, folder.first)) break;
+			wprintf(L"%ws", folder.second.c_str());
+		}
+
+		// Only left over if no worker could start. The caller walks them serially.
+		m_List.swap(walk.folders);
+	}
+
+	void mapiProcessor::WalkFolders(bool bDoRegular, bool bDoAssociated, bool bDoDescent)
+	{
+		if (!m_lpWalk) return;
+		auto& walk = *m_lpWalk;
+
+		BeginWorkerWork();
+		for (;;)
+		{
+			auto node = FolderNode{};
+			auto bFolder = false;
+			{
+				auto lock = std::unique_lock<std::mutex>(walk.lock);
+				while (!bFolder)
+				{
+					// Wait for a folder, or for every busy worker to finish without adding one
+					walk.changed.wait(lock, [&] { return !walk.folders.empty() || !walk.ulBusy; });
+					if (walk.folders.empty()) break;
+
+					node = std::move(walk.folders.front());
+					walk.folders.pop_front();
+					// A serial walk would have stopped before this folder
+					if (StoppedBefore(walk, node.walkOrder))
+					{
+						MAPIFreeBuffer(node.lpFolderEID);
+						continue;
+					}
+
+					bFolder = true;
+					walk.ulBusy++;
+				}
+			}
+
+			if (!bFolder) break;
+
+			OpenFolder(node);
+
+			// Another worker may have stopped the walk while we were opening this one.
+			// Check again so we don't write anything for a folder a serial walk wouldn't have reached.
+			auto bSkip = false;
+			{
+				const auto lock = std::lock_guard<std::mutex>(walk.lock);
+				bSkip = StoppedBefore(walk, m_walkOrder);
+			}
+
+			if (m_lpFolder && !bSkip)
+			{
+				DoProcessFoldersPerFolderWork();
+				ProcessFolder(bDoRegular, bDoAssociated, bDoDescent);
+			}
+
+			const auto bContinue = bSkip || !m_lpFolder || ContinueProcessingFolders();
+			{
+				const auto lock = std::lock_guard<std::mutex>(walk.lock);
+				if (!m_szFolderText.empty()) walk.output.emplace_back(m_walkOrder, std::move(m_szFolderText));
+				m_szFolderText.clear();
+				if (!bContinue && (!walk.bStopped || WalkOrderBefore(m_walkOrder, walk.stopOrder)))
+				{
+					walk.bStopped = true;
+					walk.stopOrder = m_walkOrder;
+				}
+
+				walk.ulBusy--;
+			}
+
+			walk.changed.notify_all();
+		}
+
+		if (m_lpFolder) m_lpFolder->Release();
+		m_lpFolder = nullptr;
+		m_lpPipeline.reset();
+		EndWorkerWork();
+	}
+
+	void mapiProcessor::FolderOutput(_In_ const std::wstring& szText)
+	{
+		if (m_lpWalk)
+		{
+			m_szFolderText += szText;
+		}
+		else
+		{
+			wprintf(L"%ws", szText.c_str());
+		}
+	}
+
+	void mapiProcessor::FolderConsoleOutput(_In_ const std::wstring& szText)
+	{
+		if (m_lpWalk)
+		{
+			if (output::fIsSet(output::dbgLevel::Console)) m_szFolderText += szText;
+		}
+		else
+		{
+			output::DebugPrint(output::dbgLevel::Console, L"%ws", szText.c_str());
+		}
+	}
+
 	bool mapiProcessor::ContinueProcessingFolders() noexcept { return true; }
 
 	bool mapiProcessor::ShouldProcessContentsTable() noexcept { return true; }
 
+	bool mapiProcessor::ShouldOpenMessagesAhead() noexcept { return false; }
+
 	void mapiProcessor::ProcessFolder(bool bDoRegular, bool bDoAssociated, bool bDoDescent)
 	{
 		if (!m_lpMDB || !m_lpFolder) return;
@@ -242,6 +456,9 @@ namespace mapi::processor
 
 				if (SUCCEEDED(hRes))
 				{
+					// Sibling folders can share a name, or sanitize to the same one. Number the later ones so each
+					// folder gets a path of its own, and workers walking them at once don't write to the same files.
+					auto childOffsets = std::unordered_set<std::wstring>{};
 					for (;;)
 					{
 						if (lpRows) FreeProws(lpRows);
@@ -259,7 +476,7 @@ namespace mapi::processor
 							DoFolderPerHierarchyTableRowWork(&lpRows->aRow[ulRow]);
 							if (lpRows->aRow[ulRow].lpProps)
 							{
-								std::wstring szSubFolderOffset; // Holds subfolder name
+								std::wstring szSubFolder = L"UnknownFolder"; // STRING_OK
 
 								const auto lpFolderDisplayName = PpropFindProp(
 									lpRows->aRow[ulRow].lpProps, lpRows->aRow[ulRow].cValues, PR_DISPLAY_NAME);
@@ -267,14 +484,18 @@ namespace mapi::processor
 								if (strings::CheckStringProp(lpFolderDisplayName, PT_TSTRING))
 								{
 									// Clean up the folder name before appending it to the offset
-									szSubFolderOffset = m_szFolderOffset +
-														strings::SanitizeFileName(strings::LPCTSTRToWstring(
-															lpFolderDisplayName->Value.LPSZ)) +
-														L"\\"; // STRING_OK
+									szSubFolder = strings::SanitizeFileName(
+										strings::LPCTSTRToWstring(lpFolderDisplayName->Value.LPSZ));
 								}
-								else
+
+								auto szSubFolderOffset = m_szFolderOffset + szSubFolder + L"\\"; // STRING_OK
+								// Paths are case insensitive
+								for (ULONG ulCopy = 2;
+									 !childOffsets.insert(strings::wstringToLower(szSubFolderOffset)).second;
+									 ulCopy++)
 								{
-									szSubFolderOffset = m_szFolderOffset + L"UnknownFolder\\"; // STRING_OK
+									szSubFolderOffset = m_szFolderOffset +
+														strings::format(L"%ws (%u)\\", szSubFolder.c_str(), ulCopy);
 								}
 
 								AddFolderToFolderList(
@@ -320,95 +541,176 @@ namespace mapi::processor
 			 PidTagMid},
 		};
 
-		LPMAPITABLE lpContentsTable = nullptr;
-
-		auto hRes = WC_MAPI(m_lpFolder->GetContentsTable(ulFlags | fMapiUnicode, &lpContentsTable));
-		if (SUCCEEDED(hRes) && lpContentsTable)
-		{
-			hRes = WC_MAPI(lpContentsTable->SetColumns(LPSPropTagArray(&contCols), TBL_BATCH));
-		}
-
-		if (SUCCEEDED(hRes) && lpContentsTable && m_lpResFolderContents)
+		if (m_lpResFolderContents)
 		{
 			output::outputRestriction(output::dbgLevel::Generic, nullptr, m_lpResFolderContents, nullptr);
-			WC_MAPI_S(lpContentsTable->Restrict(m_lpResFolderContents, TBL_BATCH));
 		}
 
-		if (SUCCEEDED(hRes) && lpContentsTable && m_lpSort)
+		// Big tables are read, and their messages opened, ahead of us on the pipeline's thread, which opens its own
+		// table. We only open one ourselves if we read it inline.
+		if (!ProcessContentsTablePipelined(ulFlags, LPSPropTagArray(&contCols)))
 		{
-			WC_MAPI_S(lpContentsTable->SortTable(const_cast<LPSSortOrderSet>(m_lpSort), TBL_BATCH));
-		}
+			LPMAPITABLE lpContentsTable = nullptr;
 
-		if (SUCCEEDED(hRes) && lpContentsTable)
-		{
-			ULONG ulCountRows = 0;
-			WC_MAPI_S(lpContentsTable->GetRowCount(0, &ulCountRows));
+			auto hRes = WC_MAPI(m_lpFolder->GetContentsTable(ulFlags | fMapiUnicode, &lpContentsTable));
+			if (SUCCEEDED(hRes) && lpContentsTable)
+			{
+				hRes = WC_MAPI(lpContentsTable->SetColumns(LPSPropTagArray(&contCols), TBL_BATCH));
+			}
 
-			BeginContentsTableWork(ulFlags, ulCountRows);
+			if (SUCCEEDED(hRes) && lpContentsTable && m_lpResFolderContents)
+			{
+				WC_MAPI_S(lpContentsTable->Restrict(m_lpResFolderContents, TBL_BATCH));
+			}
 
-			LPSRowSet lpRows = nullptr;
-			ULONG i = 0;
-			for (;;)
+			if (SUCCEEDED(hRes) && lpContentsTable && m_lpSort)
 			{
-				// If we've output enough rows, stop
-				if (m_ulCount && i >= m_ulCount) break;
-				if (lpRows) FreeProws(lpRows);
-				lpRows = nullptr;
-				hRes = WC_MAPI(lpContentsTable->QueryRows(255, NULL, &lpRows));
-				if (FAILED(hRes))
-				{
-					break;
-				}
+				WC_MAPI_S(lpContentsTable->SortTable(const_cast<LPSSortOrderSet>(m_lpSort), TBL_BATCH));
+			}
 
-				if (!lpRows || !lpRows->cRows) break;
+			if (SUCCEEDED(hRes) && lpContentsTable)
+			{
+				ULONG ulCountRows = 0;
+				WC_MAPI_S(lpContentsTable->GetRowCount(0, &ulCountRows));
 
-				for (ULONG iRow = 0; iRow < lpRows->cRows; iRow++)
+				BeginContentsTableWork(ulFlags, ulCountRows);
+
+				LPSRowSet lpRows = nullptr;
+				ULONG i = 0;
+				for (;;)
 				{
 					// If we've output enough rows, stop
 					if (m_ulCount && i >= m_ulCount) break;
-					if (!DoContentsTablePerRowWork(&lpRows->aRow[iRow], i++)) continue;
-
-					const auto lpMsgEID =
-						PpropFindProp(lpRows->aRow[iRow].lpProps, lpRows->aRow[iRow].cValues, PR_ENTRYID);
-
-					if (!lpMsgEID) continue;
-
-					const auto bin = mapi::getBin(lpMsgEID);
-					auto lpMessage = mapi::CallOpenEntry<LPMESSAGE>(
-						nullptr,
-						nullptr,
-						m_lpFolder,
-						nullptr,
-						bin.cb,
-						reinterpret_cast<LPENTRYID>(bin.lpb),
-						nullptr,
-						MAPI_BEST_ACCESS,
-						nullptr);
-					if (lpMessage)
+					if (lpRows) FreeProws(lpRows);
+					lpRows = nullptr;
+					hRes = WC_MAPI(lpContentsTable->QueryRows(255, NULL, &lpRows));
+					if (FAILED(hRes))
 					{
-						auto bHasAttach = true;
-						const auto lpMsgHasAttach =
-							PpropFindProp(lpRows->aRow[iRow].lpProps, lpRows->aRow[iRow].cValues, PR_HASATTACH);
-						if (lpMsgHasAttach)
-						{
-							bHasAttach = 0 != lpMsgHasAttach->Value.b;
-						}
-
-						ProcessMessage(lpMessage, bHasAttach, nullptr);
-						lpMessage->Release();
+						break;
 					}
 
-					lpMessage = nullptr;
+					if (!lpRows || !lpRows->cRows) break;
+
+					for (ULONG iRow = 0; iRow < lpRows->cRows; iRow++)
+					{
+						// If we've output enough rows, stop
+						if (m_ulCount && i >= m_ulCount) break;
+						ProcessContentsTableRow(&lpRows->aRow[iRow], i++, nullptr, false);
+					}
 				}
+
+				if (lpRows) FreeProws(lpRows);
 			}
 
-			if (lpRows) FreeProws(lpRows);
-			lpContentsTable->Release();
+			if (lpContentsTable) lpContentsTable->Release();
 		}
 
 		EndContentsTableWork();
 	}
 
+	bool mapiProcessor::ProcessContentsTablePipelined(ULONG ulFlags, _In_ LPSPropTagArray lpColumns)
+	{
+		if (!m_ulPipelineRows) return false;
+
+		// The folder's message count tells us whether the table's worth a pipeline before anyone opens it.
+		// Restrictions only shrink it, so we may pipeline a table which turns out small, but won't miss a big one.
+		// The pipeline opens its own copy of the folder.
+		enum
+		{
+			folderPR_ENTRYID,
+			folderPR_CONTENT_COUNT,
+			folderNUM_COLS
+		};
+		const SizedSPropTagArray(folderNUM_COLS, sptaFolderProps) = {
+			folderNUM_COLS,
+			{PR_ENTRYID, (ulFlags & MAPI_ASSOCIATED) ? PR_ASSOC_CONTENT_COUNT : PR_CONTENT_COUNT},
+		};
+		ULONG cValues = 0;
+		LPSPropValue lpProps = nullptr;
+		WC_H_GETPROPS_S(m_lpFolder->GetProps(LPSPropTagArray(&sptaFolderProps), NULL, &cValues, &lpProps));
+		if (!lpProps || lpProps[folderPR_ENTRYID].ulPropTag != PR_ENTRYID ||
+			lpProps[folderPR_CONTENT_COUNT].ulPropTag != sptaFolderProps.aulPropTag[folderPR_CONTENT_COUNT] ||
+			static_cast<ULONG>(lpProps[folderPR_CONTENT_COUNT].Value.l) < m_ulPipelineRows)
+		{
+			MAPIFreeBuffer(lpProps);
+			return false;
+		}
+
+		if (!m_lpPipeline) m_lpPipeline = std::make_unique<rowPipeline>();
+
+		auto table = pipelineTable{};
+		table.lpMDB = m_lpMDB;
+		table.folderEID = mapi::getBin(lpProps[folderPR_ENTRYID]);
+		table.ulFlags = ulFlags | fMapiUnicode;
+		table.lpColumns = lpColumns;
+		table.lpRes = m_lpResFolderContents;
+		table.lpSort = m_lpSort;
+		table.ulMaxRows = m_ulCount;
+		table.bOpenMessages = ShouldOpenMessagesAhead();
+		const auto bStarted = m_lpPipeline->start(table);
+		MAPIFreeBuffer(lpProps);
+		if (!bStarted) return false;
+
+		BeginContentsTableWork(ulFlags, m_lpPipeline->rowCount());
+
+		ULONG i = 0;
+		for (;;)
+		{
+			auto row = m_lpPipeline->next();
+			if (!row.lpRow) break;
+			ProcessContentsTableRow(row.lpRow, i++, row.lpMessage, row.bOpened);
+		}
+
+		m_lpPipeline->stop();
+		return true;
+	}
+
+	void mapiProcessor::ProcessContentsTableRow(
+		_In_ const _SRow* lpSRow,
+		ULONG ulCurRow,
+		_In_opt_ LPMESSAGE lpOpened,
+		bool bOpened)
+	{
+		if (!DoContentsTablePerRowWork(lpSRow, ulCurRow)) return;
+
+		auto lpMessage = lpOpened;
+		if (lpMessage)
+		{
+			lpMessage->AddRef();
+		}
+		else if (!bOpened)
+		{
+			const auto lpMsgEID = PpropFindProp(lpSRow->lpProps, lpSRow->cValues, PR_ENTRYID);
+
+			if (!lpMsgEID) return;
+
+			const auto bin = mapi::getBin(lpMsgEID);
+			lpMessage = mapi::CallOpenEntry<LPMESSAGE>(
+				nullptr,
+				nullptr,
+				m_lpFolder,
+				nullptr,
+				bin.cb,
+				reinterpret_cast<LPENTRYID>(bin.lpb),
+				nullptr,
+				MAPI_BEST_ACCESS,
+				nullptr);
+		}
+
+		if (lpMessage)
+		{
+			auto bHasAttach = true;
+			const auto lpMsgHasAttach = PpropFindProp(lpSRow->lpProps, lpSRow->cValues, PR_HASATTACH);
+			if (lpMsgHasAttach)
+			{
+				bHasAttach = 0 != lpMsgHasAttach->Value.b;
+			}
+
+			ProcessMessage(lpMessage, bHasAttach, nullptr);
+			lpMessage->Release();
+		}
+	}
+
 	void mapiProcessor::ProcessMessage(_In_ LPMESSAGE lpMessage, bool bHasAttach, _In_opt_ LPVOID lpParentMessageData)
 	{
 		if (!lpMessage) return;
@@ -571,6 +873,19 @@ namespace mapi::processor
 		FolderNode newNode{};
 		newNode.szFolderOffsetPath = szFolderOffsetPath;
 		newNode.lpFolderEID = lpFolderEID ? CopySBinary(lpFolderEID) : nullptr;
+		newNode.walkOrder = m_walkOrder;
+		newNode.walkOrder.push_back(m_ulChildFolders++);
+
+		if (m_lpWalk)
+		{
+			{
+				const auto lock = std::lock_guard<std::mutex>(m_lpWalk->lock);
+				m_lpWalk->folders.push_back(std::move(newNode));
+			}
+
+			m_lpWalk->changed.notify_one();
+			return;
+		}
 
 		m_List.push_back(newNode);
 	}
@@ -579,28 +894,34 @@ namespace mapi::processor
 	// If we fail to open a folder, move on to the next item in the list
 	void mapiProcessor::OpenFirstFolderInList()
 	{
-		LPMAPIFOLDER lpFolder = nullptr;
 		m_szFolderOffset.clear();
 
 		if (m_lpFolder) m_lpFolder->Release();
 		m_lpFolder = nullptr;
 
 		// loop over nodes until we open one or run out
-		while (!lpFolder && !m_List.empty())
+		while (!m_lpFolder && !m_List.empty())
 		{
 			auto node = m_List.front();
-			lpFolder = mapi::CallOpenEntry<LPMAPIFOLDER>(
-				m_lpMDB, nullptr, nullptr, nullptr, node.lpFolderEID, nullptr, MAPI_BEST_ACCESS, nullptr);
-			if (!node.szFolderOffsetPath.empty())
-			{
-				m_szFolderOffset = node.szFolderOffsetPath;
-			}
-
-			MAPIFreeBuffer(node.lpFolderEID);
 			m_List.pop_front();
+			OpenFolder(node);
 		}
+	}
 
-		m_lpFolder = lpFolder;
+	void mapiProcessor::OpenFolder(_In_ FolderNode& node)
+	{
+		if (m_lpFolder) m_lpFolder->Release();
+		m_lpFolder = mapi::CallOpenEntry<LPMAPIFOLDER>(
+			m_lpMDB, nullptr, nullptr, nullptr, node.lpFolderEID, nullptr, MAPI_BEST_ACCESS, nullptr);
+		if (!node.szFolderOffsetPath.empty())
+		{
+			m_szFolderOffset = node.szFolderOffsetPath;
+		}
+
+		m_walkOrder = node.walkOrder;
+		m_ulChildFolders = 0;
+		MAPIFreeBuffer(node.lpFolderEID);
+		node.lpFolderEID = nullptr;
 	}
 
 	// Clean up the list
@@ -624,6 +945,14 @@ namespace mapi::processor
 
 	void mapiProcessor::EndMailboxTableWork() {}
 
+	std::unique_ptr<mapiProcessor> mapiProcessor::MakeWorker() { return nullptr; }
+
+	void mapiProcessor::BeginWorkerWork() {}
+
+	void mapiProcessor::EndWorkerWork() {}
+
+	void mapiProcessor::MergeWorkerWork(_In_ mapiProcessor& /*worker*/) {}
+
 	void mapiProcessor::BeginStoreWork() noexcept {}
 
 	void mapiProcessor::EndStoreWork() noexcept {}
@@ -1,5 +1,6 @@
 #pragma once
 #include <deque>
+#include <memory>
 
 namespace mapi::processor
 {
@@ -10,14 +11,22 @@ namespace mapi::processor
 		This class handles the nitty-gritty work of walking through contents and hierarchy tables
 		It calls worker functions to do the customizable work on each object
 		These worker functions are intended to be overridden by specialized classes inheriting from this class
+
+		Folders can be walked on several threads. See InitWorkers and MakeWorker.
 		*/
 
 	struct FolderNode final
 	{
 		LPSBinary lpFolderEID{};
 		std::wstring szFolderOffsetPath;
+		// Hierarchy table row of each folder on the way down from the first folder.
+		// Ordered by length then value, this is the order a serial walk visits folders in.
+		std::vector<ULONG> walkOrder;
 	};
 
+	struct folderWalk;
+	class rowPipeline;
+
 	class mapiProcessor
 	{
 	public:
@@ -31,6 +40,11 @@ namespace mapi::processor
 		void InitFolderContentsRestriction(_In_opt_ LPSRestriction lpRes) noexcept;
 		void InitMaxOutput(_In_ ULONG ulCount) noexcept;
 		void InitSortOrder(_In_ const _SSortOrderSet* lpSort) noexcept;
+		// Walk folders after the first on up to ulWorkers threads, if MakeWorker supports it
+		void InitWorkers(_In_ ULONG ulWorkers) noexcept;
+		// Read contents tables with at least ulRows rows ahead of us on a thread of our own.
+		// 0 reads every table inline.
+		void InitPipelineRows(_In_ ULONG ulRows) noexcept;
 
 		// Processing functions
 		void ProcessMailboxTable(_In_ const std::wstring& szExchangeServerName);
@@ -44,7 +58,24 @@ namespace mapi::processor
 		LPMAPIFOLDER m_lpFolder;
 		std::wstring m_szFolderOffset; // Offset to the folder, including trailing slash
 
+		// Console output for the current folder. Written straight out when walking folders serially.
+		// Workers hold on to it, and it's written in serial walk order once all the workers are done.
+		void FolderOutput(_In_ const std::wstring& szText);
+		// Debug output at the Console level for the current folder. Workers hold it with FolderOutput's text.
+		void FolderConsoleOutput(_In_ const std::wstring& szText);
+
 	private:
+		// Parallel folder walking
+		// MakeWorker returns a new processor, set up like this one, for a worker thread to walk folders with.
+		// Return nullptr to walk serially. Session, store, restriction, sort, count and pipeline rows are copied.
+		// Workers each open their own folders and messages and call the usual worker functions on their own thread.
+		// Begin/EndWorkerWork are called on the worker's thread before its first folder and after its last.
+		// MergeWorkerWork is called on the original thread for each worker, in order, after they've all finished.
+		virtual std::unique_ptr<mapiProcessor> MakeWorker();
+		virtual void BeginWorkerWork();
+		virtual void EndWorkerWork();
+		virtual void MergeWorkerWork(_In_ mapiProcessor& worker);
+
 		// Worker functions (dump messages, scan for something, etc)
 		virtual void BeginMailboxTableWork(_In_ const std::wstring& szExchangeServerName);
 		virtual void DoMailboxTablePerRowWork(_In_ LPMDB lpMDB, _In_ const _SRow* lpSRow, ULONG ulCurRow);
@@ -55,6 +86,9 @@ namespace mapi::processor
 
 		virtual bool ContinueProcessingFolders() noexcept;
 		virtual bool ShouldProcessContentsTable() noexcept;
+		// Return true if DoContentsTablePerRowWork takes most rows, so messages can be opened before it's asked.
+		// Messages it turns down are released unused.
+		virtual bool ShouldOpenMessagesAhead() noexcept;
 		virtual void BeginProcessFoldersWork() noexcept;
 		virtual void DoProcessFoldersPerFolderWork() noexcept;
 		virtual void EndProcessFoldersWork() noexcept;
@@ -96,7 +130,22 @@ namespace mapi::processor
 		virtual void EndMessageWork(_In_ LPMESSAGE lpMessage, _In_opt_ LPVOID lpData);
 
 		void ProcessFolder(bool bDoRegular, bool bDoAssociated, bool bDoDescent);
+		// Hand the folder list out to workers. Anything they couldn't walk is left in the list.
+		void ProcessFoldersInParallel(bool bDoRegular, bool bDoAssociated, bool bDoDescent);
+		// Worker thread loop: take folders from the shared walk until it's done
+		void WalkFolders(bool bDoRegular, bool bDoAssociated, bool bDoDescent);
 		void ProcessContentsTable(ULONG ulFlags);
+		// Reads the current folder's contents table through m_lpPipeline if the folder's message count says it's
+		// big enough, calling BeginContentsTableWork with the pipeline's row count.
+		// Returns false if it didn't, and the table should be read inline.
+		bool ProcessContentsTablePipelined(ULONG ulFlags, _In_ LPSPropTagArray lpColumns);
+		// Row work, then the message. lpOpened is the message if it was opened ahead. The caller still releases it.
+		// bOpened means we tried to open it ahead, so don't try again.
+		void ProcessContentsTableRow(
+			_In_ const _SRow* lpSRow,
+			ULONG ulCurRow,
+			_In_opt_ LPMESSAGE lpOpened,
+			bool bOpened);
 		void ProcessRecipients(_In_ LPMESSAGE lpMessage, _In_opt_ LPVOID lpData);
 		void ProcessAttachments(_In_ LPMESSAGE lpMessage, bool bHasAttach, _In_opt_ LPVOID lpData);
 
@@ -106,6 +155,8 @@ namespace mapi::processor
 
 		// Call OpenEntry on the first folder in the list, remove it from the list
 		void OpenFirstFolderInList();
+		// Call OpenEntry on node and make it the current folder. Frees the node's entry ID.
+		void OpenFolder(_In_ FolderNode& node);
 
 		// Clean up the list
 		void FreeFolderList() const;
@@ -116,5 +167,14 @@ namespace mapi::processor
 		LPSRestriction m_lpResFolderContents;
 		const _SSortOrderSet* m_lpSort;
 		ULONG m_ulCount; // Limit on the number of messages processed per folder
+		ULONG m_ulPipelineRows; // Smallest contents table we'll read through m_lpPipeline
+		// Started by the first big table and kept for the rest of the walk, so its thread initializes MAPI once
+		std::unique_ptr<rowPipeline> m_lpPipeline;
+
+		std::vector<ULONG> m_walkOrder; // Walk order of the current folder
+		ULONG m_ulChildFolders{}; // Child folders of the current folder added to the list so far
+		ULONG m_ulWorkers{};
+		folderWalk* m_lpWalk{}; // Shared walk when we're a worker
+		std::wstring m_szFolderText; // FolderOutput for the current folder when we're a worker
 	};
 } // namespace mapi::processor
\ No newline at end of file
@@ -0,0 +1,327 @@
+#include <core/stdafx.h>
+#include <core/mapi/processor/rowPipeline.h>
+#include <core/mapi/mapiFunctions.h>
+#include <core/utility/error.h>
+#include <chrono>
+
+namespace mapi::processor
+{
+	constexpr ULONG cFirstBatch = 32;
+	constexpr ULONG cMinBatch = 8;
+	constexpr ULONG cMaxBatch = 1024;
+	constexpr ULONG cbBatchBudget = 1024 * 1024; // Rough bytes of row data we'll ask for at once
+	constexpr ULONG cLookAhead = 8; // Messages we'll hold open ahead of the caller
+	constexpr auto batchTarget = std::chrono::milliseconds(50);
+
+	pipelineRow& pipelineRow::operator=(pipelineRow&& other) noexcept
+	{
+		std::swap(batch, other.batch);
+		std::swap(lpRow, other.lpRow);
+		std::swap(lpMessage, other.lpMessage);
+		std::swap(bOpened, other.bOpened);
+		return *this;
+	}
+
+	pipelineRow::~pipelineRow()
+	{
+		if (lpMessage) lpMessage->Release();
+	}
+
+	rowPipeline::~rowPipeline()
+	{
+		stop();
+		{
+			const auto lock = std::lock_guard<std::mutex>(m_lock);
+			m_bQuit = true;
+		}
+
+		m_changed.notify_all();
+		if (m_thread.joinable()) m_thread.join();
+	}
+
+	_Check_return_ bool rowPipeline::start(const pipelineTable& table)
+	{
+		stop();
+
+		auto lock = std::unique_lock<std::mutex>(m_lock);
+		if (m_bThreadFailed) return false;
+		if (!m_thread.joinable())
+		{
+			try
+			{
+				m_thread = std::thread([this] { threadLoop(); });
+			}
+			catch (const std::system_error&)
+			{
+				m_bThreadFailed = true;
+				return false;
+			}
+		}
+
+		m_lpStart = &table;
+		m_bBusy = true;
+		m_bOpened = false;
+		m_bTableOK = false;
+		m_ulRowCount = 0;
+		m_bStopping = false;
+		m_bDone = false;
+		m_ulBatch = cFirstBatch;
+		m_ulOpenAhead = 0;
+		m_changed.notify_all();
+
+		// We only hold on to table until it's open
+		m_changed.wait(lock, [this] { return m_bOpened || m_bThreadFailed; });
+		if (!m_bOpened)
+		{
+			m_lpStart = nullptr;
+			m_bBusy = false;
+			return false;
+		}
+
+		if (!m_bTableOK)
+		{
+			m_changed.wait(lock, [this] { return !m_bBusy; });
+			return false;
+		}
+
+		return true;
+	}
+
+	_Check_return_ pipelineRow rowPipeline::next()
+	{
+		auto row = pipelineRow{};
+		auto lock = std::unique_lock<std::mutex>(m_lock);
+		m_changed.wait(lock, [this] { return !m_rows.empty() || m_bDone || !m_bBusy; });
+		if (m_rows.empty()) return row;
+
+		// Don't take a row out from under our thread while it opens the message
+		m_changed.wait(lock, [this] { return !m_rows.front().bOpening; });
+		auto& front = m_rows.front();
+		row.batch = std::move(front.batch);
+		row.lpRow = front.lpRow;
+		row.lpMessage = front.lpMessage;
+		row.bOpened = front.bOpened;
+		// Opened rows are always at the front
+		if (front.bOpened) m_ulOpenAhead--;
+		m_rows.pop_front();
+		lock.unlock();
+
+		// There's room to fetch and open more
+		m_changed.notify_all();
+		return row;
+	}
+
+	void rowPipeline::stop()
+	{
+		auto lock = std::unique_lock<std::mutex>(m_lock);
+		if (!m_bBusy) return;
+		m_bStopping = true;
+		m_changed.notify_all();
+		m_changed.wait(lock, [this] { return !m_bBusy; });
+	}
+
+	void rowPipeline::threadLoop()
+	{
+		// Every thread which uses MAPI needs its own MAPIInitialize
+		const auto bInitialized = SUCCEEDED(EC_MAPI(MAPIInitialize(nullptr)));
+
+		auto lock = std::unique_lock<std::mutex>(m_lock);
+		if (!bInitialized)
+		{
+			m_bThreadFailed = true;
+			m_changed.notify_all();
+			return;
+		}
+
+		for (;;)
+		{
+			m_changed.wait(lock, [this] { return m_bQuit || m_lpStart; });
+			if (m_bQuit) break;
+
+			const auto lpStart = m_lpStart;
+			m_lpStart = nullptr;
+			lock.unlock();
+			readTable(*lpStart);
+			lock.lock();
+		}
+
+		lock.unlock();
+		MAPIUninitialize();
+	}
+
+	void rowPipeline::readTable(const pipelineTable& table)
+	{
+		// Our own folder and table, so the caller can keep using theirs while we read
+		auto lpFolder = mapi::CallOpenEntry<LPMAPIFOLDER>(
+			table.lpMDB, nullptr, nullptr, nullptr, &table.folderEID, nullptr, MAPI_BEST_ACCESS, nullptr);
+		LPMAPITABLE lpTable = nullptr;
+		auto hRes = S_OK;
+		if (lpFolder)
+		{
+			hRes = WC_MAPI(lpFolder->GetContentsTable(table.ulFlags, &lpTable));
+		}
+
+		if (SUCCEEDED(hRes) && lpTable)
+		{
+			hRes = WC_MAPI(lpTable->SetColumns(table.lpColumns, TBL_BATCH));
+		}
+
+		if (SUCCEEDED(hRes) && lpTable && table.lpRes)
+		{
+			WC_MAPI_S(lpTable->Restrict(table.lpRes, TBL_BATCH));
+		}
+
+		if (SUCCEEDED(hRes) && lpTable && table.lpSort)
+		{
+			WC_MAPI_S(lpTable->SortTable(const_cast<LPSSortOrderSet>(table.lpSort), TBL_BATCH));
+		}
+
+		const auto bTableOK = SUCCEEDED(hRes) && lpTable;
+		ULONG ulRowCount = 0;
+		if (bTableOK)
+		{
+			WC_MAPI_S(lpTable->GetRowCount(0, &ulRowCount));
+		}
+
+		const auto ulMaxRows = table.ulMaxRows;
+		const auto bOpenMessages = table.bOpenMessages;
+		{
+			// start returns once it sees this, so we're done with table
+			const auto lock = std::lock_guard<std::mutex>(m_lock);
+			m_bOpened = true;
+			m_bTableOK = bTableOK;
+			m_ulRowCount = ulRowCount;
+		}
+
+		m_changed.notify_all();
+
+		if (bTableOK) readAhead(lpTable, bOpenMessages ? lpFolder : nullptr, ulMaxRows);
+
+		if (lpTable) lpTable->Release();
+		if (lpFolder) lpFolder->Release();
+
+		{
+			const auto lock = std::lock_guard<std::mutex>(m_lock);
+			m_bBusy = false;
+		}
+
+		m_changed.notify_all();
+	}
+
+	void rowPipeline::readAhead(_In_ LPMAPITABLE lpTable, _In_opt_ LPMAPIFOLDER lpFolder, ULONG ulMaxRows)
+	{
+		ULONG ulFetched = 0;
+		auto lock = std::unique_lock<std::mutex>(m_lock);
+		const auto shouldOpen = [&] {
+			return lpFolder && m_ulOpenAhead < cLookAhead && m_ulOpenAhead < m_rows.size();
+		};
+		// Stay a couple of batches ahead of the caller, and far enough ahead to open the next few messages
+		const auto shouldFetch = [&] { return !m_bDone && m_rows.size() < std::max(m_ulBatch * 2, cLookAhead); };
+		for (;;)
+		{
+			m_changed.wait(lock, [&] { return m_bStopping || shouldOpen() || shouldFetch(); });
+			if (m_bStopping) break;
+
+			if (shouldOpen())
+			{
+				// References into a deque survive pushes and pops elsewhere, and the caller waits for us on this one
+				auto& row = m_rows[m_ulOpenAhead];
+				m_ulOpenAhead++;
+				row.bOpening = true;
+				const auto lpRow = row.lpRow;
+				lock.unlock();
+
+				LPMESSAGE lpMessage = nullptr;
+				const auto lpMsgEID = PpropFindProp(lpRow->lpProps, lpRow->cValues, PR_ENTRYID);
+				if (lpMsgEID)
+				{
+					lpMessage = mapi::CallOpenEntry<LPMESSAGE>(
+						nullptr,
+						nullptr,
+						lpFolder,
+						nullptr,
+						&mapi::getBin(lpMsgEID),
+						nullptr,
+						MAPI_BEST_ACCESS,
+						nullptr);
+				}
+
+				lock.lock();
+				row.lpMessage = lpMessage;
+				row.bOpening = false;
+				row.bOpened = true;
+				m_changed.notify_all();
+				continue;
+			}
+
+			auto ulBatch = m_ulBatch;
+			if (ulMaxRows) ulBatch = std::min(ulBatch, ulMaxRows - ulFetched);
+			lock.unlock();
+
+			LPSRowSet lpRows = nullptr;
+			auto elapsed = std::chrono::steady_clock::duration{};
+			if (ulBatch)
+			{
+				const auto start = std::chrono::steady_clock::now();
+				const auto hRes = WC_MAPI(lpTable->QueryRows(ulBatch, NULL, &lpRows));
+				elapsed = std::chrono::steady_clock::now() - start;
+				if (FAILED(hRes) && lpRows)
+				{
+					FreeProws(lpRows);
+					lpRows = nullptr;
+				}
+			}
+
+			lock.lock();
+			if (!lpRows || !lpRows->cRows)
+			{
+				if (lpRows) FreeProws(lpRows);
+				m_bDone = true;
+				m_changed.notify_all();
+				continue;
+			}
+
+			ulFetched += lpRows->cRows;
+
+			// Quick batches grow so we make fewer round trips, slow ones shrink so the first rows come back sooner.
+			// Wide rows cap the batch so we don't hold too much at once.
+			ULONG cbRow = 0;
+			if (FAILED(ScCountProps(lpRows->aRow[0].cValues, lpRows->aRow[0].lpProps, &cbRow)) || !cbRow) cbRow = 1;
+			if (elapsed < batchTarget / 2 && lpRows->cRows == ulBatch)
+			{
+				m_ulBatch *= 2;
+			}
+			else if (elapsed > batchTarget * 2)
+			{
+				m_ulBatch /= 2;
+			}
+
+			m_ulBatch =
+				std::clamp(m_ulBatch, cMinBatch, std::max(cMinBatch, std::min(cMaxBatch, cbBatchBudget / cbRow)));
+
+			const auto batch = std::shared_ptr<SRowSet>(lpRows, [](LPSRowSet lpRowSet) { FreeProws(lpRowSet); });
+			for (ULONG i = 0; i < lpRows->cRows; i++)
+			{
+				m_rows.push_back({batch, &lpRows->aRow[i]});
+			}
+
+			m_changed.notify_all();
+		}
+
+		// The caller's done with the table. Release the messages they didn't take while we're still on our thread.
+		auto messages = std::vector<LPMESSAGE>{};
+		for (const auto& row : m_rows)
+		{
+			if (row.lpMessage) messages.push_back(row.lpMessage);
+		}
+
+		m_rows.clear();
+		m_ulOpenAhead = 0;
+		lock.unlock();
+
+		for (const auto lpMessage : messages)
+		{
+			lpMessage->Release();
+		}
+	}
+} // namespace mapi::processor
@@ -0,0 +1,98 @@
+#pragma once
+// Reads contents tables ahead of a processor on a thread of its own, optionally opening each row's message as well
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mapi::processor
+{
+	// A row handed out by rowPipeline. Keeps its batch of rows alive and releases its message.
+	struct pipelineRow final
+	{
+		pipelineRow() = default;
+		pipelineRow(const pipelineRow&) = delete;
+		pipelineRow& operator=(const pipelineRow&) = delete;
+		pipelineRow(pipelineRow&& other) noexcept { *this = std::move(other); }
+		pipelineRow& operator=(pipelineRow&& other) noexcept;
+		~pipelineRow();
+
+		std::shared_ptr<SRowSet> batch;
+		const _SRow* lpRow{}; // Null when there are no more rows
+		LPMESSAGE lpMessage{}; // Opened ahead. Take it by setting this to nullptr.
+		bool bOpened{}; // We tried to open it ahead, so don't bother trying again
+	};
+
+	// The contents table for rowPipeline::start to read. Only used until start returns.
+	struct pipelineTable final
+	{
+		LPMDB lpMDB{}; // Opens the folder. Shared with the pipeline's thread, as it is with folder workers.
+		SBinary folderEID{};
+		ULONG ulFlags{}; // For GetContentsTable
+		LPSPropTagArray lpColumns{};
+		LPSRestriction lpRes{};
+		const _SSortOrderSet* lpSort{};
+		ULONG ulMaxRows{}; // 0 reads every row
+		bool bOpenMessages{}; // Open each row's PR_ENTRYID ahead of the caller
+	};
+
+	// Keeps rows, and optionally their messages, queued up for the caller, one table at a time.
+	// Rows are fetched with QueryRows, in batches sized by how long they take and how wide the rows are.
+	// Messages for the next few rows are opened too, so the store's latency overlaps with our own work.
+	// The work is done on one thread, started by the first table and kept until we're destroyed,
+	// so it only initializes MAPI once. That thread opens its own folder and table from the entry ID,
+	// and the caller never touches them. Messages are handed over once opened and aren't used by both threads.
+	class rowPipeline final
+	{
+	public:
+		rowPipeline() = default;
+		~rowPipeline();
+
+		rowPipeline(const rowPipeline&) = delete;
+		rowPipeline& operator=(const rowPipeline&) = delete;
+
+		// Waits for our thread to open the table. Returns false if the thread couldn't start,
+		// initialize MAPI, or open the table. The caller then reads the table itself.
+		_Check_return_ bool start(const pipelineTable& table);
+		// Rows in the table start opened, after any restriction, so the caller needn't open the table to count them
+		ULONG rowCount() const noexcept { return m_ulRowCount; }
+		// Waits for the next row. lpRow is null once the table is done.
+		_Check_return_ pipelineRow next();
+		// Done with the table, whether or not we've read every row.
+		// Waits for our thread to release its table and any message the caller didn't take.
+		void stop();
+
+	private:
+		struct entry
+		{
+			std::shared_ptr<SRowSet> batch;
+			const _SRow* lpRow{};
+			LPMESSAGE lpMessage{};
+			bool bOpening{};
+			bool bOpened{};
+		};
+
+		void threadLoop();
+		// Opens a table and reads it until stop is called
+		void readTable(const pipelineTable& table);
+		// Fetches or opens whatever the caller will need next, until stop is called
+		void readAhead(_In_ LPMAPITABLE lpTable, _In_opt_ LPMAPIFOLDER lpFolder, ULONG ulMaxRows);
+
+		std::mutex m_lock;
+		std::condition_variable m_changed;
+		std::thread m_thread;
+		const pipelineTable* m_lpStart{}; // Table waiting for our thread to open it
+		bool m_bThreadFailed{}; // Our thread couldn't start or initialize MAPI
+		bool m_bQuit{};
+		bool m_bBusy{}; // A table is started and our thread hasn't finished with it yet
+		bool m_bOpened{}; // Our thread has opened the started table, or failed to
+		bool m_bTableOK{};
+		ULONG m_ulRowCount{}; // Set with m_bOpened
+		bool m_bStopping{};
+		bool m_bDone{}; // No more rows will be queued
+		ULONG m_ulBatch{}; // Rows to ask for next
+		std::deque<entry> m_rows; // Rows the caller hasn't taken yet
+		ULONG m_ulOpenAhead{}; // Rows at the front of m_rows opened or being opened
+	};
+} // namespace mapi::processor
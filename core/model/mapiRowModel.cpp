@@ -4,10 +4,6 @@
 #include <core/mapi/cache/namedProps.h>
 #include <core/interpret/proptags.h>
 #include <core/property/parseProperty.h>
-#include <core/utility/error.h>
-#include <core/mapi/mapiFunctions.h>
-#include <core/mapi/mapiMemory.h>
-#include <core/utility/registry.h>
 
 namespace model
 {
@@ -64,66 +60,18 @@ namespace model
 		_In_ const bool bIsAB)
 	{
 		if (!cValues || !lpPropVals) return {};
-		const SBinary* lpSigBin = nullptr; // Will be borrowed. Do not free.
-		LPSPropValue lpMappingSigFromObject = nullptr;
-		std::vector<std::shared_ptr<cache::namedPropCacheEntry>> namedPropCacheEntries = {};
 
-		if (!bIsAB && registry::parseNamedProps)
-		{
-			// Pre cache and prop tag to name mappings we need
-			// First gather tags
-			auto tags = std::vector<ULONG>{};
-			for (ULONG i = 0; i < cValues; i++)
-			{
-				if (registry::getPropNamesOnAllProps ||
-					PROP_ID(lpPropVals[i].ulPropTag) >= 0x8000) // It's either a named prop or we're doing all props
-				{
-					tags.push_back(lpPropVals[i].ulPropTag);
-				}
-			}
-
-			if (!tags.empty())
-			{
-				auto lpTags = mapi::allocate<LPSPropTagArray>(CbNewSPropTagArray(static_cast<ULONG>(tags.size())));
-				if (lpTags)
-				{
-					lpTags->cValues = static_cast<ULONG>(tags.size());
-					ULONG i = 0;
-					for (const auto tag : tags)
-					{
-						mapi::setTag(lpTags, i++) = tag;
-					}
-
-					// Second get a mapping signature
-					const SPropValue* lpMappingSig = mapi::FindProp(lpPropVals, cValues, PR_MAPPING_SIGNATURE);
-					if (lpMappingSig && lpMappingSig->ulPropTag == PR_MAPPING_SIGNATURE)
-						lpSigBin = &mapi::getBin(lpMappingSig);
-					if (!lpSigBin && lpProp)
-					{
-						WC_H_S(HrGetOneProp(lpProp, PR_MAPPING_SIGNATURE, &lpMappingSigFromObject));
-						if (lpMappingSigFromObject && lpMappingSigFromObject->ulPropTag == PR_MAPPING_SIGNATURE)
-							lpSigBin = &mapi::getBin(lpMappingSigFromObject);
-					}
-
-					// Third, look up all the tags and cache named prop info
-					namedPropCacheEntries = cache::GetNamesFromIDs(lpProp, lpSigBin, lpTags, NULL);
-					MAPIFreeBuffer(lpTags);
-				}
-			}
-		}
+		// Look up every named prop in the array at once
+		const auto names = cache::propArrayNames(cValues, lpPropVals, lpProp, bIsAB);
 
 		auto models = std::vector<std::shared_ptr<model::mapiRowModel>>{};
 		for (ULONG i = 0; i < cValues; i++)
 		{
 			const auto prop = lpPropVals[i];
-			const auto lpNameID = cache::find(namedPropCacheEntries, [&](const auto& _entry) {
-				return _entry->getPropID() == PROP_ID(prop.ulPropTag);
-			});
-			models.push_back(
-				model::propToModelInternal(&prop, prop.ulPropTag, lpProp, bIsAB, lpSigBin, lpNameID->getMapiNameId()));
+			models.push_back(model::propToModelInternal(
+				&prop, prop.ulPropTag, lpProp, bIsAB, names.getSig(), names.find(prop.ulPropTag)));
 		}
 
-		if (lpMappingSigFromObject) MAPIFreeBuffer(lpMappingSigFromObject);
 		return models;
 	}
 
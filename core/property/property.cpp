@@ -37,7 +37,7 @@ namespace property
 	{
 		if (m_szParsing.empty()) return L"";
 
-		const auto szTag = strings::loadstring(uidTag);
+		const auto& szTag = strings::loadstring(uidTag);
 		std::wstringstream szXML;
 		szXML << tagopen(szTag + m_attributes.toXML(), iIndent);
 
@@ -46,7 +46,14 @@ namespace property
 			szXML << cdataopen;
 		}
 
-		szXML << strings::ScrubStringForXML(m_szParsing);
+		if (strings::NeedsScrubForXML(m_szParsing))
+		{
+			szXML << strings::ScrubStringForXML(m_szParsing);
+		}
+		else
+		{
+			szXML << m_szParsing;
+		}
 
 		if (!m_bXMLSafe)
 		{
@@ -101,8 +108,8 @@ namespace property
 
 		if (mv == L"true")
 		{
-			const auto szValue = strings::loadstring(columns::PropXMLNames[columns::pcPROPVAL].uidName);
-			const auto szRow = strings::loadstring(IDS_ROW);
+			const auto& szValue = strings::loadstring(columns::PropXMLNames[columns::pcPROPVAL].uidName);
+			const auto& szRow = strings::loadstring(IDS_ROW);
 
 			szXML << tagopen(szValue + m_attributes.toXML(), iIndent) + L"\n";
 
@@ -126,7 +126,7 @@ namespace propertybag
 					break;
 				case PT_MV_LONG:
 				{
-					const auto parser = std::make_shared<smartview::binaryParser>(m_binVal);
+					const auto parser = smartview::binaryParser::borrow(m_binVal);
 					const auto count = static_cast<ULONG>(parser->getSize() / sizeof(LONG));
 					m_bin = std::vector<BYTE>(sizeof(LONG) * count);
 					m_prop.Value.MVl.lpl = reinterpret_cast<LONG*>(m_bin.data());
@@ -141,7 +141,7 @@ namespace propertybag
 				}
 				case PT_MV_BINARY:
 				{
-					const auto parser = std::make_shared<smartview::binaryParser>(m_binVal);
+					const auto parser = smartview::binaryParser::borrow(m_binVal);
 					const auto count = smartview::blockT<ULONG>::parse(parser)->getData();
 					m_bin = std::vector<BYTE>(sizeof(SBinary) * count);
 					m_mvBin = std::vector<std::vector<BYTE>>(count);
@@ -164,7 +164,7 @@ namespace propertybag
 				}
 				case PT_MV_UNICODE:
 				{
-					const auto parser = std::make_shared<smartview::binaryParser>(m_binVal);
+					const auto parser = smartview::binaryParser::borrow(m_binVal);
 					const auto count = smartview::blockT<ULONG>::parse(parser)->getData();
 					m_bin = std::vector<BYTE>(sizeof(LPWSTR) * count);
 					m_mvW = std::vector<std::wstring>(count);
@@ -186,7 +186,7 @@ namespace propertybag
 				}
 				case PT_MV_STRING8:
 				{
-					const auto parser = std::make_shared<smartview::binaryParser>(m_binVal);
+					const auto parser = smartview::binaryParser::borrow(m_binVal);
 					const auto count = smartview::blockT<ULONG>::parse(parser)->getData();
 					m_bin = std::vector<BYTE>(sizeof(LPSTR) * count);
 					m_mvA = std::vector<std::string>(count);
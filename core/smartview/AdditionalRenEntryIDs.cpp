@@ -39,7 +39,8 @@ namespace smartview
 		{
 			// Build a new parser to preread and count our elements
 			// This new parser will only contain as much space as suggested in wDataElementsSize
-			auto DataElementParser = std::make_shared<binaryParser>(*wDataElementsSize, parser->getAddress());
+			// It only lives for this loop, so it can borrow our parser's buffer instead of copying it
+			auto DataElementParser = binaryParser::borrow(*wDataElementsSize, parser->getAddress());
 			for (;;)
 			{
 				if (DataElementParser->getSize() < 2 * sizeof(WORD)) break;
@@ -299,7 +299,7 @@ namespace smartview
 		{
 			for (WORD i = 0; i < *m_ExceptionCount; i++)
 			{
-				auto ee = std::make_shared<ExtendedException>(*m_WriterVersion2, *m_ExceptionInfo[i]->OverrideFlags);
+				auto ee = makeBlock<ExtendedException>(*m_WriterVersion2, *m_ExceptionInfo[i]->OverrideFlags);
 				ee->block::parse(parser, false);
 				m_ExtendedException.emplace_back(ee);
 			}
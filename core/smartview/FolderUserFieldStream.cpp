@@ -80,7 +80,7 @@ namespace smartview
 			for (DWORD i = 0; i < *m_FolderUserFieldsAnsiCount; i++)
 			{
 				if (parser->empty()) continue;
-				auto fd = std::make_shared<FolderFieldDefinition>(false);
+				auto fd = makeBlock<FolderFieldDefinition>(false);
 				fd->block::parse(parser, false);
 				m_FieldDefinitionsA.emplace_back(fd);
 			}
@@ -93,7 +93,7 @@ namespace smartview
 			for (DWORD i = 0; i < *m_FolderUserFieldsUnicodeCount; i++)
 			{
 				if (parser->empty()) continue;
-				auto fd = std::make_shared<FolderFieldDefinition>(true);
+				auto fd = makeBlock<FolderFieldDefinition>(true);
 				fd->block::parse(parser, false);
 				m_FieldDefinitionsW.emplace_back(fd);
 			}
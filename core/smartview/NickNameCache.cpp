@@ -11,7 +11,7 @@ namespace smartview
 		{
 			if (*cValues < _MaxEntriesSmall)
 			{
-				lpProps = std::make_shared<PropertiesStruct>(*cValues, true, false);
+				lpProps = makeBlock<PropertiesStruct>(*cValues, true, false);
 				lpProps->block::parse(parser, false);
 			}
 		}
@@ -20,7 +20,7 @@ namespace smartview
 		for (;;)
 		{
 			if (dwPropCount >= m_MaxEntries) break;
-			auto sPropValueStruct = std::make_shared<SPropValueStruct>(dwPropCount++, m_NickName, m_RuleCondition);
+			auto sPropValueStruct = makeBlock<SPropValueStruct>(dwPropCount++, m_NickName, m_RuleCondition);
 			const auto curOffset = parser->getOffset();
 			if (sPropValueStruct)
 			{
@@ -138,7 +138,7 @@ namespace smartview
 				psbSkipBlocks.reserve(skipBlockCount);
 				for (DWORD i = 0; i < skipBlockCount; i++)
 				{
-					auto skipBlock = std::make_shared<SkipBlock>(i);
+					auto skipBlock = makeBlock<SkipBlock>(i);
 					skipBlock->block::parse(parser, false);
 					psbSkipBlocks.emplace_back(skipBlock);
 				}
@@ -219,7 +219,7 @@ namespace smartview
 			{
 				for (DWORD i = 0; i < *m_dwFieldDefinitionCount; i++)
 				{
-					auto def = std::make_shared<FieldDefinition>(*m_wVersion);
+					auto def = makeBlock<FieldDefinition>(*m_wVersion);
 					def->block::parse(parser, false);
 					m_pfdFieldDefinitions.emplace_back(def);
 				}
@@ -12,7 +12,7 @@ namespace smartview
 		{
 			if (*cValues < _MaxEntriesSmall)
 			{
-				rgPropVals = std::make_shared<PropertiesStruct>(*cValues, false, false);
+				rgPropVals = makeBlock<PropertiesStruct>(*cValues, false, false);
 				rgPropVals->block::parse(parser, false);
 			}
 		}
@@ -79,7 +79,7 @@ namespace smartview
 		m_Period = blockT<DWORD>::parse(parser);
 		m_SlidingFlag = blockT<DWORD>::parse(parser);
 
-		m_PatternTypeSpecific = std::make_shared<PatternTypeSpecific>(*m_PatternType);
+		m_PatternTypeSpecific = makeBlock<PatternTypeSpecific>(*m_PatternType);
 		m_PatternTypeSpecific->block::parse(parser, false);
 
 		m_EndType = blockT<DWORD>::parse(parser);
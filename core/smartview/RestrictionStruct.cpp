@@ -31,7 +31,7 @@ namespace smartview
 				for (ULONG i = 0; i < *cRes; i++)
 				{
 					if (!parser->getSize()) break;
-					auto res = std::make_shared<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
+					auto res = makeBlock<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
 					res->block::parse(parser, false);
 					lpRes.emplace_back(res);
 				}
@@ -76,7 +76,7 @@ namespace smartview
 				for (ULONG i = 0; i < *cRes; i++)
 				{
 					if (!parser->getSize()) break;
-					auto res = std::make_shared<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
+					auto res = makeBlock<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
 					res->block::parse(parser, false);
 					lpRes.emplace_back(res);
 				}
@@ -108,7 +108,7 @@ namespace smartview
 		{
 			if (m_ulDepth < _MaxDepth && parser->getSize())
 			{
-				lpRes = std::make_shared<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
+				lpRes = makeBlock<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
 				lpRes->block::parse(parser, false);
 			}
 		}
@@ -166,7 +166,7 @@ namespace smartview
 		{
 			ulFuzzyLevel = blockT<DWORD>::parse(parser);
 			ulPropTag = blockT<DWORD>::parse(parser);
-			lpProp = std::make_shared<SPropValueStruct>(0, false, m_bRuleCondition);
+			lpProp = makeBlock<SPropValueStruct>(0, false, m_bRuleCondition);
 			lpProp->block::parse(parser, false);
 		}
 
@@ -197,7 +197,7 @@ namespace smartview
 			ulCount = blockT<DWORD>::parse(parser);
 			if (m_ulDepth < _MaxDepth && parser->getSize())
 			{
-				lpRes = std::make_shared<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
+				lpRes = makeBlock<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
 				lpRes->block::parse(parser, false);
 			}
 		}
@@ -226,7 +226,7 @@ namespace smartview
 				relop = blockT<DWORD>::parse(parser);
 
 			ulPropTag = blockT<DWORD>::parse(parser);
-			lpProp = std::make_shared<SPropValueStruct>(0, false, m_bRuleCondition);
+			lpProp = makeBlock<SPropValueStruct>(0, false, m_bRuleCondition);
 			lpProp->block::parse(parser, false);
 		}
 
@@ -347,7 +347,7 @@ namespace smartview
 			ulSubObject = blockT<DWORD>::parse(parser);
 			if (m_ulDepth < _MaxDepth && parser->getSize())
 			{
-				lpRes = std::make_shared<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
+				lpRes = makeBlock<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
 				lpRes->block::parse(parser, false);
 			}
 		}
@@ -376,14 +376,14 @@ namespace smartview
 			else
 				cValues = blockT<DWORD>::parse(parser);
 
-			lpProp = std::make_shared<PropertiesStruct>(*cValues, false, m_bRuleCondition);
+			lpProp = makeBlock<PropertiesStruct>(*cValues, false, m_bRuleCondition);
 			lpProp->block::parse(parser, false);
 
 			// Check if a restriction is present
 			const auto resExists = blockT<BYTE>::parse(parser);
 			if (*resExists && m_ulDepth < _MaxDepth && parser->getSize())
 			{
-				lpRes = std::make_shared<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
+				lpRes = makeBlock<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
 				lpRes->block::parse(parser, false);
 			}
 		}
@@ -415,14 +415,14 @@ namespace smartview
 			else
 				cValues = blockT<DWORD>::parse(parser);
 
-			lpProp = std::make_shared<PropertiesStruct>(*cValues, false, m_bRuleCondition);
+			lpProp = makeBlock<PropertiesStruct>(*cValues, false, m_bRuleCondition);
 			lpProp->block::parse(parser, false);
 
 			// Check if a restriction is present
 			const auto& resExists = blockT<BYTE>::parse(parser);
 			if (*resExists && m_ulDepth < _MaxDepth && parser->getSize())
 			{
-				lpRes = std::make_shared<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
+				lpRes = makeBlock<RestrictionStruct>(m_ulDepth + 1, m_bRuleCondition, m_bExtendedCount);
 				lpRes->block::parse(parser, false);
 			}
 		}
@@ -466,43 +466,43 @@ namespace smartview
 		switch (*rt)
 		{
 		case RES_AND:
-			res = std::make_shared<SAndRestrictionStruct>();
+			res = makeBlock<SAndRestrictionStruct>();
 			break;
 		case RES_OR:
-			res = std::make_shared<SOrRestrictionStruct>();
+			res = makeBlock<SOrRestrictionStruct>();
 			break;
 		case RES_NOT:
-			res = std::make_shared<SNotRestrictionStruct>();
+			res = makeBlock<SNotRestrictionStruct>();
 			break;
 		case RES_CONTENT:
-			res = std::make_shared<SContentRestrictionStruct>();
+			res = makeBlock<SContentRestrictionStruct>();
 			break;
 		case RES_PROPERTY:
-			res = std::make_shared<SPropertyRestrictionStruct>();
+			res = makeBlock<SPropertyRestrictionStruct>();
 			break;
 		case RES_COMPAREPROPS:
-			res = std::make_shared<SComparePropsRestrictionStruct>();
+			res = makeBlock<SComparePropsRestrictionStruct>();
 			break;
 		case RES_BITMASK:
-			res = std::make_shared<SBitMaskRestrictionStruct>();
+			res = makeBlock<SBitMaskRestrictionStruct>();
 			break;
 		case RES_SIZE:
-			res = std::make_shared<SSizeRestrictionStruct>();
+			res = makeBlock<SSizeRestrictionStruct>();
 			break;
 		case RES_EXIST:
-			res = std::make_shared<SExistRestrictionStruct>();
+			res = makeBlock<SExistRestrictionStruct>();
 			break;
 		case RES_SUBRESTRICTION:
-			res = std::make_shared<SSubRestrictionStruct>();
+			res = makeBlock<SSubRestrictionStruct>();
 			break;
 		case RES_COMMENT:
-			res = std::make_shared<SCommentRestrictionStruct>();
+			res = makeBlock<SCommentRestrictionStruct>();
 			break;
 		case RES_ANNOTATION:
-			res = std::make_shared<SAnnotationRestrictionStruct>();
+			res = makeBlock<SAnnotationRestrictionStruct>();
 			break;
 		case RES_COUNT:
-			res = std::make_shared<SCountRestrictionStruct>();
+			res = makeBlock<SCountRestrictionStruct>();
 			break;
 		}
 
@@ -226,7 +226,7 @@ namespace smartview
 				PropertyValues.reserve(*NoOfProperties);
 				for (DWORD i = 0; i < *NoOfProperties; i++)
 				{
-					auto prop = std::make_shared<SPropValueStruct>(i, false, true);
+					auto prop = makeBlock<SPropValueStruct>(i, false, true);
 					prop->block::parse(parser, false);
 					PropertyValues.push_back(prop);
 				}
@@ -308,7 +308,7 @@ namespace smartview
 		std::shared_ptr<SPropValueStruct> TaggedPropertyValue;
 		void parse() override
 		{
-			TaggedPropertyValue = std::make_shared<SPropValueStruct>(0, false, true);
+			TaggedPropertyValue = makeBlock<SPropValueStruct>(0, false, true);
 			TaggedPropertyValue->block::parse(parser, false);
 		}
 
@@ -345,37 +345,37 @@ namespace smartview
 		switch (at)
 		{
 		case OP_MOVE:
-			ret = std::make_shared<ActionDataMoveCopy>();
+			ret = makeBlock<ActionDataMoveCopy>();
 			break;
 		case OP_COPY:
-			ret = std::make_shared<ActionDataMoveCopy>();
+			ret = makeBlock<ActionDataMoveCopy>();
 			break;
 		case OP_REPLY:
-			ret = std::make_shared<ActionDataReply>();
+			ret = makeBlock<ActionDataReply>();
 			break;
 		case OP_OOF_REPLY:
-			ret = std::make_shared<ActionDataReply>();
+			ret = makeBlock<ActionDataReply>();
 			break;
 		case OP_DEFER_ACTION:
-			ret = std::make_shared<ActionDataDefer>();
+			ret = makeBlock<ActionDataDefer>();
 			break;
 		case OP_BOUNCE:
-			ret = std::make_shared<ActionDataBounce>();
+			ret = makeBlock<ActionDataBounce>();
 			break;
 		case OP_FORWARD:
-			ret = std::make_shared<ActionDataForwardDelegate>();
+			ret = makeBlock<ActionDataForwardDelegate>();
 			break;
 		case OP_DELEGATE:
-			ret = std::make_shared<ActionDataForwardDelegate>();
+			ret = makeBlock<ActionDataForwardDelegate>();
 			break;
 		case OP_TAG:
-			ret = std::make_shared<ActionDataTag>();
+			ret = makeBlock<ActionDataTag>();
 			break;
 		case OP_DELETE:
-			ret = std::make_shared<ActionDataDeleteMarkRead>();
+			ret = makeBlock<ActionDataDeleteMarkRead>();
 			break;
 		case OP_MARK_AS_READ:
-			ret = std::make_shared<ActionDataDeleteMarkRead>();
+			ret = makeBlock<ActionDataDeleteMarkRead>();
 			break;
 		}
 
@@ -460,7 +460,7 @@ namespace smartview
 			ActionBlocks.reserve(*NoOfActions);
 			for (DWORD i = 0; i < *NoOfActions; i++)
 			{
-				auto actionBlock = std::make_shared<ActionBlock>(m_bExtended);
+				auto actionBlock = makeBlock<ActionBlock>(m_bExtended);
 				actionBlock->block::parse(parser, false);
 				ActionBlocks.push_back(actionBlock);
 			}
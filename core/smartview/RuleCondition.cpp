@@ -54,7 +54,7 @@ namespace smartview
 			PropertyName.reserve(*NoOfNamedProps);
 			for (auto i = 0; i < *NoOfNamedProps; i++)
 			{
-				auto namedProp = std::make_shared<smartview::PropertyName>(PropId[i]);
+				auto namedProp = makeBlock<smartview::PropertyName>(PropId[i]);
 				namedProp->block::parse(parser, false);
 				PropertyName.emplace_back(namedProp);
 			}
@@ -79,7 +79,7 @@ namespace smartview
 	void RuleCondition::parse()
 	{
 		m_NamedPropertyInformation = block::parse<NamedPropertyInformation>(parser, false);
-		m_lpRes = std::make_shared<RestrictionStruct>(true, m_bExtended);
+		m_lpRes = makeBlock<RestrictionStruct>(true, m_bExtended);
 		m_lpRes->block::parse(parser, false);
 	}
 
@@ -13,7 +13,7 @@ namespace smartview
 		Pad = blockT<DWORD>::parse(parser);
 		if (*PropertyCount)
 		{
-			Props = std::make_shared<PropertiesStruct>(*PropertyCount, false, false);
+			Props = makeBlock<PropertiesStruct>(*PropertyCount, false, false);
 			Props->block::parse(parser, false);
 		}
 	}
@@ -90,7 +90,7 @@ namespace smartview
 
 		if (*m_Flags & SFST_MRES)
 		{
-			m_Restriction = std::make_shared<RestrictionStruct>(false, true);
+			m_Restriction = makeBlock<RestrictionStruct>(false, true);
 			m_Restriction->block::parse(parser, false);
 		}
 
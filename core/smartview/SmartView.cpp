@@ -1,5 +1,6 @@
 #include <core/stdafx.h>
 #include <core/smartview/SmartView.h>
+#include <core/smartview/renderCache.h>
 #include <core/mapi/extraPropTags.h>
 #include <core/utility/strings.h>
 #include <core/interpret/guid.h>
@@ -47,20 +48,84 @@
 
 namespace smartview
 {
+	// Parse within a parseBudget, flagging the result if the budget ran out.
+	// Returns false if it did, since the same blob may parse in full another time.
+	bool parseWithBudget(const std::shared_ptr<block>& svp, const std::shared_ptr<binaryParser>& parser)
+	{
+		auto truncated = std::wstring{};
+		{
+			const auto budget = parseBudget{};
+			svp->parse(parser, true);
+			truncated = budget.describe();
+		}
+
+		if (truncated.empty()) return true;
+		svp->addHeader(truncated);
+		return false;
+	}
+
 	std::shared_ptr<block> InterpretBinary(const SBinary myBin, parserType parser, _In_opt_ LPMAPIPROP lpMAPIProp)
 	{
 		if (!registry::doSmartView) emptySW();
 
+		// Build the whole block tree in one arena. It's freed when the last block is released.
+		const auto arena = blockArena::scope{};
 		auto svp = GetSmartViewParser(parser, lpMAPIProp);
 		if (svp)
 		{
-			svp->parse(std::make_shared<binaryParser>(myBin.cb, myBin.lpb), true);
+			parseWithBudget(svp, std::make_shared<binaryParser>(myBin.cb, myBin.lpb));
 			return svp;
 		}
 
 		return emptySW();
 	}
 
+	// Parse and render in one step.
+	// Since no block outlives this call we can parse the caller's buffer in place rather than copying it.
+	// Repeat blobs are served from the render cache.
+	std::wstring InterpretBinaryAsString(const SBinary myBin, parserType parser, _In_opt_ LPMAPIPROP lpMAPIProp)
+	{
+		// Security descriptors render differently depending on the object they came from
+		const auto cacheable =
+			!lpMAPIProp || (parser != parserType::SECURITYDESCRIPTOR && parser != parserType::FBSECURITYDESCRIPTOR);
+		auto szCached = std::wstring{};
+		if (cacheable && renderCache::find(parser, myBin, szCached)) return szCached;
+
+		const auto arena = blockArena::scope{};
+		auto svp = GetSmartViewParser(parser, lpMAPIProp);
+		if (svp)
+		{
+			// A truncated render depends on how fast this parse ran, so don't hand it out again.
+			// That includes any budget of its own a nested parse ran out of while we rendered.
+			const auto truncations = parseBudget::truncations();
+			const auto complete = parseWithBudget(svp, binaryParser::borrow(myBin.cb, myBin.lpb));
+			auto szResult = svp->toString();
+			if (cacheable && complete && parseBudget::truncations() == truncations)
+			{
+				renderCache::add(parser, myBin, szResult);
+			}
+			return szResult;
+		}
+
+		return strings::emptystring;
+	}
+
+	// As above, but streams the rendered text to sink in chunks rather than building one string
+	void InterpretBinaryAsString(
+		const SBinary myBin,
+		parserType parser,
+		_In_opt_ LPMAPIPROP lpMAPIProp,
+		const std::function<void(const std::wstring&)>& sink)
+	{
+		const auto arena = blockArena::scope{};
+		auto svp = GetSmartViewParser(parser, lpMAPIProp);
+		if (svp)
+		{
+			parseWithBudget(svp, binaryParser::borrow(myBin.cb, myBin.lpb));
+			svp->toString(sink);
+		}
+	}
+
 	// Functions to parse PT_LONG/PT-I2 properties
 	_Check_return_ std::wstring RTimeToSzString(DWORD rTime, bool bLabel);
 	_Check_return_ std::wstring PTI8ToSzString(LARGE_INTEGER liI8, bool bLabel);
@@ -73,78 +138,78 @@ namespace smartview
 		case parserType::NOPARSING:
 			return nullptr;
 		case parserType::TOMBSTONE:
-			return std::make_shared<TombStone>();
+			return makeBlock<TombStone>();
 		case parserType::PCL:
-			return std::make_shared<PCL>();
+			return makeBlock<PCL>();
 		case parserType::VERBSTREAM:
-			return std::make_shared<VerbStream>();
+			return makeBlock<VerbStream>();
 		case parserType::NICKNAMECACHE:
-			return std::make_shared<NickNameCache>();
+			return makeBlock<NickNameCache>();
 		case parserType::DECODEENTRYID:
-			return std::make_shared<decodeEntryID>();
+			return makeBlock<decodeEntryID>();
 		case parserType::ENCODEENTRYID:
-			return std::make_shared<encodeEntryID>();
+			return makeBlock<encodeEntryID>();
 		case parserType::FOLDERUSERFIELDS:
-			return std::make_shared<FolderUserFieldStream>();
+			return makeBlock<FolderUserFieldStream>();
 		case parserType::RECIPIENTROWSTREAM:
-			return std::make_shared<RecipientRowStream>();
+			return makeBlock<RecipientRowStream>();
 		case parserType::WEBVIEWPERSISTSTREAM:
-			return std::make_shared<WebViewPersistStream>();
+			return makeBlock<WebViewPersistStream>();
 		case parserType::FLATENTRYLIST:
-			return std::make_shared<FlatEntryList>();
+			return makeBlock<FlatEntryList>();
 		case parserType::ADDITIONALRENENTRYIDSEX:
-			return std::make_shared<AdditionalRenEntryIDs>();
+			return makeBlock<AdditionalRenEntryIDs>();
 		case parserType::PROPERTYDEFINITIONSTREAM:
-			return std::make_shared<PropertyDefinitionStream>();
+			return makeBlock<PropertyDefinitionStream>();
 		case parserType::SEARCHFOLDERDEFINITION:
-			return std::make_shared<SearchFolderDefinition>();
+			return makeBlock<SearchFolderDefinition>();
 		case parserType::ENTRYLIST:
-			return std::make_shared<EntryList>();
+			return makeBlock<EntryList>();
 		case parserType::RULEACTION:
-			return std::make_shared<RuleAction>(false);
+			return makeBlock<RuleAction>(false);
 		case parserType::EXTENDEDRULEACTION:
-			return std::make_shared<RuleAction>(true);
+			return makeBlock<RuleAction>(true);
 		case parserType::RULECONDITION:
-			return std::make_shared<RuleCondition>(false);
+			return makeBlock<RuleCondition>(false);
 		case parserType::EXTENDEDRULECONDITION:
-			return std::make_shared<RuleCondition>(true);
+			return makeBlock<RuleCondition>(true);
 		case parserType::RESTRICTION:
-			return std::make_shared<RestrictionStruct>(false, true);
+			return makeBlock<RestrictionStruct>(false, true);
 		case parserType::PROPERTIES:
-			return std::make_shared<PropertiesStruct>(_MaxEntriesSmall, false, false);
+			return makeBlock<PropertiesStruct>(_MaxEntriesSmall, false, false);
 		case parserType::ENTRYID:
-			return std::make_shared<EntryIdStruct>();
+			return makeBlock<EntryIdStruct>();
 		case parserType::GLOBALOBJECTID:
-			return std::make_shared<GlobalObjectId>();
+			return makeBlock<GlobalObjectId>();
 		case parserType::TASKASSIGNERS:
-			return std::make_shared<TaskAssigners>();
+			return makeBlock<TaskAssigners>();
 		case parserType::CONVERSATIONINDEX:
-			return std::make_shared<ConversationIndex>();
+			return makeBlock<ConversationIndex>();
 		case parserType::REPORTTAG:
-			return std::make_shared<ReportTag>();
+			return makeBlock<ReportTag>();
 		case parserType::TIMEZONEDEFINITION:
-			return std::make_shared<TimeZoneDefinition>();
+			return makeBlock<TimeZoneDefinition>();
 		case parserType::TIMEZONE:
-			return std::make_shared<TimeZone>();
+			return makeBlock<TimeZone>();
 		case parserType::EXTENDEDFOLDERFLAGS:
-			return std::make_shared<ExtendedFlags>();
+			return makeBlock<ExtendedFlags>();
 		case parserType::APPOINTMENTRECURRENCEPATTERN:
-			return std::make_shared<AppointmentRecurrencePattern>();
+			return makeBlock<AppointmentRecurrencePattern>();
 		case parserType::RECURRENCEPATTERN:
-			return std::make_shared<RecurrencePattern>();
+			return makeBlock<RecurrencePattern>();
 		case parserType::SID:
-			return std::make_shared<SIDBin>();
+			return makeBlock<SIDBin>();
 		case parserType::SECURITYDESCRIPTOR:
-			return std::make_shared<SDBin>(lpMAPIProp, false);
+			return makeBlock<SDBin>(lpMAPIProp, false);
 		case parserType::FBSECURITYDESCRIPTOR:
-			return std::make_shared<SDBin>(lpMAPIProp, true);
+			return makeBlock<SDBin>(lpMAPIProp, true);
 		case parserType::XID:
-			return std::make_shared<XID>();
+			return makeBlock<XID>();
 		case parserType::SWAPPEDTODO:
-			return std::make_shared<swappedToDo>();
+			return makeBlock<swappedToDo>();
 		default:
 			// Any other case is either handled by an add-in or not at all
-			return std::make_shared<addinParser>(type);
+			return makeBlock<addinParser>(type);
 		}
 	}
 
@@ -368,7 +433,7 @@ namespace smartview
 
 			if (parser != parserType::NOPARSING)
 			{
-				return InterpretBinary(mapi::getBin(lpProp), parser, lpMAPIProp)->toString();
+				return InterpretBinaryAsString(mapi::getBin(lpProp), parser, lpMAPIProp);
 			}
 
 			break;
@@ -398,7 +463,7 @@ namespace smartview
 			}
 
 			szResult += strings::formatmessage(IDS_MVROWBIN, ulRow);
-			szResult += InterpretBinary(myBinArray.lpbin[ulRow], parser, lpMAPIProp)->toString();
+			szResult += InterpretBinaryAsString(myBinArray.lpbin[ulRow], parser, lpMAPIProp);
 		}
 
 		return szResult;
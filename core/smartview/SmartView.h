@@ -7,6 +7,12 @@ enum class parserType;
 namespace smartview
 {
 	std::shared_ptr<block> InterpretBinary(const SBinary myBin, parserType parser, _In_opt_ LPMAPIPROP lpMAPIProp);
+	std::wstring InterpretBinaryAsString(const SBinary myBin, parserType parser, _In_opt_ LPMAPIPROP lpMAPIProp);
+	void InterpretBinaryAsString(
+		const SBinary myBin,
+		parserType parser,
+		_In_opt_ LPMAPIPROP lpMAPIProp,
+		const std::function<void(const std::wstring&)>& sink);
 
 	std::shared_ptr<block> GetSmartViewParser(parserType type, _In_opt_ LPMAPIPROP lpMAPIProp);
 	_Check_return_ parserType FindSmartViewParserForProp(
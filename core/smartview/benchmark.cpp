@@ -0,0 +1,151 @@
+#include <core/stdafx.h>
+#include <core/smartview/benchmark.h>
+#include <core/addin/mfcmapi.h>
+#include <core/utility/strings.h>
+#include <core/utility/output.h>
+
+namespace smartview
+{
+	namespace benchmark
+	{
+		const std::vector<std::pair<ULONG, parserType>> corpusPrefixes = {
+			{1, parserType::ADDITIONALRENENTRYIDSEX},
+			{2, parserType::APPOINTMENTRECURRENCEPATTERN},
+			{3, parserType::CONVERSATIONINDEX},
+			{4, parserType::ENTRYID},
+			{5, parserType::ENTRYLIST},
+			{6, parserType::EXTENDEDFOLDERFLAGS},
+			{7, parserType::EXTENDEDRULECONDITION},
+			{8, parserType::FLATENTRYLIST},
+			{9, parserType::FOLDERUSERFIELDS},
+			{10, parserType::GLOBALOBJECTID},
+			{11, parserType::PROPERTIES},
+			{12, parserType::PROPERTYDEFINITIONSTREAM},
+			{13, parserType::RECIPIENTROWSTREAM},
+			{14, parserType::RECURRENCEPATTERN},
+			{15, parserType::REPORTTAG},
+			{16, parserType::RESTRICTION},
+			{17, parserType::RULECONDITION},
+			{18, parserType::SEARCHFOLDERDEFINITION},
+			{19, parserType::SECURITYDESCRIPTOR},
+			{20, parserType::SID},
+			{21, parserType::TASKASSIGNERS},
+			{22, parserType::TIMEZONE},
+			{23, parserType::TIMEZONEDEFINITION},
+			{24, parserType::WEBVIEWPERSISTSTREAM},
+			{25, parserType::NICKNAMECACHE},
+			{26, parserType::ENCODEENTRYID},
+			{27, parserType::DECODEENTRYID},
+			{28, parserType::VERBSTREAM},
+			{29, parserType::TOMBSTONE},
+			{30, parserType::PCL},
+			{31, parserType::FBSECURITYDESCRIPTOR},
+			{32, parserType::XID},
+			{33, parserType::RULEACTION},
+			{34, parserType::EXTENDEDRULEACTION},
+			{38, parserType::SWAPPEDTODO},
+		};
+
+		std::wstring formatResult(const result& line)
+		{
+			return strings::format(
+				L"%ws\t%zu\t%zu\t%.3f\t%.3f\t%zu\t%zu\t%zu\t%zu\n", // STRING_OK
+				line.parser.c_str(),
+				line.blobs,
+				line.bytes,
+				line.parseNsPerByte,
+				line.toStringNsPerByte,
+				line.parseAllocs,
+				line.toStringAllocs,
+				line.parsePeak,
+				line.toStringPeak);
+		}
+
+		_Check_return_ bool saveResults(const std::wstring& szPath, const std::vector<result>& results)
+		{
+			const auto fOut = output::MyOpenFile(szPath, true);
+			if (!fOut) return false;
+
+			output::OutputToFile(fOut, resultHeader);
+			for (const auto& line : results)
+			{
+				output::OutputToFile(fOut, formatResult(line));
+			}
+
+			output::CloseFile(fOut);
+			return true;
+		}
+
+		namespace
+		{
+			// Older builds wrote raw UTF-16 LE, with no byte order mark
+			std::wstring decodeResults(const std::string& raw)
+			{
+				const auto lpb = reinterpret_cast<const BYTE*>(raw.data());
+				if (raw.size() >= 3 && lpb[0] == 0xEF && lpb[1] == 0xBB && lpb[2] == 0xBF)
+				{
+					return strings::utf8Towstring(raw.substr(3));
+				}
+
+				auto bUtf16 = raw.size() >= 2 && lpb[0] == 0xFF && lpb[1] == 0xFE;
+				if (!bUtf16 && raw.size() >= 2 && raw.size() % sizeof(wchar_t) == 0 && lpb[0] && !lpb[1]) bUtf16 = true;
+				if (bUtf16)
+				{
+					auto szText = std::wstring(
+						reinterpret_cast<const wchar_t*>(raw.data()), raw.size() / sizeof(wchar_t));
+					if (!szText.empty() && szText[0] == L'\xFEFF') szText.erase(0, 1);
+					return szText;
+				}
+
+				return strings::utf8Towstring(raw);
+			}
+		} // namespace
+
+		std::map<std::wstring, result> loadResults(const std::wstring& szPath)
+		{
+			auto results = std::map<std::wstring, result>{};
+			const auto fIn = output::MyOpenFileMode(szPath, L"rb");
+			if (!fIn) return results;
+
+			auto raw = std::string{};
+			char buffer[0x1000];
+			for (auto cb = fread(buffer, 1, sizeof buffer, fIn); cb; cb = fread(buffer, 1, sizeof buffer, fIn))
+			{
+				raw.append(buffer, cb);
+			}
+
+			fclose(fIn);
+
+			auto bRetained = false;
+			for (const auto& line : strings::split(strings::StripCarriage(decodeResults(raw)), L'\n'))
+			{
+				const auto fields = strings::split(line, L'\t');
+				if (fields.size() < 9) continue;
+				if (fields[0] == L"parser") // STRING_OK
+				{
+					// Some builds wrote what heap was still held after each call, which isn't comparable to a peak
+					bRetained = fields[7] == L"parse retained"; // STRING_OK
+					continue;
+				}
+
+				auto entry = result{};
+				entry.parser = fields[0];
+				entry.blobs = strings::wstringToUlong(fields[1], 10);
+				entry.bytes = strings::wstringToUlong(fields[2], 10);
+				entry.parseNsPerByte = strings::wstringToDouble(fields[3]);
+				entry.toStringNsPerByte = strings::wstringToDouble(fields[4]);
+				entry.parseAllocs = strings::wstringToUlong(fields[5], 10);
+				entry.toStringAllocs = strings::wstringToUlong(fields[6], 10);
+				if (!bRetained)
+				{
+					entry.parsePeak = strings::wstringToUlong(fields[7], 10);
+					entry.toStringPeak = strings::wstringToUlong(fields[8], 10);
+				}
+
+				results[entry.parser] = entry;
+			}
+
+			return results;
+		}
+	} // namespace benchmark
+} // namespace smartview
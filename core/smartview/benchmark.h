@@ -0,0 +1,46 @@
+#pragma once
+
+// Forward declarations
+enum class parserType;
+
+namespace smartview
+{
+	// benchmark - the Smart View test corpus and the results files MrMAPI's parser benchmark writes.
+	// MrMAPI saves a run's results to compare later runs against, so the file format is shared here
+	// with the unit tests which check it reads back what it wrote.
+	namespace benchmark
+	{
+		// Corpus files are named <prefix>-<name>.dat, as in UnitTest\SmartViewTestData\In.
+		// The prefix picks the parser. The unit tests load the same files as resources numbered prefix * 1000 + n.
+		extern const std::vector<std::pair<ULONG, parserType>> corpusPrefixes;
+
+		// Per parse figures for one parser, one line of a results file
+		struct result
+		{
+			std::wstring parser;
+			size_t blobs{};
+			size_t bytes{}; // Input bytes across the parser's blobs
+			double parseNsPerByte{};
+			double toStringNsPerByte{};
+			size_t parseAllocs{};
+			size_t toStringAllocs{};
+			// Most heap a single parse or toString held at once, including memory it freed before returning.
+			// Only debug builds, whose CRT lets us watch every allocation, measure these. Otherwise they're 0.
+			size_t parsePeak{};
+			size_t toStringPeak{};
+		};
+
+		constexpr auto resultHeader =
+			L"parser\tblobs\tbytes\tparse ns/byte\ttoString ns/byte\tparse allocs\ttoString allocs\t"
+			L"parse peak\ttoString peak\n"; // STRING_OK
+
+		// One tab separated line per parser, so results files diff cleanly
+		std::wstring formatResult(const result& line);
+
+		// Results files are UTF-8 text with a byte order mark
+		_Check_return_ bool saveResults(const std::wstring& szPath, const std::vector<result>& results);
+		// Reads a results file back in, keyed by parser name. Also reads the UTF-16 files older builds wrote.
+		// Files which recorded retained heap rather than peaks load with peaks of 0.
+		std::map<std::wstring, result> loadResults(const std::wstring& szPath);
+	} // namespace benchmark
+} // namespace smartview
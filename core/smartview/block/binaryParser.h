@@ -11,12 +11,36 @@ namespace smartview
 		binaryParser(size_t cb, _In_count_(cb) const BYTE* _bin)
 		{
 			bin = _bin && cb ? std::vector<BYTE>(_bin, _bin + cb) : std::vector<BYTE>{};
-			size = bin.size();
+			lpBin = bin.data();
+			cbBin = bin.size();
+			size = cbBin;
 		}
 		binaryParser(const std::vector<BYTE>& _bin)
 		{
 			bin = _bin;
-			size = bin.size();
+			lpBin = bin.data();
+			cbBin = bin.size();
+			size = cbBin;
+		}
+
+		// Build a parser over memory we do not own. No copy is made.
+		// The caller must keep _bin alive for as long as the parser or any block parsed from it is in use.
+		static std::shared_ptr<binaryParser> borrow(size_t cb, _In_count_(cb) const BYTE* _bin)
+		{
+			auto ret = std::make_shared<binaryParser>();
+			if (_bin && cb)
+			{
+				ret->lpBin = _bin;
+				ret->cbBin = cb;
+				ret->size = cb;
+			}
+
+			return ret;
+		}
+
+		static std::shared_ptr<binaryParser> borrow(const std::vector<BYTE>& _bin)
+		{
+			return borrow(_bin.size(), _bin.data());
 		}
 
 		binaryParser(const binaryParser&) = delete;
@@ -25,9 +49,16 @@ namespace smartview
 		bool empty() const noexcept { return offset == size; }
 		void advance(size_t cb) noexcept { offset += cb; }
 		void rewind() noexcept { offset = 0; }
+		// Skip to the end of the buffer, past any cap, so nothing more can be read
+		void drain() noexcept { offset = cbBin; }
 		size_t getOffset() const noexcept { return offset; }
 		void setOffset(size_t _offset) noexcept { offset = _offset; }
-		const BYTE* getAddress() const noexcept { return bin.data() + offset; }
+		const BYTE* getAddress() const noexcept { return lpBin + offset; }
+		// Address of an absolute offset into the buffer, ignoring our current position and cap
+		const BYTE* getAddressAt(size_t _offset) const noexcept
+		{
+			return lpBin && _offset <= cbBin ? lpBin + _offset : nullptr;
+		}
 		void setCap(size_t cap)
 		{
 			sizes.push(size);
@@ -41,7 +72,7 @@ namespace smartview
 		{
 			if (sizes.empty())
 			{
-				size = bin.size();
+				size = cbBin;
 			}
 			else
 			{
@@ -57,9 +88,11 @@ namespace smartview
 		bool checkSize(size_t cb) const noexcept { return cb <= getSize(); }
 
 	private:
-		std::vector<BYTE> bin;
+		std::vector<BYTE> bin; // Our copy of the data. Empty if we're borrowing the caller's buffer.
+		const BYTE* lpBin{}; // The buffer we parse - either bin.data() or the caller's buffer
+		size_t cbBin{};
 		size_t offset{};
-		size_t size{}; // When uncapped, this is bin.size(). When capped, this is our artificial capped size.
+		size_t size{}; // When uncapped, this is cbBin. When capped, this is our artificial capped size.
 		std::stack<size_t> sizes;
 	};
 } // namespace smartview
\ No newline at end of file
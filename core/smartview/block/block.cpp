@@ -5,7 +5,7 @@
 
 namespace smartview
 {
-	std::shared_ptr<block> block::create() { return std::make_shared<scratchBlock>(); }
+	std::shared_ptr<block> block::create() { return makeBlock<scratchBlock>(); }
 
 	void block::addHeader(const std::wstring& _text) { addChild(create(_text)); }
 
@@ -34,72 +34,156 @@ namespace smartview
 	void block::ensureParsed()
 	{
 		if (parsed || !parser || parser->empty()) return;
+
+		// Once the parse budget is spent, drain the parser so everything above us stops too
+		const auto budget = parseBudget::current();
+		if (budget && !budget->check())
+		{
+			parser->drain();
+			return;
+		}
+
 		parsed = true; // parse can unset this if needed
 		// Our offset is the parser's starting offset
 		setOffset(parser->getOffset());
 
+		parsing = true;
 		parse();
-		parseBlocks();
+		parsing = false;
+
+		// Our size is the parser's ending offset minus our offset
+		setSize(parser->getOffset() - getOffset());
 
-		if (this->hasData() && enableJunk && parser->getSize())
+		// Only blocks with data get to claim junk, so if there's junk we have to build our blocks now to know
+		if (enableJunk && parser->getSize() && this->hasData())
 		{
 			auto junkData = blockBytes::parse(parser, parser->getSize());
 			addLabeledChild(strings::formatmessage(L"Unparsed data size = 0x%1!08X!", junkData->size()), junkData);
+			setSize(parser->getOffset() - getOffset());
 		}
+	}
 
-		// And our size is the parser's ending offset minus our offset
-		setSize(parser->getOffset() - getOffset());
+	void block::ensureBlocks()
+	{
+		if (blocksBuilt || parsing || !parsed) return;
+		blocksBuilt = true;
+		parseBlocks();
 	}
 
-	std::vector<std::wstring> tabStrings(const std::vector<std::wstring>& elems, bool usePipes)
+	// blockWriter - renders a block tree in a single pass.
+	// Output accumulates in one buffer. With a sink, the buffer is handed off whenever it fills,
+	// so arbitrarily large trees can be streamed out without holding the whole string.
+	// Leading and trailing whitespace is trimmed and embedded nulls become dots as we go.
+	class blockWriter
 	{
-		if (elems.empty()) return {};
+	public:
+		explicit blockWriter(_In_opt_ const std::function<void(const std::wstring&)>* _sink = nullptr) : sink(_sink)
+		{
+			if (sink) buffer.reserve(flushSize);
+		}
 
-		std::vector<std::wstring> strings;
-		strings.reserve(elems.size());
-		auto iter = elems.begin();
-		for (const auto& elem : elems)
+		void write(const std::wstring& str)
 		{
-			if (usePipes)
-			{
-				strings.emplace_back(L"|\t" + elem);
-			}
-			else
+			const auto cch = str.length();
+			auto i = size_t{};
+			while (i < cch)
 			{
-				strings.emplace_back(L"\t" + elem);
+				// Leading whitespace is dropped. Anything after that is held until we know it isn't trailing.
+				auto j = i;
+				while (j < cch && isWhitespace(str[j]))
+					j++;
+				if (started && j > i) pending.append(str, i, j - i);
+				if (j == cch) break;
+
+				auto k = j;
+				while (k < cch && !isWhitespace(str[k]))
+					k++;
+
+				started = true;
+				if (!pending.empty())
+				{
+					// If we built a string with embedded nulls in it, replace them with dots.
+					std::replace(pending.begin(), pending.end(), L'\0', L'.');
+					buffer += pending;
+					pending.clear();
+				}
+
+				buffer.append(str, j, k - j);
+				i = k;
 			}
+
+			if (sink && buffer.size() >= flushSize) flush();
 		}
 
-		return strings;
-	}
+		// Drops any trailing whitespace and hands off whatever is left
+		std::wstring close()
+		{
+			pending.clear();
+			if (sink) flush();
+			return std::move(buffer);
+		}
+
+	private:
+		static bool isWhitespace(wchar_t chr) noexcept
+		{
+			return chr == L'\0' || chr == L' ' || chr == L'\r' || chr == L'\n' || chr == L'\t';
+		}
+
+		void flush()
+		{
+			if (!buffer.empty()) (*sink)(buffer);
+			buffer.clear();
+		}
+
+		static constexpr size_t flushSize = 0x10000;
 
-	std::vector<std::wstring> block::toStringsInternal() const
+		const std::function<void(const std::wstring&)>* sink{};
+		std::wstring buffer;
+		std::wstring pending;
+		bool started{};
+	};
+
+	// Each node's text gets a line, indented by the tabs (or pipes) of every ancestor with text
+	void block::writeStrings(blockWriter& writer, std::wstring& prefix) const
 	{
-		std::vector<std::wstring> strings;
-		strings.reserve(children.size() + 1);
-		if (!text.empty()) strings.push_back(text + L"\r\n");
+		const auto hasText = !text.empty();
+		const auto cchPrefix = prefix.length();
+		if (hasText)
+		{
+			writer.write(prefix);
+			writer.write(text);
+			writer.write(L"\r\n");
+			prefix += usePipes() ? L"|\t" : L"\t";
+		}
 
 		for (const auto& child : children)
 		{
-			auto childStrings = child->toStringsInternal();
-			if (!text.empty()) childStrings = tabStrings(childStrings, usePipes());
-			strings.insert(std::end(strings), std::begin(childStrings), std::end(childStrings));
+			child->ensureBlocks();
+			child->writeStrings(writer, prefix);
 		}
 
-		return strings;
+		prefix.resize(cchPrefix);
 	}
 
 	std::wstring block::toString()
 	{
 		ensureParsed();
+		ensureBlocks();
 
-		auto strings = toStringsInternal();
-		auto parsedString = strings::trimWhitespace(strings::join(strings, strings::emptystring));
+		auto writer = blockWriter{};
+		auto prefix = std::wstring{};
+		writeStrings(writer, prefix);
+		return writer.close();
+	}
 
-		// If we built a string with embedded nulls in it, replace them with dots.
-		std::replace_if(
-			parsedString.begin(), parsedString.end(), [](const WCHAR& chr) { return chr == L'\0'; }, L'.');
+	void block::toString(const std::function<void(const std::wstring&)>& sink)
+	{
+		ensureParsed();
+		ensureBlocks();
 
-		return parsedString;
+		auto writer = blockWriter{&sink};
+		auto prefix = std::wstring{};
+		writeStrings(writer, prefix);
+		writer.close();
 	}
 } // namespace smartview
\ No newline at end of file
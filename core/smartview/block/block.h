@@ -1,9 +1,39 @@
 #pragma once
 #include <core/smartview/block/binaryParser.h>
+#include <core/smartview/block/blockArena.h>
 #include <core/utility/strings.h>
 
 namespace smartview
 {
+	class blockWriter;
+
+	// Typed view of the data a block parsed, for structured output.
+	// data points into the block, so it's only good as long as the block is.
+	struct blockValue
+	{
+		enum class valueType
+		{
+			none, // Text only
+			boolean,
+			unsignedInt,
+			signedInt,
+			floating,
+			guid,
+			filetime,
+			bytes,
+			stringA,
+			stringW,
+		};
+
+		valueType type{valueType::none};
+		size_t width{}; // Size of the parsed type, for the numeric types
+		ULONGLONG number{}; // boolean, unsignedInt, signedInt (two's complement) and filetime
+		double floating{};
+		GUID guid{};
+		const void* data{}; // bytes, stringA and stringW
+		size_t cb{}; // Bytes at data
+	};
+
 	constexpr ULONG _MaxBytes = 0xFFFF;
 	constexpr ULONG _MaxDepth = 25;
 	constexpr ULONG _MaxEID = 500;
@@ -20,23 +50,41 @@ namespace smartview
 		block& operator=(const block&) = delete;
 
 		// Getters and setters
+		// Text and children are built on demand by parseBlocks the first time they're asked for,
+		// so callers which only want the parsed values never pay for rendering.
 		// Get the text for just this block
-		const std::wstring& getText() const noexcept { return text; }
+		const std::wstring& getText()
+		{
+			ensureBlocks();
+			return text;
+		}
 		// Get the text for this and all child blocks
 		std::wstring toString();
+		// Stream the text for this and all child blocks to sink in chunks, without building the whole string
+		void toString(const std::function<void(const std::wstring&)>& sink);
 		template <typename... Args> void setText(const std::wstring& _text, Args... args)
 		{
+			ensureBlocks();
 			text = strings::formatmessage(_text.c_str(), args...);
 		}
-		void setText(const std::wstring& _text) { text = _text.c_str(); }
+		void setText(const std::wstring& _text)
+		{
+			ensureBlocks();
+			text = _text.c_str();
+		}
 
-		const std::vector<std::shared_ptr<block>>& getChildren() const noexcept { return children; }
+		const std::vector<std::shared_ptr<block>>& getChildren()
+		{
+			ensureBlocks();
+			return children;
+		}
 		size_t getSize() const noexcept { return cb; }
 		void setSize(size_t _size) noexcept { cb = _size; }
 		size_t getOffset() const noexcept { return offset; }
 		void setOffset(size_t _offset) noexcept { offset = _offset; }
 		void shiftOffset(size_t _shift)
 		{
+			ensureBlocks();
 			offset = offset + _shift;
 			for (const auto& child : children)
 			{
@@ -47,6 +95,7 @@ namespace smartview
 		ULONG getSource() const noexcept { return source; }
 		void setSource(ULONG _source)
 		{
+			ensureBlocks();
 			source = _source;
 			for (const auto& child : children)
 			{
@@ -54,23 +103,34 @@ namespace smartview
 			}
 		}
 
+		// Typed value of this block, if it has one. Blocks which only carry text leave it empty.
+		virtual blockValue getValue() const { return {}; }
+
 		bool isSet() const noexcept { return parsed; }
 		bool isHeader() const noexcept { return cb == 0 && offset == 0; }
-		bool hasData() const noexcept { return !text.empty() || !children.empty(); }
+		bool hasData()
+		{
+			ensureBlocks();
+			return !text.empty() || !children.empty();
+		}
 
 		// Add child blocks of various types
 		void addChild(const std::shared_ptr<block>& child)
 		{
 			if (child && child->isSet())
 			{
+				ensureBlocks();
 				children.push_back(child);
 			}
 		}
 
+		// The label we give the child replaces whatever text it builds for itself
 		void addChild(const std::shared_ptr<block>& child, const std::wstring& _text)
 		{
 			if (child && child->isSet())
 			{
+				ensureBlocks();
+				child->ensureBlocks();
 				child->text = _text;
 				children.push_back(child);
 			}
@@ -81,6 +141,8 @@ namespace smartview
 		{
 			if (child && child->isSet())
 			{
+				ensureBlocks();
+				child->ensureBlocks();
 				child->text = strings::formatmessage(_text.c_str(), args...);
 				children.push_back(child);
 			}
@@ -134,7 +196,7 @@ namespace smartview
 		static std::shared_ptr<T>
 		parse(const std::shared_ptr<binaryParser>& binaryParser, size_t cbBin, bool _enableJunk)
 		{
-			auto ret = std::make_shared<T>();
+			auto ret = makeBlock<T>();
 			ret->block::parse(binaryParser, cbBin, _enableJunk);
 			return ret;
 		}
@@ -156,18 +218,22 @@ namespace smartview
 
 	protected:
 		void ensureParsed();
+		void ensureBlocks();
 		std::shared_ptr<binaryParser> parser;
 		bool parsed{false};
 		bool enableJunk{true};
 
 	private:
-		std::vector<std::wstring> toStringsInternal() const;
+		void writeStrings(blockWriter& writer, std::wstring& prefix) const;
 		// Consume binaryParser and populate members (which may also inherit from block)
 		virtual void parse() = 0;
 		// (optional) Stitches block submembers into a tree via children member
+		// Called on demand once parsing is complete - must not touch the parser
 		virtual void parseBlocks(){};
 		virtual bool usePipes() const { return false; }
 
+		bool parsing{false};
+		bool blocksBuilt{false};
 		size_t offset{};
 		size_t cb{};
 		ULONG source{};
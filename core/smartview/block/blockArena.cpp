@@ -0,0 +1,80 @@
+#include <core/stdafx.h>
+#include <core/smartview/block/blockArena.h>
+
+namespace smartview
+{
+	namespace
+	{
+		thread_local blockArena* currentArena{};
+
+		size_t alignPadding(const BYTE* address, size_t align) noexcept
+		{
+			const auto misalignment = reinterpret_cast<uintptr_t>(address) % align;
+			return misalignment ? align - misalignment : 0;
+		}
+
+		std::atomic<size_t> statBlocks{};
+		std::atomic<size_t> statHeapAllocations{};
+		std::atomic<size_t> statBytes{};
+	} // namespace
+
+	blockArena::scope::scope() : arena(new blockArena()), previous(currentArena) { currentArena = arena; }
+
+	blockArena::scope::~scope()
+	{
+		currentArena = previous;
+		// Drop the scope's reference. The arena lives on until every block allocated from it is gone.
+		arena->release();
+	}
+
+	blockArena* blockArena::current() noexcept { return currentArena; }
+
+	blockArena::~blockArena()
+	{
+		for (const auto chunk : chunks)
+		{
+			delete[] chunk;
+		}
+	}
+
+	_Ret_notnull_ void* blockArena::allocate(size_t cb, size_t align)
+	{
+		auto padding = alignPadding(next, align);
+		if (!next || padding + cb > remaining)
+		{
+			// Oversized requests get a chunk of their own
+			const auto cbChunk = cb + align > chunkSize ? cb + align : chunkSize;
+			const auto chunk = new BYTE[cbChunk];
+			chunks.push_back(chunk);
+			statHeapAllocations++;
+			next = chunk;
+			remaining = cbChunk;
+			padding = alignPadding(next, align);
+		}
+
+		const auto ret = next + padding;
+		next = ret + cb;
+		remaining -= padding + cb;
+		addRef();
+		return ret;
+	}
+
+	blockArena::stats blockArena::getStats() noexcept
+	{
+		return {statBlocks.load(), statHeapAllocations.load(), statBytes.load()};
+	}
+
+	void blockArena::resetStats() noexcept
+	{
+		statBlocks = 0;
+		statHeapAllocations = 0;
+		statBytes = 0;
+	}
+
+	void blockArena::countBlock(size_t cb, bool onHeap) noexcept
+	{
+		statBlocks++;
+		statBytes += cb;
+		if (onHeap) statHeapAllocations++;
+	}
+} // namespace smartview
\ No newline at end of file
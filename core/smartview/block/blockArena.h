@@ -0,0 +1,116 @@
+#pragma once
+#include <core/smartview/block/parseBudget.h>
+#include <atomic>
+
+namespace smartview
+{
+	// blockArena - monotonic allocator for the block tree built by a single parse.
+	// Blocks (and their shared_ptr control blocks) are carved out of large chunks instead
+	// of each getting their own heap allocation. Individual frees are no-ops - the whole
+	// arena is released in one shot when the last block allocated from it goes away.
+	//
+	// Usage: place a blockArena::scope on the stack around a parse. Any block allocated
+	// via makeBlock on this thread while the scope is active lands in its arena.
+	class blockArena
+	{
+	public:
+		blockArena(const blockArena&) = delete;
+		blockArena& operator=(const blockArena&) = delete;
+
+		class scope
+		{
+		public:
+			scope();
+			~scope();
+			scope(const scope&) = delete;
+			scope& operator=(const scope&) = delete;
+
+		private:
+			blockArena* arena{};
+			blockArena* previous{};
+		};
+
+		// The arena for the parse currently running on this thread, if any
+		static blockArena* current() noexcept;
+
+		_Ret_notnull_ void* allocate(size_t cb, size_t align);
+		void deallocate() noexcept { release(); }
+
+		// Process wide counters so we can measure how many heap allocations block trees cost
+		struct stats
+		{
+			size_t blocks{}; // Blocks allocated, in or out of an arena
+			size_t heapAllocations{}; // Heap allocations made for blocks - one per block without an arena
+			size_t bytes{}; // Bytes requested for blocks
+		};
+		static stats getStats() noexcept;
+		static void resetStats() noexcept;
+		static void countBlock(size_t cb, bool onHeap) noexcept;
+
+	private:
+		blockArena() = default;
+		~blockArena();
+
+		void addRef() noexcept { live++; }
+		void release() noexcept
+		{
+			if (--live == 0) delete this;
+		}
+
+		static constexpr size_t chunkSize = 0x10000;
+
+		std::vector<BYTE*> chunks;
+		BYTE* next{};
+		size_t remaining{};
+		// Count of outstanding allocations plus one for the scope that created us
+		std::atomic<size_t> live{1};
+	};
+
+	// std allocator which carves from a blockArena. Used with std::allocate_shared so the
+	// control block and the block share a single arena allocation.
+	template <typename T> class blockArenaAllocator
+	{
+	public:
+		using value_type = T;
+
+		explicit blockArenaAllocator(blockArena* _arena) noexcept : arena(_arena) {}
+		template <typename U>
+		blockArenaAllocator(const blockArenaAllocator<U>& other) noexcept : arena(other.getArena())
+		{
+		}
+
+		_Ret_notnull_ T* allocate(size_t n)
+		{
+			return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+		}
+		void deallocate(T*, size_t) noexcept { arena->deallocate(); }
+
+		blockArena* getArena() const noexcept { return arena; }
+
+		template <typename U> bool operator==(const blockArenaAllocator<U>& other) const noexcept
+		{
+			return arena == other.getArena();
+		}
+		template <typename U> bool operator!=(const blockArenaAllocator<U>& other) const noexcept
+		{
+			return arena != other.getArena();
+		}
+
+	private:
+		blockArena* arena{};
+	};
+
+	// Allocate a block, using the current parse's arena if there is one
+	template <typename T, typename... Args> std::shared_ptr<T> makeBlock(Args&&... args)
+	{
+		const auto arena = blockArena::current();
+		blockArena::countBlock(sizeof(T), arena == nullptr);
+		if (const auto budget = parseBudget::current()) budget->chargeBlock(sizeof(T));
+		if (arena)
+		{
+			return std::allocate_shared<T>(blockArenaAllocator<T>(arena), std::forward<Args>(args)...);
+		}
+
+		return std::make_shared<T>(std::forward<Args>(args)...);
+	}
+} // namespace smartview
\ No newline at end of file
@@ -12,15 +12,28 @@ namespace smartview
 		blockBytes& operator=(const blockBytes&) = delete;
 
 		// Mimic std::vector<BYTE>
-		operator const std::vector<BYTE>&() const noexcept { return _data; }
-		size_t size() const noexcept { return _data.size(); }
-		bool empty() const noexcept { return _data.empty(); }
-		const BYTE* data() const noexcept { return _data.data(); }
+		// We don't hold our own copy of the bytes, just an offset and length into our parser's buffer.
+		operator std::vector<BYTE>() const
+		{
+			return empty() ? std::vector<BYTE>{} : std::vector<BYTE>(data(), data() + cbData);
+		}
+		size_t size() const noexcept { return cbData; }
+		bool empty() const noexcept { return cbData == 0; }
+		const BYTE* data() const noexcept { return parser && cbData ? parser->getAddressAt(dataOffset) : nullptr; }
+
+		blockValue getValue() const override
+		{
+			auto ret = blockValue{};
+			ret.type = blockValue::valueType::bytes;
+			ret.data = data();
+			ret.cb = size();
+			return ret;
+		}
 
 		static std::shared_ptr<blockBytes>
 		parse(const std::shared_ptr<binaryParser>& parser, size_t _cbBytes, size_t _cbMaxBytes = -1)
 		{
-			auto ret = std::make_shared<blockBytes>();
+			auto ret = makeBlock<blockBytes>();
 			ret->parser = parser;
 			ret->enableJunk = false;
 			ret->cbBytes = _cbBytes;
@@ -31,15 +44,17 @@ namespace smartview
 
 		std::wstring toTextString(bool bMultiLine) const
 		{
-			return strings::StripCharacter(strings::BinToTextStringW(_data, bMultiLine), L'\0');
+			const auto bin = SBinary{static_cast<ULONG>(size()), const_cast<LPBYTE>(data())};
+			return strings::StripCharacter(strings::BinToTextStringW(&bin, bMultiLine), L'\0');
 		}
 
-		std::wstring toHexString(bool bMultiLine) const { return strings::BinToHexString(_data, bMultiLine); }
+		std::wstring toHexString(bool bMultiLine) const { return strings::BinToHexString(data(), size(), bMultiLine); }
 
 		bool equal(size_t _cb, const BYTE* _bin) const noexcept
 		{
-			if (_cb != _data.size()) return false;
-			return memcmp(_data.data(), _bin, _cb) == 0;
+			if (_cb != cbData) return false;
+			if (!_cb) return true;
+			return memcmp(data(), _bin, _cb) == 0;
 		}
 
 	private:
@@ -49,20 +64,22 @@ namespace smartview
 			if (cbBytes && parser->checkSize(cbBytes) &&
 				(cbMaxBytes == static_cast<size_t>(-1) || cbBytes <= cbMaxBytes))
 			{
-				_data = std::vector<BYTE>{
-					const_cast<LPBYTE>(parser->getAddress()), const_cast<LPBYTE>(parser->getAddress() + cbBytes)};
+				dataOffset = parser->getOffset();
+				cbData = cbBytes;
 				parser->advance(cbBytes);
-				setText(toHexString(true));
 				parsed = true;
 			}
 		};
 
-		// TODO: Would it be better to hold the parser and size/offset data and build this as needed?
-		std::vector<BYTE> _data;
+		void parseBlocks() override { setText(toHexString(true)); }
+
+		// Location of our bytes in parser's buffer. The parser keeps the bytes alive for us.
+		size_t dataOffset{};
+		size_t cbData{};
 
 		size_t cbBytes{};
 		size_t cbMaxBytes{};
 	};
 
-	inline std::shared_ptr<blockBytes> emptyBB() { return std::make_shared<blockBytes>(); }
+	inline std::shared_ptr<blockBytes> emptyBB() { return makeBlock<blockBytes>(); }
 } // namespace smartview
\ No newline at end of file
@@ -0,0 +1,461 @@
+#include <core/stdafx.h>
+#include <core/smartview/block/blockEmitter.h>
+#include <core/interpret/guid.h>
+#include <cmath>
+
+namespace smartview
+{
+	namespace
+	{
+		// Text before the first " = " or ": " is the field name, as is a label ending in a colon.
+		// Unlabeled bytes render as "cb: 2 lpb: 0102", which names nothing.
+		std::wstring fieldName(const std::wstring& text, const blockValue& value)
+		{
+			if (value.type == blockValue::valueType::bytes && text.compare(0, 4, L"cb: ") == 0) return {};
+
+			const auto trimmed = strings::trimWhitespace(text);
+			if (!trimmed.empty() && trimmed.back() == L':' && trimmed.find(L'\n') == std::wstring::npos)
+			{
+				return strings::trimWhitespace(trimmed.substr(0, trimmed.length() - 1));
+			}
+
+			const auto equals = text.find(L" = ");
+			const auto colon = text.find(L": ");
+			const auto split = min(equals, colon);
+			if (split == std::wstring::npos) return {};
+
+			return strings::trimWhitespace(text.substr(0, split));
+		}
+
+		std::string typeName(const blockValue& value)
+		{
+			switch (value.type)
+			{
+			case blockValue::valueType::boolean:
+				return "bool";
+			case blockValue::valueType::unsignedInt:
+				return "u" + std::to_string(value.width * 8);
+			case blockValue::valueType::signedInt:
+				return "i" + std::to_string(value.width * 8);
+			case blockValue::valueType::floating:
+				return "f" + std::to_string(value.width * 8);
+			case blockValue::valueType::guid:
+				return "guid";
+			case blockValue::valueType::filetime:
+				return "filetime";
+			case blockValue::valueType::bytes:
+				return "bytes";
+			case blockValue::valueType::stringA:
+				return "stringA";
+			case blockValue::valueType::stringW:
+				return "stringW";
+			default:
+				return {};
+			}
+		}
+
+		// Accumulates output and hands it to the sink whenever the buffer fills
+		class emitter
+		{
+		public:
+			emitter(emitFormat _format, _In_opt_ const std::function<void(const std::string&)>* _sink)
+				: format(_format), sink(_sink)
+			{
+				if (sink) buffer.reserve(flushSize);
+			}
+
+			void emit(const std::shared_ptr<block>& root)
+			{
+				if (format == emitFormat::binary)
+				{
+					buffer += "SVB";
+					buffer += '\x01';
+					writeBinary(*root);
+				}
+				else
+				{
+					writeJson(*root);
+				}
+			}
+
+			std::string close()
+			{
+				if (sink) flush();
+				return std::move(buffer);
+			}
+
+		private:
+			void flushIfFull()
+			{
+				if (sink && buffer.size() >= flushSize) flush();
+			}
+
+			void flush()
+			{
+				if (!buffer.empty()) (*sink)(buffer);
+				buffer.clear();
+			}
+
+			// UTF-16 to UTF-8. Nulls become dots, as they do in toString.
+			void appendUtf8(const wchar_t* str, size_t cch, bool jsonEscape)
+			{
+				for (size_t i = 0; i < cch; i++)
+				{
+					auto ch = static_cast<ULONG>(str[i]);
+					if (ch >= 0xD800 && ch <= 0xDBFF && i + 1 < cch && str[i + 1] >= 0xDC00 && str[i + 1] <= 0xDFFF)
+					{
+						ch = 0x10000 + ((ch - 0xD800) << 10) + (str[++i] - 0xDC00);
+					}
+					else if (ch >= 0xD800 && ch <= 0xDFFF)
+					{
+						ch = 0xFFFD;
+					}
+
+					if (ch == 0) ch = L'.';
+
+					if (ch < 0x80)
+					{
+						if (jsonEscape)
+						{
+							appendJsonChar(static_cast<char>(ch));
+						}
+						else
+						{
+							buffer += static_cast<char>(ch);
+						}
+					}
+					else if (ch < 0x800)
+					{
+						buffer += static_cast<char>(0xC0 | ch >> 6);
+						buffer += static_cast<char>(0x80 | (ch & 0x3F));
+					}
+					else if (ch < 0x10000)
+					{
+						buffer += static_cast<char>(0xE0 | ch >> 12);
+						buffer += static_cast<char>(0x80 | (ch >> 6 & 0x3F));
+						buffer += static_cast<char>(0x80 | (ch & 0x3F));
+					}
+					else
+					{
+						buffer += static_cast<char>(0xF0 | ch >> 18);
+						buffer += static_cast<char>(0x80 | (ch >> 12 & 0x3F));
+						buffer += static_cast<char>(0x80 | (ch >> 6 & 0x3F));
+						buffer += static_cast<char>(0x80 | (ch & 0x3F));
+					}
+				}
+			}
+
+			void appendJsonChar(char ch)
+			{
+				static const char hexDigits[] = "0123456789abcdef";
+				switch (ch)
+				{
+				case '"':
+					buffer += "\\\"";
+					break;
+				case '\\':
+					buffer += "\\\\";
+					break;
+				case '\n':
+					buffer += "\\n";
+					break;
+				case '\r':
+					buffer += "\\r";
+					break;
+				case '\t':
+					buffer += "\\t";
+					break;
+				default:
+					if (static_cast<unsigned char>(ch) < 0x20)
+					{
+						buffer += "\\u00";
+						buffer += hexDigits[ch >> 4];
+						buffer += hexDigits[ch & 0xF];
+					}
+					else
+					{
+						buffer += ch;
+					}
+				}
+			}
+
+			void appendJsonString(const std::wstring& str)
+			{
+				buffer += '"';
+				appendUtf8(str.c_str(), str.length(), true);
+				buffer += '"';
+			}
+
+			// Narrow strings are in an unknown code page, so anything outside ASCII is taken as Latin-1
+			void appendJsonStringA(const char* str, size_t cch)
+			{
+				buffer += '"';
+				for (size_t i = 0; i < cch; i++)
+				{
+					const auto ch = static_cast<unsigned char>(str[i]);
+					if (ch == 0)
+					{
+						appendJsonChar('.');
+					}
+					else if (ch < 0x80)
+					{
+						appendJsonChar(static_cast<char>(ch));
+					}
+					else
+					{
+						const auto wch = static_cast<wchar_t>(ch);
+						appendUtf8(&wch, 1, true);
+					}
+				}
+
+				buffer += '"';
+			}
+
+			void appendJsonValue(const blockValue& value)
+			{
+				switch (value.type)
+				{
+				case blockValue::valueType::boolean:
+					buffer += value.number ? "true" : "false";
+					break;
+				case blockValue::valueType::unsignedInt:
+				case blockValue::valueType::filetime:
+					buffer += std::to_string(value.number);
+					break;
+				case blockValue::valueType::signedInt:
+					buffer += std::to_string(static_cast<LONGLONG>(value.number));
+					break;
+				case blockValue::valueType::floating:
+					if (std::isfinite(value.floating))
+					{
+						char sz[32]{};
+						snprintf(sz, sizeof sz, "%.17g", value.floating);
+						buffer += sz;
+					}
+					else
+					{
+						buffer += "null";
+					}
+
+					break;
+				case blockValue::valueType::guid:
+					appendJsonString(guid::GUIDToString(value.guid));
+					break;
+				case blockValue::valueType::bytes:
+				{
+					const auto hex = strings::BinToHexString(static_cast<const BYTE*>(value.data), value.cb, false);
+					buffer += '"';
+					appendUtf8(hex.c_str(), hex.length(), false);
+					buffer += '"';
+					break;
+				}
+				case blockValue::valueType::stringA:
+					appendJsonStringA(static_cast<const char*>(value.data), trimNulls(value));
+					break;
+				case blockValue::valueType::stringW:
+					buffer += '"';
+					appendUtf8(static_cast<const wchar_t*>(value.data), trimNulls(value), true);
+					buffer += '"';
+					break;
+				default:
+					buffer += "null";
+				}
+			}
+
+			// Parsed strings count their terminators, which aren't part of the value
+			static size_t trimNulls(const blockValue& value)
+			{
+				if (value.type == blockValue::valueType::stringW)
+				{
+					const auto str = static_cast<const wchar_t*>(value.data);
+					auto cch = value.cb / sizeof(wchar_t);
+					while (cch && !str[cch - 1])
+						cch--;
+					return cch;
+				}
+
+				const auto str = static_cast<const char*>(value.data);
+				auto cch = value.cb;
+				while (cch && !str[cch - 1])
+					cch--;
+				return cch;
+			}
+
+			void writeJson(block& node)
+			{
+				const auto& text = node.getText();
+				const auto value = node.getValue();
+				const auto name = fieldName(text, value);
+
+				buffer += '{';
+				if (!name.empty())
+				{
+					buffer += "\"name\":";
+					appendJsonString(name);
+					buffer += ',';
+				}
+
+				if (!text.empty())
+				{
+					buffer += "\"text\":";
+					appendJsonString(text);
+					buffer += ',';
+				}
+
+				buffer += "\"offset\":" + std::to_string(node.getOffset());
+				buffer += ",\"size\":" + std::to_string(node.getSize());
+				if (node.getSource()) buffer += ",\"source\":" + std::to_string(node.getSource());
+				if (value.type != blockValue::valueType::none)
+				{
+					buffer += ",\"type\":\"" + typeName(value) + "\",\"value\":";
+					appendJsonValue(value);
+				}
+
+				const auto& children = node.getChildren();
+				if (!children.empty())
+				{
+					buffer += ",\"children\":[";
+					auto first = true;
+					for (const auto& child : children)
+					{
+						if (!first) buffer += ',';
+						first = false;
+						writeJson(*child);
+					}
+
+					buffer += ']';
+				}
+
+				buffer += '}';
+				flushIfFull();
+			}
+
+			void appendU32(size_t value)
+			{
+				const auto dw = static_cast<DWORD>(value);
+				buffer += static_cast<char>(dw & 0xFF);
+				buffer += static_cast<char>(dw >> 8 & 0xFF);
+				buffer += static_cast<char>(dw >> 16 & 0xFF);
+				buffer += static_cast<char>(dw >> 24 & 0xFF);
+			}
+
+			void appendLittleEndian(ULONGLONG value, size_t width)
+			{
+				for (size_t i = 0; i < width; i++)
+				{
+					buffer += static_cast<char>(value >> (i * 8) & 0xFF);
+				}
+			}
+
+			// Length prefixed UTF-8. The length is patched in once we know it.
+			void appendLengthPrefixed(const wchar_t* str, size_t cch)
+			{
+				const auto cbStart = buffer.size();
+				appendU32(0);
+				appendUtf8(str, cch, false);
+				const auto cb = static_cast<DWORD>(buffer.size() - cbStart - sizeof DWORD);
+				for (size_t i = 0; i < sizeof DWORD; i++)
+				{
+					buffer[cbStart + i] = static_cast<char>(cb >> (i * 8) & 0xFF);
+				}
+			}
+
+			void appendBinaryValue(const blockValue& value)
+			{
+				switch (value.type)
+				{
+				case blockValue::valueType::boolean:
+				case blockValue::valueType::unsignedInt:
+				case blockValue::valueType::signedInt:
+					appendU32(value.width);
+					appendLittleEndian(value.number, value.width);
+					break;
+				case blockValue::valueType::filetime:
+					appendU32(sizeof ULONGLONG);
+					appendLittleEndian(value.number, sizeof ULONGLONG);
+					break;
+				case blockValue::valueType::floating:
+				{
+					auto bits = ULONGLONG{};
+					memcpy(&bits, &value.floating, sizeof bits);
+					appendU32(sizeof bits);
+					appendLittleEndian(bits, sizeof bits);
+					break;
+				}
+				case blockValue::valueType::guid:
+					appendU32(sizeof GUID);
+					appendLittleEndian(value.guid.Data1, sizeof value.guid.Data1);
+					appendLittleEndian(value.guid.Data2, sizeof value.guid.Data2);
+					appendLittleEndian(value.guid.Data3, sizeof value.guid.Data3);
+					buffer.append(reinterpret_cast<const char*>(value.guid.Data4), sizeof value.guid.Data4);
+					break;
+				case blockValue::valueType::bytes:
+					appendU32(value.cb);
+					if (value.cb) buffer.append(static_cast<const char*>(value.data), value.cb);
+					break;
+				case blockValue::valueType::stringA:
+				{
+					const auto cch = trimNulls(value);
+					appendU32(cch);
+					buffer.append(static_cast<const char*>(value.data), cch);
+					break;
+				}
+				case blockValue::valueType::stringW:
+					appendLengthPrefixed(static_cast<const wchar_t*>(value.data), trimNulls(value));
+					break;
+				default:
+					appendU32(0);
+				}
+			}
+
+			void writeBinary(block& node)
+			{
+				const auto& text = node.getText();
+				const auto value = node.getValue();
+				const auto name = fieldName(text, value);
+
+				appendU32(node.getOffset());
+				appendU32(node.getSize());
+				appendU32(node.getSource());
+				buffer += static_cast<char>(value.type);
+				buffer += static_cast<char>(value.width);
+				appendLengthPrefixed(name.c_str(), name.length());
+				appendLengthPrefixed(text.c_str(), text.length());
+				appendBinaryValue(value);
+
+				const auto& children = node.getChildren();
+				appendU32(children.size());
+				flushIfFull();
+				for (const auto& child : children)
+				{
+					writeBinary(*child);
+				}
+			}
+
+			static constexpr size_t flushSize = 0x10000;
+
+			emitFormat format;
+			const std::function<void(const std::string&)>* sink{};
+			std::string buffer;
+		};
+	} // namespace
+
+	void emitBlocks(
+		const std::shared_ptr<block>& root,
+		emitFormat format,
+		const std::function<void(const std::string&)>& sink)
+	{
+		if (!root) return;
+		auto writer = emitter{format, &sink};
+		writer.emit(root);
+		writer.close();
+	}
+
+	std::string emitBlocks(const std::shared_ptr<block>& root, emitFormat format)
+	{
+		if (!root) return {};
+		auto writer = emitter{format, nullptr};
+		writer.emit(root);
+		return writer.close();
+	}
+} // namespace smartview
@@ -0,0 +1,31 @@
+#pragma once
+#include <core/smartview/block/block.h>
+
+namespace smartview
+{
+	// Machine readable output for block trees, for tools which would otherwise have to scrape toString.
+	// Every node carries its field name, text, offset, size, source and typed value.
+	// The name is the part of the text before " = " or ": ", or a label ending in a colon.
+	// It's left out when the text has none of these.
+	//
+	// json: one compact UTF-8 object per tree:
+	//   {"name":"cb","text":"cb = 0x00000004","offset":0,"size":4,"type":"u32","value":4,"children":[...]}
+	//   Members with nothing to say are left out. Bytes are hex strings and GUIDs are in registry format.
+	// binary: "SVB" followed by a version byte (1), then the root node. Each node is, little endian:
+	//   u32 offset, u32 size, u32 source, u8 value type, u8 value width,
+	//   u32 cb + UTF-8 name, u32 cb + UTF-8 text, u32 cb + value, u32 child count, then the children.
+	//   Value types are numbered as in blockValue::valueType. Numbers are stored in their parsed width,
+	//   floating point values as doubles, filetimes as u64 and wide strings as UTF-8.
+	enum class emitFormat
+	{
+		json,
+		binary,
+	};
+
+	// Stream root out to sink in chunks. Only the structure is walked - toString is never built.
+	void emitBlocks(
+		const std::shared_ptr<block>& root,
+		emitFormat format,
+		const std::function<void(const std::string&)>& sink);
+	std::string emitBlocks(const std::shared_ptr<block>& root, emitFormat format);
+} // namespace smartview
@@ -32,7 +32,7 @@ namespace smartview
 		void parse() override = 0;
 		void parseBlocks() override
 		{
-			const auto size = parser->getOffset() - getOffset();
+			const auto size = getSize();
 			auto prop = SPropValue{m_ulPropTag, 0, {}};
 			getProp(prop);
 
@@ -40,15 +40,15 @@ namespace smartview
 			auto altPropString = std::wstring{};
 			property::parseProperty(&prop, &propString, &altPropString);
 
-			const auto propBlock =
-				blockStringW::parse(strings::RemoveInvalidCharactersW(propString, false), size, getOffset());
+			strings::RemoveInvalidCharactersInPlace(propString, false);
+			strings::RemoveInvalidCharactersInPlace(altPropString, false);
+			const auto propBlock = blockStringW::parse(std::move(propString), size, getOffset());
 			if (!propBlock->empty())
 			{
 				addChild(propBlock, L"PropString = %1!ws!", propBlock->c_str());
 			}
 
-			const auto altPropBlock =
-				blockStringW::parse(strings::RemoveInvalidCharactersW(altPropString, false), size, getOffset());
+			const auto altPropBlock = blockStringW::parse(std::move(altPropString), size, getOffset());
 			if (!altPropBlock->empty())
 			{
 				addChild(altPropBlock, L"AltPropString = %1!ws!", altPropBlock->c_str());
@@ -149,12 +149,7 @@ namespace smartview
 	public:
 		operator SBinary() noexcept { return {*cb, const_cast<LPBYTE>(lpb->data())}; }
 
-		std::shared_ptr<block> toSmartView() override
-		{
-			auto svp = InterpretBinary(this->operator SBinary(), svParser, nullptr);
-			svp->shiftOffset(lpb->getOffset());
-			return svp;
-		}
+		std::shared_ptr<block> toSmartView() override { return smartView; }
 
 	private:
 		void parse() override
@@ -175,11 +170,22 @@ namespace smartview
 
 			// Note that we're not placing a restriction on how large a binary property we can parse. May need to revisit this.
 			lpb = blockBytes::parse(parser, *cb);
+
+			// Parse our Smart View now, so it's charged to the same budget as the rest of the parse.
+			// It borrows our parser's buffer, which we hold on to.
+			auto svp = GetSmartViewParser(svParser, nullptr);
+			if (svp)
+			{
+				svp->parse(binaryParser::borrow(lpb->size(), lpb->data()), true);
+				svp->shiftOffset(lpb->getOffset());
+				smartView = svp;
+			}
 		}
 
 		const void getProp(SPropValue& prop) noexcept override { prop.Value.bin = this->operator SBinary(); }
 		std::shared_ptr<blockT<ULONG>> cb = emptyT<ULONG>();
 		std::shared_ptr<blockBytes> lpb = emptyBB();
+		std::shared_ptr<block> smartView = emptySW();
 	};
 
 	/* case PT_MV_BINARY */
@@ -208,7 +214,7 @@ namespace smartview
 			{
 				for (ULONG j = 0; j < *cValues; j++)
 				{
-					const auto block = std::make_shared<SBinaryBlock>();
+					const auto block = makeBlock<SBinaryBlock>();
 					block->init(CHANGE_PROP_TYPE(m_ulPropTag, PT_BINARY), false, true, true);
 					block->block::parse(parser, false);
 					lpbin.emplace_back(block);
@@ -495,49 +501,49 @@ namespace smartview
 		switch (PROP_TYPE(ulPropTag))
 		{
 		case PT_I2:
-			ret = std::make_shared<I2BLock>();
+			ret = makeBlock<I2BLock>();
 			break;
 		case PT_LONG:
-			ret = std::make_shared<LongBLock>();
+			ret = makeBlock<LongBLock>();
 			break;
 		case PT_ERROR:
-			ret = std::make_shared<ErrorBlock>();
+			ret = makeBlock<ErrorBlock>();
 			break;
 		case PT_R4:
-			ret = std::make_shared<R4BLock>();
+			ret = makeBlock<R4BLock>();
 			break;
 		case PT_DOUBLE:
-			ret = std::make_shared<DoubleBlock>();
+			ret = makeBlock<DoubleBlock>();
 			break;
 		case PT_BOOLEAN:
-			ret = std::make_shared<BooleanBlock>();
+			ret = makeBlock<BooleanBlock>();
 			break;
 		case PT_I8:
-			ret = std::make_shared<I8Block>();
+			ret = makeBlock<I8Block>();
 			break;
 		case PT_SYSTIME:
-			ret = std::make_shared<FILETIMEBLock>();
+			ret = makeBlock<FILETIMEBLock>();
 			break;
 		case PT_STRING8:
-			ret = std::make_shared<CountedStringA>();
+			ret = makeBlock<CountedStringA>();
 			break;
 		case PT_BINARY:
-			ret = std::make_shared<SBinaryBlock>();
+			ret = makeBlock<SBinaryBlock>();
 			break;
 		case PT_UNICODE:
-			ret = std::make_shared<CountedStringW>();
+			ret = makeBlock<CountedStringW>();
 			break;
 		case PT_CLSID:
-			ret = std::make_shared<CLSIDBlock>();
+			ret = makeBlock<CLSIDBlock>();
 			break;
 		case PT_MV_STRING8:
-			ret = std::make_shared<StringArrayA>();
+			ret = makeBlock<StringArrayA>();
 			break;
 		case PT_MV_UNICODE:
-			ret = std::make_shared<StringArrayW>();
+			ret = makeBlock<StringArrayW>();
 			break;
 		case PT_MV_BINARY:
-			ret = std::make_shared<SBinaryArrayBlock>();
+			ret = makeBlock<SBinaryArrayBlock>();
 			break;
 		default:
 			return nullptr;
@@ -16,9 +16,18 @@ namespace smartview
 		_NODISCARD std::string::size_type length() const noexcept { return data.length(); }
 		_NODISCARD bool empty() const noexcept { return data.empty(); }
 
+		blockValue getValue() const override
+		{
+			auto ret = blockValue{};
+			ret.type = blockValue::valueType::stringA;
+			ret.data = data.c_str();
+			ret.cb = data.length();
+			return ret;
+		}
+
 		static std::shared_ptr<blockStringA> parse(const std::shared_ptr<binaryParser>& parser, size_t cchChar = -1)
 		{
-			auto ret = std::make_shared<blockStringA>();
+			auto ret = makeBlock<blockStringA>();
 			ret->parser = parser;
 			ret->enableJunk = false;
 			ret->cchChar = cchChar;
@@ -41,15 +50,16 @@ namespace smartview
 				data = strings::RemoveInvalidCharactersA(
 					std::string(reinterpret_cast<LPCSTR>(parser->getAddress()), cchChar));
 				parser->advance(sizeof CHAR * cchChar);
-				setText(strings::stringTowstring(data));
 				parsed = true;
 			}
 		};
 
+		void parseBlocks() override { setText(strings::stringTowstring(data)); }
+
 		std::string data;
 
 		size_t cchChar{};
 	};
 
-	inline std::shared_ptr<blockStringA> emptySA() { return std::make_shared<blockStringA>(); }
+	inline std::shared_ptr<blockStringA> emptySA() { return makeBlock<blockStringA>(); }
 } // namespace smartview
\ No newline at end of file
@@ -16,13 +16,21 @@ namespace smartview
 		_NODISCARD std::wstring::size_type length() const noexcept { return data.length(); }
 		_NODISCARD bool empty() const noexcept { return data.empty(); }
 
-		static std::shared_ptr<blockStringW> parse(const std::wstring& _data, size_t _size, size_t _offset)
+		blockValue getValue() const override
 		{
-			auto ret = std::make_shared<blockStringW>();
+			auto ret = blockValue{};
+			ret.type = blockValue::valueType::stringW;
+			ret.data = data.c_str();
+			ret.cb = data.length() * sizeof(wchar_t);
+			return ret;
+		}
+
+		static std::shared_ptr<blockStringW> parse(std::wstring _data, size_t _size, size_t _offset)
+		{
+			auto ret = makeBlock<blockStringW>();
 			ret->parsed = true;
 			ret->enableJunk = false;
-			ret->data = _data;
-			ret->setText(_data);
+			ret->data = std::move(_data);
 			ret->setSize(_size);
 			ret->setOffset(_offset);
 			return ret;
@@ -30,7 +38,7 @@ namespace smartview
 
 		static std::shared_ptr<blockStringW> parse(const std::shared_ptr<binaryParser>& parser, size_t cchChar = -1)
 		{
-			auto ret = std::make_shared<blockStringW>();
+			auto ret = makeBlock<blockStringW>();
 			ret->parser = parser;
 			ret->enableJunk = false;
 			ret->cchChar = cchChar;
@@ -50,18 +58,19 @@ namespace smartview
 
 			if (cchChar && parser->checkSize(sizeof WCHAR * cchChar))
 			{
-				data = strings::RemoveInvalidCharactersW(
-					std::wstring(reinterpret_cast<LPCWSTR>(parser->getAddress()), cchChar));
+				data.assign(reinterpret_cast<LPCWSTR>(parser->getAddress()), cchChar);
+				strings::RemoveInvalidCharactersInPlace(data);
 				parser->advance(sizeof WCHAR * cchChar);
-				setText(data);
 				parsed = true;
 			}
 		};
 
+		void parseBlocks() override { setText(data); }
+
 		std::wstring data;
 
 		size_t cchChar{};
 	};
 
-	inline std::shared_ptr<blockStringW> emptySW() { return std::make_shared<blockStringW>(); }
+	inline std::shared_ptr<blockStringW> emptySW() { return makeBlock<blockStringW>(); }
 } // namespace smartview
\ No newline at end of file
@@ -24,9 +24,51 @@ namespace smartview
 		operator T&() noexcept { return data; }
 		operator T() const noexcept { return data; }
 
+		blockValue getValue() const override
+		{
+			auto ret = blockValue{};
+			ret.width = sizeof T;
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				ret.type = blockValue::valueType::boolean;
+				ret.number = data ? 1 : 0;
+			}
+			else if constexpr (std::is_integral_v<T>)
+			{
+				ret.type = std::is_signed_v<T> ? blockValue::valueType::signedInt : blockValue::valueType::unsignedInt;
+				ret.number = static_cast<ULONGLONG>(data);
+			}
+			else if constexpr (std::is_floating_point_v<T>)
+			{
+				ret.type = blockValue::valueType::floating;
+				ret.floating = data;
+			}
+			else if constexpr (std::is_same_v<T, GUID>)
+			{
+				ret.type = blockValue::valueType::guid;
+				ret.guid = data;
+			}
+			else if constexpr (std::is_same_v<T, FILETIME>)
+			{
+				ret.type = blockValue::valueType::filetime;
+				ret.number = static_cast<ULONGLONG>(data.dwHighDateTime) << 32 | data.dwLowDateTime;
+			}
+			else if constexpr (std::is_same_v<T, LARGE_INTEGER>)
+			{
+				ret.type = blockValue::valueType::signedInt;
+				ret.number = static_cast<ULONGLONG>(data.QuadPart);
+			}
+			else
+			{
+				ret.width = 0;
+			}
+
+			return ret;
+		}
+
 		static std::shared_ptr<blockT<T>> parse(const std::shared_ptr<binaryParser>& parser)
 		{
-			auto ret = std::make_shared<blockT<T>>();
+			auto ret = makeBlock<blockT<T>>();
 			ret->parser = parser;
 			ret->ensureParsed();
 			return ret;
@@ -36,7 +78,7 @@ namespace smartview
 		// Usage: std::shared_ptr<blockT<T>> tmp = blockT<T>::parser<U>(parser);
 		template <typename U> static std::shared_ptr<blockT<T>> parse(const std::shared_ptr<binaryParser>& parser)
 		{
-			if (!parser->checkSize(sizeof U)) return std::make_shared<blockT<T>>();
+			if (!parser->checkSize(sizeof U)) return makeBlock<blockT<T>>();
 
 			const U _data = *reinterpret_cast<const U*>(parser->getAddress());
 			const auto offset = parser->getOffset();
@@ -46,7 +88,7 @@ namespace smartview
 
 		static std::shared_ptr<blockT<T>> create(const T& _data, size_t _size, size_t _offset)
 		{
-			const auto ret = std::make_shared<blockT<T>>(_data, _size, _offset);
+			const auto ret = makeBlock<blockT<T>>(_data, _size, _offset);
 			ret->parsed = true;
 			return ret;
 		}
@@ -67,5 +109,5 @@ namespace smartview
 		T data{};
 	};
 
-	template <typename T> std::shared_ptr<blockT<T>> emptyT() { return std::make_shared<blockT<T>>(); }
+	template <typename T> std::shared_ptr<blockT<T>> emptyT() { return makeBlock<blockT<T>>(); }
 } // namespace smartview
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include <core/stdafx.h>
+#include <core/smartview/block/parseBudget.h>
+
+namespace smartview
+{
+	namespace
+	{
+		thread_local parseBudget* currentBudget{};
+		thread_local size_t truncationCount{};
+
+		// Reading the clock on every parse would cost more than most parses, so only look every so often
+		constexpr size_t clockInterval = 0x40;
+	} // namespace
+
+	parseBudget::parseBudget(const limits& _limits)
+		: budget(_limits), start(std::chrono::steady_clock::now()), previous(currentBudget)
+	{
+		currentBudget = this;
+	}
+
+	parseBudget::~parseBudget() { currentBudget = previous; }
+
+	parseBudget* parseBudget::current() noexcept { return currentBudget; }
+
+	size_t parseBudget::truncations() noexcept { return truncationCount; }
+
+	void parseBudget::spend(resource _spent) noexcept
+	{
+		spent = _spent;
+		truncationCount++;
+	}
+
+	void parseBudget::chargeBlock(size_t cb) noexcept
+	{
+		blocks++;
+		bytes += cb;
+		if (spent != resource::none) return;
+		if (blocks > budget.maxBlocks)
+		{
+			spend(resource::blocks);
+		}
+		else if (bytes > budget.maxBytes)
+		{
+			spend(resource::bytes);
+		}
+	}
+
+	bool parseBudget::check() noexcept
+	{
+		if (spent == resource::none && ++checks % clockInterval == 0 &&
+			std::chrono::steady_clock::now() - start > budget.maxTime)
+		{
+			spend(resource::time);
+		}
+
+		return spent == resource::none;
+	}
+
+	std::wstring parseBudget::describe() const
+	{
+		switch (spent)
+		{
+		case resource::blocks:
+			return strings::format(
+				L"*** Truncated: parse exceeded its budget of %zu blocks ***", budget.maxBlocks); // STRING_OK
+		case resource::bytes:
+			return strings::format(
+				L"*** Truncated: parse exceeded its budget of %zu bytes ***", budget.maxBytes); // STRING_OK
+		case resource::time:
+			return strings::format(
+				L"*** Truncated: parse exceeded its budget of %lld ms ***", // STRING_OK
+				static_cast<LONGLONG>(budget.maxTime.count()));
+		default:
+			return {};
+		}
+	}
+} // namespace smartview
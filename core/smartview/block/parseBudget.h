@@ -0,0 +1,68 @@
+#pragma once
+#include <chrono>
+
+namespace smartview
+{
+	// parseBudget - caps the total work one parse may do, on top of the per structure caps in block.h.
+	// Those caps bound each count and depth on its own, but nested structures multiply them, so a
+	// corrupt blob can still cost minutes and gigabytes.
+	//
+	// Usage: place a parseBudget on the stack around a parse. Every block allocated on this thread counts
+	// against it, and ensureParsed checks it before each parse. Once the budget is spent no further blocks
+	// parse and the parser is drained, so the structures above wind down quickly. The caller can then
+	// check exceeded() and flag the result as truncated.
+	//
+	// Only parse() is charged. Binary properties inside a structure parse their own Smart View during parse(),
+	// so nested blobs count against the same budget. Rendering - the parseBlocks and toString work blocks do
+	// on demand - runs after the budget has gone out of scope and has no limit of its own. It only walks blocks
+	// the parse already built and never reads the parser, so its cost follows the size of the tree the budget allowed.
+	class parseBudget
+	{
+	public:
+		struct limits
+		{
+			size_t maxBlocks;
+			size_t maxBytes; // Bytes of blocks allocated
+			std::chrono::milliseconds maxTime;
+		};
+
+		static constexpr limits defaultLimits{500000, 0x4000000, std::chrono::milliseconds{10000}};
+
+		explicit parseBudget(const limits& _limits = defaultLimits);
+		~parseBudget();
+		parseBudget(const parseBudget&) = delete;
+		parseBudget& operator=(const parseBudget&) = delete;
+
+		// The budget for the parse currently running on this thread, if any
+		static parseBudget* current() noexcept;
+		// How many budgets have run out on this thread. Compare before and after some work to see
+		// if anything in it was truncated, however deeply nested.
+		static size_t truncations() noexcept;
+
+		enum class resource
+		{
+			none,
+			blocks,
+			bytes,
+			time,
+		};
+
+		void chargeBlock(size_t cb) noexcept;
+		// Returns false once the budget is spent
+		bool check() noexcept;
+		resource exceeded() const noexcept { return spent; }
+		// Marker for truncated output. Empty if the budget held.
+		std::wstring describe() const;
+
+	private:
+		void spend(resource _spent) noexcept;
+
+		limits budget;
+		size_t blocks{};
+		size_t bytes{};
+		size_t checks{};
+		resource spent{resource::none};
+		std::chrono::steady_clock::time_point start;
+		parseBudget* previous{};
+	};
+} // namespace smartview
@@ -0,0 +1,350 @@
+#include <core/stdafx.h>
+#include <core/smartview/detectParser.h>
+#include <core/smartview/SmartView.h>
+#include <core/smartview/block/blockArena.h>
+#include <core/smartview/block/parseBudget.h>
+#include <core/addin/mfcmapi.h>
+#include <core/mapi/extraPropTags.h>
+#include <core/interpret/guid.h>
+#include <atomic>
+#include <thread>
+
+namespace smartview
+{
+	namespace
+	{
+		// clang-format off
+		const BYTE globalObjectId[] = {
+			0x04, 0x00, 0x00, 0x00, 0x82, 0x00, 0xE0, 0x00,
+			0x74, 0xC5, 0xB7, 0x10, 0x1A, 0x82, 0xE0, 0x08,
+		};
+		const BYTE reportTagCookie[] = {'P', 'C', 'D', 'F', 'E', 'B', '0', '9', 0}; // STRING_OK
+		// clang-format on
+
+		// Parsers which make sense of any blob, or don't parse blobs at all
+		bool isDetectable(parserType parser) noexcept
+		{
+			switch (parser)
+			{
+			case parserType::NOPARSING:
+			case parserType::DECODEENTRYID:
+			case parserType::ENCODEENTRYID:
+			case parserType::LONGRTIME:
+			case parserType::PTI8:
+			case parserType::SFIDMID:
+				return false;
+			default:
+				return parser > parserType::NOPARSING && parser < parserType::END;
+			}
+		}
+
+		// Unaligned little endian reads. Callers check the size first.
+		WORD readWord(const BYTE* pb) noexcept { return static_cast<WORD>(pb[0] | pb[1] << 8); }
+		DWORD readDword(const BYTE* pb) noexcept
+		{
+			return static_cast<DWORD>(pb[0] | pb[1] << 8 | pb[2] << 16) | static_cast<DWORD>(pb[3]) << 24;
+		}
+
+		bool startsWith(const SBinary& bin, const BYTE* pb, size_t cb) noexcept
+		{
+			return bin.cb >= cb && memcmp(bin.lpb, pb, cb) == 0;
+		}
+
+		// A run of one byte sizes each followed by an XID
+		bool isPCL(const SBinary& bin) noexcept
+		{
+			size_t i = 0;
+			while (i < bin.cb)
+			{
+				const auto cbXID = bin.lpb[i++];
+				if (cbXID < sizeof(GUID) + 1 || cbXID > sizeof(GUID) + 8 || cbXID > bin.cb - i) return false;
+				i += cbXID;
+			}
+
+			return i != 0;
+		}
+
+		// Persist blocks of WORD id and WORD size, ending at an empty sentinel or the end of the blob
+		// Every block holds at least one element, which is itself a WORD id and WORD size
+		bool isAdditionalRenEntryIDs(const SBinary& bin) noexcept
+		{
+			size_t i = 0;
+			auto count = 0;
+			while (bin.cb - i >= 2 * sizeof(WORD))
+			{
+				const auto id = readWord(bin.lpb + i);
+				const auto cb = readWord(bin.lpb + i + sizeof(WORD));
+				i += 2 * sizeof(WORD);
+				if (id == 0) return count != 0 && cb == 0;
+				if (cb < 2 * sizeof(WORD) || cb > bin.cb - i) return false;
+				i += cb;
+				count++;
+			}
+
+			return count != 0 && i == bin.cb;
+		}
+
+		// Byte id and byte size pairs which add up to the whole blob
+		bool isExtendedFlags(const SBinary& bin) noexcept
+		{
+			size_t i = 0;
+			while (bin.cb - i >= 2)
+			{
+				const auto id = bin.lpb[i];
+				const auto cb = bin.lpb[i + 1];
+				i += 2;
+				if (id == 0 || cb > bin.cb - i) return false;
+				i += cb;
+			}
+
+			return i != 0 && i == bin.cb;
+		}
+
+		bool isPropType(ULONG ulPropType) noexcept
+		{
+			switch (ulPropType & ~MV_FLAG)
+			{
+			case PT_I2:
+			case PT_LONG:
+			case PT_R4:
+			case PT_DOUBLE:
+			case PT_CURRENCY:
+			case PT_APPTIME:
+			case PT_ERROR:
+			case PT_BOOLEAN:
+			case PT_OBJECT:
+			case PT_I8:
+			case PT_STRING8:
+			case PT_UNICODE:
+			case PT_SYSTIME:
+			case PT_CLSID:
+			case PT_SVREID:
+			case PT_SRESTRICTION:
+			case PT_ACTIONS:
+			case PT_BINARY:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		// A leading DWORD count which is neither zero nor past our caps
+		bool hasCount(const SBinary& bin) noexcept
+		{
+			if (bin.cb < sizeof(DWORD)) return false;
+			const auto count = readDword(bin.lpb);
+			return count != 0 && count < _MaxEntriesLarge;
+		}
+
+		// Parse bin with parser inside its own arena and budget
+		parserCandidate parseCandidate(const SBinary& bin, parserType parser, parserMatch match)
+		{
+			auto candidate = parserCandidate{parser, match, 0, bin.cb, nullptr};
+			const auto arena = blockArena::scope{};
+			const auto budget = parseBudget{};
+			auto svp = GetSmartViewParser(parser, nullptr);
+			if (!svp) return candidate;
+			const auto binParser = binaryParser::borrow(bin.cb, bin.lpb);
+			svp->parse(binParser, false);
+			// A parse which ran out of budget tells us nothing about the blob
+			if (!svp->isSet() || budget.exceeded() != parseBudget::resource::none) return candidate;
+
+			candidate.cbParsed = min(binParser->getOffset(), static_cast<size_t>(bin.cb));
+			candidate.cbUnparsed = bin.cb - candidate.cbParsed;
+			candidate.result = svp;
+			return candidate;
+		}
+
+		// Parse every candidate, in parallel when there's enough work to cover the threads
+		void parseCandidates(const SBinary& bin, std::vector<parserCandidate>& candidates)
+		{
+			// Below this, starting a thread costs more than the parses it would run
+			constexpr size_t cbParallel = 0x1000;
+			auto next = std::atomic<size_t>{};
+			const auto parse = [&] {
+				for (auto i = next++; i < candidates.size(); i = next++)
+				{
+					candidates[i] = parseCandidate(bin, candidates[i].type, candidates[i].match);
+				}
+			};
+
+			auto threads = std::vector<std::thread>{};
+			if (bin.cb * candidates.size() >= cbParallel)
+			{
+				const auto cThreads = max(std::thread::hardware_concurrency(), 1u);
+				for (UINT i = 1; i < cThreads && i < candidates.size(); i++)
+				{
+					threads.emplace_back(parse);
+				}
+			}
+
+			parse();
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+		}
+	} // namespace
+
+	_Check_return_ parserMatch PrefilterParser(const SBinary& bin, parserType parser) noexcept
+	{
+		if (!bin.lpb || !bin.cb || !isDetectable(parser)) return parserMatch::none;
+		const auto pb = bin.lpb;
+		const size_t cb = bin.cb;
+
+		switch (parser)
+		{
+		case parserType::TOMBSTONE:
+			return cb >= 5 * sizeof(DWORD) && readDword(pb) == 0xBEDEAFCD ? parserMatch::signature
+																		   : parserMatch::none;
+		case parserType::NICKNAMECACHE:
+			return cb >= 3 * sizeof(DWORD) && readDword(pb) == 0xBAADF00D ? parserMatch::signature
+																		   : parserMatch::none;
+		case parserType::GLOBALOBJECTID:
+			return cb >= 40 && startsWith(bin, globalObjectId, sizeof globalObjectId) ? parserMatch::signature
+																						: parserMatch::none;
+		case parserType::REPORTTAG:
+			return startsWith(bin, reportTagCookie, sizeof reportTagCookie) ? parserMatch::signature
+																			: parserMatch::none;
+		case parserType::SEARCHFOLDERDEFINITION:
+			return cb >= 3 * sizeof(DWORD) && readDword(pb) == 0x00001004 ? parserMatch::signature
+																		   : parserMatch::none;
+		case parserType::RECURRENCEPATTERN:
+		case parserType::APPOINTMENTRECURRENCEPATTERN:
+			// Reader and writer versions are both 0x3004
+			return cb >= 5 * sizeof(WORD) && readDword(pb) == 0x30043004 ? parserMatch::signature
+																		  : parserMatch::none;
+		case parserType::SECURITYDESCRIPTOR:
+		case parserType::FBSECURITYDESCRIPTOR:
+		{
+			// A header, sized by its first WORD, then a self relative descriptor which starts with its revision
+			if (cb < 2 * sizeof(WORD)) return parserMatch::none;
+			const auto cbHeader = readWord(pb);
+			return cbHeader >= 2 * sizeof(WORD) && cbHeader < cb && pb[cbHeader] == SECURITY_DESCRIPTOR_REVISION
+					   ? parserMatch::signature
+					   : parserMatch::none;
+		}
+		case parserType::ENTRYID:
+		{
+			if (cb < 4 + sizeof(GUID)) return parserMatch::none;
+			auto provider = GUID{};
+			memcpy(&provider, pb + 4, sizeof(GUID));
+			if (provider == guid::muidOOP || provider == guid::muidEMSAB || provider == guid::muidContabDLL ||
+				provider == guid::muidStoreWrap || provider == guid::WAB_GUID)
+			{
+				return parserMatch::signature;
+			}
+
+			// Exchange folder and message entry IDs are known by their size
+			if (cb == 4 + sizeof(GUID) + 26 || cb == 4 + sizeof(GUID) + 50) return parserMatch::shape;
+			// Anything else needs the usual zero flags, or the ephemeral flag
+			return pb[0] == EPHEMERAL || (pb[1] == 0 && pb[2] == 0 && pb[3] == 0) ? parserMatch::plausible
+																				  : parserMatch::none;
+		}
+		case parserType::SID:
+			// Revision 1, then a count of subauthorities which sets the size
+			return cb >= 8 && pb[0] == SID_REVISION && pb[1] <= SID_MAX_SUB_AUTHORITIES &&
+						   cb == 8 + pb[1] * sizeof(DWORD)
+					   ? parserMatch::shape
+					   : parserMatch::none;
+		case parserType::CONVERSATIONINDEX:
+			// A 22 byte header then 5 byte child blocks
+			return cb >= 22 && (cb - 22) % 5 == 0 && pb[0] == 1 ? parserMatch::shape : parserMatch::none;
+		case parserType::TIMEZONE:
+			return cb == 3 * sizeof(DWORD) + 2 * (sizeof(WORD) + sizeof(SYSTEMTIME)) ? parserMatch::shape
+																					   : parserMatch::none;
+		case parserType::TIMEZONEDEFINITION:
+			// Major version 2, minor version 1, then a header size which has to fit
+			return cb >= 3 * sizeof(WORD) && pb[0] == 2 && pb[1] == 1 && readWord(pb + 2) <= cb - 2 * sizeof(WORD)
+					   ? parserMatch::shape
+					   : parserMatch::none;
+		case parserType::PROPERTYDEFINITIONSTREAM:
+		{
+			if (cb < sizeof(WORD) + sizeof(DWORD)) return parserMatch::none;
+			const auto version = readWord(pb);
+			return version == 0x0102 || version == 0x0103 ? parserMatch::shape : parserMatch::none;
+		}
+		case parserType::VERBSTREAM:
+			return cb >= sizeof(WORD) + sizeof(DWORD) && readWord(pb) == 0x0102 ? parserMatch::shape
+																				 : parserMatch::none;
+		case parserType::SWAPPEDTODO:
+			return cb == 7 * sizeof(DWORD) + 512 && readDword(pb) == 1 ? parserMatch::shape : parserMatch::none;
+		case parserType::PCL:
+			return isPCL(bin) ? parserMatch::shape : parserMatch::none;
+		case parserType::ADDITIONALRENENTRYIDSEX:
+			return isAdditionalRenEntryIDs(bin) ? parserMatch::shape : parserMatch::none;
+		case parserType::EXTENDEDFOLDERFLAGS:
+			return isExtendedFlags(bin) ? parserMatch::shape : parserMatch::none;
+		case parserType::FLATENTRYLIST:
+			// cbEntries covers everything after the two counts
+			return hasCount(bin) && cb >= 2 * sizeof(DWORD) && readDword(pb + sizeof(DWORD)) == cb - 2 * sizeof(DWORD)
+					   ? parserMatch::shape
+					   : parserMatch::none;
+		case parserType::XID:
+			return cb > sizeof(GUID) && cb <= sizeof(GUID) + 8 ? parserMatch::plausible : parserMatch::none;
+		case parserType::ENTRYLIST:
+			// Each entry has two DWORDs of lengths before any entry IDs
+			return hasCount(bin) && cb >= 2 * sizeof(DWORD) &&
+						   (cb - 2 * sizeof(DWORD)) / (2 * sizeof(DWORD)) >= readDword(pb)
+					   ? parserMatch::plausible
+					   : parserMatch::none;
+		case parserType::PROPERTIES:
+			return cb >= sizeof(DWORD) && isPropType(PROP_TYPE(readDword(pb))) ? parserMatch::plausible
+																				: parserMatch::none;
+		case parserType::RESTRICTION:
+			return cb >= sizeof(DWORD) && readDword(pb) <= RES_ANNOTATION ? parserMatch::plausible
+																		  : parserMatch::none;
+		case parserType::RULECONDITION:
+		case parserType::EXTENDEDRULECONDITION:
+			// A count of named properties, then a restriction
+			return cb > sizeof(WORD) && readWord(pb) < _MaxEntriesSmall ? parserMatch::plausible : parserMatch::none;
+		case parserType::TASKASSIGNERS:
+		case parserType::FOLDERUSERFIELDS:
+		case parserType::RECIPIENTROWSTREAM:
+		case parserType::WEBVIEWPERSISTSTREAM:
+			return hasCount(bin) ? parserMatch::plausible : parserMatch::none;
+		default:
+			// Rule actions and anything new get a full parse
+			return parserMatch::plausible;
+		}
+	}
+
+	std::vector<parserCandidate> DetectParsers(const SBinary& bin)
+	{
+		auto strong = std::vector<parserCandidate>{};
+		auto weak = std::vector<parserCandidate>{};
+		for (auto i = static_cast<int>(parserType::NOPARSING) + 1; i < static_cast<int>(parserType::END); i++)
+		{
+			const auto parser = static_cast<parserType>(i);
+			const auto match = PrefilterParser(bin, parser);
+			if (match == parserMatch::none) continue;
+			(match == parserMatch::signature ? strong : weak).push_back({parser, match, 0, bin.cb, nullptr});
+		}
+
+		parseCandidates(bin, strong);
+		const auto clean = std::any_of(strong.begin(), strong.end(), [](const parserCandidate& candidate) {
+			return candidate.result && candidate.cbUnparsed == 0;
+		});
+		if (!clean)
+		{
+			parseCandidates(bin, weak);
+			strong.insert(strong.end(), weak.begin(), weak.end());
+		}
+
+		// Drop what didn't parse
+		strong.erase(
+			std::remove_if(
+				strong.begin(),
+				strong.end(),
+				[](const parserCandidate& candidate) { return !candidate.result || !candidate.cbParsed; }),
+			strong.end());
+
+		std::stable_sort(strong.begin(), strong.end(), [](const parserCandidate& a, const parserCandidate& b) {
+			if (a.match != b.match) return a.match > b.match;
+			if (a.cbUnparsed != b.cbUnparsed) return a.cbUnparsed < b.cbUnparsed;
+			return a.cbParsed > b.cbParsed;
+		});
+
+		return strong;
+	}
+} // namespace smartview
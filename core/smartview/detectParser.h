@@ -0,0 +1,41 @@
+#pragma once
+#include <core/smartview/block/block.h>
+
+// Forward declarations
+enum class parserType;
+
+namespace smartview
+{
+	// detectParser - guess which Smart View parser fits a blob we know nothing about.
+	// Running every parser over every blob is slow and most of them happily "parse" anything,
+	// so each parser first gets a cheap look at the bytes: magic numbers, version words,
+	// exact lengths and length prefixed layouts that have to add up. Only the parsers which
+	// pass get a full parse, and those run in parallel. The results are ranked best first.
+
+	// How strongly the bytes suggest a parser, weakest first
+	enum class parserMatch
+	{
+		none, // Can't be this parser
+		plausible, // Nothing rules it out
+		shape, // Exact length, version word or a layout which adds up
+		signature, // Magic bytes
+	};
+
+	struct parserCandidate
+	{
+		parserType type;
+		parserMatch match;
+		size_t cbParsed; // Bytes the parser consumed
+		size_t cbUnparsed; // Bytes left over
+		std::shared_ptr<block> result;
+	};
+
+	// Cheap look at bin for parser. Never parses.
+	_Check_return_ parserMatch PrefilterParser(const SBinary& bin, parserType parser) noexcept;
+
+	// Fully parse bin with each built in parser which passes the prefilter and rank what parsed.
+	// Ranked by match, then fewest bytes left over, then most bytes consumed.
+	// If any signature match parses cleanly, weaker matches are never parsed.
+	// Results parse bin in place, so bin must outlive them.
+	std::vector<parserCandidate> DetectParsers(const SBinary& bin);
+} // namespace smartview
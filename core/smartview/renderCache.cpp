@@ -0,0 +1,140 @@
+#include <core/stdafx.h>
+#include <core/smartview/renderCache.h>
+#include <core/addin/mfcmapi.h>
+#include <core/utility/registry.h>
+#include <mutex>
+#include <string_view>
+
+namespace smartview
+{
+	namespace renderCache
+	{
+		namespace
+		{
+			struct entry
+			{
+				size_t hash{};
+				parserType parser{};
+				std::vector<BYTE> bin;
+				std::wstring text;
+
+				size_t size() const noexcept { return bin.size() + text.size() * sizeof(wchar_t); }
+			};
+
+			// Most recently used at the front
+			std::list<entry> lru;
+			std::unordered_multimap<size_t, std::list<entry>::iterator> index;
+			size_t cachedBytes{};
+			stats counters{};
+			std::mutex cacheMutex;
+
+			size_t hashKey(parserType parser, const SBinary& bin)
+			{
+				const auto hash = std::hash<std::string_view>{}(
+					std::string_view(reinterpret_cast<const char*>(bin.lpb), bin.lpb ? bin.cb : 0));
+				return hash ^ (static_cast<size_t>(parser) + 0x9E3779B9 + (hash << 6) + (hash >> 2));
+			}
+
+			bool matches(const entry& item, parserType parser, const SBinary& bin)
+			{
+				return item.parser == parser && item.bin.size() == bin.cb &&
+					   (bin.cb == 0 || memcmp(item.bin.data(), bin.lpb, bin.cb) == 0);
+			}
+
+			// Caller holds cacheMutex
+			std::list<entry>::iterator lookup(size_t hash, parserType parser, const SBinary& bin)
+			{
+				const auto range = index.equal_range(hash);
+				for (auto it = range.first; it != range.second; ++it)
+				{
+					if (matches(*it->second, parser, bin)) return it->second;
+				}
+
+				return lru.end();
+			}
+
+			// Caller holds cacheMutex
+			void evictOldest()
+			{
+				const auto oldest = std::prev(lru.end());
+				const auto range = index.equal_range(oldest->hash);
+				for (auto it = range.first; it != range.second; ++it)
+				{
+					if (it->second == oldest)
+					{
+						index.erase(it);
+						break;
+					}
+				}
+
+				cachedBytes -= oldest->size();
+				lru.erase(oldest);
+				counters.evictions++;
+			}
+		} // namespace
+
+		_Check_return_ bool find(parserType parser, const SBinary& bin, std::wstring& out)
+		{
+			if (!registry::smartViewCacheSize || bin.cb > maxBlobSize || (bin.cb && !bin.lpb)) return false;
+
+			const auto hash = hashKey(parser, bin);
+			auto lock = std::lock_guard<std::mutex>(cacheMutex);
+			const auto it = lookup(hash, parser, bin);
+			if (it == lru.end())
+			{
+				counters.misses++;
+				return false;
+			}
+
+			lru.splice(lru.begin(), lru, it);
+			counters.hits++;
+			out = it->text;
+			return true;
+		}
+
+		void add(parserType parser, const SBinary& bin, const std::wstring& text)
+		{
+			const size_t capacity = registry::smartViewCacheSize;
+			if (!capacity || bin.cb > maxBlobSize || (bin.cb && !bin.lpb)) return;
+
+			auto item = entry{hashKey(parser, bin), parser, std::vector<BYTE>(bin.lpb, bin.lpb + bin.cb), text};
+			if (item.size() > maxBytes) return;
+
+			auto lock = std::lock_guard<std::mutex>(cacheMutex);
+			// Another thread may have rendered the same blob while we did
+			if (lookup(item.hash, parser, bin) != lru.end()) return;
+
+			while (!lru.empty() && (lru.size() >= capacity || cachedBytes + item.size() > maxBytes))
+			{
+				evictOldest();
+			}
+
+			cachedBytes += item.size();
+			lru.push_front(std::move(item));
+			index.emplace(lru.front().hash, lru.begin());
+		}
+
+		void clear()
+		{
+			auto lock = std::lock_guard<std::mutex>(cacheMutex);
+			index.clear();
+			lru.clear();
+			cachedBytes = 0;
+		}
+
+		stats getStats()
+		{
+			auto lock = std::lock_guard<std::mutex>(cacheMutex);
+			auto ret = counters;
+			ret.entries = lru.size();
+			ret.bytes = cachedBytes;
+			return ret;
+		}
+
+		void resetStats()
+		{
+			auto lock = std::lock_guard<std::mutex>(cacheMutex);
+			counters = {};
+		}
+	} // namespace renderCache
+} // namespace smartview
@@ -0,0 +1,37 @@
+#pragma once
+
+// Forward declarations
+enum class parserType;
+
+namespace smartview
+{
+	// renderCache - bounded LRU of rendered Smart View text, keyed by parser and blob contents.
+	// Contents table and folder dumps hand us the same PR_PARENT_ENTRYID, PR_STORE_ENTRYID and
+	// conversation index prefixes on every row. With the cache on we parse and render each one once.
+	// Only rendered text is cached. Block trees are handed out for callers to adjust, so each caller
+	// gets its own.
+	// The cache holds up to SmartViewCacheSize entries. Zero disables it.
+	namespace renderCache
+	{
+		// Blobs larger than this aren't worth holding on to
+		constexpr size_t maxBlobSize = 0x10000;
+		// Cap on the bytes held by the cache, blobs and text together
+		constexpr size_t maxBytes = 0x2000000;
+
+		// Returns true and fills out with the cached text if bin was rendered with parser before
+		_Check_return_ bool find(parserType parser, const SBinary& bin, std::wstring& out);
+		void add(parserType parser, const SBinary& bin, const std::wstring& text);
+		void clear();
+
+		struct stats
+		{
+			size_t hits{};
+			size_t misses{};
+			size_t evictions{};
+			size_t entries{};
+			size_t bytes{};
+		};
+		stats getStats();
+		void resetStats();
+	} // namespace renderCache
+} // namespace smartview
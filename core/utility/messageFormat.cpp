@@ -0,0 +1,580 @@
+// Deliberately does not use the precompiled header so this builds with nothing but the standard library
+#include <core/utility/messageFormat.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cwchar>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace strings
+{
+	namespace
+	{
+		constexpr int maxArgs = 99;
+
+		// Values pulled from the va_list, indexed by argument.
+		// Left uninitialized so a message with few inserts doesn't pay to clear all 99.
+		struct argValue
+		{
+			long long i;
+			double d;
+			const void* p;
+		};
+
+		bool isDigit(wchar_t c) noexcept { return c >= L'0' && c <= L'9'; }
+
+		int parseNumber(const wchar_t*& sz) noexcept
+		{
+			auto ret = 0;
+			while (isDigit(*sz))
+			{
+				if (ret < 0x10000) ret = ret * 10 + (*sz - L'0');
+				sz++;
+			}
+
+			return ret;
+		}
+
+		void pad(std::wstring& out, int count, wchar_t c)
+		{
+			if (count > 0) out.append(static_cast<size_t>(count), c);
+		}
+
+		// Write prefix, leading zeros and body into out, padded out to width per the insert's flags
+		void appendPadded(
+			std::wstring& out,
+			const compiledMessage::insert& ins,
+			int width,
+			const wchar_t* prefix,
+			size_t cchPrefix,
+			int leadingZeros,
+			const wchar_t* body,
+			size_t cchBody,
+			bool allowZeroPad)
+		{
+			const auto fill = width - static_cast<int>(cchPrefix + cchBody) - leadingZeros;
+			if (ins.leftAlign)
+			{
+				out.append(prefix, cchPrefix);
+				pad(out, leadingZeros, L'0');
+				out.append(body, cchBody);
+				pad(out, fill, L' ');
+			}
+			else if (ins.zeroPad && allowZeroPad)
+			{
+				out.append(prefix, cchPrefix);
+				pad(out, fill + leadingZeros, L'0');
+				out.append(body, cchBody);
+			}
+			else
+			{
+				pad(out, fill, L' ');
+				out.append(prefix, cchPrefix);
+				pad(out, leadingZeros, L'0');
+				out.append(body, cchBody);
+			}
+		}
+
+		void appendInteger(
+			std::wstring& out,
+			const compiledMessage::insert& ins,
+			const argValue& value,
+			int width,
+			int precision)
+		{
+			auto conversion = ins.conversion;
+			auto negative = false;
+			unsigned long long magnitude = 0;
+			if (conversion == L'p')
+			{
+				// Pointers print as zero padded upper case hex, like the CRT does
+				magnitude = reinterpret_cast<uintptr_t>(value.p);
+				conversion = L'X';
+				if (precision < 0) precision = static_cast<int>(sizeof(void*) * 2);
+			}
+			else if (conversion == L'd' || conversion == L'i')
+			{
+				auto signedValue = value.i;
+				switch (ins.type)
+				{
+				case compiledMessage::argType::int32:
+					signedValue = ins.shortInt ? static_cast<short>(value.i) : static_cast<int>(value.i);
+					break;
+				case compiledMessage::argType::intPtr:
+					signedValue = static_cast<ptrdiff_t>(value.i);
+					break;
+				default:
+					break;
+				}
+
+				negative = signedValue < 0;
+				magnitude = negative ? 0ULL - static_cast<unsigned long long>(signedValue)
+									 : static_cast<unsigned long long>(signedValue);
+			}
+			else
+			{
+				magnitude = static_cast<unsigned long long>(value.i);
+				switch (ins.type)
+				{
+				case compiledMessage::argType::int32:
+					magnitude =
+						ins.shortInt ? static_cast<unsigned short>(magnitude) : static_cast<unsigned int>(magnitude);
+					break;
+				case compiledMessage::argType::intPtr:
+					magnitude = static_cast<size_t>(magnitude);
+					break;
+				default:
+					break;
+				}
+			}
+
+			const auto base = conversion == L'o' ? 8ULL : conversion == L'x' || conversion == L'X' ? 16ULL : 10ULL;
+			const auto digits = conversion == L'x' ? L"0123456789abcdef" : L"0123456789ABCDEF";
+
+			// Digits are written from the back of the buffer forward
+			auto buffer = std::array<wchar_t, 24>{};
+			auto end = buffer.data() + buffer.size();
+			auto start = end;
+			for (auto remaining = magnitude; remaining; remaining /= base)
+			{
+				*--start = digits[remaining % base];
+			}
+
+			auto cchBody = static_cast<size_t>(end - start);
+			// Default precision is 1, so zero prints as 0. An explicit precision of 0 prints nothing for zero.
+			const auto minDigits = precision < 0 ? 1 : precision;
+			auto leadingZeros = minDigits > static_cast<int>(cchBody) ? minDigits - static_cast<int>(cchBody) : 0;
+			if (conversion == L'o' && ins.alternate && leadingZeros == 0 && (cchBody == 0 || *start != L'0'))
+			{
+				leadingZeros = 1;
+			}
+
+			wchar_t prefix[2]{};
+			size_t cchPrefix = 0;
+			if (negative)
+				prefix[cchPrefix++] = L'-';
+			else if ((conversion == L'd' || conversion == L'i') && ins.plusSign)
+				prefix[cchPrefix++] = L'+';
+			else if ((conversion == L'd' || conversion == L'i') && ins.spaceSign)
+				prefix[cchPrefix++] = L' ';
+			else if (base == 16 && ins.alternate && magnitude && ins.conversion != L'p')
+			{
+				prefix[cchPrefix++] = L'0';
+				prefix[cchPrefix++] = conversion;
+			}
+
+			appendPadded(out, ins, width, prefix, cchPrefix, leadingZeros, start, cchBody, precision < 0);
+		}
+
+		void appendString(
+			std::wstring& out,
+			const compiledMessage::insert& ins,
+			const argValue& value,
+			int width,
+			int precision)
+		{
+			if (ins.type == compiledMessage::argType::narrowString)
+			{
+				auto sz = static_cast<const char*>(value.p);
+				if (!sz) sz = "(null)";
+				auto cch = std::char_traits<char>::length(sz);
+				if (precision >= 0 && static_cast<size_t>(precision) < cch) cch = static_cast<size_t>(precision);
+
+				// Same byte to wchar_t widening as stringTowstring, done in place rather than through a temporary
+				const auto fill = width - static_cast<int>(cch);
+				if (!ins.leftAlign) pad(out, fill, ins.zeroPad ? L'0' : L' ');
+				for (size_t i = 0; i < cch; i++)
+				{
+					out.push_back(static_cast<wchar_t>(static_cast<unsigned char>(sz[i])));
+				}
+
+				if (ins.leftAlign) pad(out, fill, L' ');
+			}
+			else
+			{
+				auto sz = static_cast<const wchar_t*>(value.p);
+				if (!sz) sz = L"(null)";
+				auto cch = std::char_traits<wchar_t>::length(sz);
+				if (precision >= 0 && static_cast<size_t>(precision) < cch) cch = static_cast<size_t>(precision);
+				appendPadded(out, ins, width, nullptr, 0, 0, sz, cch, true);
+			}
+		}
+
+		void appendChar(std::wstring& out, const compiledMessage::insert& ins, const argValue& value, int width)
+		{
+			const auto c = ins.shortInt ? static_cast<wchar_t>(static_cast<unsigned char>(value.i))
+										: static_cast<wchar_t>(value.i);
+			appendPadded(out, ins, width, nullptr, 0, 0, &c, 1, true);
+		}
+
+		// Floating point is rare enough in our messages that we let the CRT do the work
+		void appendFloat(
+			std::wstring& out,
+			const compiledMessage::insert& ins,
+			const argValue& value,
+			int width,
+			int precision)
+		{
+			wchar_t spec[16]{};
+			auto cchSpec = size_t{};
+			spec[cchSpec++] = L'%';
+			if (ins.leftAlign) spec[cchSpec++] = L'-';
+			if (ins.plusSign) spec[cchSpec++] = L'+';
+			if (ins.spaceSign) spec[cchSpec++] = L' ';
+			if (ins.zeroPad) spec[cchSpec++] = L'0';
+			if (ins.alternate) spec[cchSpec++] = L'#';
+			spec[cchSpec++] = L'*';
+			spec[cchSpec++] = L'.';
+			spec[cchSpec++] = L'*';
+			spec[cchSpec++] = ins.conversion;
+
+			// Enough for the widest %f of a double plus any requested width or precision
+			const auto cchBuffer = 384 + (width > 0 ? width : 0) + (precision > 0 ? precision : 0);
+			auto buffer = std::vector<wchar_t>(static_cast<size_t>(cchBuffer));
+			const auto cch = std::swprintf(
+				buffer.data(), buffer.size(), spec, width > 0 ? width : 0, precision, value.d);
+			if (cch > 0) out.append(buffer.data(), static_cast<size_t>(cch));
+		}
+
+		// Parse a printf style spec, stopping at the closing !
+		// Returns false if the spec is not terminated, in which case the insert is left with its defaults
+		bool parseSpec(const wchar_t*& sz, compiledMessage::insert& ins, int& nextArg)
+		{
+			auto insertArg = ins.arg;
+			auto spec = compiledMessage::insert{};
+			auto p = sz;
+			for (;; p++)
+			{
+				if (*p == L'-')
+					spec.leftAlign = true;
+				else if (*p == L'+')
+					spec.plusSign = true;
+				else if (*p == L' ')
+					spec.spaceSign = true;
+				else if (*p == L'0')
+					spec.zeroPad = true;
+				else if (*p == L'#')
+					spec.alternate = true;
+				else
+					break;
+			}
+
+			// Each * consumes an insert, and the value itself moves to the following one
+			if (*p == L'*')
+			{
+				spec.widthArg = insertArg++;
+				p++;
+			}
+			else if (isDigit(*p))
+			{
+				spec.width = parseNumber(p);
+			}
+
+			if (*p == L'.')
+			{
+				p++;
+				if (*p == L'*')
+				{
+					spec.precisionArg = insertArg++;
+					p++;
+				}
+				else
+				{
+					spec.precision = parseNumber(p);
+				}
+			}
+
+			auto type = compiledMessage::argType::int32;
+			// W functions treat a bare s or c as wide and S or C as narrow. h and l/w force narrow and wide.
+			auto narrow = false;
+			auto wide = false;
+			if (p[0] == L'I' && p[1] == L'6' && p[2] == L'4')
+			{
+				type = compiledMessage::argType::int64;
+				p += 3;
+			}
+			else if (p[0] == L'I' && p[1] == L'3' && p[2] == L'2')
+			{
+				p += 3;
+			}
+			else if (p[0] == L'l' && p[1] == L'l')
+			{
+				type = compiledMessage::argType::int64;
+				p += 2;
+			}
+			else if (*p == L'I' || *p == L'z' || *p == L't' || *p == L'j')
+			{
+				type = *p == L'j' ? compiledMessage::argType::int64 : compiledMessage::argType::intPtr;
+				p++;
+			}
+			else if (*p == L'h')
+			{
+				spec.shortInt = true;
+				narrow = true;
+				p++;
+			}
+			else if (*p == L'l' || *p == L'w' || *p == L'L')
+			{
+				wide = *p != L'L';
+				p++;
+			}
+
+			spec.conversion = *p;
+			switch (*p)
+			{
+			case L'd':
+			case L'i':
+			case L'u':
+			case L'x':
+			case L'X':
+			case L'o':
+				break;
+			case L'c':
+			case L'C':
+				// shortInt on a character conversion marks it narrow
+				type = compiledMessage::argType::int32;
+				spec.shortInt = narrow || (*p == L'C' && !wide);
+				spec.conversion = L'c';
+				break;
+			case L'p':
+				type = compiledMessage::argType::pointer;
+				break;
+			case L'e':
+			case L'E':
+			case L'f':
+			case L'F':
+			case L'g':
+			case L'G':
+			case L'a':
+			case L'A':
+				type = compiledMessage::argType::floating;
+				break;
+			case L'S':
+				type = wide ? compiledMessage::argType::wideString : compiledMessage::argType::narrowString;
+				spec.conversion = L's';
+				break;
+			case L's':
+			default:
+				// Anything we don't recognize is treated as the default string insert
+				type = narrow ? compiledMessage::argType::narrowString : compiledMessage::argType::wideString;
+				spec.conversion = L's';
+				break;
+			}
+
+			if (*p) p++;
+			if (*p != L'!') return false;
+
+			spec.literalEnd = ins.literalEnd;
+			spec.arg = insertArg;
+			spec.type = type;
+			ins = spec;
+			sz = p + 1;
+			nextArg = insertArg + 1;
+			return true;
+		}
+
+		std::shared_mutex g_messageCacheLock;
+		std::unordered_map<std::wstring, std::shared_ptr<const compiledMessage>> g_messageCache;
+		// Callers pass a small fixed set of format strings. If we get past this something is
+		// building formats on the fly, so start over rather than grow forever.
+		constexpr size_t maxCachedMessages = 0x1000;
+	} // namespace
+
+	compiledMessage::compiledMessage(const wchar_t* szMsg)
+	{
+		if (!szMsg) return;
+
+		auto noteArg = [&](int arg, argType type) {
+			const auto index = static_cast<size_t>(arg);
+			if (index >= args.size()) args.resize(index + 1, argType::none);
+			if (args[index] == argType::none) args[index] = type;
+		};
+
+		for (auto sz = szMsg; *sz;)
+		{
+			if (*sz != L'%')
+			{
+				text.push_back(*sz++);
+				continue;
+			}
+
+			sz++;
+			if (*sz >= L'1' && *sz <= L'9')
+			{
+				auto ins = insert{};
+				ins.literalEnd = text.length();
+				ins.arg = *sz++ - L'1';
+				if (isDigit(*sz)) ins.arg = (ins.arg + 1) * 10 + (*sz++ - L'0') - 1;
+
+				auto nextArg = ins.arg + 1;
+				if (*sz == L'!')
+				{
+					auto spec = sz + 1;
+					if (parseSpec(spec, ins, nextArg)) sz = spec;
+				}
+
+				if (ins.widthArg >= 0) noteArg(ins.widthArg, argType::int32);
+				if (ins.precisionArg >= 0) noteArg(ins.precisionArg, argType::int32);
+				noteArg(ins.arg, ins.type);
+				inserts.push_back(ins);
+				continue;
+			}
+
+			switch (*sz)
+			{
+			case L'0':
+				// Terminates the message with no trailing line break
+				return;
+			case L'n':
+				text.append(L"\r\n");
+				break;
+			case L'r':
+				text.push_back(L'\r');
+				break;
+			case L't':
+				text.push_back(L'\t');
+				break;
+			case L'b':
+				text.push_back(L' ');
+				break;
+			case L'\0':
+				// A trailing % is dropped
+				return;
+			default:
+				// %% %. %! and anything else produce the character itself
+				text.push_back(*sz);
+				break;
+			}
+
+			sz++;
+		}
+	}
+
+	void compiledMessage::append(std::wstring& out, va_list argList) const
+	{
+		// Pull every argument in order so later inserts can reference earlier ones and vice versa
+		std::array<argValue, maxArgs> values;
+		va_list args2;
+		va_copy(args2, argList);
+		for (size_t i = 0; i < args.size() && i < values.size(); i++)
+		{
+			values[i] = argValue{};
+			switch (args[i])
+			{
+			case argType::int32:
+				values[i].i = va_arg(args2, int);
+				break;
+			case argType::int64:
+				values[i].i = va_arg(args2, long long);
+				break;
+			case argType::intPtr:
+				values[i].i = static_cast<long long>(va_arg(args2, ptrdiff_t));
+				break;
+			case argType::floating:
+				values[i].d = va_arg(args2, double);
+				break;
+			case argType::none:
+			case argType::wideString:
+			case argType::narrowString:
+			case argType::pointer:
+				values[i].p = va_arg(args2, const void*);
+				break;
+			}
+		}
+
+		va_end(args2);
+
+		out.reserve(out.length() + text.length() + inserts.size() * 8);
+		auto literalStart = size_t{};
+		for (const auto& ins : inserts)
+		{
+			out.append(text, literalStart, ins.literalEnd - literalStart);
+			literalStart = ins.literalEnd;
+			if (ins.arg >= maxArgs) continue;
+
+			const auto& value = values[static_cast<size_t>(ins.arg)];
+			auto width = ins.width;
+			auto precision = ins.precision;
+			auto leftAlign = ins.leftAlign;
+			if (ins.widthArg >= 0 && ins.widthArg < maxArgs)
+			{
+				width = static_cast<int>(values[static_cast<size_t>(ins.widthArg)].i);
+				// A negative * width means left align, as with printf
+				if (width < 0)
+				{
+					leftAlign = true;
+					width = -width;
+				}
+			}
+
+			if (ins.precisionArg >= 0 && ins.precisionArg < maxArgs)
+			{
+				precision = static_cast<int>(values[static_cast<size_t>(ins.precisionArg)].i);
+				if (precision < 0) precision = -1;
+			}
+
+			const auto* effective = &ins;
+			auto adjusted = insert{};
+			if (leftAlign != ins.leftAlign)
+			{
+				adjusted = ins;
+				adjusted.leftAlign = leftAlign;
+				effective = &adjusted;
+			}
+
+			switch (ins.conversion)
+			{
+			case L'd':
+			case L'i':
+			case L'u':
+			case L'x':
+			case L'X':
+			case L'o':
+			case L'p':
+				appendInteger(out, *effective, value, width, precision);
+				break;
+			case L'c':
+				appendChar(out, *effective, value, width);
+				break;
+			case L's':
+				appendString(out, *effective, value, width, precision);
+				break;
+			default:
+				appendFloat(out, *effective, value, width, precision);
+				break;
+			}
+		}
+
+		out.append(text, literalStart, std::wstring::npos);
+	}
+
+	std::wstring compiledMessage::format(va_list argList) const
+	{
+		auto ret = std::wstring{};
+		append(ret, argList);
+		return ret;
+	}
+
+	std::shared_ptr<const compiledMessage> compileMessage(const wchar_t* szMsg)
+	{
+		if (!szMsg) szMsg = L"";
+		const auto key = std::wstring(szMsg);
+		{
+			const auto lock = std::shared_lock<std::shared_mutex>(g_messageCacheLock);
+			const auto it = g_messageCache.find(key);
+			if (it != g_messageCache.end()) return it->second;
+		}
+
+		auto compiled = std::make_shared<const compiledMessage>(szMsg);
+		const auto lock = std::unique_lock<std::shared_mutex>(g_messageCacheLock);
+		if (g_messageCache.size() >= maxCachedMessages) g_messageCache.clear();
+		return g_messageCache.emplace(key, compiled).first->second;
+	}
+
+	void appendmessageV(std::wstring& out, const wchar_t* szMsg, va_list argList)
+	{
+		compileMessage(szMsg)->append(out, argList);
+	}
+} // namespace strings
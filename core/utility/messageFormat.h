@@ -0,0 +1,64 @@
+#pragma once
+// Native replacement for FormatMessageW(FORMAT_MESSAGE_FROM_STRING)
+// Only depends on the standard library so it can be built and benchmarked off Windows.
+#include <cstdarg>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace strings
+{
+	// A message format string ("%1!ws! was %2!08X!%n") parsed once into literal runs and inserts.
+	// Supports the FormatMessage escapes (%0 %% %n %r %t %b %. %!) and inserts %1 through %99
+	// with an optional printf style spec. The default spec is s, which for us is a wide string.
+	class compiledMessage
+	{
+	public:
+		explicit compiledMessage(const wchar_t* szMsg);
+
+		// Appends the formatted message to out, pulling inserts from argList
+		void append(std::wstring& out, va_list argList) const;
+		std::wstring format(va_list argList) const;
+
+		enum class argType
+		{
+			none, // Not referenced by the format - assumed to be pointer sized
+			int32,
+			int64,
+			intPtr,
+			floating,
+			wideString,
+			narrowString,
+			pointer,
+		};
+
+		struct insert
+		{
+			size_t literalEnd{}; // End of the literal run in text which precedes this insert
+			int arg{}; // Zero based argument index. -1 for a trailing literal with no insert
+			argType type{argType::wideString};
+			wchar_t conversion{L's'};
+			bool leftAlign{};
+			bool plusSign{};
+			bool spaceSign{};
+			bool zeroPad{};
+			bool alternate{};
+			bool shortInt{}; // h on an integer conversion
+			int width{-1}; // -1 when not specified
+			int precision{-1}; // -1 when not specified
+			int widthArg{-1}; // Argument supplying the width for *
+			int precisionArg{-1}; // Argument supplying the precision for *
+		};
+
+	private:
+		std::wstring text; // Literal text with escapes already resolved
+		std::vector<insert> inserts;
+		std::vector<argType> args; // Type of each argument, in argument order
+	};
+
+	// Parse szMsg, or fetch it from the cache if we've seen it before
+	std::shared_ptr<const compiledMessage> compileMessage(const wchar_t* szMsg);
+
+	// Appends szMsg formatted with argList to out, reusing out's buffer
+	void appendmessageV(std::wstring& out, const wchar_t* szMsg, va_list argList);
+} // namespace strings
@@ -1,5 +1,6 @@
 #include <core/stdafx.h>
 #include <core/utility/output.h>
+#include <core/utility/outputSink.h>
 #include <core/utility/strings.h>
 #include <core/utility/file.h>
 #include <core/utility/registry.h>
@@ -15,7 +16,7 @@
 
 namespace output
 {
-	std::wstring g_szXMLHeader = L"<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n";
+	std::wstring g_szXMLHeader = L"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
 	std::function<void(const std::wstring& errString)> outputToDbgView;
 	FILE* g_fDebugFile = nullptr;
 
@@ -77,11 +78,20 @@ namespace output
 		return false;
 	}
 
-	_Check_return_ FILE* MyOpenFile(const std::wstring& szFileName, bool bNewFile)
+	_Check_return_ FILE* MyOpenFile(const std::wstring& szFileName, bool bNewFile, bool bBackgroundWriter)
 	{
-		auto mode = L"a+"; // STRING_OK
-		if (bNewFile) mode = L"w, ccs=UNICODE"; // STRING_OK
-		return MyOpenFileMode(szFileName, mode);
+		if (!bNewFile) return MyOpenFileMode(szFileName, L"a+"); // STRING_OK
+
+		// New files are written through a sink, which does its own encoding and line endings
+		const auto fOut = MyOpenFileMode(szFileName, L"wb"); // STRING_OK
+		if (fOut)
+		{
+			auto lpSink = std::make_unique<fileSink>(fOut, bBackgroundWriter);
+			lpSink->write(L"\xFEFF"); // BOM
+			attachSink(fOut, std::move(lpSink));
+		}
+
+		return fOut;
 	}
 
 	_Check_return_ FILE* MyOpenFileMode(const std::wstring& szFileName, const wchar_t* mode)
@@ -116,40 +126,64 @@ namespace output
 
 	void CloseFile(_In_opt_ FILE* fFile) noexcept
 	{
-		if (fFile) fclose(fFile);
+		if (!fFile) return;
+		detachSink(fFile);
+		fclose(fFile);
 	}
 
 	void WriteFile(_In_ FILE* fFile, const std::wstring& szString)
 	{
-		if (!szString.empty())
+		if (szString.empty()) return;
+
+		const auto lpSink = findSink(fFile);
+		if (lpSink)
+		{
+			lpSink->write(szString);
+		}
+		else
 		{
 			fputws(szString.c_str(), fFile);
 		}
 	}
 
-	void OutputThreadTime(dbgLevel ulDbgLvl)
+	// Time stamps only change once a millisecond, so each thread keeps its last one
+	const std::wstring& GetThreadTime(dbgLevel ulDbgLvl)
 	{
-		// Compute current time and thread for a time stamp
-		std::wstring szThreadTime;
-
-		SYSTEMTIME stLocalTime = {};
-		FILETIME ftLocalTime = {};
-
-		GetSystemTime(&stLocalTime);
-		GetSystemTimeAsFileTime(&ftLocalTime);
-
+		thread_local auto ullLastMs = ULONGLONG{};
+		thread_local auto ulLastDbgLvl = dbgLevel::NoDebug;
+		thread_local auto szThreadTime = std::wstring{};
+
+		auto ftTime = FILETIME{};
+		GetSystemTimeAsFileTime(&ftTime);
+		auto liTime = ULARGE_INTEGER{};
+		liTime.LowPart = ftTime.dwLowDateTime;
+		liTime.HighPart = ftTime.dwHighDateTime;
+		const auto ullMs = liTime.QuadPart / 10000;
+		if (ullMs == ullLastMs && ulDbgLvl == ulLastDbgLvl && !szThreadTime.empty()) return szThreadTime;
+
+		auto stTime = SYSTEMTIME{};
+		FileTimeToSystemTime(&ftTime, &stTime);
 		szThreadTime = strings::format(
 			L"0x%04x %02d:%02u:%02u.%03u%ws  %02u-%02u-%4u 0x%08X: ", // STRING_OK
 			GetCurrentThreadId(),
-			stLocalTime.wHour <= 12 ? stLocalTime.wHour : stLocalTime.wHour - 12,
-			stLocalTime.wMinute,
-			stLocalTime.wSecond,
-			stLocalTime.wMilliseconds,
-			stLocalTime.wHour <= 12 ? L"AM" : L"PM", // STRING_OK
-			stLocalTime.wMonth,
-			stLocalTime.wDay,
-			stLocalTime.wYear,
+			stTime.wHour <= 12 ? stTime.wHour : stTime.wHour - 12,
+			stTime.wMinute,
+			stTime.wSecond,
+			stTime.wMilliseconds,
+			stTime.wHour <= 12 ? L"AM" : L"PM", // STRING_OK
+			stTime.wMonth,
+			stTime.wDay,
+			stTime.wYear,
 			ulDbgLvl);
+		ullLastMs = ullMs;
+		ulLastDbgLvl = ulDbgLvl;
+		return szThreadTime;
+	}
+
+	void OutputThreadTime(dbgLevel ulDbgLvl)
+	{
+		// Compute current time and thread for a time stamp
+		const auto& szThreadTime = GetThreadTime(ulDbgLvl);
 		OutputDebugStringW(szThreadTime.c_str());
 		if (outputToDbgView)
 		{
@@ -185,7 +219,7 @@ namespace output
 			}
 			else
 			{
-				wprintf(L"%ws", szMsg.c_str());
+				fputws(szMsg.c_str(), stdout);
 			}
 
 			// print to to our debug output log file
@@ -357,7 +391,7 @@ namespace output
 
 		if (!szValue[0]) return;
 
-		auto szTag = strings::loadstring(uidTag);
+		const auto& szTag = strings::loadstring(uidTag);
 
 		OutputIndent(ulDbgLvl, fFile, iIndent);
 		Outputf(ulDbgLvl, fFile, false, L"<%ws>", szTag.c_str());
@@ -366,7 +400,15 @@ namespace output
 			OutputCDataOpen(ulDbgLvl, fFile);
 		}
 
-		Output(ulDbgLvl, fFile, false, strings::ScrubStringForXML(szValue));
+		// Most values are clean, so only copy the ones we have to scrub
+		if (strings::NeedsScrubForXML(szValue))
+		{
+			Output(ulDbgLvl, fFile, false, strings::ScrubStringForXML(szValue));
+		}
+		else
+		{
+			Output(ulDbgLvl, fFile, false, szValue);
+		}
 
 		if (bWrapCData)
 		{
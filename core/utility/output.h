@@ -55,7 +55,9 @@ namespace output
 	bool fIsSetv(dbgLevel ulTag) noexcept;
 	bool earlyExit(dbgLevel ulDbgLvl, bool fFile);
 
-	_Check_return_ FILE* MyOpenFile(const std::wstring& szFileName, bool bNewFile);
+	// New files are written as UTF-8 through a buffered sink. See outputSink.h.
+	// A background writer suits files which stay open for a lot of output.
+	_Check_return_ FILE* MyOpenFile(const std::wstring& szFileName, bool bNewFile, bool bBackgroundWriter = false);
 	_Check_return_ FILE* MyOpenFileMode(const std::wstring& szFileName, const wchar_t* mode);
 	void CloseFile(_In_opt_ FILE* fFile) noexcept;
 
@@ -0,0 +1,194 @@
+#include <core/stdafx.h>
+#include <core/utility/outputSink.h>
+#include <atomic>
+
+namespace output
+{
+	constexpr size_t cchBuffer = 64 * 1024; // Characters we collect before writing
+	constexpr size_t cMaxQueued = 4; // Buffers the background writer may fall behind by
+	constexpr size_t cMaxSpare = 2;
+
+	fileSink::fileSink(_In_ FILE* _fFile, bool _bBackground) : fFile(_fFile), bBackground(_bBackground)
+	{
+		szPending.reserve(cchBuffer + cchBuffer / 4);
+		if (bBackground)
+		{
+			try
+			{
+				writer = std::thread([this] { writerLoop(); });
+			}
+			catch (const std::system_error&)
+			{
+				// No thread, so write as we go
+				bBackground = false;
+			}
+		}
+	}
+
+	fileSink::~fileSink()
+	{
+		flush();
+		if (writer.joinable())
+		{
+			{
+				const auto guard = std::lock_guard<std::mutex>(lock);
+				bStopping = true;
+			}
+
+			changed.notify_all();
+			writer.join();
+		}
+	}
+
+	void fileSink::write(std::wstring_view szText)
+	{
+		for (;;)
+		{
+			const auto lf = szText.find(L'\n');
+			if (lf == std::wstring_view::npos)
+			{
+				szPending.append(szText);
+				break;
+			}
+
+			szPending.append(szText.substr(0, lf));
+			szPending.append(L"\r\n");
+			szText.remove_prefix(lf + 1);
+		}
+
+		if (szPending.size() >= cchBuffer) submit();
+	}
+
+	void fileSink::flush()
+	{
+		submit();
+		if (bBackground)
+		{
+			auto guard = std::unique_lock<std::mutex>(lock);
+			changed.wait(guard, [this] { return queue.empty() && !bWriting; });
+		}
+
+		fflush(fFile);
+	}
+
+	void fileSink::submit()
+	{
+		if (szPending.empty()) return;
+		if (!bBackground)
+		{
+			writeChunk(szPending, szEncoded);
+			szPending.clear();
+			return;
+		}
+
+		{
+			auto guard = std::unique_lock<std::mutex>(lock);
+			changed.wait(guard, [this] { return queue.size() < cMaxQueued; });
+			queue.push_back(std::move(szPending));
+			szPending.clear();
+			if (!spare.empty())
+			{
+				szPending = std::move(spare.back());
+				spare.pop_back();
+			}
+		}
+
+		changed.notify_all();
+		szPending.reserve(cchBuffer + cchBuffer / 4);
+	}
+
+	void fileSink::writeChunk(std::wstring_view szText, std::string& szOut)
+	{
+		// A UTF-16 code unit never takes more than three bytes of UTF-8, so one pass will do
+		const auto cch = static_cast<int>(szText.size());
+		szOut.resize(szText.size() * 3);
+		const auto cb = WideCharToMultiByte(
+			CP_UTF8, 0, szText.data(), cch, szOut.data(), static_cast<int>(szOut.size()), nullptr, nullptr);
+		if (cb > 0) fwrite(szOut.data(), 1, cb, fFile);
+	}
+
+	void fileSink::writerLoop()
+	{
+		auto szOut = std::string{};
+		auto guard = std::unique_lock<std::mutex>(lock);
+		for (;;)
+		{
+			changed.wait(guard, [this] { return bStopping || !queue.empty(); });
+			if (queue.empty()) return;
+
+			auto szText = std::move(queue.front());
+			queue.pop_front();
+			bWriting = true;
+			guard.unlock();
+
+			writeChunk(szText, szOut);
+			szText.clear();
+
+			guard.lock();
+			if (spare.size() < cMaxSpare) spare.push_back(std::move(szText));
+			bWriting = false;
+			changed.notify_all();
+		}
+	}
+
+	namespace
+	{
+		std::mutex sinksLock;
+		std::unordered_map<FILE*, std::unique_ptr<sink>> sinks;
+		// Bumped whenever a sink comes or goes, so cached lookups know to look again
+		std::atomic<ULONG> sinksGeneration{1};
+
+		struct cachedSink
+		{
+			FILE* fFile{};
+			sink* lpSink{};
+			ULONG ulGeneration{};
+		};
+	} // namespace
+
+	void attachSink(_In_ FILE* fFile, std::unique_ptr<sink> lpSink)
+	{
+		if (!fFile) return;
+
+		{
+			const auto guard = std::lock_guard<std::mutex>(sinksLock);
+			sinks[fFile].swap(lpSink);
+			sinksGeneration++;
+		}
+
+		// Whatever was attached before goes away outside the lock, since flushing it may take a while
+		lpSink.reset();
+	}
+
+	void detachSink(_In_opt_ FILE* fFile) noexcept
+	{
+		if (!fFile) return;
+
+		auto lpSink = std::unique_ptr<sink>{};
+		{
+			const auto guard = std::lock_guard<std::mutex>(sinksLock);
+			const auto it = sinks.find(fFile);
+			if (it == sinks.end()) return;
+			lpSink = std::move(it->second);
+			sinks.erase(it);
+			sinksGeneration++;
+		}
+
+		lpSink.reset();
+	}
+
+	// Every write looks up its file's sink, so each thread remembers the last one it found
+	_Check_return_ sink* findSink(_In_opt_ FILE* fFile)
+	{
+		if (!fFile) return nullptr;
+
+		thread_local auto cached = cachedSink{};
+		const auto ulGeneration = sinksGeneration.load();
+		if (cached.fFile == fFile && cached.ulGeneration == ulGeneration) return cached.lpSink;
+
+		const auto guard = std::lock_guard<std::mutex>(sinksLock);
+		const auto it = sinks.find(fFile);
+		cached = {fFile, it == sinks.end() ? nullptr : it->second.get(), sinksGeneration.load()};
+		return cached.lpSink;
+	}
+} // namespace output
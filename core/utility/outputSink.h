@@ -0,0 +1,65 @@
+#pragma once
+// Buffered output sinks for files written through output::Output
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+namespace output
+{
+	// Where Output sends text for a file which has a sink attached.
+	// A sink is used by one thread at a time, like the FILE it stands in for.
+	class sink
+	{
+	public:
+		virtual ~sink() = default;
+		virtual void write(std::wstring_view szText) = 0;
+		// Everything written so far reaches the file
+		virtual void flush() = 0;
+	};
+
+	// Collects text in a large buffer and writes it out as UTF-8, converting a buffer at a time.
+	// Line feeds become CRLF, as they would through a text mode stream.
+	// With a background writer, encoding and writing happen on a thread of our own
+	// so the caller only ever appends to a buffer.
+	class fileSink final : public sink
+	{
+	public:
+		fileSink(_In_ FILE* fFile, bool bBackground);
+		~fileSink() override;
+
+		fileSink(const fileSink&) = delete;
+		fileSink& operator=(const fileSink&) = delete;
+
+		void write(std::wstring_view szText) override;
+		void flush() override;
+
+	private:
+		// Hands the pending text off to be encoded and written
+		void submit();
+		void writeChunk(std::wstring_view szText, std::string& szEncoded);
+		void writerLoop();
+
+		FILE* fFile{};
+		std::wstring szPending; // Text not yet submitted
+		std::string szEncoded; // Reused for foreground writes
+
+		// Background writer
+		bool bBackground{};
+		std::thread writer;
+		std::mutex lock;
+		std::condition_variable changed;
+		std::deque<std::wstring> queue; // Buffers waiting to be written
+		std::deque<std::wstring> spare; // Written buffers, kept to save reallocating
+		bool bWriting{}; // The writer has a buffer in hand
+		bool bStopping{};
+	};
+
+	// Send all Output for fFile through lpSink until the sink is detached. Replaces any sink already attached.
+	void attachSink(_In_ FILE* fFile, std::unique_ptr<sink> lpSink);
+	// Flushes and destroys the sink, if fFile has one. CloseFile does this for you.
+	void detachSink(_In_opt_ FILE* fFile) noexcept;
+	_Check_return_ sink* findSink(_In_opt_ FILE* fFile);
+} // namespace output
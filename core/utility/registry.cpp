@@ -67,6 +67,10 @@ namespace registry
 	boolRegKey displayAboutDialog{L"DisplayAboutDialog", true, false, NULL};
 	wstringRegKey propertyColumnOrder{L"PropertyColumnOrder", L"", false, NULL};
 	dwordRegKey namedPropBatchSize{L"NamedPropBatchSize", regOptionType::stringDec, 400, false, NULL};
+	// Directory to persist the named property cache in, one file per mapping signature. Empty disables persistence.
+	wstringRegKey namedPropCacheDir{L"NamedPropCacheDir", L"", false, NULL};
+	// Number of rendered Smart View blobs to keep for reuse. Zero disables the cache.
+	dwordRegKey smartViewCacheSize{L"SmartViewCacheSize", regOptionType::stringDec, 1000, false, NULL};
 
 	std::vector<__RegKey*> RegKeys = {
 		&debugTag,
@@ -99,7 +103,9 @@ namespace registry
 		&uiDiag,
 		&displayAboutDialog,
 		&propertyColumnOrder,
-		&namedPropBatchSize};
+		&namedPropBatchSize,
+		&namedPropCacheDir,
+		&smartViewCacheSize};
 
 	// If the value is not set in the registry, return the default value
 	DWORD ReadDWORDFromRegistry(_In_ HKEY hKey, _In_ const std::wstring& szValue, _In_ const DWORD dwDefaultVal)
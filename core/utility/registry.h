@@ -198,4 +198,6 @@ namespace registry
 	extern boolRegKey displayAboutDialog;
 	extern wstringRegKey propertyColumnOrder;
 	extern dwordRegKey namedPropBatchSize;
+	extern wstringRegKey namedPropCacheDir;
+	extern dwordRegKey smartViewCacheSize;
 } // namespace registry
\ No newline at end of file
@@ -1,5 +1,12 @@
 #include <core/stdafx.h>
 #include <core/utility/strings.h>
+#include <core/utility/messageFormat.h>
+#include <shared_mutex>
+#include <array>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define STRINGS_SSE2
+#endif
 #include <core/utility/output.h>
 #include <core/interpret/guid.h>
 
@@ -43,10 +50,29 @@ namespace strings
 	// This will try to load the string from the executable, which is fine for MFCMAPI and MrMAPI
 	// In our unit tests, we must load strings from UnitTest.dll, so we use setTestInstance
 	// to populate an appropriate HINSTANCE
-	void setTestInstance(HINSTANCE hInstance) noexcept { g_testInstance = hInstance; }
+	void setTestInstance(HINSTANCE hInstance) noexcept
+	{
+		g_testInstance = hInstance;
+		clearMessageCache();
+	}
 
-	std::wstring loadstring(DWORD dwID)
+	namespace
 	{
+		std::shared_mutex g_resourceStringsLock;
+		// Resource strings by module and ID, so we only hit LoadStringW once per string.
+		// Entries are never removed, so the references loadstring hands out stay good for the life of the process.
+		std::map<std::pair<HINSTANCE, DWORD>, const std::wstring> g_resourceStrings;
+	} // namespace
+
+	const std::wstring& loadstring(DWORD dwID)
+	{
+		const auto key = std::make_pair(g_testInstance, dwID);
+		{
+			const auto lock = std::shared_lock<std::shared_mutex>(g_resourceStringsLock);
+			const auto it = g_resourceStrings.find(key);
+			if (it != g_resourceStrings.end()) return it->second;
+		}
+
 		std::wstring fmtString;
 		LPWSTR buffer = nullptr;
 		const size_t len = LoadStringW(g_testInstance, dwID, reinterpret_cast<PWCHAR>(&buffer), 0);
@@ -56,28 +82,17 @@ namespace strings
 			fmtString.assign(buffer, len);
 		}
 
-		return fmtString;
+		// Another thread may have beaten us here. Either way, everyone gets the same copy.
+		const auto lock = std::unique_lock<std::shared_mutex>(g_resourceStringsLock);
+		return g_resourceStrings.emplace(key, std::move(fmtString)).first->second;
 	}
 
+	// FormatMessageW style formatting, done natively with a parsed format cached per string
 	std::wstring formatmessageV(LPCWSTR szMsg, va_list argList)
 	{
-		LPWSTR buffer = nullptr;
-		const auto dw = FormatMessageW(
-			FORMAT_MESSAGE_FROM_STRING | FORMAT_MESSAGE_ALLOCATE_BUFFER,
-			szMsg,
-			0,
-			0,
-			reinterpret_cast<LPWSTR>(&buffer),
-			0,
-			&argList);
-		if (dw)
-		{
-			auto ret = std::wstring(buffer);
-			static_cast<void>(LocalFree(buffer));
-			return ret;
-		}
-
-		return L"";
+		auto ret = std::wstring{};
+		appendmessageV(ret, szMsg, argList);
+		return ret;
 	}
 
 	std::wstring formatmessagesys(DWORD dwID)
@@ -101,12 +116,46 @@ namespace strings
 		return L"";
 	}
 
+	namespace
+	{
+		std::shared_mutex g_resourceMessagesLock;
+		// Resource ID to its parsed format string, so we only hit LoadStringW once per ID
+		std::unordered_map<DWORD, std::shared_ptr<const compiledMessage>> g_resourceMessages;
+	} // namespace
+
+	void clearMessageCache()
+	{
+		const auto lock = std::unique_lock<std::shared_mutex>(g_resourceMessagesLock);
+		g_resourceMessages.clear();
+	}
+
+	std::shared_ptr<const compiledMessage> compileMessage(DWORD dwID)
+	{
+		{
+			const auto lock = std::shared_lock<std::shared_mutex>(g_resourceMessagesLock);
+			const auto it = g_resourceMessages.find(dwID);
+			if (it != g_resourceMessages.end()) return it->second;
+		}
+
+		auto compiled = std::make_shared<const compiledMessage>(loadstring(dwID).c_str());
+		const auto lock = std::unique_lock<std::shared_mutex>(g_resourceMessagesLock);
+		return g_resourceMessages.emplace(dwID, compiled).first->second;
+	}
+
+	void appendmessage(std::wstring& out, DWORD dwID, ...)
+	{
+		va_list argList;
+		va_start(argList, dwID);
+		compileMessage(dwID)->append(out, argList);
+		va_end(argList);
+	}
+
 	// Takes format strings with %1 %2 %3...
 	std::wstring formatmessage(DWORD dwID, ...)
 	{
 		va_list argList;
 		va_start(argList, dwID);
-		auto ret = formatmessageV(loadstring(dwID).c_str(), argList);
+		auto ret = compileMessage(dwID)->format(argList);
 		va_end(argList);
 		return ret;
 	}
@@ -153,6 +202,33 @@ namespace strings
 		return dst;
 	}
 
+	std::wstring utf8Towstring(const std::string& src)
+	{
+		if (src.empty()) return {};
+		const auto cb = static_cast<int>(src.size());
+		const auto cch = MultiByteToWideChar(CP_UTF8, 0, src.data(), cb, nullptr, 0);
+		if (cch <= 0) return {};
+		auto dst = std::wstring(static_cast<size_t>(cch), L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, src.data(), cb, dst.data(), cch);
+		return dst;
+	}
+
+	size_t utf8CompleteLength(const std::string& src) noexcept
+	{
+		// Step back over up to three continuation bytes to the lead byte of the last sequence
+		auto lead = src.size();
+		for (size_t i = 0; i < 3 && lead > 0; i++)
+		{
+			if ((static_cast<BYTE>(src[lead - 1]) & 0xC0) != 0x80) break;
+			lead--;
+		}
+
+		if (lead == 0) return src.size();
+		const auto c = static_cast<BYTE>(src[lead - 1]);
+		const size_t cbSequence = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+		return src.size() - (lead - 1) < cbSequence ? lead - 1 : src.size();
+	}
+
 	std::wstring LPCTSTRToWstring(LPCTSTR src)
 	{
 #ifdef UNICODE
@@ -309,33 +385,42 @@ namespace strings
 		return strip(szString, [character](const WCHAR& chr) { return chr == character; });
 	}
 
+	void StripCharacterInPlace(std::wstring& szString, WCHAR character)
+	{
+		szString.erase(std::remove(szString.begin(), szString.end(), character), szString.end());
+	}
+
 	std::wstring StripCarriage(const std::wstring& szString) { return StripCharacter(szString, L'\r'); }
 
 	std::wstring StripCRLF(const std::wstring& szString)
 	{
 		return strip(szString, [](const WCHAR& chr) {
 			// Remove carriage returns
-			return std::wstring(L", \r\n").find(chr) != std::wstring::npos;
+			return chr == L',' || chr == L' ' || chr == L'\r' || chr == L'\n';
 		});
 	}
 
-	std::wstring trimWhitespace(const std::wstring& szString)
+	std::wstring_view trimWhitespaceView(std::wstring_view szString) noexcept
 	{
-		static const auto whitespace = {L'\0', L' ', L'\r', L'\n', L'\t'};
+		constexpr auto whitespace = std::wstring_view{L"\0 \r\n\t", 5};
 		const auto first = szString.find_first_not_of(whitespace);
-		if (first == std::string::npos) return emptystring;
+		if (first == std::wstring_view::npos) return {};
 		const auto last = szString.find_last_not_of(whitespace);
 		return szString.substr(first, last - first + 1);
 	}
 
-	std::wstring trim(const std::wstring& szString)
+	std::wstring trimWhitespace(const std::wstring& szString) { return std::wstring(trimWhitespaceView(szString)); }
+
+	std::wstring_view trimView(std::wstring_view szString) noexcept
 	{
-		const auto first = szString.find_first_not_of(' ');
-		if (first == std::string::npos) return emptystring;
-		const auto last = szString.find_last_not_of(' ');
+		const auto first = szString.find_first_not_of(L' ');
+		if (first == std::wstring_view::npos) return {};
+		const auto last = szString.find_last_not_of(L' ');
 		return szString.substr(first, last - first + 1);
 	}
 
+	std::wstring trim(const std::wstring& szString) { return std::wstring(trimView(szString)); }
+
 	std::wstring replace(const std::wstring& str, const std::function<bool(const WCHAR&)>& func, const WCHAR& chr)
 	{
 		std::wstring result;
@@ -344,15 +429,24 @@ namespace strings
 		return result;
 	}
 
+	// Anything less than 0x20 except tab, carriage return and linefeed
+	bool InvalidXMLCharacter(WCHAR chr) noexcept { return chr < 0x20 && chr != L'\t' && chr != L'\r' && chr != L'\n'; }
+
+	bool NeedsScrubForXML(std::wstring_view szString) noexcept
+	{
+		return std::any_of(szString.begin(), szString.end(), InvalidXMLCharacter);
+	}
+
+	void ScrubStringForXMLInPlace(std::wstring& szString) noexcept
+	{
+		std::replace_if(szString.begin(), szString.end(), InvalidXMLCharacter, L'.');
+	}
+
 	std::wstring ScrubStringForXML(const std::wstring& szString)
 	{
-		return replace(
-			szString,
-			[](const WCHAR& chr) {
-				// Replace anything less than 0x20 except tab, carriage return and linefeed
-				return chr < 0x20 && std::wstring(L"\t\r\n").find(chr) == std::wstring::npos;
-			},
-			L'.');
+		auto szScrubbed = szString;
+		ScrubStringForXMLInPlace(szScrubbed);
+		return szScrubbed;
 	}
 
 	// Processes szFileIn, replacing non file system characters with underscores
@@ -363,7 +457,8 @@ namespace strings
 			szFileIn,
 			[](const WCHAR& chr) {
 				// Remove non file system characters
-				return std::wstring(L"^&*-+=[]\\|;:\",<>/?\r\n").find(chr) != std::wstring::npos;
+				constexpr auto invalid = std::wstring_view{L"^&*-+=[]\\|;:\",<>/?\r\n"};
+				return invalid.find(chr) != std::wstring_view::npos;
 			},
 			L'_');
 	}
@@ -407,18 +502,23 @@ namespace strings
 		return szBin;
 	}
 
-	std::wstring RemoveInvalidCharactersW(const std::wstring& szString, bool bMultiLine)
+	void RemoveInvalidCharactersInPlace(std::wstring& szString, bool bMultiLine) noexcept
 	{
-		if (szString.empty()) return szString;
-		auto szBin(szString);
-		const auto nullTerminated = szBin.back() == L'\0';
+		if (szString.empty()) return;
+		const auto nullTerminated = szString.back() == L'\0';
 		std::replace_if(
-			szBin.begin(),
-			szBin.end(),
+			szString.begin(),
+			szString.end(),
 			[bMultiLine](const WCHAR& chr) noexcept { return InvalidCharacter(chr, bMultiLine); },
 			L'.');
 
-		if (nullTerminated) szBin.back() = L'\0';
+		if (nullTerminated) szString.back() = L'\0';
+	}
+
+	std::wstring RemoveInvalidCharactersW(const std::wstring& szString, bool bMultiLine)
+	{
+		auto szBin(szString);
+		RemoveInvalidCharactersInPlace(szBin, bMultiLine);
 		return szBin;
 	}
 
@@ -434,8 +534,9 @@ namespace strings
 	{
 		if (!lpBin || !lpBin->cb || lpBin->cb % sizeof WCHAR || !lpBin->lpb) return L"";
 
-		const std::wstring szBin(reinterpret_cast<LPWSTR>(lpBin->lpb), lpBin->cb / sizeof WCHAR);
-		return RemoveInvalidCharactersW(szBin, bMultiLine);
+		auto szBin = std::wstring(reinterpret_cast<LPWSTR>(lpBin->lpb), lpBin->cb / sizeof WCHAR);
+		RemoveInvalidCharactersInPlace(szBin, bMultiLine);
+		return szBin;
 	}
 
 	std::wstring BinToTextString(const std::vector<BYTE>& lpByte, bool bMultiLine)
@@ -460,6 +561,123 @@ namespace strings
 		return szBin;
 	}
 
+	namespace
+	{
+		// Each byte's two hex characters, packed so they can be written with a single store
+		const std::array<std::array<wchar_t, 2>, 256> hexPairs = [] {
+			auto pairs = std::array<std::array<wchar_t, 2>, 256>{};
+			for (auto i = 0; i < 256; i++)
+			{
+				pairs[i][0] = L"0123456789ABCDEF"[i >> 4];
+				pairs[i][1] = L"0123456789ABCDEF"[i & 0xf];
+			}
+
+			return pairs;
+		}();
+
+		// Hex character to its nibble value. 0xff means not a hex character.
+		const std::array<BYTE, 256> hexValues = [] {
+			auto values = std::array<BYTE, 256>{};
+			values.fill(0xff);
+			for (auto i = 0; i < 10; i++)
+			{
+				values[L'0' + i] = static_cast<BYTE>(i);
+			}
+
+			for (auto i = 0; i < 6; i++)
+			{
+				values[L'A' + i] = static_cast<BYTE>(0xa + i);
+				values[L'a' + i] = static_cast<BYTE>(0xa + i);
+			}
+
+			return values;
+		}();
+	} // namespace
+
+	void BinToHex(_In_count_(cb) const BYTE* lpb, size_t cb, _Out_writes_(cb * 2) wchar_t* out) noexcept
+	{
+		size_t i = 0;
+#ifdef STRINGS_SSE2
+		static_assert(sizeof(wchar_t) == 2, "SSE2 hex encoding writes UTF-16");
+		// 16 bytes in, 32 characters out per pass
+		const auto zero = _mm_setzero_si128();
+		const auto lowNibble = _mm_set1_epi8(0x0f);
+		const auto nine = _mm_set1_epi8(9);
+		const auto digit = _mm_set1_epi8('0');
+		const auto letterGap = _mm_set1_epi8('A' - '0' - 10);
+		const auto toHex = [&](__m128i nibbles) {
+			const auto letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, nine), letterGap);
+			return _mm_add_epi8(_mm_add_epi8(nibbles, digit), letters);
+		};
+
+		for (; i + 16 <= cb; i += 16)
+		{
+			const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lpb + i));
+			const auto high = toHex(_mm_and_si128(_mm_srli_epi16(bytes, 4), lowNibble));
+			const auto low = toHex(_mm_and_si128(bytes, lowNibble));
+			const auto first = _mm_unpacklo_epi8(high, low);
+			const auto second = _mm_unpackhi_epi8(high, low);
+			const auto dest = reinterpret_cast<__m128i*>(out + i * 2);
+			_mm_storeu_si128(dest, _mm_unpacklo_epi8(first, zero));
+			_mm_storeu_si128(dest + 1, _mm_unpackhi_epi8(first, zero));
+			_mm_storeu_si128(dest + 2, _mm_unpacklo_epi8(second, zero));
+			_mm_storeu_si128(dest + 3, _mm_unpackhi_epi8(second, zero));
+		}
+#endif
+
+		for (; i < cb; i++)
+		{
+			const auto& pair = hexPairs[lpb[i]];
+			out[i * 2] = pair[0];
+			out[i * 2 + 1] = pair[1];
+		}
+	}
+
+	bool HexToBin(_In_count_(cch) const wchar_t* lpsz, size_t cch, _Out_writes_(cch / 2) BYTE* out) noexcept
+	{
+		size_t i = 0;
+#ifdef STRINGS_SSE2
+		// 16 characters in, 8 bytes out per pass
+		const auto zero = _mm_setzero_si128();
+		const auto digit = _mm_set1_epi8('0');
+		const auto nine = _mm_set1_epi8(9);
+		const auto lowerCase = _mm_set1_epi8(0x20);
+		const auto letter = _mm_set1_epi8('a');
+		const auto five = _mm_set1_epi8(5);
+		const auto ten = _mm_set1_epi8(10);
+		const auto lowByte = _mm_set1_epi16(0xff);
+		for (; i + 16 <= cch; i += 16)
+		{
+			// Characters over 0xff saturate to 0x00 or 0xff, neither of which is hex
+			const auto src = reinterpret_cast<const __m128i*>(lpsz + i);
+			const auto chars = _mm_packus_epi16(_mm_loadu_si128(src), _mm_loadu_si128(src + 1));
+
+			const auto digits = _mm_sub_epi8(chars, digit);
+			const auto isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, nine), digits);
+			const auto letters = _mm_sub_epi8(_mm_or_si128(chars, lowerCase), letter);
+			const auto isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letters, five), letters);
+			if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xffff) return false;
+
+			const auto nibbles = _mm_or_si128(
+				_mm_and_si128(isDigit, digits), _mm_andnot_si128(isDigit, _mm_add_epi8(letters, ten)));
+			// Each 16 bit lane holds a high nibble in its low byte and a low nibble in its high byte
+			const auto bytes =
+				_mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, lowByte), 4), _mm_srli_epi16(nibbles, 8));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + i / 2), _mm_packus_epi16(bytes, zero));
+		}
+#endif
+
+		for (; i + 1 < cch; i += 2)
+		{
+			const auto high = lpsz[i] > 0xff ? BYTE{0xff} : hexValues[lpsz[i]];
+			const auto low = lpsz[i + 1] > 0xff ? BYTE{0xff} : hexValues[lpsz[i + 1]];
+			if (high == 0xff || low == 0xff) return false;
+			out[i / 2] = static_cast<BYTE>(high << 4 | low);
+		}
+
+		return true;
+	}
+
 	std::wstring BinToHexString(_In_opt_count_(cb) const BYTE* lpb, size_t cb, bool bPrependCB)
 	{
 		std::wstring lpsz;
@@ -475,16 +693,9 @@ namespace strings
 		}
 		else
 		{
-			for (ULONG i = 0; i < cb; i++)
-			{
-				const auto bLow = static_cast<BYTE>(lpb[i] & 0xf);
-				const auto bHigh = static_cast<BYTE>(lpb[i] >> 4 & 0xf);
-				const auto szLow = static_cast<wchar_t>(bLow <= 0x9 ? L'0' + bLow : L'A' + bLow - 0xa);
-				const auto szHigh = static_cast<wchar_t>(bHigh <= 0x9 ? L'0' + bHigh : L'A' + bHigh - 0xa);
-
-				lpsz += szHigh;
-				lpsz += szLow;
-			}
+			const auto cchPrefix = lpsz.length();
+			lpsz.resize(cchPrefix + cb * 2);
+			BinToHex(lpb, cb, &lpsz[cchPrefix]);
 		}
 
 		return lpsz;
@@ -519,206 +730,239 @@ namespace strings
 	// If cbTarget != 0, caps the number of bytes converted at cbTarget
 	std::vector<BYTE> HexStringToBin(_In_ const std::wstring& input, size_t cbTarget)
 	{
-		// remove junk
-		auto lpsz = strip(input, [](const WCHAR& chr) { return IsFilteredHex(chr); });
+		// remove junk, but only copy the input if there is junk to remove
+		auto filtered = std::wstring{};
+		auto lpsz = input.c_str();
+		auto cchStrLen = input.length();
+		if (std::any_of(input.begin(), input.end(), IsFilteredHex))
+		{
+			filtered = strip(input, [](const WCHAR& chr) { return IsFilteredHex(chr); });
+			lpsz = filtered.c_str();
+			cchStrLen = filtered.length();
+		}
 
 		// strip one (and only one) prefix
-		stripPrefix(lpsz, L"0x") || stripPrefix(lpsz, L"0X") || stripPrefix(lpsz, L"x") || stripPrefix(lpsz, L"X");
+		if (cchStrLen >= 2 && lpsz[0] == L'0' && (lpsz[1] == L'x' || lpsz[1] == L'X'))
+		{
+			lpsz += 2;
+			cchStrLen -= 2;
+		}
+		else if (cchStrLen >= 1 && (lpsz[0] == L'x' || lpsz[0] == L'X'))
+		{
+			lpsz++;
+			cchStrLen--;
+		}
 
-		const auto cchStrLen = lpsz.length();
 		// If our input is odd, we can't convert
 		// Unless we've capped our output at less than the input
 		if (cchStrLen % 2 != 0 && (cbTarget == 0 || cbTarget * 2 > cchStrLen)) return std::vector<BYTE>();
 
-		std::vector<BYTE> lpb;
-		WCHAR szTmp[3] = {0};
-		size_t iCur = 0;
-		size_t cbConverted = 0;
-
-		// convert two characters at a time
-		while (iCur + 1 < cchStrLen && (cbTarget == 0 || cbConverted < cbTarget))
-		{
-			// Check for valid hex characters
-			if (lpsz[iCur] > 255 || lpsz[iCur + 1] > 255 || !isxdigit(lpsz[iCur]) || !isxdigit(lpsz[iCur + 1]))
-			{
-				return std::vector<BYTE>();
-			}
+		auto cb = cchStrLen / 2;
+		if (cbTarget != 0 && cbTarget < cb) cb = cbTarget;
 
-			szTmp[0] = lpsz[iCur];
-			szTmp[1] = lpsz[iCur + 1];
-			lpb.push_back(static_cast<BYTE>(wcstol(szTmp, nullptr, 16)));
-			iCur += 2;
-			cbConverted++;
-		}
+		auto lpb = std::vector<BYTE>(cb);
+		if (!HexToBin(lpsz, cb * 2, lpb.data())) return std::vector<BYTE>();
 
 		return lpb;
 	}
 
-	std::vector<std::wstring> split(const std::wstring& str, const wchar_t delim)
+	void split(std::wstring_view str, wchar_t delim, std::vector<std::wstring_view>& out)
 	{
-		auto ss = std::wstringstream(str);
-		std::wstring item;
-		std::vector<std::wstring> elems;
-		while (getline(ss, item, delim))
-		{
-			elems.push_back(item);
-		}
+		out.clear();
+		if (str.empty()) return;
 
-		// If the last character is a delimiter, the above won't get our final "string".
-		// For instamce, "1." has only mapped to "1" so far.
-		// Add a final "" to finish the split.
-		if (str.length() >= 1 && str.back() == delim)
+		// A trailing delimiter leaves a final empty field, so "1." splits to "1" and ""
+		for (;;)
 		{
-			elems.push_back(L"");
+			const auto pos = str.find(delim);
+			out.push_back(str.substr(0, pos));
+			if (pos == std::wstring_view::npos) break;
+			str.remove_prefix(pos + 1);
 		}
-
-		return elems;
 	}
 
-	std::wstring join(const std::vector<std::wstring>& elems, const std::wstring& delim, bool bSkipEmpty)
+	std::vector<std::wstring> split(const std::wstring& str, const wchar_t delim)
 	{
-		if (elems.empty()) return emptystring;
+		auto fields = std::vector<std::wstring_view>{};
+		split(str, delim, fields);
+		return std::vector<std::wstring>(fields.begin(), fields.end());
+	}
 
-		std::wstringstream ss;
-		auto iter = elems.begin();
-		bool needDelim = false;
-		while (true)
+	void join(std::wstring& out, const std::vector<std::wstring>& elems, std::wstring_view delim, bool bSkipEmpty)
+	{
+		out.clear();
+		auto cch = size_t{};
+		for (const auto& elem : elems)
 		{
-			if (bSkipEmpty && iter->empty())
-			{
-				if (++iter == elems.end()) break;
-				continue;
-			}
+			cch += elem.length() + delim.length();
+		}
 
-			if (needDelim) ss << delim;
-			ss << *iter;
-			if (++iter == elems.end()) break;
+		out.reserve(cch);
+		auto needDelim = false;
+		for (const auto& elem : elems)
+		{
+			if (bSkipEmpty && elem.empty()) continue;
+			if (needDelim) out.append(delim);
+			out.append(elem);
 			needDelim = true;
 		}
+	}
 
-		return ss.str();
+	std::wstring join(const std::vector<std::wstring>& elems, const std::wstring& delim, bool bSkipEmpty)
+	{
+		auto out = std::wstring{};
+		join(out, elems, delim, bSkipEmpty);
+		return out;
 	}
 
 	std::wstring join(const std::vector<std::wstring>& elems, const wchar_t delim, bool bSkipEmpty)
 	{
-		return join(elems, std::wstring(1, delim), bSkipEmpty);
+		auto out = std::wstring{};
+		join(out, elems, std::wstring_view{&delim, 1}, bSkipEmpty);
+		return out;
 	}
 
 	// clang-format off
-	// 0x7f means invalid character
-	static const char pBase64[] = {
-		0x3e, 0x7f, 0x7f, 0x7f, 0x3f, 0x34, 0x35, 0x36,
-		0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x7f,
-		0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x00, 0x01,
-		0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
-		0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11,
-		0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
-		0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x1a, 0x1b,
-		0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23,
-		0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b,
-		0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33
+	static const // Base64 Index into encoding
+		char pIndex[] = { // and decoding table.
+		0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+		0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f, 0x50,
+		0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+		0x59, 0x5a, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66,
+		0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e,
+		0x6f, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76,
+		0x77, 0x78, 0x79, 0x7a, 0x30, 0x31, 0x32, 0x33,
+		0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x2b, 0x2f
 	};
 	// clang-format on
 
+	namespace
+	{
+		// Base64 character to its 6 bit value. 0x7f means invalid character.
+		const std::array<BYTE, 256> base64Values = [] {
+			auto values = std::array<BYTE, 256>{};
+			values.fill(0x7f);
+			for (BYTE i = 0; i < 64; i++)
+			{
+				values[static_cast<BYTE>(pIndex[i])] = i;
+			}
+
+			return values;
+		}();
+
+		BYTE base64Value(wchar_t c) noexcept { return c > 0xff ? BYTE{0x7f} : base64Values[c]; }
+	} // namespace
+
+	size_t Base64DecodedSize(_In_count_(cch) const wchar_t* lpsz, size_t cch) noexcept
+	{
+		if (cch % 4) return 0;
+		auto cb = cch / 4 * 3;
+		if (cch && lpsz[cch - 1] == L'=') cb--;
+		if (cch > 1 && lpsz[cch - 2] == L'=') cb--;
+		return cb;
+	}
+
 	// https://tools.ietf.org/html/rfc4648
-	std::vector<BYTE> Base64Decode(const std::wstring& szEncodedStr)
+	bool Base64DecodeTo(
+		_In_count_(cch) const wchar_t* lpsz,
+		size_t cch,
+		_Out_ BYTE* out) noexcept
 	{
-		const auto cchLen = szEncodedStr.length();
-		std::vector<BYTE> lpb;
-		if (cchLen % 4) return lpb;
+		if (cch % 4) return false;
 
-		// look for padding at the end
-		const auto posEqual = szEncodedStr.find(L'=');
-		if (posEqual != std::wstring::npos)
+		// Padding can only be one or two = at the very end
+		auto cchPadding = size_t{};
+		while (cchPadding < cch && lpsz[cch - cchPadding - 1] == L'=')
 		{
-			auto suffix = szEncodedStr.substr(posEqual);
-			if (suffix.length() >= 3 || suffix.find_first_not_of(L'=') != std::wstring::npos) return lpb;
+			cchPadding++;
 		}
 
-		auto szEncodedStrPtr = szEncodedStr.c_str();
-		WCHAR c[4] = {0};
-		BYTE bTmp[3] = {0}; // output
+		if (cchPadding > 2) return false;
 
-		while (*szEncodedStrPtr)
+		// Every quartet but the last is four real characters
+		const auto cchFull = cchPadding ? cch - 4 : cch;
+		for (size_t i = 0; i < cchFull; i += 4)
 		{
-			auto iOutlen = 3;
-			for (auto i = 0; i < 4; i++)
-			{
-				c[i] = *(szEncodedStrPtr + i);
-				if (c[i] == L'=')
-				{
-					iOutlen = i - 1;
-					break;
-				}
-
-				if (c[i] < 0x2b || c[i] > 0x7a) return std::vector<BYTE>(); // Accept '+' through 'z' at first
-
-				c[i] = pBase64[c[i] - 0x2b];
-				if (c[i] == 0x7f) return std::vector<BYTE>(); // and then reject characters which mapped to 0x7f
-			}
+			const auto c0 = base64Value(lpsz[i]);
+			const auto c1 = base64Value(lpsz[i + 1]);
+			const auto c2 = base64Value(lpsz[i + 2]);
+			const auto c3 = base64Value(lpsz[i + 3]);
+			// Valid values are 6 bits, so any 0x7f shows up in the OR
+			if ((c0 | c1 | c2 | c3) & 0x40) return false;
+
+			*out++ = static_cast<BYTE>(c0 << 2 | c1 >> 4);
+			*out++ = static_cast<BYTE>((c1 & 0x0f) << 4 | c2 >> 2);
+			*out++ = static_cast<BYTE>((c2 & 0x03) << 6 | c3);
+		}
 
-			bTmp[0] = static_cast<BYTE>(c[0] << 2 | c[1] >> 4);
-			bTmp[1] = static_cast<BYTE>((c[1] & 0x0f) << 4 | c[2] >> 2);
-			bTmp[2] = static_cast<BYTE>((c[2] & 0x03) << 6 | c[3]);
+		if (cchPadding)
+		{
+			const auto last = lpsz + cchFull;
+			const auto c0 = base64Value(last[0]);
+			const auto c1 = base64Value(last[1]);
+			const auto c2 = cchPadding == 1 ? base64Value(last[2]) : BYTE{0};
+			if ((c0 | c1 | c2) & 0x40) return false;
+
+			*out++ = static_cast<BYTE>(c0 << 2 | c1 >> 4);
+			if (cchPadding == 1) *out = static_cast<BYTE>((c1 & 0x0f) << 4 | c2 >> 2);
+		}
 
-			for (auto i = 0; i < iOutlen; i++)
-			{
-				lpb.push_back(bTmp[i]);
-			}
+		return true;
+	}
 
-			szEncodedStrPtr += 4;
-		}
+	std::vector<BYTE> Base64Decode(const std::wstring& szEncodedStr)
+	{
+		const auto cchLen = szEncodedStr.length();
+		auto lpb = std::vector<BYTE>(Base64DecodedSize(szEncodedStr.c_str(), cchLen));
+		if (!Base64DecodeTo(szEncodedStr.c_str(), cchLen, lpb.data())) return std::vector<BYTE>();
 
 		return lpb;
 	}
 
-	// clang-format off
-	static const // Base64 Index into encoding
-		char pIndex[] = { // and decoding table.
-		0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
-		0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f, 0x50,
-		0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
-		0x59, 0x5a, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66,
-		0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e,
-		0x6f, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76,
-		0x77, 0x78, 0x79, 0x7a, 0x30, 0x31, 0x32, 0x33,
-		0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x2b, 0x2f
-	};
-	// clang-format on
-
-	std::wstring Base64Encode(size_t cbSourceBuf, _In_count_(cbSourceBuf) const BYTE* lpSourceBuffer)
+	void Base64EncodeTo(
+		size_t cbSourceBuf,
+		_In_count_(cbSourceBuf) const BYTE* lpSourceBuffer,
+		_Out_ wchar_t* out) noexcept
 	{
-		std::wstring szEncodedStr;
 		size_t cbBuf = 0;
 
 		// Using integer division to round down here
-		while (cbBuf < cbSourceBuf / 3 * 3) // encode each 3 byte octet.
+		for (; cbBuf < cbSourceBuf / 3 * 3; cbBuf += 3) // encode each 3 byte octet.
 		{
-			szEncodedStr += pIndex[lpSourceBuffer[cbBuf] >> 2];
-			szEncodedStr += pIndex[((lpSourceBuffer[cbBuf] & 0x03) << 4) + (lpSourceBuffer[cbBuf + 1] >> 4)];
-			szEncodedStr += pIndex[((lpSourceBuffer[cbBuf + 1] & 0x0f) << 2) + (lpSourceBuffer[cbBuf + 2] >> 6)];
-			szEncodedStr += pIndex[lpSourceBuffer[cbBuf + 2] & 0x3f];
-			cbBuf += 3; // Next octet.
+			const auto b0 = lpSourceBuffer[cbBuf];
+			const auto b1 = lpSourceBuffer[cbBuf + 1];
+			const auto b2 = lpSourceBuffer[cbBuf + 2];
+			*out++ = pIndex[b0 >> 2];
+			*out++ = pIndex[((b0 & 0x03) << 4) + (b1 >> 4)];
+			*out++ = pIndex[((b1 & 0x0f) << 2) + (b2 >> 6)];
+			*out++ = pIndex[b2 & 0x3f];
 		}
 
 		if (cbSourceBuf - cbBuf != 0) // Partial octet remaining?
 		{
-			szEncodedStr += pIndex[lpSourceBuffer[cbBuf] >> 2]; // Yes, encode it.
+			const auto b0 = lpSourceBuffer[cbBuf];
+			*out++ = pIndex[b0 >> 2]; // Yes, encode it.
 
 			if (cbSourceBuf - cbBuf == 1) // End of octet?
 			{
-				szEncodedStr += pIndex[(lpSourceBuffer[cbBuf] & 0x03) << 4];
-				szEncodedStr += L'=';
-				szEncodedStr += L'=';
+				*out++ = pIndex[(b0 & 0x03) << 4];
+				*out++ = L'=';
+				*out = L'=';
 			}
 			else
 			{ // No, one more part.
-				szEncodedStr += pIndex[((lpSourceBuffer[cbBuf] & 0x03) << 4) + (lpSourceBuffer[cbBuf + 1] >> 4)];
-				szEncodedStr += pIndex[(lpSourceBuffer[cbBuf + 1] & 0x0f) << 2];
-				szEncodedStr += L'=';
+				const auto b1 = lpSourceBuffer[cbBuf + 1];
+				*out++ = pIndex[((b0 & 0x03) << 4) + (b1 >> 4)];
+				*out++ = pIndex[(b1 & 0x0f) << 2];
+				*out = L'=';
 			}
 		}
+	}
 
+	std::wstring Base64Encode(size_t cbSourceBuf, _In_count_(cbSourceBuf) const BYTE* lpSourceBuffer)
+	{
+		auto szEncodedStr = std::wstring(Base64EncodedSize(cbSourceBuf), L'\0');
+		if (!szEncodedStr.empty()) Base64EncodeTo(cbSourceBuf, lpSourceBuffer, &szEncodedStr[0]);
 		return szEncodedStr;
 	}
 
@@ -764,8 +1008,26 @@ namespace strings
 
 	bool IsFilteredHex(const WCHAR& chr)
 	{
-		const std::wstring szJunk = L"\r\n\t -.,\\/'{}`\""; // STRING_OK
-		return szJunk.find(chr) != std::wstring::npos;
+		switch (chr)
+		{
+		case L'\r':
+		case L'\n':
+		case L'\t':
+		case L' ':
+		case L'-':
+		case L'.':
+		case L',':
+		case L'\\':
+		case L'/':
+		case L'\'':
+		case L'{':
+		case L'}':
+		case L'`':
+		case L'"':
+			return true;
+		default:
+			return false;
+		}
 	}
 
 	size_t OffsetToFilteredOffset(const std::wstring& szString, size_t offset)
@@ -882,30 +1144,32 @@ namespace strings
 	{
 		auto ret = std::map<std::wstring, std::wstring>();
 		// Start with: a: b c: d
-		const auto tokens = strings::split(str, L' ');
+		auto tokens = std::vector<std::wstring_view>{};
+		strings::split(str, L' ', tokens);
 		// Now we have a:, b, c:, d
 		// Look for a token that ends in :
 		// Then pair that with the next token and add to the return
-		std::wstring label;
-		for (const auto token : tokens)
+		std::wstring_view label;
+		for (const auto& token : tokens)
 		{
+			const auto isLabel = !token.empty() && token.back() == L':';
 			if (label.empty())
 			{
-				if (token.back() == L':')
+				if (isLabel)
 				{
 					label = token.substr(0, token.size() - 1);
 				}
 			}
 			else
 			{
-				if (token.back() != L':')
+				if (!isLabel)
 				{
-					ret[label] = token;
-					label.clear();
+					ret[std::wstring(label)] = token;
+					label = {};
 				}
 				else
 				{
-					label.clear();
+					label = {};
 				}
 			}
 		}
@@ -932,12 +1196,18 @@ namespace strings
 	std::wstring collapseTree(const std::wstring& src)
 	{
 		// Strategy: Split to lines, trim whitepace around lines, join with spaces
-		auto lines = strings::split(src, L'\n');
-		for (auto& line : lines)
+		auto lines = std::vector<std::wstring_view>{};
+		split(src, L'\n', lines);
+		auto ret = std::wstring{};
+		ret.reserve(src.length());
+		for (const auto& line : lines)
 		{
-			line = strings::trimWhitespace(line);
+			const auto trimmed = trimWhitespaceView(line);
+			if (trimmed.empty()) continue;
+			if (!ret.empty()) ret += L' ';
+			ret.append(trimmed);
 		}
 
-		return join(lines, L' ', true);
+		return ret;
 	}
 } // namespace strings
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include <string_view>
 
 namespace strings
 {
@@ -8,7 +9,8 @@ namespace strings
 
 	extern std::wstring emptystring;
 	void setTestInstance(HINSTANCE hInstance) noexcept;
-	std::wstring loadstring(DWORD dwID);
+	// Resource strings are loaded once and cached for the life of the process
+	const std::wstring& loadstring(DWORD dwID);
 	std::wstring formatV(LPCWSTR szMsg, va_list argList);
 	std::wstring format(LPCWSTR szMsg, ...);
 #ifdef CHECKFORMATPARAMS
@@ -20,10 +22,17 @@ namespace strings
 	std::wstring formatmessagesys(DWORD dwID);
 	std::wstring formatmessage(DWORD dwID, ...);
 	std::wstring formatmessage(LPCWSTR szMsg, ...);
+	std::wstring formatmessageV(LPCWSTR szMsg, va_list argList);
+	// Appends the formatted resource string to out instead of returning a new string
+	void appendmessage(std::wstring& out, DWORD dwID, ...);
+	void clearMessageCache();
 	std::basic_string<TCHAR> wstringTotstring(const std::wstring& src);
 	std::string wstringTostring(const std::wstring& src);
 	LPTSTR LPCSTRToLPTSTR(const LPCSTR src);
 	std::wstring stringTowstring(const std::string& src);
+	std::wstring utf8Towstring(const std::string& src);
+	// Length of src up to the end of its last complete UTF-8 sequence, for text which arrives in pieces
+	size_t utf8CompleteLength(const std::string& src) noexcept;
 	std::wstring LPCTSTRToWstring(LPCTSTR src);
 	std::wstring LPCSTRToWstring(LPCSTR src);
 	LPCWSTR wstringToLPCWSTR(const std::wstring& src) noexcept;
@@ -47,11 +56,16 @@ namespace strings
 	std::wstring trim(const std::wstring& szString);
 	std::wstring replace(const std::wstring& str, const std::function<bool(const WCHAR&)>& func, const WCHAR& chr);
 	std::wstring ScrubStringForXML(const std::wstring& szString);
+	// In place versions of the scrubbers, for strings we own and don't need to keep
+	void StripCharacterInPlace(std::wstring& szString, WCHAR character);
+	void ScrubStringForXMLInPlace(std::wstring& szString) noexcept;
+	bool NeedsScrubForXML(std::wstring_view szString) noexcept;
 	std::wstring SanitizeFileName(const std::wstring& szFileIn);
 	std::wstring indent(int iIndent);
 
 	std::string RemoveInvalidCharactersA(const std::string& szString, bool bMultiLine = true);
 	std::wstring RemoveInvalidCharactersW(const std::wstring& szString, bool bMultiLine = true);
+	void RemoveInvalidCharactersInPlace(std::wstring& szString, bool bMultiLine = true) noexcept;
 	std::wstring BinToTextStringW(const std::vector<BYTE>& lpByte, bool bMultiLine);
 	std::wstring BinToTextStringW(_In_opt_ const SBinary* lpBin, bool bMultiLine);
 	std::wstring BinToTextString(const std::vector<BYTE>& lpByte, bool bMultiLine);
@@ -61,14 +75,37 @@ namespace strings
 	std::wstring BinToHexString(_In_opt_ const SBinary* lpBin, bool bPrependCB);
 	bool stripPrefix(std::wstring& str, const std::wstring& prefix);
 	std::vector<BYTE> HexStringToBin(_In_ const std::wstring& input, size_t cbTarget = 0);
+	// Buffer based hex conversion. out must hold cb * 2 characters or cch / 2 bytes.
+	// HexToBin expects bare hex - no prefix or junk - and fails on any non hex character.
+	void BinToHex(_In_count_(cb) const BYTE* lpb, size_t cb, _Out_writes_(cb * 2) wchar_t* out) noexcept;
+	bool HexToBin(_In_count_(cch) const wchar_t* lpsz, size_t cch, _Out_writes_(cch / 2) BYTE* out) noexcept;
 
 	std::vector<std::wstring> split(const std::wstring& str, wchar_t delim);
 	std::wstring join(const std::vector<std::wstring>& elems, const std::wstring& delim, bool bSkipEmpty = false);
 	std::wstring join(const std::vector<std::wstring>& elems, wchar_t delim, bool bSkipEmpty = false);
+	// Allocation free versions of split, join and trim.
+	// Views point into the source string, which must outlive them.
+	// out is cleared first, so a caller can hand the same one in on every call and keep its capacity.
+	void split(std::wstring_view str, wchar_t delim, std::vector<std::wstring_view>& out);
+	void join(
+		std::wstring& out,
+		const std::vector<std::wstring>& elems,
+		std::wstring_view delim,
+		bool bSkipEmpty = false);
+	std::wstring_view trimView(std::wstring_view szString) noexcept;
+	std::wstring_view trimWhitespaceView(std::wstring_view szString) noexcept;
 
 	// Base64 functions
 	std::vector<BYTE> Base64Decode(const std::wstring& szEncodedStr);
 	std::wstring Base64Encode(size_t cbSourceBuf, _In_count_(cbSourceBuf) const BYTE* lpSourceBuffer);
+	// Buffer based Base64. Size the output with Base64DecodedSize/Base64EncodedSize.
+	size_t Base64DecodedSize(_In_count_(cch) const wchar_t* lpsz, size_t cch) noexcept;
+	constexpr size_t Base64EncodedSize(size_t cb) noexcept { return (cb + 2) / 3 * 4; }
+	bool Base64DecodeTo(_In_count_(cch) const wchar_t* lpsz, size_t cch, _Out_ BYTE* out) noexcept;
+	void Base64EncodeTo(
+		size_t cbSourceBuf,
+		_In_count_(cbSourceBuf) const BYTE* lpSourceBuffer,
+		_Out_ wchar_t* out) noexcept;
 
 	std::wstring CurrencyToString(const CURRENCY& curVal);
 